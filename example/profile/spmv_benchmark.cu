@@ -0,0 +1,85 @@
+#include <catch2/catch.hpp>
+#include <muda/muda.h>
+#include <muda/ext/linear_system.h>
+#include <example_common.h>
+using namespace muda;
+
+template <typename T, int BlockDim>
+void spmv_benchmark_of(int block_row_size, int blocks_per_row)
+{
+    using BlockMatrix = Eigen::Matrix<T, BlockDim, BlockDim>;
+
+    LinearSystemContext ctx;
+    int                 dimension = BlockDim * block_row_size;
+    int                 count     = block_row_size * blocks_per_row;
+
+    std::vector<int>         row_indices(count);
+    std::vector<int>         col_indices(count);
+    std::vector<BlockMatrix> blocks(count, BlockMatrix::Ones());
+    for(int i = 0; i < count; ++i)
+    {
+        row_indices[i] = i / blocks_per_row;
+        col_indices[i] = std::rand() % block_row_size;
+    }
+
+    DeviceTripletMatrix<T, BlockDim> A_triplet;
+    A_triplet.reshape(block_row_size, block_row_size);
+    A_triplet.resize_triplets(count);
+    A_triplet.block_row_indices().copy_from(row_indices.data());
+    A_triplet.block_col_indices().copy_from(col_indices.data());
+    A_triplet.block_values().copy_from(blocks.data());
+
+    DeviceBCOOMatrix<T, BlockDim> A_bcoo;
+    ctx.convert(A_triplet, A_bcoo);
+    DeviceBSRMatrix<T, BlockDim> A_bsr;
+    ctx.convert(A_bcoo, A_bsr);
+
+    DeviceDenseVector<T> x(dimension), y(dimension);
+    x.fill(1);
+
+    auto time = [&](auto&& f)
+    {
+        constexpr int repeat = 100;
+        Event         start{Event::Bit::eDefault};
+        Event         stop{Event::Bit::eDefault};
+        f();  // warm up
+        checkCudaErrors(cudaEventRecord(start, ctx.stream()));
+        for(int i = 0; i < repeat; ++i)
+            f();
+        checkCudaErrors(cudaEventRecord(stop, ctx.stream()));
+        checkCudaErrors(cudaEventSynchronize(stop));
+        return Event::elapsed_time(start, stop) / repeat;
+    };
+
+    auto atomic = time([&] { ctx.spmv(A_bcoo.cview(), x.cview(), y.view()); });
+    auto segmented = time([&] { ctx.spmv(A_bcoo, x.cview(), y.view()); });
+    ctx.spmv_policy().bsr_algorithm(LinearSystemBSRSpMVAlgorithm::CuSparse);
+    auto bsrmv = time([&] { ctx.spmv(A_bsr.cview(), x.cview(), y.view()); });
+    ctx.spmv_policy().bsr_algorithm(LinearSystemBSRSpMVAlgorithm::Custom);
+    auto custom_bsr = time([&] { ctx.spmv(A_bsr.cview(), x.cview(), y.view()); });
+
+    std::cout << "spmv " << (sizeof(T) == 8 ? "double" : "float") << " N=" << BlockDim
+              << " rows=" << block_row_size << " blocks/row=" << blocks_per_row
+              << ": atomic " << atomic << "ms, segmented " << segmented
+              << "ms, bsrmv " << bsrmv << "ms, custom bsr " << custom_bsr << "ms\n";
+}
+
+void spmv_benchmark()
+{
+    example_desc(R"(compare the spmv paths of LinearSystemContext on block
+matrices: the atomic and the segmented BCOO kernels, cuSPARSE bsrmv and
+the custom warp-per-block-row BSR kernel (N <= 8).)");
+
+    for(int blocks_per_row : {8, 32, 128})
+    {
+        spmv_benchmark_of<double, 3>(100000, blocks_per_row);
+        spmv_benchmark_of<double, 6>(50000, blocks_per_row);
+        spmv_benchmark_of<double, 9>(20000, blocks_per_row);
+        spmv_benchmark_of<double, 12>(10000, blocks_per_row);
+    }
+}
+
+TEST_CASE("spmv_benchmark", "[profile]")
+{
+    spmv_benchmark();
+}
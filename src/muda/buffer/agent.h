@@ -3,4 +3,5 @@
 #include <muda/buffer/agent/kernel_construct.h>
 #include <muda/buffer/agent/kernel_copy_construct.h>
 #include <muda/buffer/agent/kernel_destruct.h>
-#include <muda/buffer/agent/kernel_fill.h>
\ No newline at end of file
+#include <muda/buffer/agent/kernel_fill.h>
+#include <muda/buffer/agent/kernel_copy_batch.h>
\ No newline at end of file
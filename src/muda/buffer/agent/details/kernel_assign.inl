@@ -3,6 +3,7 @@
 #include <muda/buffer/buffer_view.h>
 #include <muda/buffer/buffer_2d_view.h>
 #include <muda/buffer/buffer_3d_view.h>
+#include <muda/buffer/agent/vectorize.h>
 
 namespace muda::details::buffer
 {
@@ -16,6 +17,72 @@ MUDA_INLINE MUDA_HOST void kernel_assign(cudaStream_t stream, VarView<T> dst, CV
                { *dst.data() = *src.data(); });
 }
 
+// assign 1D, 16-byte words
+template <typename T>
+MUDA_INLINE MUDA_HOST void kernel_assign_vectorized(int            grid_dim,
+                                                    int            block_dim,
+                                                    cudaStream_t   stream,
+                                                    BufferView<T>  dst,
+                                                    CBufferView<T> src)
+{
+    T*                 dst_data = dst.data();
+    const T*           src_data = src.data();
+    VectorRowLayout<T> layout{dst_data, dst.size()};
+
+    ParallelFor(grid_dim, block_dim, 0, stream)
+        .apply(layout.slot_count(),
+               [dst_data, src_data, layout] __device__(int i) mutable
+               {
+                   layout.apply(
+                       i,
+                       [&](size_t e) { dst_data[e] = src_data[e]; },
+                       [&](size_t e)
+                       {
+                           *reinterpret_cast<VectorWord*>(dst_data + e) =
+                               *reinterpret_cast<const VectorWord*>(src_data + e);
+                       });
+               });
+}
+
+// assign 2D/3D rows, 16-byte words
+template <typename T>
+MUDA_INLINE MUDA_HOST void kernel_assign_vectorized(int                  grid_dim,
+                                                    int                  block_dim,
+                                                    cudaStream_t         stream,
+                                                    PitchedRows<T>       dst,
+                                                    PitchedRows<const T> src)
+{
+    VectorRowLayout<T> layout{dst.base, dst.width};
+    size_t             slots_per_row = layout.slot_count();
+
+    ParallelFor(grid_dim, block_dim, 0, stream)
+        .apply(dst.rows * slots_per_row,
+               [dst, src, layout, slots_per_row] __device__(int i) mutable
+               {
+                   auto     r       = i / slots_per_row;
+                   T*       dst_row = dst.row(r);
+                   const T* src_row = src.row(r);
+                   layout.apply(
+                       i % slots_per_row,
+                       [&](size_t e) { dst_row[e] = src_row[e]; },
+                       [&](size_t e)
+                       {
+                           *reinterpret_cast<VectorWord*>(dst_row + e) =
+                               *reinterpret_cast<const VectorWord*>(src_row + e);
+                       });
+               });
+}
+
+// dst and src rows can share one layout only if they have the same
+// misalignment with respect to 16 bytes
+template <typename T>
+MUDA_INLINE MUDA_HOST bool can_assign_vectorized(const PitchedRows<T>&       dst,
+                                                 const PitchedRows<const T>& src)
+{
+    return dst.uniform_rows() && src.uniform_rows()
+           && word_misalignment(dst.base) == word_misalignment(src.base);
+}
+
 // assign 1D
 template <typename T>
 MUDA_INLINE MUDA_HOST void kernel_assign(int            grid_dim,
@@ -24,6 +91,16 @@ MUDA_INLINE MUDA_HOST void kernel_assign(int            grid_dim,
                                          BufferView<T>  dst,
                                          CBufferView<T> src)
 {
+    if constexpr(is_vectorizable_v<T>)
+    {
+        if(is_element_aligned(dst.data()) && is_element_aligned(src.data())
+           && word_misalignment(dst.data()) == word_misalignment(src.data()))
+        {
+            kernel_assign_vectorized(grid_dim, block_dim, stream, dst, src);
+            return;
+        }
+    }
+
     ParallelFor(grid_dim, block_dim, 0, stream)
         .apply(dst.size(),
                [dst, src] __device__(int i) mutable
@@ -38,6 +115,17 @@ MUDA_INLINE MUDA_HOST void kernel_assign(int              grid_dim,
                                          Buffer2DView<T>  dst,
                                          CBuffer2DView<T> src)
 {
+    if constexpr(is_vectorizable_v<T>)
+    {
+        auto dst_rows = make_pitched_rows(dst);
+        auto src_rows = make_pitched_rows(src);
+        if(can_assign_vectorized(dst_rows, src_rows))
+        {
+            kernel_assign_vectorized(grid_dim, block_dim, stream, dst_rows, src_rows);
+            return;
+        }
+    }
+
     ParallelFor(grid_dim, block_dim, 0, stream)
         .apply(dst.total_size(),
                [dst, src] __device__(int i) mutable
@@ -52,6 +140,17 @@ MUDA_INLINE MUDA_HOST void kernel_assign(int              grid_dim,
                                          Buffer3DView<T>  dst,
                                          CBuffer3DView<T> src)
 {
+    if constexpr(is_vectorizable_v<T>)
+    {
+        auto dst_rows = make_pitched_rows(dst);
+        auto src_rows = make_pitched_rows(src);
+        if(can_assign_vectorized(dst_rows, src_rows))
+        {
+            kernel_assign_vectorized(grid_dim, block_dim, stream, dst_rows, src_rows);
+            return;
+        }
+    }
+
     ParallelFor(grid_dim, block_dim, 0, stream)
         .apply(dst.total_size(),
                [dst, src] __device__(int i) mutable
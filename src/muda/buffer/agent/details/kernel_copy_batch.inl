@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <muda/launch/memory.h>
+#include <muda/launch/parallel_for.h>
+#include <muda/buffer/buffer_view.h>
+
+namespace muda::details::buffer
+{
+template <typename T>
+MUDA_INLINE MUDA_HOST size_t plan_copy_batch(std::vector<CopyBatchRange<T>>& ranges)
+{
+    // drop empty ranges
+    ranges.erase(std::remove_if(ranges.begin(),
+                                ranges.end(),
+                                [](const CopyBatchRange<T>& r)
+                                { return r.count == 0; }),
+                 ranges.end());
+
+    std::sort(ranges.begin(),
+              ranges.end(),
+              [](const CopyBatchRange<T>& a, const CopyBatchRange<T>& b)
+              { return a.dst < b.dst; });
+
+    // merge adjacent ranges
+    size_t tail = 0;
+    for(size_t i = 1; i < ranges.size(); ++i)
+    {
+        auto& last = ranges[tail];
+        auto& curr = ranges[i];
+
+        MUDA_ASSERT(last.dst + last.count <= curr.dst,
+                    "copy_batch: dst ranges overlap, dst[%p, %lld) and dst[%p, %lld)",
+                    last.dst,
+                    last.count,
+                    curr.dst,
+                    curr.count);
+
+        if(last.dst + last.count == curr.dst && last.src + last.count == curr.src)
+            last.count += curr.count;
+        else
+            ranges[++tail] = curr;
+    }
+    if(!ranges.empty())
+        ranges.resize(tail + 1);
+
+    size_t total = 0;
+    for(auto& r : ranges)
+    {
+        r.begin = total;
+        total += r.count;
+    }
+    return total;
+}
+
+template <typename T>
+MUDA_INLINE MUDA_HOST void kernel_copy_batch(int                        grid_dim,
+                                             int                        block_dim,
+                                             cudaStream_t               stream,
+                                             span<const BufferView<T>>  dst,
+                                             span<const CBufferView<T>> src)
+{
+    MUDA_ASSERT(dst.size() == src.size(),
+                "copy_batch: dst count(%lld) should be equal to src count(%lld)",
+                dst.size(),
+                src.size());
+
+    std::vector<CopyBatchRange<T>> ranges(dst.size());
+    for(size_t i = 0; i < dst.size(); ++i)
+    {
+        MUDA_ASSERT(dst[i].size() == src[i].size(),
+                    "copy_batch: the %lld-th BufferView pair should have the same size",
+                    i);
+        ranges[i].dst   = const_cast<T*>(dst[i].data());
+        ranges[i].src   = src[i].data();
+        ranges[i].count = src[i].size();
+    }
+
+    auto total = plan_copy_batch(ranges);
+    if(total == 0)
+        return;
+
+    if(ranges.size() == 1)  // everything merged, no need for a range table
+    {
+        auto r = ranges.front();
+        ParallelFor(grid_dim, block_dim, 0, stream)
+            .apply(static_cast<int>(r.count),
+                   [dst = r.dst, src = r.src] __device__(int i) mutable
+                   { dst[i] = src[i]; });
+        return;
+    }
+
+    // upload the range table, it's released in stream order after the kernel
+    CopyBatchRange<T>* d_ranges = nullptr;
+    auto               bytes    = ranges.size() * sizeof(CopyBatchRange<T>);
+    Memory(stream).alloc_1d(&d_ranges, bytes).upload(d_ranges, ranges.data(), bytes);
+
+    ParallelFor(grid_dim, block_dim, 0, stream)
+        .apply(static_cast<int>(total),
+               [table = d_ranges, table_size = static_cast<int>(ranges.size())] __device__(
+                   int i) mutable
+               {
+                   // find the last range with begin <= i
+                   int lo = 0;
+                   int hi = table_size - 1;
+                   while(lo < hi)
+                   {
+                       int mid = (lo + hi + 1) / 2;
+                       if(table[mid].begin <= i)
+                           lo = mid;
+                       else
+                           hi = mid - 1;
+                   }
+                   auto& r     = table[lo];
+                   auto  local = i - r.begin;
+                   r.dst[local] = r.src[local];
+               });
+
+    Memory(stream).free(d_ranges);
+}
+}  // namespace muda::details::buffer
@@ -4,6 +4,7 @@
 #include <muda/buffer/buffer_view.h>
 #include <muda/buffer/buffer_2d_view.h>
 #include <muda/buffer/buffer_3d_view.h>
+#include <muda/buffer/agent/vectorize.h>
 
 namespace muda::details::buffer
 {
@@ -24,11 +25,63 @@ MUDA_INLINE MUDA_HOST void kernel_fill(cudaStream_t stream, VarView<T> dst, cons
     }
 }
 
+// fill 1D, 16-byte words
+template <typename T>
+MUDA_INLINE MUDA_HOST void kernel_fill_vectorized(
+    int grid_dim, int block_dim, cudaStream_t stream, BufferView<T> dst, const T& val)
+{
+    T*                 data = dst.data();
+    VectorRowLayout<T> layout{data, dst.size()};
+    VectorWord         word = make_fill_word(val);
+
+    ParallelFor(grid_dim, block_dim, 0, stream)
+        .apply(layout.slot_count(),
+               [data, layout, val, word] __device__(int i) mutable
+               {
+                   layout.apply(
+                       i,
+                       [&](size_t e) { data[e] = val; },
+                       [&](size_t e)
+                       { *reinterpret_cast<VectorWord*>(data + e) = word; });
+               });
+}
+
+// fill 2D/3D rows, 16-byte words
+template <typename T>
+MUDA_INLINE MUDA_HOST void kernel_fill_vectorized(
+    int grid_dim, int block_dim, cudaStream_t stream, PitchedRows<T> dst, const T& val)
+{
+    VectorRowLayout<T> layout{dst.base, dst.width};
+    VectorWord         word          = make_fill_word(val);
+    size_t             slots_per_row = layout.slot_count();
+
+    ParallelFor(grid_dim, block_dim, 0, stream)
+        .apply(dst.rows * slots_per_row,
+               [dst, layout, slots_per_row, val, word] __device__(int i) mutable
+               {
+                   T* row = dst.row(i / slots_per_row);
+                   layout.apply(
+                       i % slots_per_row,
+                       [&](size_t e) { row[e] = val; },
+                       [&](size_t e)
+                       { *reinterpret_cast<VectorWord*>(row + e) = word; });
+               });
+}
+
 // fill 1D
 template <typename T>
 MUDA_INLINE MUDA_HOST void kernel_fill(
     int grid_dim, int block_dim, cudaStream_t stream, BufferView<T> dst, const T& val)
 {
+    if constexpr(is_vectorizable_v<T>)
+    {
+        if(is_element_aligned(dst.data()))
+        {
+            kernel_fill_vectorized(grid_dim, block_dim, stream, dst, val);
+            return;
+        }
+    }
+
     ParallelFor(grid_dim, block_dim, 0, stream)
         .apply(dst.size(),
                [dst, val] __device__(int i) mutable { *dst.data(i) = val; });
@@ -39,6 +92,16 @@ template <typename T>
 MUDA_INLINE MUDA_HOST void kernel_fill(
     int grid_dim, int block_dim, cudaStream_t stream, Buffer2DView<T> dst, const T& val)
 {
+    if constexpr(is_vectorizable_v<T>)
+    {
+        auto rows = make_pitched_rows(dst);
+        if(rows.uniform_rows())
+        {
+            kernel_fill_vectorized(grid_dim, block_dim, stream, rows, val);
+            return;
+        }
+    }
+
     ParallelFor(grid_dim, block_dim, 0, stream)
         .apply(dst.total_size(),
                [dst, val] __device__(int i) mutable { *dst.data(i) = val; });
@@ -49,6 +112,16 @@ template <typename T>
 MUDA_INLINE MUDA_HOST void kernel_fill(
     int grid_dim, int block_dim, cudaStream_t stream, Buffer3DView<T> dst, const T& val)
 {
+    if constexpr(is_vectorizable_v<T>)
+    {
+        auto rows = make_pitched_rows(dst);
+        if(rows.uniform_rows())
+        {
+            kernel_fill_vectorized(grid_dim, block_dim, stream, rows, val);
+            return;
+        }
+    }
+
     ParallelFor(grid_dim, block_dim, 0, stream)
         .apply(dst.total_size(),
                [dst, val] __device__(int i) mutable { *dst.data(i) = val; });
@@ -0,0 +1,36 @@
+#pragma once
+#include <cuda.h>
+#include <vector>
+#include <muda/mstl/span.h>
+#include <muda/buffer/buffer_fwd.h>
+
+namespace muda::details::buffer
+{
+// one contiguous range to copy, [begin, begin + count) is the position of
+// this range in the flattened batch
+template <typename T>
+class CopyBatchRange
+{
+  public:
+    T*       dst   = nullptr;
+    const T* src   = nullptr;
+    size_t   count = 0;
+    size_t   begin = 0;
+};
+
+// sort the ranges by dst address, merge the ranges which are contiguous in
+// both dst and src, and compute the flattened begin of each range.
+// return the total element count of the batch.
+template <typename T>
+MUDA_HOST size_t plan_copy_batch(std::vector<CopyBatchRange<T>>& ranges);
+
+// copy many small ranges in one kernel launch
+template <typename T>
+MUDA_HOST void kernel_copy_batch(int                        grid_dim,
+                                 int                        block_dim,
+                                 cudaStream_t               stream,
+                                 span<const BufferView<T>>  dst,
+                                 span<const CBufferView<T>> src);
+}  // namespace muda::details::buffer
+
+#include "details/kernel_copy_batch.inl"
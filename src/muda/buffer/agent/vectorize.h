@@ -0,0 +1,168 @@
+/*****************************************************************//**
+ * \file   vectorize.h
+ * \brief  Helpers for the 16-byte vectorized fill/assign agent kernels.
+ *
+ * A row of `count` elements is split into a scalar head (up to the first
+ * 16-byte boundary), a body of 16-byte words and a scalar tail. One thread
+ * handles one *slot* (a head element, a body word or a tail element), so
+ * small element types (char, short, float, int2 ...) are moved with
+ * 16-byte loads/stores instead of one narrow access per thread.
+ *********************************************************************/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <cuda_runtime.h>
+#include <muda/muda_def.h>
+#include <muda/type_traits/type_label.h>
+#include <muda/buffer/buffer_2d_view.h>
+#include <muda/buffer/buffer_3d_view.h>
+
+namespace muda::details::buffer
+{
+using VectorWord                       = uint4;
+inline constexpr size_t VectorWordSize = sizeof(VectorWord);
+
+// T can be moved by 16-byte words if it is trivially copy assignable and
+// exactly tiles a 16-byte word (16-byte types are already vectorized by nvcc)
+template <typename T>
+inline constexpr bool is_vectorizable_v =
+    muda::is_trivially_copy_assignable_v<T> && sizeof(T) < VectorWordSize
+    && VectorWordSize % sizeof(T) == 0;
+
+MUDA_INLINE MUDA_GENERIC size_t word_misalignment(const void* ptr) MUDA_NOEXCEPT
+{
+    return reinterpret_cast<uintptr_t>(ptr) % VectorWordSize;
+}
+
+template <typename T>
+MUDA_INLINE MUDA_GENERIC bool is_element_aligned(const T* ptr) MUDA_NOEXCEPT
+{
+    return reinterpret_cast<uintptr_t>(ptr) % sizeof(T) == 0;
+}
+
+template <typename T>
+class VectorRowLayout
+{
+  public:
+    static constexpr size_t ElementsPerWord = VectorWordSize / sizeof(T);
+
+    size_t head = 0;
+    size_t body = 0;  // in words
+    size_t tail = 0;
+
+    MUDA_GENERIC VectorRowLayout() = default;
+
+    // `row_begin` must be aligned to sizeof(T)
+    MUDA_GENERIC VectorRowLayout(const T* row_begin, size_t count) MUDA_NOEXCEPT
+    {
+        auto mis = word_misalignment(row_begin);
+        head     = mis == 0 ? 0 : (VectorWordSize - mis) / sizeof(T);
+        head     = head < count ? head : count;
+        body     = (count - head) / ElementsPerWord;
+        tail     = count - head - body * ElementsPerWord;
+    }
+
+    MUDA_GENERIC size_t slot_count() const MUDA_NOEXCEPT
+    {
+        return head + body + tail;
+    }
+
+    // call `scalar(element_index)` or `word(first_element_index)` for the slot
+    template <typename FScalar, typename FWord>
+    MUDA_GENERIC void apply(size_t slot, FScalar&& scalar, FWord&& word) const
+    {
+        if(slot < head)
+            scalar(slot);
+        else if(slot < head + body)
+            word(head + (slot - head) * ElementsPerWord);
+        else
+            scalar(head + body * ElementsPerWord + (slot - head - body));
+    }
+};
+
+// replicate `val` over a 16-byte word
+template <typename T>
+MUDA_INLINE MUDA_HOST VectorWord make_fill_word(const T& val)
+{
+    static_assert(is_vectorizable_v<T>, "T is not vectorizable");
+    VectorWord word;
+    auto       bytes = reinterpret_cast<std::byte*>(&word);
+    for(size_t i = 0; i < VectorRowLayout<T>::ElementsPerWord; ++i)
+        std::memcpy(bytes + i * sizeof(T), &val, sizeof(T));
+    return word;
+}
+
+/**
+ * \brief The rows of a 2D/3D pitched view, flattened as `depth * height` rows
+ * of `width` elements.
+ */
+template <typename T>
+class PitchedRows
+{
+  public:
+    T*     base             = nullptr;  // first element of the view
+    size_t pitch_bytes      = 0;
+    size_t pitch_bytes_area = 0;
+    size_t height           = 1;
+    size_t rows             = 0;
+    size_t width            = 0;
+
+    MUDA_GENERIC T* row(size_t r) const MUDA_NOEXCEPT
+    {
+        using byte_t = std::conditional_t<std::is_const_v<T>, const std::byte, std::byte>;
+        auto d = r / height;
+        auto h = r % height;
+        return reinterpret_cast<T*>(reinterpret_cast<byte_t*>(base)
+                                    + d * pitch_bytes_area + h * pitch_bytes);
+    }
+
+    // every row shares the layout of the first row
+    MUDA_GENERIC bool uniform_rows() const MUDA_NOEXCEPT
+    {
+        return pitch_bytes % VectorWordSize == 0
+               && pitch_bytes_area % VectorWordSize == 0 && is_element_aligned(base);
+    }
+};
+
+template <typename T>
+MUDA_INLINE MUDA_HOST PitchedRows<T> make_pitched_rows(Buffer2DView<T> v)
+{
+    auto h = v.extent().height();
+    return PitchedRows<T>{v.data(0, 0), v.pitch_bytes(), v.pitch_bytes() * h, h, h, v.extent().width()};
+}
+
+template <typename T>
+MUDA_INLINE MUDA_HOST PitchedRows<const T> make_pitched_rows(CBuffer2DView<T> v)
+{
+    auto h = v.extent().height();
+    return PitchedRows<const T>{
+        v.data(0, 0), v.pitch_bytes(), v.pitch_bytes() * h, h, h, v.extent().width()};
+}
+
+template <typename T>
+MUDA_INLINE MUDA_HOST PitchedRows<T> make_pitched_rows(Buffer3DView<T> v)
+{
+    auto e = v.extent();
+    return PitchedRows<T>{v.data(0, 0, 0),
+                          v.pitch_bytes(),
+                          v.pitch_bytes_area(),
+                          e.height(),
+                          e.depth() * e.height(),
+                          e.width()};
+}
+
+template <typename T>
+MUDA_INLINE MUDA_HOST PitchedRows<const T> make_pitched_rows(CBuffer3DView<T> v)
+{
+    auto e = v.extent();
+    return PitchedRows<const T>{v.data(0, 0, 0),
+                                v.pitch_bytes(),
+                                v.pitch_bytes_area(),
+                                e.height(),
+                                e.depth() * e.height(),
+                                e.width()};
+}
+}  // namespace muda::details::buffer
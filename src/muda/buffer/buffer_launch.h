@@ -2,6 +2,8 @@
 #include <muda/launch/launch_base.h>
 #include <muda/muda_config.h>
 #include <muda/tools/extent.h>
+#include <muda/mstl/span.h>
+#include <vector>
 
 namespace muda
 {
@@ -156,6 +158,20 @@ class BufferLaunch : public LaunchBase<BufferLaunch>
     MUDA_HOST BufferLaunch& copy(ComputeGraphVar<Buffer3DView<T>>&       dst,
                                  const ComputeGraphVar<Buffer3DView<T>>& src);
 
+    /**********************************************************************************************
+    * 
+    * BufferView Batch Copy: Device <- Device
+    * copy dst[i] <- src[i] for all i in one kernel launch, ranges which are adjacent
+    * in both dst and src are merged before launching.
+    * 
+    **********************************************************************************************/
+    template <typename T>
+    MUDA_HOST BufferLaunch& copy_batch(span<const BufferView<T>>  dst,
+                                       span<const CBufferView<T>> src);
+    template <typename T>
+    MUDA_HOST BufferLaunch& copy_batch(const std::vector<BufferView<T>>&  dst,
+                                       const std::vector<CBufferView<T>>& src);
+
     /**********************************************************************************************
     * 
     * BufferView Copy: Host <- Device
@@ -372,6 +372,29 @@ MUDA_HOST BufferLaunch& BufferLaunch::copy(ComputeGraphVar<Buffer3DView<T>>& dst
 }
 
 
+/**********************************************************************************************
+* 
+* BufferView Batch Copy: Device <- Device
+* 
+**********************************************************************************************/
+template <typename T>
+MUDA_HOST BufferLaunch& BufferLaunch::copy_batch(span<const BufferView<T>>  dst,
+                                                 span<const CBufferView<T>> src)
+{
+    MUDA_ASSERT(ComputeGraphBuilder::is_direct_launching(),
+                "copy_batch is not allowed in a compute graph");
+    details::buffer::kernel_copy_batch(m_grid_dim, m_block_dim, m_stream, dst, src);
+    return *this;
+}
+
+template <typename T>
+MUDA_HOST BufferLaunch& BufferLaunch::copy_batch(const std::vector<BufferView<T>>& dst,
+                                                 const std::vector<CBufferView<T>>& src)
+{
+    return copy_batch(span<const BufferView<T>>{dst}, span<const CBufferView<T>>{src});
+}
+
+
 /**********************************************************************************************
 * 
 * BufferView Copy: Host <- Device
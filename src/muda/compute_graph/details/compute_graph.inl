@@ -389,7 +389,7 @@ MUDA_INLINE void ComputeGraph::launch(bool single_stream, cudaStream_t s)
     }
     m_event_result = Event::QueryResult::eNotReady;
     checkCudaErrors(cudaEventRecord(m_event, s));
-#if MUDA_CHECK_ON
+#if MUDA_CHECK_LEVEL >= 1
     if(Debug::is_debug_sync_all())
         checkCudaErrors(cudaStreamSynchronize(s));
 #endif
@@ -1,3 +1,5 @@
 #pragma once
 #include <muda/container/var.h>
-#include <muda/container/vector.h>
\ No newline at end of file
+#include <muda/container/vector.h>
+#include <muda/container/append_buffer.h>
+#include <muda/container/hash_map.h>
\ No newline at end of file
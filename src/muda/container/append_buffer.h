@@ -0,0 +1,141 @@
+/*****************************************************************//**
+ * \file   append_buffer.h
+ * \brief  A device buffer that kernels can append to, with warp-aggregated
+ * `push()` and a host-side grow-and-retry protocol for overflow.
+ *
+ * usage:
+ *  DeviceAppendBuffer<int2> pairs(1024);
+ *  pairs.grow_and_retry(
+ *      [&](AppendBufferViewer<int2> out)
+ *      {
+ *          ParallelFor(256).apply(N,
+ *              [out] __device__(int i) mutable
+ *              {
+ *                  if(overlap(i)) out.push(make_int2(i, j));
+ *              });
+ *      });
+ *  pairs.view(); // the appended elements
+ *********************************************************************/
+
+#pragma once
+#include <vector>
+#include <muda/viewer/viewer_base.h>
+#include <muda/buffer/device_buffer.h>
+#include <muda/buffer/device_var.h>
+
+namespace muda
+{
+namespace details
+{
+    class AppendBufferState
+    {
+      public:
+        // number of pushes requested, may exceed the capacity
+        int count = 0;
+        // set by any push that did not fit
+        int overflow = 0;
+    };
+}  // namespace details
+
+template <typename T>
+class AppendBufferViewer : public ViewerBase<false>
+{
+    MUDA_VIEWER_COMMON_NAME(AppendBufferViewer);
+
+    T*                          m_data     = nullptr;
+    int                         m_capacity = 0;
+    details::AppendBufferState* m_state    = nullptr;
+
+  public:
+    using value_type = T;
+
+    MUDA_GENERIC AppendBufferViewer() = default;
+    MUDA_GENERIC AppendBufferViewer(T* data, int capacity, details::AppendBufferState* state) MUDA_NOEXCEPT
+        : m_data(data),
+          m_capacity(capacity),
+          m_state(state)
+    {
+    }
+
+    /**
+     * \brief Append a value, all active lanes of a warp share a single atomic
+     * (the active lanes must push to the same buffer).
+     *
+     * \return the index of the value in the buffer, or -1 if the buffer
+     * overflowed (the overflow flag is raised and the required size is still
+     * counted, so that the host can grow the buffer and retry).
+     */
+    MUDA_DEVICE int push(const T& value) MUDA_NOEXCEPT;
+
+    /**
+     * \brief Reserve `n` contiguous slots for this thread.
+     *
+     * \return the first index, or -1 if the slots do not fit.
+     */
+    MUDA_DEVICE int reserve(int n) MUDA_NOEXCEPT;
+
+    // write to a slot returned by `reserve()`
+    MUDA_GENERIC T& operator()(int i) MUDA_NOEXCEPT;
+
+    MUDA_GENERIC int capacity() const MUDA_NOEXCEPT { return m_capacity; }
+
+  private:
+    MUDA_DEVICE int warp_aggregated_reserve() MUDA_NOEXCEPT;
+    MUDA_DEVICE int check_fit(int begin, int n) MUDA_NOEXCEPT;
+};
+
+/**
+ * \brief A device buffer filled by kernels through `AppendBufferViewer::push()`.
+ *
+ * Host operations run on the default stream and are synchronous, like
+ * `DeviceBuffer`.
+ */
+template <typename T>
+class DeviceAppendBuffer
+{
+    DeviceBuffer<T>                       m_data;
+    DeviceVar<details::AppendBufferState> m_state;
+
+  public:
+    using value_type = T;
+
+    DeviceAppendBuffer(size_t capacity = 0);
+
+    // grow the capacity, keeping the appended elements
+    void reserve(size_t capacity);
+    // drop all appended elements and the overflow flag
+    void clear();
+
+    // number of appended elements that fit in the buffer
+    size_t size() const;
+    // number of elements the kernels tried to append
+    size_t required_size() const;
+    size_t capacity() const MUDA_NOEXCEPT { return m_data.size(); }
+    bool   overflowed() const;
+
+    /**
+     * \brief Run `launch(viewer)`, if it overflows, grow the buffer to the
+     * required size, roll back to the current size and run it again.
+     *
+     * `launch` is rerun as a whole, so it must not depend on the pushes of
+     * the failed run.
+     *
+     * \return the number of retries
+     */
+    template <typename F>
+    int grow_and_retry(F&& launch, int max_retry = 4);
+
+    AppendBufferViewer<T> viewer() MUDA_NOEXCEPT;
+
+    BufferView<T>  view() { return m_data.view(0, size()); }
+    CBufferView<T> view() const { return m_data.view(0, size()); }
+
+    void copy_to(std::vector<T>& host) const;
+
+  private:
+    details::AppendBufferState state() const;
+    void                       set_count(int count);
+};
+}  // namespace muda
+
+#include "details/append_buffer.inl"
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <muda/cuda/cooperative_groups.h>
+
+namespace muda
+{
+template <typename T>
+MUDA_DEVICE int AppendBufferViewer<T>::warp_aggregated_reserve() MUDA_NOEXCEPT
+{
+    namespace cg = cooperative_groups;
+
+    // one atomic per group of lanes that reach the push together
+    auto g    = cg::coalesced_threads();
+    int  base = 0;
+    if(g.thread_rank() == 0)
+        base = atomicAdd(&m_state->count, static_cast<int>(g.size()));
+    base = g.shfl(base, 0);
+    return base + static_cast<int>(g.thread_rank());
+}
+
+template <typename T>
+MUDA_DEVICE int AppendBufferViewer<T>::check_fit(int begin, int n) MUDA_NOEXCEPT
+{
+    if(begin + n > m_capacity)
+    {
+        m_state->overflow = 1;
+        return -1;
+    }
+    return begin;
+}
+
+template <typename T>
+MUDA_DEVICE int AppendBufferViewer<T>::push(const T& value) MUDA_NOEXCEPT
+{
+    if constexpr(DEBUG_VIEWER)
+        if(m_state == nullptr)
+            MUDA_KERNEL_ERROR("AppendBufferViewer[%s:%s]: state is null",
+                              this->name(),
+                              this->kernel_name());
+
+    auto i = check_fit(warp_aggregated_reserve(), 1);
+    if(i >= 0)
+        m_data[i] = value;
+    return i;
+}
+
+template <typename T>
+MUDA_DEVICE int AppendBufferViewer<T>::reserve(int n) MUDA_NOEXCEPT
+{
+    if constexpr(DEBUG_VIEWER)
+        if(m_state == nullptr)
+            MUDA_KERNEL_ERROR("AppendBufferViewer[%s:%s]: state is null",
+                              this->name(),
+                              this->kernel_name());
+
+    return check_fit(atomicAdd(&m_state->count, n), n);
+}
+
+template <typename T>
+MUDA_GENERIC T& AppendBufferViewer<T>::operator()(int i) MUDA_NOEXCEPT
+{
+    if constexpr(DEBUG_VIEWER)
+        if(!(i >= 0 && i < m_capacity))
+            MUDA_KERNEL_ERROR("AppendBufferViewer[%s:%s]: out of range, index=(%d) capacity=(%d)",
+                              this->name(),
+                              this->kernel_name(),
+                              i,
+                              m_capacity);
+    return m_data[i];
+}
+
+template <typename T>
+DeviceAppendBuffer<T>::DeviceAppendBuffer(size_t capacity)
+    : m_data(capacity)
+    , m_state(details::AppendBufferState{})
+{
+}
+
+template <typename T>
+void DeviceAppendBuffer<T>::reserve(size_t capacity)
+{
+    if(capacity > m_data.size())
+        m_data.resize(capacity);
+}
+
+template <typename T>
+void DeviceAppendBuffer<T>::clear()
+{
+    set_count(0);
+}
+
+template <typename T>
+details::AppendBufferState DeviceAppendBuffer<T>::state() const
+{
+    return m_state;
+}
+
+template <typename T>
+void DeviceAppendBuffer<T>::set_count(int count)
+{
+    details::AppendBufferState s;
+    s.count = count;
+    m_state = s;
+}
+
+template <typename T>
+size_t DeviceAppendBuffer<T>::size() const
+{
+    return std::min(required_size(), capacity());
+}
+
+template <typename T>
+size_t DeviceAppendBuffer<T>::required_size() const
+{
+    return static_cast<size_t>(state().count);
+}
+
+template <typename T>
+bool DeviceAppendBuffer<T>::overflowed() const
+{
+    return state().overflow != 0;
+}
+
+template <typename T>
+template <typename F>
+int DeviceAppendBuffer<T>::grow_and_retry(F&& launch, int max_retry)
+{
+    auto s = state();
+    MUDA_ASSERT(!s.overflow,
+                "DeviceAppendBuffer already overflowed (required=%d, capacity=%d), call clear() first",
+                s.count,
+                (int)capacity());
+
+    // roll back point
+    int begin = s.count;
+    launch(viewer());
+
+    int retry = 0;
+    for(s = state(); s.overflow; s = state())
+    {
+        MUDA_ASSERT(retry < max_retry,
+                    "DeviceAppendBuffer still overflows after %d retries (required=%d, capacity=%d)",
+                    retry,
+                    s.count,
+                    (int)capacity());
+        reserve(s.count);
+        set_count(begin);
+        launch(viewer());
+        ++retry;
+    }
+    return retry;
+}
+
+template <typename T>
+AppendBufferViewer<T> DeviceAppendBuffer<T>::viewer() MUDA_NOEXCEPT
+{
+    return AppendBufferViewer<T>{m_data.data(), static_cast<int>(m_data.size()), m_state.data()};
+}
+
+template <typename T>
+void DeviceAppendBuffer<T>::copy_to(std::vector<T>& host) const
+{
+    auto v = view();
+    host.resize(v.size());
+    v.copy_to(host.data());
+}
+}  // namespace muda
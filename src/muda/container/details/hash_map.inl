@@ -0,0 +1,416 @@
+#include <muda/launch/parallel_for.h>
+
+namespace muda
+{
+namespace details::hash_map
+{
+    template <typename K>
+    MUDA_INLINE MUDA_GENERIC K load(const K* address) MUDA_NOEXCEPT
+    {
+#ifdef __CUDA_ARCH__
+        return *reinterpret_cast<const volatile K*>(address);
+#else
+        return *address;
+#endif
+    }
+
+    template <typename K>
+    MUDA_INLINE MUDA_GENERIC K cas(K* address, K compare, K val) MUDA_NOEXCEPT
+    {
+#ifdef __CUDA_ARCH__
+        if constexpr(sizeof(K) == 4)
+        {
+            using U = unsigned int;
+            return static_cast<K>(atomicCAS(reinterpret_cast<U*>(address),
+                                            static_cast<U>(compare),
+                                            static_cast<U>(val)));
+        }
+        else
+        {
+            using U = unsigned long long int;
+            return static_cast<K>(atomicCAS(reinterpret_cast<U*>(address),
+                                            static_cast<U>(compare),
+                                            static_cast<U>(val)));
+        }
+#else
+        K old = *address;
+        if(old == compare)
+            *address = val;
+        return old;
+#endif
+    }
+
+    MUDA_INLINE MUDA_GENERIC void add(int* address, int val) MUDA_NOEXCEPT
+    {
+#ifdef __CUDA_ARCH__
+        atomicAdd(address, val);
+#else
+        *address += val;
+#endif
+    }
+
+    // smallest power of 2 (>= 16) holding `size` keys under the load factor
+    MUDA_INLINE size_t required_capacity(size_t size, float max_load_factor)
+    {
+        size_t capacity = 16;
+        while(capacity * max_load_factor < size)
+            capacity <<= 1;
+        return capacity;
+    }
+}  // namespace details::hash_map
+
+/*****************************************************************************
+ *
+ * HashMapViewerBase
+ *
+ *****************************************************************************/
+
+template <bool IsConst, typename K, typename V, typename Hash>
+MUDA_GENERIC int HashMapViewerBase<IsConst, K, V, Hash>::find(const K& key) const MUDA_NOEXCEPT
+{
+    if(key == EmptyKey || key == TombstoneKey)
+        return -1;
+
+    int mask = m_capacity - 1;
+    int s    = home_slot(key);
+    for(int i = 0; i < m_capacity; ++i)
+    {
+        K cur = details::hash_map::load(m_keys + s);
+        if(cur == key)
+            return s;
+        if(cur == EmptyKey)
+            return -1;
+        s = (s + 1) & mask;
+    }
+    return -1;
+}
+
+template <bool IsConst, typename K, typename V, typename Hash>
+MUDA_GENERIC auto HashMapViewerBase<IsConst, K, V, Hash>::find_value(const K& key)
+    MUDA_NOEXCEPT->auto_const_t<V>*
+{
+    auto s = find(key);
+    return s >= 0 ? m_values + s : nullptr;
+}
+
+template <bool IsConst, typename K, typename V, typename Hash>
+template <bool Enable, std::enable_if_t<Enable, int>>
+MUDA_GENERIC int HashMapViewerBase<IsConst, K, V, Hash>::insert(const K& key,
+                                                                const V& value) MUDA_NOEXCEPT
+{
+    check_key(key);
+
+    int mask = m_capacity - 1;
+    int s    = home_slot(key);
+    for(int i = 0; i < m_capacity; ++i)
+    {
+        K cur = details::hash_map::load(m_keys + s);
+        if(cur == EmptyKey)
+        {
+            // tombstones are never reclaimed here: the key may live further
+            // down the probe sequence
+            cur = details::hash_map::cas(m_keys + s, EmptyKey, key);
+            if(cur == EmptyKey)
+            {
+                m_values[s] = value;
+                details::hash_map::add(&m_state->size, 1);
+                details::hash_map::add(&m_state->used, 1);
+                return s;
+            }
+        }
+        if(cur == key)
+        {
+            m_values[s] = value;
+            return s;
+        }
+        s = (s + 1) & mask;
+    }
+
+    if constexpr(DEBUG_VIEWER)
+        MUDA_KERNEL_ERROR("HashMap[%s:%s]: table is full, capacity=%d",
+                          this->name(),
+                          this->kernel_name(),
+                          m_capacity);
+    return -1;
+}
+
+template <bool IsConst, typename K, typename V, typename Hash>
+template <bool Enable, std::enable_if_t<Enable, int>>
+MUDA_GENERIC bool HashMapViewerBase<IsConst, K, V, Hash>::erase(const K& key) MUDA_NOEXCEPT
+{
+    auto s = find(key);
+    if(s < 0)
+        return false;
+    if(details::hash_map::cas(m_keys + s, key, TombstoneKey) != key)
+        return false;  // erased by another thread
+    details::hash_map::add(&m_state->size, -1);
+    return true;
+}
+
+template <bool IsConst, typename K, typename V, typename Hash>
+MUDA_GENERIC int HashMapViewerBase<IsConst, K, V, Hash>::check_slot(int slot) const MUDA_NOEXCEPT
+{
+    if constexpr(DEBUG_VIEWER)
+        if(!(slot >= 0 && slot < m_capacity))
+            MUDA_KERNEL_ERROR("HashMap[%s:%s]: slot out of range, slot=(%d) capacity=(%d)",
+                              this->name(),
+                              this->kernel_name(),
+                              slot,
+                              m_capacity);
+    return slot;
+}
+
+template <bool IsConst, typename K, typename V, typename Hash>
+MUDA_GENERIC void HashMapViewerBase<IsConst, K, V, Hash>::check_key(const K& key) const MUDA_NOEXCEPT
+{
+    if constexpr(DEBUG_VIEWER)
+        if(key == EmptyKey || key == TombstoneKey)
+            MUDA_KERNEL_ERROR("HashMap[%s:%s]: key (%lld) is reserved",
+                              this->name(),
+                              this->kernel_name(),
+                              (long long)key);
+}
+
+/*****************************************************************************
+ *
+ * DeviceHashMap
+ *
+ *****************************************************************************/
+
+template <typename K, typename V, typename Hash>
+DeviceHashMap<K, V, Hash>::DeviceHashMap(size_t expected_size, float max_load_factor, const Hash& hash)
+    : m_state(details::HashMapState{})
+    , m_max_load_factor(max_load_factor)
+    , m_hash(hash)
+{
+    MUDA_ASSERT(max_load_factor > 0.0f && max_load_factor < 1.0f,
+                "max_load_factor should be in (0, 1), yours = %f",
+                max_load_factor);
+    rehash(details::hash_map::required_capacity(expected_size, m_max_load_factor));
+}
+
+template <typename K, typename V, typename Hash>
+void DeviceHashMap<K, V, Hash>::reserve(size_t size)
+{
+    auto c = details::hash_map::required_capacity(size, m_max_load_factor);
+    if(c > capacity())
+        rehash(c);
+}
+
+template <typename K, typename V, typename Hash>
+void DeviceHashMap<K, V, Hash>::clear()
+{
+    m_keys.fill(Viewer::EmptyKey);
+    m_state = details::HashMapState{};
+}
+
+template <typename K, typename V, typename Hash>
+void DeviceHashMap<K, V, Hash>::rehash(size_t new_capacity)
+{
+    DeviceBuffer<K> old_keys   = std::move(m_keys);
+    DeviceBuffer<V> old_values = std::move(m_values);
+
+    m_keys = DeviceBuffer<K>{};
+    m_keys.resize(new_capacity, Viewer::EmptyKey);
+    m_values = DeviceBuffer<V>{};
+    m_values.resize(new_capacity);
+    m_state = details::HashMapState{};
+
+    if(old_keys.size() == 0)
+        return;
+
+    ParallelFor(256)
+        .kernel_name(__FUNCTION__)
+        .apply(old_keys.size(),
+               [old = CViewer{old_keys.data(), old_values.data(), nullptr, (int)old_keys.size(), m_hash},
+                map = viewer()] __device__(int i) mutable
+               {
+                   if(old.is_occupied(i))
+                       map.insert(old.key_at(i), old.value_at(i));
+               })
+        .wait();
+}
+
+template <typename K, typename V, typename Hash>
+void DeviceHashMap<K, V, Hash>::insert(CBufferView<K> keys, CBufferView<V> values)
+{
+    MUDA_ASSERT(keys.size() == values.size(),
+                "keys and values should have the same size, keys=%d, values=%d",
+                (int)keys.size(),
+                (int)values.size());
+
+    details::HashMapState s = m_state;
+    // tombstones occupy slots too, rehash drops them
+    if((s.used + keys.size()) > capacity() * m_max_load_factor)
+        rehash(details::hash_map::required_capacity(s.size + keys.size(), m_max_load_factor));
+
+    ParallelFor(256)
+        .kernel_name(__FUNCTION__)
+        .apply(keys.size(),
+               [map = viewer(), keys = keys.cviewer(), values = values.cviewer()] __device__(
+                   int i) mutable { map.insert(keys(i), values(i)); });
+}
+
+template <typename K, typename V, typename Hash>
+void DeviceHashMap<K, V, Hash>::find(CBufferView<K> keys, BufferView<V> values, const V& not_found) const
+{
+    MUDA_ASSERT(keys.size() == values.size(),
+                "keys and values should have the same size, keys=%d, values=%d",
+                (int)keys.size(),
+                (int)values.size());
+
+    ParallelFor(256)
+        .kernel_name(__FUNCTION__)
+        .apply(keys.size(),
+               [map = cviewer(), keys = keys.cviewer(), values = values.viewer(), not_found] __device__(
+                   int i) mutable
+               {
+                   auto v    = map.find_value(keys(i));
+                   values(i) = v ? *v : not_found;
+               });
+}
+
+template <typename K, typename V, typename Hash>
+void DeviceHashMap<K, V, Hash>::find_slots(CBufferView<K> keys, BufferView<int> slots) const
+{
+    MUDA_ASSERT(keys.size() == slots.size(),
+                "keys and slots should have the same size, keys=%d, slots=%d",
+                (int)keys.size(),
+                (int)slots.size());
+
+    ParallelFor(256)
+        .kernel_name(__FUNCTION__)
+        .apply(keys.size(),
+               [map = cviewer(), keys = keys.cviewer(), slots = slots.viewer()] __device__(
+                   int i) mutable { slots(i) = map.find(keys(i)); });
+}
+
+template <typename K, typename V, typename Hash>
+void DeviceHashMap<K, V, Hash>::erase(CBufferView<K> keys)
+{
+    ParallelFor(256)
+        .kernel_name(__FUNCTION__)
+        .apply(keys.size(),
+               [map = viewer(), keys = keys.cviewer()] __device__(int i) mutable
+               { map.erase(keys(i)); });
+}
+
+template <typename K, typename V, typename Hash>
+size_t DeviceHashMap<K, V, Hash>::size() const
+{
+    details::HashMapState s = m_state;
+    return s.size;
+}
+
+template <typename K, typename V, typename Hash>
+auto DeviceHashMap<K, V, Hash>::viewer() MUDA_NOEXCEPT->Viewer
+{
+    return Viewer{m_keys.data(), m_values.data(), m_state.data(), (int)capacity(), m_hash};
+}
+
+template <typename K, typename V, typename Hash>
+auto DeviceHashMap<K, V, Hash>::cviewer() const MUDA_NOEXCEPT->CViewer
+{
+    return CViewer{m_keys.data(), m_values.data(), m_state.data(), (int)capacity(), m_hash};
+}
+
+/*****************************************************************************
+ *
+ * HostHashMap
+ *
+ *****************************************************************************/
+
+template <typename K, typename V, typename Hash>
+HostHashMap<K, V, Hash>::HostHashMap(size_t expected_size, float max_load_factor, const Hash& hash)
+    : m_max_load_factor(max_load_factor)
+    , m_hash(hash)
+{
+    MUDA_ASSERT(max_load_factor > 0.0f && max_load_factor < 1.0f,
+                "max_load_factor should be in (0, 1), yours = %f",
+                max_load_factor);
+    rehash(details::hash_map::required_capacity(expected_size, m_max_load_factor));
+}
+
+template <typename K, typename V, typename Hash>
+void HostHashMap<K, V, Hash>::reserve(size_t size)
+{
+    auto c = details::hash_map::required_capacity(size, m_max_load_factor);
+    if(c > capacity())
+        rehash(c);
+}
+
+template <typename K, typename V, typename Hash>
+void HostHashMap<K, V, Hash>::clear()
+{
+    std::fill(m_keys.begin(), m_keys.end(), Viewer::EmptyKey);
+    m_state = details::HashMapState{};
+}
+
+template <typename K, typename V, typename Hash>
+void HostHashMap<K, V, Hash>::rehash(size_t new_capacity)
+{
+    std::vector<K> old_keys   = std::move(m_keys);
+    std::vector<V> old_values = std::move(m_values);
+
+    m_keys.assign(new_capacity, Viewer::EmptyKey);
+    m_values.assign(new_capacity, V{});
+    m_state = details::HashMapState{};
+
+    CViewer old{old_keys.data(), old_values.data(), nullptr, (int)old_keys.size(), m_hash};
+    auto    map = viewer();
+    for(int i = 0; i < (int)old_keys.size(); ++i)
+        if(old.is_occupied(i))
+            map.insert(old.key_at(i), old.value_at(i));
+}
+
+template <typename K, typename V, typename Hash>
+void HostHashMap<K, V, Hash>::insert(const std::vector<K>& keys, const std::vector<V>& values)
+{
+    MUDA_ASSERT(keys.size() == values.size(),
+                "keys and values should have the same size, keys=%d, values=%d",
+                (int)keys.size(),
+                (int)values.size());
+
+    if((m_state.used + keys.size()) > capacity() * m_max_load_factor)
+        rehash(details::hash_map::required_capacity(m_state.size + keys.size(),
+                                                    m_max_load_factor));
+
+    auto map = viewer();
+    for(size_t i = 0; i < keys.size(); ++i)
+        map.insert(keys[i], values[i]);
+}
+
+template <typename K, typename V, typename Hash>
+void HostHashMap<K, V, Hash>::find(const std::vector<K>& keys,
+                                   std::vector<V>&       values,
+                                   const V&              not_found) const
+{
+    values.resize(keys.size());
+    auto map = cviewer();
+    for(size_t i = 0; i < keys.size(); ++i)
+    {
+        auto v    = map.find_value(keys[i]);
+        values[i] = v ? *v : not_found;
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void HostHashMap<K, V, Hash>::erase(const std::vector<K>& keys)
+{
+    auto map = viewer();
+    for(auto& key : keys)
+        map.erase(key);
+}
+
+template <typename K, typename V, typename Hash>
+auto HostHashMap<K, V, Hash>::viewer() MUDA_NOEXCEPT->Viewer
+{
+    return Viewer{m_keys.data(), m_values.data(), &m_state, (int)capacity(), m_hash};
+}
+
+template <typename K, typename V, typename Hash>
+auto HostHashMap<K, V, Hash>::cviewer() const MUDA_NOEXCEPT->CViewer
+{
+    return CViewer{m_keys.data(), m_values.data(), &m_state, (int)capacity(), m_hash};
+}
+}  // namespace muda
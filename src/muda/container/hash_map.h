@@ -0,0 +1,280 @@
+/*****************************************************************//**
+ * \file   hash_map.h
+ * \brief  An open-addressing (linear probing) hash map on the device, with
+ * bulk host operations and a viewer for in-kernel lookups and inserts.
+ *
+ * The probing code lives in `HashMapViewerBase` and is `MUDA_GENERIC`, so the
+ * host reference `HostHashMap` runs exactly the same code as the device.
+ *
+ * Keys must be 4 or 8 byte integers. The two largest key values
+ * (`EmptyKey`/`TombstoneKey`, i.e. -1/-2 for signed keys) are reserved.
+ *
+ * An insert publishes the key before it stores the value, so `insert()` and
+ * `find()`/`find_value()` must not run concurrently (e.g. in the same kernel):
+ * a concurrent lookup may see the key with a stale value. Inserts among
+ * themselves, and lookups among themselves, are safe.
+ *
+ * usage:
+ *  DeviceHashMap<uint64_t, int> map(1024);
+ *  map.insert(keys, values);
+ *  map.find(keys, found_values, -1);
+ *  ParallelFor(256).apply(N,
+ *      [map = map.cviewer()] __device__(int i)
+ *      {
+ *          auto v = map.find_value(cell_key(i));
+ *          if(v) ...
+ *      });
+ *********************************************************************/
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <muda/viewer/viewer_base.h>
+#include <muda/buffer/device_buffer.h>
+#include <muda/buffer/device_var.h>
+
+namespace muda
+{
+namespace details
+{
+    class HashMapState
+    {
+      public:
+        // live keys
+        int size = 0;
+        // non-empty slots (live keys + tombstones)
+        int used = 0;
+    };
+}  // namespace details
+
+/**
+ * \brief splitmix64 finalizer
+ */
+template <typename K>
+class HashMapDefaultHash
+{
+  public:
+    MUDA_GENERIC uint64_t operator()(const K& key) const MUDA_NOEXCEPT
+    {
+        uint64_t x = static_cast<uint64_t>(key);
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+};
+
+template <bool IsConst, typename K, typename V, typename Hash = HashMapDefaultHash<K>>
+class HashMapViewerBase : public ViewerBase<IsConst>
+{
+    static_assert(std::is_integral_v<K> && (sizeof(K) == 4 || sizeof(K) == 8),
+                  "HashMap key must be a 4 or 8 byte integer");
+
+    using Base = ViewerBase<IsConst>;
+    template <typename U>
+    using auto_const_t = typename Base::template auto_const_t<U>;
+
+    MUDA_VIEWER_COMMON_NAME(HashMapViewerBase);
+
+  public:
+    using ConstViewer    = HashMapViewerBase<true, K, V, Hash>;
+    using NonConstViewer = HashMapViewerBase<false, K, V, Hash>;
+    using ThisViewer     = HashMapViewerBase<IsConst, K, V, Hash>;
+
+    using key_type    = K;
+    using mapped_type = V;
+
+    static constexpr K EmptyKey     = static_cast<K>(~0ull);
+    static constexpr K TombstoneKey = static_cast<K>(~1ull);
+
+  protected:
+    auto_const_t<K>*                     m_keys     = nullptr;
+    auto_const_t<V>*                     m_values   = nullptr;
+    auto_const_t<details::HashMapState>* m_state    = nullptr;
+    int                                  m_capacity = 0;  // power of 2
+    Hash                                 m_hash;
+
+  public:
+    MUDA_GENERIC HashMapViewerBase() MUDA_NOEXCEPT = default;
+
+    MUDA_GENERIC HashMapViewerBase(auto_const_t<K>*                     keys,
+                                   auto_const_t<V>*                     values,
+                                   auto_const_t<details::HashMapState>* state,
+                                   int                                  capacity,
+                                   const Hash& hash = Hash{}) MUDA_NOEXCEPT
+        : m_keys(keys),
+          m_values(values),
+          m_state(state),
+          m_capacity(capacity),
+          m_hash(hash)
+    {
+    }
+
+    MUDA_GENERIC auto as_const() const MUDA_NOEXCEPT
+    {
+        return ConstViewer{m_keys, m_values, m_state, m_capacity, m_hash};
+    }
+
+    MUDA_GENERIC operator ConstViewer() const MUDA_NOEXCEPT
+    {
+        return as_const();
+    }
+
+    // slot of the key, or -1 if it is not in the map
+    MUDA_GENERIC int find(const K& key) const MUDA_NOEXCEPT;
+
+    // pointer to the value of the key, or nullptr if it is not in the map
+    MUDA_GENERIC auto_const_t<V>* find_value(const K& key) MUDA_NOEXCEPT;
+    MUDA_GENERIC const V*         find_value(const K& key) const MUDA_NOEXCEPT
+    {
+        return remove_const(*this).find_value(key);
+    }
+
+    MUDA_GENERIC bool contains(const K& key) const MUDA_NOEXCEPT
+    {
+        return find(key) >= 0;
+    }
+
+    /**
+     * \brief Insert the key or assign the value if the key is already in the map.
+     *
+     * Concurrent inserts of the same key keep one of the values. Don't look
+     * keys up while other threads insert: the value is stored after the key
+     * becomes visible.
+     *
+     * \return the slot, or -1 if the table is full
+     */
+    template <bool Enable = !IsConst, std::enable_if_t<Enable, int> = 0>
+    MUDA_GENERIC int insert(const K& key, const V& value) MUDA_NOEXCEPT;
+
+    // \return true if the key was in the map
+    template <bool Enable = !IsConst, std::enable_if_t<Enable, int> = 0>
+    MUDA_GENERIC bool erase(const K& key) MUDA_NOEXCEPT;
+
+    MUDA_GENERIC const K& key_at(int slot) const MUDA_NOEXCEPT
+    {
+        return m_keys[check_slot(slot)];
+    }
+
+    MUDA_GENERIC auto_const_t<V>& value_at(int slot) MUDA_NOEXCEPT
+    {
+        return m_values[check_slot(slot)];
+    }
+
+    MUDA_GENERIC const V& value_at(int slot) const MUDA_NOEXCEPT
+    {
+        return remove_const(*this).value_at(slot);
+    }
+
+    // whether the slot holds a live key
+    MUDA_GENERIC bool is_occupied(int slot) const MUDA_NOEXCEPT
+    {
+        auto k = key_at(slot);
+        return k != EmptyKey && k != TombstoneKey;
+    }
+
+    MUDA_GENERIC int capacity() const MUDA_NOEXCEPT { return m_capacity; }
+
+  private:
+    MUDA_GENERIC int  check_slot(int slot) const MUDA_NOEXCEPT;
+    MUDA_GENERIC void check_key(const K& key) const MUDA_NOEXCEPT;
+    MUDA_GENERIC int  home_slot(const K& key) const MUDA_NOEXCEPT
+    {
+        return static_cast<int>(m_hash(key) & static_cast<uint64_t>(m_capacity - 1));
+    }
+};
+
+template <typename K, typename V, typename Hash = HashMapDefaultHash<K>>
+using HashMapViewer = HashMapViewerBase<false, K, V, Hash>;
+template <typename K, typename V, typename Hash = HashMapDefaultHash<K>>
+using CHashMapViewer = HashMapViewerBase<true, K, V, Hash>;
+
+/**
+ * \brief A device hash map with linear probing.
+ *
+ * Bulk operations run on the default stream. The table grows (rehashes) on
+ * bulk `insert()` to keep the load factor below `max_load_factor`. Inserts
+ * done by user kernels through `viewer()` never grow the table, call
+ * `reserve()` before launching them.
+ */
+template <typename K, typename V, typename Hash = HashMapDefaultHash<K>>
+class DeviceHashMap
+{
+  public:
+    using Viewer  = HashMapViewer<K, V, Hash>;
+    using CViewer = CHashMapViewer<K, V, Hash>;
+
+    using key_type    = K;
+    using mapped_type = V;
+
+    DeviceHashMap(size_t expected_size = 0, float max_load_factor = 0.5f, const Hash& hash = Hash{});
+
+    // make room for `size` keys without exceeding the max load factor
+    void reserve(size_t size);
+    void clear();
+
+    void insert(CBufferView<K> keys, CBufferView<V> values);
+    // values[i] = map[keys[i]], or `not_found` if keys[i] is not in the map
+    void find(CBufferView<K> keys, BufferView<V> values, const V& not_found = V{}) const;
+    // slots[i] = slot of keys[i], or -1 if keys[i] is not in the map
+    void find_slots(CBufferView<K> keys, BufferView<int> slots) const;
+    void erase(CBufferView<K> keys);
+
+    size_t size() const;
+    size_t capacity() const MUDA_NOEXCEPT { return m_keys.size(); }
+    float  max_load_factor() const MUDA_NOEXCEPT { return m_max_load_factor; }
+
+    Viewer  viewer() MUDA_NOEXCEPT;
+    CViewer cviewer() const MUDA_NOEXCEPT;
+
+  private:
+    void rehash(size_t new_capacity);
+
+    DeviceBuffer<K>                  m_keys;
+    DeviceBuffer<V>                  m_values;
+    DeviceVar<details::HashMapState> m_state;
+    float                            m_max_load_factor;
+    Hash                             m_hash;
+};
+
+/**
+ * \brief Host reference of `DeviceHashMap`, running the same probing code
+ * serially, for testing.
+ */
+template <typename K, typename V, typename Hash = HashMapDefaultHash<K>>
+class HostHashMap
+{
+  public:
+    using Viewer  = HashMapViewer<K, V, Hash>;
+    using CViewer = CHashMapViewer<K, V, Hash>;
+
+    HostHashMap(size_t expected_size = 0, float max_load_factor = 0.5f, const Hash& hash = Hash{});
+
+    void reserve(size_t size);
+    void clear();
+
+    void insert(const std::vector<K>& keys, const std::vector<V>& values);
+    void find(const std::vector<K>& keys, std::vector<V>& values, const V& not_found = V{}) const;
+    void erase(const std::vector<K>& keys);
+
+    size_t size() const MUDA_NOEXCEPT { return m_state.size; }
+    size_t capacity() const MUDA_NOEXCEPT { return m_keys.size(); }
+
+    Viewer  viewer() MUDA_NOEXCEPT;
+    CViewer cviewer() const MUDA_NOEXCEPT;
+
+  private:
+    void rehash(size_t new_capacity);
+
+    std::vector<K>       m_keys;
+    std::vector<V>       m_values;
+    details::HashMapState m_state;
+    float                m_max_load_factor;
+    Hash                 m_hash;
+};
+}  // namespace muda
+
+#include "details/hash_map.inl"
@@ -0,0 +1,198 @@
+/*****************************************************************//**
+ * \file   cub_temp_size_cache.h
+ * \brief  Cache of the temp storage sizes queried from cub.
+ *
+ * A CubWrapper call normally runs the cub algorithm twice: a query pass for
+ * `temp_storage_bytes` and the real pass. The size only depends on the
+ * algorithm, the type signature and the problem size, so it is cached per
+ * call site (one site per instantiation of the wrapper function) and
+ * per device and item-count bucket (power of 2), the query pass is skipped
+ * on a hit.
+ *
+ * A bucket keeps the size queried for the largest item count seen so far,
+ * a call hits if its item count is not larger (cub temp sizes don't shrink
+ * with the problem size). Other size parameters (e.g. the bit range of a
+ * radix sort) go to `extra` and must match exactly.
+ *
+ * Pure host C++, the CUDA side is in `cub_wrapper_macro_def.inl`.
+ *********************************************************************/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+namespace muda
+{
+class CubTempSizeCache
+{
+  public:
+    class Stats
+    {
+      public:
+        size_t hits     = 0;
+        size_t misses   = 0;
+        size_t bypassed = 0;  // calls with the cache disabled (globally or per wrapper)
+
+        double hit_rate() const
+        {
+            auto n = hits + misses;
+            return n ? double(hits) / n : 0.0;
+        }
+    };
+
+    class Site
+    {
+      public:
+        explicit Site(std::string_view name)
+            : m_name(name)
+        {
+        }
+
+        const std::string& name() const { return m_name; }
+
+      private:
+        friend class CubTempSizeCache;
+        class Entry
+        {
+          public:
+            size_t max_items = 0;
+            size_t bytes     = 0;
+        };
+
+        using Key = std::tuple<int, int, uint64_t>;  // (device, bucket, extra)
+
+        std::string          m_name;
+        std::mutex           m_mutex;
+        std::map<Key, Entry> m_entries;
+    };
+
+    // the call site `name` (made on first use), stable address, lives until
+    // the process exits
+    static Site& site(std::string_view name)
+    {
+        auto&                       ins = instance();
+        std::lock_guard<std::mutex> lock{ins.m_mutex};
+        auto it = ins.m_sites.find(name);
+        if(it == ins.m_sites.end())
+            it = ins.m_sites.try_emplace(std::string{name}, name).first;
+        return it->second;
+    }
+
+    // power-of-2 bucket of an item count
+    static int bucket(size_t num_items)
+    {
+        int b = 0;
+        while((size_t{1} << b) < num_items && b < 63)
+            ++b;
+        return b;
+    }
+
+    // combine the other size parameters of a call into `extra`
+    template <typename... Args>
+    static uint64_t extra(Args... args)
+    {
+        uint64_t h = 1469598103934665603ull;  // FNV-1a over the values
+        ((h = (h ^ static_cast<uint64_t>(args)) * 1099511628211ull), ...);
+        return h;
+    }
+
+    /**
+     * \brief Look up the temp size of a call on `device` (the current device
+     * ordinal, cub tunes its kernels per architecture).
+     *
+     * \return true and set `bytes` on a hit, false if the size must be
+     * queried (then `store()` it).
+     */
+    static bool lookup(Site& site, int device, size_t num_items, uint64_t extra, size_t& bytes)
+    {
+        auto& ins = instance();
+        if(!ins.m_enabled.load(std::memory_order_relaxed))
+        {
+            ++ins.m_bypassed;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock{site.m_mutex};
+        auto it = site.m_entries.find({device, bucket(num_items), extra});
+        if(it != site.m_entries.end() && num_items <= it->second.max_items)
+        {
+            bytes = it->second.bytes;
+            ++ins.m_hits;
+            return true;
+        }
+        ++ins.m_misses;
+        return false;
+    }
+
+    static void store(Site& site, int device, size_t num_items, uint64_t extra, size_t bytes)
+    {
+        if(!enabled())
+            return;
+        std::lock_guard<std::mutex> lock{site.m_mutex};
+        auto& e = site.m_entries[{device, bucket(num_items), extra}];
+        if(num_items >= e.max_items)
+        {
+            e.max_items = num_items;
+            e.bytes     = bytes;
+        }
+    }
+
+    // count a call that skipped the cache (`CubWrapper::temp_size_cache(false)`)
+    static void bypass() { ++instance().m_bypassed; }
+
+    // bypass the cache globally (every call queries cub again)
+    static void enable(bool on) { instance().m_enabled = on; }
+    static bool enabled() { return instance().m_enabled; }
+
+    static Stats stats()
+    {
+        auto& ins = instance();
+        Stats s;
+        s.hits     = ins.m_hits;
+        s.misses   = ins.m_misses;
+        s.bypassed = ins.m_bypassed;
+        return s;
+    }
+
+    static void reset_stats()
+    {
+        auto& ins      = instance();
+        ins.m_hits     = 0;
+        ins.m_misses   = 0;
+        ins.m_bypassed = 0;
+    }
+
+    // drop all the cached sizes
+    static void clear()
+    {
+        auto&                       ins = instance();
+        std::lock_guard<std::mutex> lock{ins.m_mutex};
+        for(auto& [name, s] : ins.m_sites)
+        {
+            std::lock_guard<std::mutex> site_lock{s.m_mutex};
+            s.m_entries.clear();
+        }
+    }
+
+  private:
+    std::mutex                               m_mutex;
+    std::map<std::string, Site, std::less<>> m_sites;  // by name
+    std::atomic<bool>                        m_enabled{true};
+    std::atomic<size_t>                      m_hits{0};
+    std::atomic<size_t>                      m_misses{0};
+    std::atomic<size_t>                      m_bypassed{0};
+
+    static CubTempSizeCache& instance()
+    {
+        static CubTempSizeCache ins;
+        return ins;
+    }
+};
+}  // namespace muda
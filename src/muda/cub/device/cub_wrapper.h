@@ -6,6 +6,8 @@
 #include <muda/buffer/buffer_launch.h>
 #include <muda/compute_graph/compute_graph.h>
 #include <muda/launch/stream.h>
+#include <muda/tools/platform.h>
+#include <muda/cub/device/cub_temp_size_cache.h>
 
 namespace muda
 {
@@ -28,6 +30,14 @@ class CubWrapper : public LaunchBase<Derive>
     // meaningless for cub, so we just delete it
     void kernel_name(std::string_view) = delete;
 
-    Stream* m_muda_stream = nullptr;
+    // bypass the temp size cache for the calls of this wrapper
+    Derive& temp_size_cache(bool on)
+    {
+        m_temp_size_cache = on;
+        return static_cast<Derive&>(*this);
+    }
+
+    Stream* m_muda_stream     = nullptr;
+    bool    m_temp_size_cache = true;
 };
 }  // namespace muda
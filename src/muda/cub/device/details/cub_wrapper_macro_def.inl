@@ -2,6 +2,7 @@
 // because it should be inserted in multiple files
 
 #define MUDA_CUB_WRAPPER_IMPL(x)                                               \
+    ::muda::details::LaunchInfoCache::flush();                                 \
     cudaStream_t _stream            = this->stream();                          \
     size_t       temp_storage_bytes = 0;                                       \
     void*        d_temp_storage     = nullptr;                                 \
@@ -14,11 +15,50 @@
                                                                                \
     return *this;
 
+// the query pass is skipped if the temp size of this call site (per
+// instantiation), device and item count is cached, see <muda/cub/device/cub_temp_size_cache.h>
+// `extra`: the other parameters the temp size depends on (0 if none)
+#define MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, extra, x)                      \
+    ::muda::details::LaunchInfoCache::flush();                                 \
+    cudaStream_t _stream            = this->stream();                          \
+    size_t       temp_storage_bytes = 0;                                       \
+    void*        d_temp_storage     = nullptr;                                 \
+                                                                               \
+    static auto& _temp_size_site = ::muda::CubTempSizeCache::site(MUDA_FUNCTION_SIG); \
+    const auto   _temp_size_items = static_cast<size_t>(num_items);            \
+    const auto   _temp_size_extra = static_cast<uint64_t>(extra);              \
+    int          _temp_size_device = 0;                                        \
+    checkCudaErrors(cudaGetDevice(&_temp_size_device));                        \
+    if(!this->m_temp_size_cache)                                               \
+        ::muda::CubTempSizeCache::bypass();                                    \
+    if(!this->m_temp_size_cache                                                \
+       || !::muda::CubTempSizeCache::lookup(_temp_size_site,                   \
+                                            _temp_size_device,                 \
+                                            _temp_size_items,                  \
+                                            _temp_size_extra,                  \
+                                            temp_storage_bytes))               \
+    {                                                                          \
+        checkCudaErrors(x);                                                    \
+        if(this->m_temp_size_cache)                                            \
+            ::muda::CubTempSizeCache::store(_temp_size_site,                   \
+                                            _temp_size_device,                 \
+                                            _temp_size_items,                  \
+                                            _temp_size_extra,                  \
+                                            temp_storage_bytes);               \
+    }                                                                          \
+                                                                               \
+    d_temp_storage = (void*)prepare_buffer(temp_storage_bytes);                \
+                                                                               \
+    checkCudaErrors(x);                                                        \
+                                                                               \
+    return *this;
+
 #define MUDA_CUB_WRAPPER_FOR_COMPUTE_GRAPH_IMPL(x)                                                        \
     std::string_view name{__func__};                                                                      \
     ComputeGraphBuilder::invoke_phase_actions(                                                            \
         [&]                                                                                               \
         {                                                                                                 \
+            ::muda::details::LaunchInfoCache::flush();                                                    \
             cudaStream_t _stream = this->stream();                                                        \
             checkCudaErrors(x);                                                                           \
         },                                                                                                \
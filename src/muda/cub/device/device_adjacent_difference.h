@@ -29,7 +29,7 @@ class DeviceAdjacentDifference : public CubWrapper<DeviceAdjacentDifference>
                                                DifferenceOpT difference_op = {},
                                                bool debug_synchronous = false)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceAdjacentDifference::SubtractLeftCopy(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceAdjacentDifference::SubtractLeftCopy(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, difference_op, _stream, debug_synchronous));
     }
 
@@ -39,7 +39,7 @@ class DeviceAdjacentDifference : public CubWrapper<DeviceAdjacentDifference>
                                            DifferenceOpT difference_op = {},
                                            bool debug_synchronous      = false)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceAdjacentDifference::SubtractLeft(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceAdjacentDifference::SubtractLeft(
             d_temp_storage, temp_storage_bytes, d_in, num_items, difference_op, _stream, debug_synchronous));
     }
 
@@ -50,7 +50,7 @@ class DeviceAdjacentDifference : public CubWrapper<DeviceAdjacentDifference>
                                                 DifferenceOpT difference_op = {},
                                                 bool debug_synchronous = false)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceAdjacentDifference::SubtractRightCopy(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceAdjacentDifference::SubtractRightCopy(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, difference_op, _stream, debug_synchronous));
     }
 
@@ -60,7 +60,7 @@ class DeviceAdjacentDifference : public CubWrapper<DeviceAdjacentDifference>
                                             DifferenceOpT difference_op = {},
                                             bool debug_synchronous      = false)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceAdjacentDifference::SubtractRight(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceAdjacentDifference::SubtractRight(
             d_temp_storage, temp_storage_bytes, d_in, num_items, difference_op, _stream, debug_synchronous));
     }
 
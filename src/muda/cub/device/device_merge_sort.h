@@ -18,7 +18,7 @@ class DeviceMergeSort : public CubWrapper<DeviceMergeSort>
     template <typename KeyIteratorT, typename ValueIteratorT, typename OffsetT, typename CompareOpT>
     DeviceMergeSort& SortPairs(KeyIteratorT d_keys, ValueIteratorT d_items, OffsetT num_items, CompareOpT compare_op)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceMergeSort::SortPairs(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceMergeSort::SortPairs(
             d_temp_storage, temp_storage_bytes, d_keys, d_items, num_items, compare_op, _stream, false));
     }
 
@@ -30,7 +30,7 @@ class DeviceMergeSort : public CubWrapper<DeviceMergeSort>
                                    OffsetT             num_items,
                                    CompareOpT          compare_op)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceMergeSort::SortPairsCopy(d_temp_storage,
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceMergeSort::SortPairsCopy(d_temp_storage,
                                                                   temp_storage_bytes,
                                                                   d_input_keys,
                                                                   d_input_items,
@@ -45,7 +45,7 @@ class DeviceMergeSort : public CubWrapper<DeviceMergeSort>
     template <typename KeyIteratorT, typename OffsetT, typename CompareOpT>
     DeviceMergeSort& SortKeys(KeyIteratorT d_keys, OffsetT num_items, CompareOpT compare_op)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceMergeSort::SortKeys(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceMergeSort::SortKeys(
             d_temp_storage, temp_storage_bytes, d_keys, num_items, compare_op, _stream, false));
     }
 
@@ -55,7 +55,7 @@ class DeviceMergeSort : public CubWrapper<DeviceMergeSort>
                                   OffsetT           num_items,
                                   CompareOpT        compare_op)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceMergeSort::SortKeysCopy(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceMergeSort::SortKeysCopy(
             d_temp_storage, temp_storage_bytes, d_input_keys, d_output_keys, num_items, compare_op, _stream, false));
     }
 
@@ -65,14 +65,14 @@ class DeviceMergeSort : public CubWrapper<DeviceMergeSort>
                                      OffsetT        num_items,
                                      CompareOpT     compare_op)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceMergeSort::StableSortPairs(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceMergeSort::StableSortPairs(
             d_temp_storage, temp_storage_bytes, d_keys, d_items, num_items, compare_op, _stream, false));
     }
 
     template <typename KeyIteratorT, typename OffsetT, typename CompareOpT>
     DeviceMergeSort& StableSortKeys(KeyIteratorT d_keys, OffsetT num_items, CompareOpT compare_op)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceMergeSort::StableSortKeys(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceMergeSort::StableSortKeys(
             d_temp_storage, temp_storage_bytes, d_keys, num_items, compare_op, _stream, false));
     }
 
@@ -24,7 +24,7 @@ class DevicePartition : public CubWrapper<DevicePartition>
                              NumSelectedIteratorT d_num_selected_out,
                              int                  num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DevicePartition::Flagged(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DevicePartition::Flagged(
             d_temp_storage, temp_storage_bytes, d_in, d_flags, d_out, d_num_selected_out, num_items, _stream, false));
     }
 
@@ -35,7 +35,7 @@ class DevicePartition : public CubWrapper<DevicePartition>
                         int                  num_items,
                         SelectOp             select_op)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DevicePartition::If(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DevicePartition::If(
             d_temp_storage, temp_storage_bytes, d_in, d_out, d_num_selected_out, num_items, select_op, _stream, false));
     }
 
@@ -49,7 +49,7 @@ class DevicePartition : public CubWrapper<DevicePartition>
                         SelectFirstPartOp         select_first_part_op,
                         SelectSecondPartOp        select_second_part_op)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DevicePartition::If(d_temp_storage,
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DevicePartition::If(d_temp_storage,
                                                        temp_storage_bytes,
                                                        d_in,
                                                        d_first_part_out,
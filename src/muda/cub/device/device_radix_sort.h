@@ -30,7 +30,7 @@ class DeviceRadixSort : public CubWrapper<DeviceRadixSort>
                                int           begin_bit = 0,
                                int           end_bit   = sizeof(KeyT) * 8)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRadixSort::SortPairs(d_temp_storage,
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, CubTempSizeCache::extra(begin_bit, end_bit), cub::DeviceRadixSort::SortPairs(d_temp_storage,
                                                               temp_storage_bytes,
                                                               d_keys_in,
                                                               d_keys_out,
@@ -50,7 +50,7 @@ class DeviceRadixSort : public CubWrapper<DeviceRadixSort>
                                int                        begin_bit = 0,
                                int end_bit = sizeof(KeyT) * 8)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRadixSort::SortPairs(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, CubTempSizeCache::extra(begin_bit, end_bit), cub::DeviceRadixSort::SortPairs(
             d_temp_storage, temp_storage_bytes, d_keys, d_values, num_items, begin_bit, end_bit, _stream));
     }
 
@@ -63,7 +63,7 @@ class DeviceRadixSort : public CubWrapper<DeviceRadixSort>
                                          int           begin_bit = 0,
                                          int end_bit = sizeof(KeyT) * 8)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRadixSort::SortPairsDescending(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, CubTempSizeCache::extra(begin_bit, end_bit), cub::DeviceRadixSort::SortPairsDescending(
             d_temp_storage, temp_storage_bytes, d_keys_in, d_keys_out, d_values_in, d_values_out, num_items, begin_bit, end_bit, _stream));
     }
 
@@ -74,7 +74,7 @@ class DeviceRadixSort : public CubWrapper<DeviceRadixSort>
                                          int begin_bit = 0,
                                          int end_bit   = sizeof(KeyT) * 8)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRadixSort::SortPairsDescending(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, CubTempSizeCache::extra(begin_bit, end_bit), cub::DeviceRadixSort::SortPairsDescending(
             d_temp_storage, temp_storage_bytes, d_keys, d_values, num_items, begin_bit, end_bit, _stream));
     }
 
@@ -85,7 +85,7 @@ class DeviceRadixSort : public CubWrapper<DeviceRadixSort>
                               int         begin_bit = 0,
                               int         end_bit   = sizeof(KeyT) * 8)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRadixSort::SortKeys(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, CubTempSizeCache::extra(begin_bit, end_bit), cub::DeviceRadixSort::SortKeys(
             d_temp_storage, temp_storage_bytes, d_keys_in, d_keys_out, num_items, begin_bit, end_bit, _stream));
     }
 
@@ -95,7 +95,7 @@ class DeviceRadixSort : public CubWrapper<DeviceRadixSort>
                               int                      begin_bit = 0,
                               int end_bit = sizeof(KeyT) * 8)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRadixSort::SortKeys(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, CubTempSizeCache::extra(begin_bit, end_bit), cub::DeviceRadixSort::SortKeys(
             d_temp_storage, temp_storage_bytes, d_keys, num_items, begin_bit, end_bit, _stream));
     }
 
@@ -106,7 +106,7 @@ class DeviceRadixSort : public CubWrapper<DeviceRadixSort>
                                         int         begin_bit = 0,
                                         int         end_bit = sizeof(KeyT) * 8)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRadixSort::SortKeysDescending(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, CubTempSizeCache::extra(begin_bit, end_bit), cub::DeviceRadixSort::SortKeysDescending(
             d_temp_storage, temp_storage_bytes, d_keys_in, d_keys_out, num_items, begin_bit, end_bit, _stream));
     }
 
@@ -116,7 +116,7 @@ class DeviceRadixSort : public CubWrapper<DeviceRadixSort>
                                         int                      begin_bit = 0,
                                         int end_bit = sizeof(KeyT) * 8)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRadixSort::SortKeysDescending(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, CubTempSizeCache::extra(begin_bit, end_bit), cub::DeviceRadixSort::SortKeysDescending(
             d_temp_storage, temp_storage_bytes, d_keys, num_items, begin_bit, end_bit, _stream));
     }
 
@@ -24,14 +24,14 @@ class DeviceReduce : public CubWrapper<DeviceReduce>
                          ReductionOpT    reduction_op,
                          T               init)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceReduce::Reduce(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceReduce::Reduce(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, reduction_op, init, _stream, false));
     }
 
     template <typename InputIteratorT, typename OutputIteratorT>
     DeviceReduce& Sum(InputIteratorT d_in, OutputIteratorT d_out, int num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceReduce::Sum(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceReduce::Sum(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, _stream, false));
     }
 
@@ -39,7 +39,7 @@ class DeviceReduce : public CubWrapper<DeviceReduce>
     template <typename InputIteratorT, typename OutputIteratorT>
     DeviceReduce& Min(InputIteratorT d_in, OutputIteratorT d_out, int num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceReduce::Min(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceReduce::Min(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, _stream, false));
     }
 
@@ -47,7 +47,7 @@ class DeviceReduce : public CubWrapper<DeviceReduce>
     template <typename InputIteratorT, typename OutputIteratorT>
     DeviceReduce& ArgMin(InputIteratorT d_in, OutputIteratorT d_out, int num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceReduce::ArgMin(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceReduce::ArgMin(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, _stream, false));
     }
 
@@ -56,7 +56,7 @@ class DeviceReduce : public CubWrapper<DeviceReduce>
     DeviceReduce& Max(InputIteratorT d_in, OutputIteratorT d_out, int num_items)
     {
 
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceReduce::Max(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceReduce::Max(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, _stream, false));
     }
 
@@ -64,7 +64,7 @@ class DeviceReduce : public CubWrapper<DeviceReduce>
     template <typename InputIteratorT, typename OutputIteratorT>
     DeviceReduce& ArgMax(InputIteratorT d_in, OutputIteratorT d_out, int num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceReduce::ArgMax(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceReduce::ArgMax(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, _stream, false));
     }
 
@@ -77,7 +77,7 @@ class DeviceReduce : public CubWrapper<DeviceReduce>
                               ReductionOpT              reduction_op,
                               int                       num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceReduce::ReduceByKey(d_temp_storage,
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceReduce::ReduceByKey(d_temp_storage,
                                                              temp_storage_bytes,
                                                              d_keys_in,
                                                              d_unique_out,
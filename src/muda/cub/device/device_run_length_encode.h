@@ -22,7 +22,7 @@ class DeviceRunLengthEncode : public CubWrapper<DeviceRunLengthEncode>
                                   NumRunsOutputIteratorT d_num_runs_out,
                                   int                    num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRunLengthEncode::Encode(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceRunLengthEncode::Encode(
             d_temp_storage, temp_storage_bytes, d_in, d_unique_out, d_counts_out, d_num_runs_out, num_items, _stream, false));
     }
 
@@ -33,7 +33,7 @@ class DeviceRunLengthEncode : public CubWrapper<DeviceRunLengthEncode>
                                           NumRunsOutputIteratorT d_num_runs_out,
                                           int                    num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceRunLengthEncode::NonTrivialRuns(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceRunLengthEncode::NonTrivialRuns(
             d_temp_storage, temp_storage_bytes, d_in, d_offsets_out, d_lengths_out, d_num_runs_out, num_items, _stream, false));
     }
 
@@ -27,7 +27,7 @@ class DeviceScan : public CubWrapper<DeviceScan>
     template <typename InputIteratorT, typename OutputIteratorT>
     DeviceScan& ExclusiveSum(InputIteratorT d_in, OutputIteratorT d_out, int num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceScan::ExclusiveSum(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceScan::ExclusiveSum(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, _stream, false));
     }
 
@@ -39,7 +39,7 @@ class DeviceScan : public CubWrapper<DeviceScan>
                               InitValueT      init_value,
                               int             num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceScan::ExclusiveScan(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceScan::ExclusiveScan(
             d_temp_storage, temp_storage_bytes, d_in, d_out, scan_op, init_value, num_items, _stream, false));
     }
 
@@ -47,14 +47,14 @@ class DeviceScan : public CubWrapper<DeviceScan>
     template <typename InputIteratorT, typename OutputIteratorT>
     DeviceScan& InclusiveSum(InputIteratorT d_in, OutputIteratorT d_out, int num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceScan::InclusiveSum(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceScan::InclusiveSum(
             d_temp_storage, temp_storage_bytes, d_in, d_out, num_items, _stream, false));
     }
 
     template <typename InputIteratorT, typename OutputIteratorT, typename ScanOpT>
     DeviceScan& InclusiveScan(InputIteratorT d_in, OutputIteratorT d_out, ScanOpT scan_op, int num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceScan::InclusiveScan(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceScan::InclusiveScan(
             d_temp_storage, temp_storage_bytes, d_in, d_out, scan_op, num_items, _stream, false));
     }
 
@@ -65,7 +65,7 @@ class DeviceScan : public CubWrapper<DeviceScan>
                                   int                   num_items,
                                   EqualityOpT equality_op = EqualityOpT())
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceScan::ExclusiveSumByKey(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceScan::ExclusiveSumByKey(
             d_temp_storage, temp_storage_bytes, d_keys_in, d_values_in, d_values_out, num_items, equality_op, _stream, false));
     }
 
@@ -78,7 +78,7 @@ class DeviceScan : public CubWrapper<DeviceScan>
                                    int                   num_items,
                                    EqualityOpT equality_op = EqualityOpT())
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceScan::ExclusiveScanByKey(d_temp_storage,
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceScan::ExclusiveScanByKey(d_temp_storage,
                                                                   temp_storage_bytes,
                                                                   d_keys_in,
                                                                   d_values_in,
@@ -98,7 +98,7 @@ class DeviceScan : public CubWrapper<DeviceScan>
                                   int                   num_items,
                                   EqualityOpT equality_op = EqualityOpT())
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceScan::InclusiveSumByKey(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceScan::InclusiveSumByKey(
             d_temp_storage, temp_storage_bytes, d_keys_in, d_values_in, d_values_out, num_items, equality_op, _stream, false));
     }
 
@@ -110,7 +110,7 @@ class DeviceScan : public CubWrapper<DeviceScan>
                                    int                   num_items,
                                    EqualityOpT equality_op = EqualityOpT())
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceScan::InclusiveScanByKey(d_temp_storage,
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceScan::InclusiveScanByKey(d_temp_storage,
                                                                   temp_storage_bytes,
                                                                   d_keys_in,
                                                                   d_values_in,
@@ -22,7 +22,7 @@ class DeviceSelect : public CubWrapper<DeviceSelect>
                           NumSelectedIteratorT d_num_selected_out,
                           int                  num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceSelect::Flagged(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceSelect::Flagged(
             d_temp_storage, temp_storage_bytes, d_in, d_flags, d_out, d_num_selected_out, num_items, _stream, false));
     }
 
@@ -33,7 +33,7 @@ class DeviceSelect : public CubWrapper<DeviceSelect>
                      int                  num_items,
                      SelectOp             select_op)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceSelect::If(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceSelect::If(
             d_temp_storage, temp_storage_bytes, d_in, d_out, d_num_selected_out, num_items, select_op, _stream, false));
     }
 
@@ -43,7 +43,7 @@ class DeviceSelect : public CubWrapper<DeviceSelect>
                          NumSelectedIteratorT d_num_selected_out,
                          int                  num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceSelect::Unique(
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceSelect::Unique(
             d_temp_storage, temp_storage_bytes, d_in, d_out, d_num_selected_out, num_items, _stream, false));
     }
 #if CUB_VERSION >= 200200
@@ -55,7 +55,7 @@ class DeviceSelect : public CubWrapper<DeviceSelect>
                               NumSelectedIteratorT d_num_selected_out,
                               int                  num_items)
     {
-        MUDA_CUB_WRAPPER_IMPL(cub::DeviceSelect::UniqueByKey(d_temp_storage,
+        MUDA_CUB_WRAPPER_CACHED_IMPL(num_items, 0, cub::DeviceSelect::UniqueByKey(d_temp_storage,
                                                              temp_storage_bytes,
                                                              d_keys_in,
                                                              d_values_in,
@@ -9,7 +9,7 @@ class Debug
   private:
     static auto& _is_debug_sync_all()
     {
-        static std::atomic<bool> m_is_debug_sync_all(false);
+        static std::atomic<bool> m_is_debug_sync_all(CHECK_LEVEL >= CheckLevel::SyncAll);
         return m_is_debug_sync_all;
     }
 
@@ -38,12 +38,16 @@ class FieldEntryViewerBase : public FieldEntryViewerCore<IsConst, T, Layout, M,
 
     MUDA_GENERIC auto operator()(int i)
     {
-        return ThisMatrixMap{data(i, 0, 0), this->m_stride};
+        auto v = ThisMatrixMap{data(i, 0, 0), this->m_stride};
+        this->record_access(v);
+        return v;
     }
 
     MUDA_GENERIC auto operator()(int i) const
     {
-        return ConstMatrixMap{data(i, 0, 0), this->m_stride};
+        auto v = ConstMatrixMap{data(i, 0, 0), this->m_stride};
+        this->record_access(v);
+        return v;
     }
 };
 
@@ -24,8 +24,16 @@ class FieldEntryViewerBase<IsConst, T, Layout, 1, 1>
         return remove_const(this)->data(i);
     }
 
-    MUDA_GENERIC auto_const_t<T>& operator()(int i) { return *data(i); }
-    MUDA_GENERIC const T&         operator()(int i) const { return *data(i); }
+    MUDA_GENERIC auto_const_t<T>& operator()(int i)
+    {
+        auto& v = *data(i);
+        this->record_access(v);
+        return v;
+    }
+    MUDA_GENERIC const T& operator()(int i) const
+    {
+        return remove_const(this)->operator()(i);
+    }
 };
 
 template <typename T, FieldEntryLayout Layout>
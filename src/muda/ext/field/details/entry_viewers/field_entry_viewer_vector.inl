@@ -32,11 +32,15 @@ class FieldEntryViewerBase<IsConst, T, Layout, N, 1>
 
     MUDA_GENERIC auto operator()(int i)
     {
-        return ThisVectorMap{data(i, 0), this->m_stride};
+        auto v = ThisVectorMap{data(i, 0), this->m_stride};
+        this->record_access(v);
+        return v;
     }
     MUDA_GENERIC auto operator()(int i) const
     {
-        return ConstVectorMap{data(i, 0), this->m_stride};
+        auto v = ConstVectorMap{data(i, 0), this->m_stride};
+        this->record_access(v);
+        return v;
     }
 };
 
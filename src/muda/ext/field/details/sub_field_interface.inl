@@ -9,6 +9,7 @@ MUDA_INLINE SubFieldInterface::~SubFieldInterface()
 template <typename F>
 void SubFieldInterface::resize_data_buffer(size_t size, F&& func)
 {
+    MemoryScope scope{MemoryCategory::Field, "Field"};
     if(m_data_buffer == nullptr)
     {
         Memory().alloc(&m_data_buffer, size).set(m_data_buffer, size, 0).wait();
@@ -35,6 +35,39 @@ namespace details::field
         }
         return ret;
     }
+
+    // the components of entries [offset, offset + size), see NonFiniteSentinel
+    template <typename T, FieldEntryLayout Layout, int M, int N>
+    class NonFiniteFieldRange
+    {
+      public:
+        FieldEntryCore core;
+        int            offset = 0;
+        int            count  = 0;
+
+        MUDA_GENERIC int size() const MUDA_NOEXCEPT { return count; }
+
+        MUDA_GENERIC bool find(int i, double& value, int* index) const MUDA_NOEXCEPT
+        {
+            index[0] = i;
+            index[1] = -1;
+            index[2] = -1;
+            for(int c = 0; c < N; ++c)
+                for(int r = 0; r < M; ++r)
+                {
+                    const T* p;
+                    if constexpr(M == 1 && N == 1)
+                        p = core.data<T, Layout>(offset + i);
+                    else if constexpr(N == 1)
+                        p = core.data<T, Layout>(offset + i, r);
+                    else
+                        p = core.data<T, Layout>(offset + i, r, c);
+                    if(::muda::details::find_non_finite(*p, value))
+                        return true;
+                }
+            return false;
+        }
+    };
 }  // namespace details::field
 
 template <bool IsConst, typename T, FieldEntryLayout Layout, int M, int N>
@@ -77,6 +110,9 @@ class FieldEntryViewerCore : protected ViewerBase<IsConst>
                            m_size);
 
         m_stride = details::field::make_stride<T, Layout, M, N>(*m_core);
+
+        this->template watch_non_finite<T>(
+            details::field::NonFiniteFieldRange<T, Layout, M, N>{*m_core, m_offset, m_size});
     }
 
     MUDA_GENERIC FieldEntryViewerCore(const FieldEntryViewerCore&) = default;
@@ -47,6 +47,8 @@ class DenseVectorViewerBase : public ViewerBase<IsConst>
         , m_size(size)
         , m_origin_size(origin_size)
     {
+        this->template watch_non_finite<T>(details::NonFiniteDenseRange<T>{
+            reinterpret_cast<const std::byte*>(data ? data + offset : nullptr), make_int3(size, 1, 1), make_int3(sizeof(T), 0, 0), 1});
     }
 
     MUDA_GENERIC auto as_const() const
@@ -75,8 +77,16 @@ class DenseVectorViewerBase : public ViewerBase<IsConst>
         return remove_const(*this).segment(offset, size);
     }
 
-    MUDA_GENERIC const T& operator()(int i) const { return m_data[index(i)]; }
-    MUDA_GENERIC auto_const_t<T>& operator()(int i) { return m_data[index(i)]; }
+    MUDA_GENERIC const T& operator()(int i) const
+    {
+        return remove_const(*this)(i);
+    }
+    MUDA_GENERIC auto_const_t<T>& operator()(int i)
+    {
+        auto& v = m_data[index(i)];
+        this->record_access(v);
+        return v;
+    }
 
     template <int N>
     MUDA_GENERIC auto segment(int offset) const
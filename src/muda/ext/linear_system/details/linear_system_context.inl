@@ -9,6 +9,7 @@ MUDA_INLINE LinearSystemContext::LinearSystemContext(const LinearSystemContextCr
     , m_handles(info.stream)
     , m_converter(m_handles)
 {
+    MemoryScope scope{MemoryCategory::LinearSystem, "LinearSystemContext"};
     m_buffers.emplace_back(info.buffer_byte_size_base);
 }
 
@@ -58,7 +59,8 @@ MUDA_INLINE BufferView<std::byte> LinearSystemContext::temp_buffer(size_t size)
             return b.view(0, size);
     auto base = m_create_info.buffer_byte_size_base;
     // round up to multiple of base
-    auto rounded_size = ((size + base - 1) / base) * base;
+    auto        rounded_size = ((size + base - 1) / base) * base;
+    MemoryScope scope{MemoryCategory::LinearSystem, "LinearSystemContext"};
     return m_buffers.emplace_back(rounded_size).view(0, size);
 }
 
@@ -44,6 +44,28 @@ void MatrixFormatConverter::convert(const DeviceTripletMatrix<T, N>& from,
     impl<T, N>().convert(from, to);
 }
 
+template <typename T, int N>
+void MatrixFormatConverter::convert(const DeviceTripletMatrix<T, N>& from,
+                                    DeviceBCOOMatrix<T, N>&          to,
+                                    uint64_t                         pattern_id)
+{
+    impl<T, N>().convert(from, to, pattern_id);
+}
+
+template <typename T, int N>
+void MatrixFormatConverter::convert_values_only(const DeviceTripletMatrix<T, N>& from,
+                                                DeviceBCOOMatrix<T, N>& to,
+                                                uint64_t pattern_id)
+{
+    impl<T, N>().convert_values_only(from, to, pattern_id);
+}
+
+template <typename T, int N>
+void MatrixFormatConverter::release_pattern(uint64_t pattern_id)
+{
+    impl<T, N>().release_pattern(pattern_id);
+}
+
 // BCOO -> Dense Matrix
 template <typename T, int N>
 void MatrixFormatConverter::convert(const DeviceBCOOMatrix<T, N>& from,
@@ -178,6 +178,88 @@ void MatrixFormatConverter<T, N>::make_unique_blocks(const DeviceTripletMatrix<T
         BlockMatrix::Zero().eval());
 }
 
+template <typename T, int N>
+void MatrixFormatConverter<T, N>::convert(const DeviceTripletMatrix<T, N>& from,
+                                          DeviceBCOOMatrix<T, N>&          to,
+                                          uint64_t pattern_id)
+{
+    convert(from, to);
+
+    auto& pattern         = triplet_patterns[pattern_id];
+    pattern.block_rows    = from.block_rows();
+    pattern.block_cols    = from.block_cols();
+    pattern.triplet_count = from.triplet_count();
+
+    if(from.triplet_count() == 0)
+    {
+        pattern.sort_index.resize(0);
+        pattern.offsets.resize(0);
+        pattern.row_indices.resize(0);
+        pattern.col_indices.resize(0);
+        return;
+    }
+
+    // `sort_index` and `offsets` are reused by the other conversions, keep a copy
+    pattern.sort_index  = sort_index;
+    pattern.offsets     = offsets;
+    pattern.row_indices = to.m_block_row_indices;
+    pattern.col_indices = to.m_block_col_indices;
+}
+
+template <typename T, int N>
+void MatrixFormatConverter<T, N>::convert_values_only(const DeviceTripletMatrix<T, N>& from,
+                                                      DeviceBCOOMatrix<T, N>& to,
+                                                      uint64_t pattern_id)
+{
+    using namespace muda;
+
+    auto it = triplet_patterns.find(pattern_id);
+    MUDA_ASSERT(it != triplet_patterns.end(),
+                "pattern_id=%llu is unknown, call convert() with this pattern_id first",
+                (unsigned long long)pattern_id);
+
+    auto& pattern = it->second;
+    MUDA_ASSERT(pattern.triplet_count == from.triplet_count()
+                    && pattern.block_rows == from.block_rows()
+                    && pattern.block_cols == from.block_cols(),
+                "pattern mismatch: pattern(rows=%d, cols=%d, triplets=%d), from(rows=%d, cols=%d, triplets=%d)",
+                pattern.block_rows,
+                pattern.block_cols,
+                (int)pattern.triplet_count,
+                from.block_rows(),
+                from.block_cols(),
+                (int)from.triplet_count());
+
+    to.reshape(pattern.block_rows, pattern.block_cols);
+    to.m_block_row_indices = pattern.row_indices;
+    to.m_block_col_indices = pattern.col_indices;
+    to.m_block_values.resize(pattern.row_indices.size());
+
+    if(to.m_block_values.size() == 0)
+        return;
+
+    // gather + segmented sum, one thread per unique block
+    ParallelFor(256)
+        .kernel_name(__FUNCTION__)
+        .apply(to.m_block_values.size(),
+               [src_blocks = from.m_block_values.cviewer().name("blocks"),
+                sort_index = pattern.sort_index.cviewer().name("sort_index"),
+                offsets    = pattern.offsets.cviewer().name("offsets"),
+                dst_blocks = to.m_block_values.viewer().name("block_values")] __device__(int i) mutable
+               {
+                   BlockMatrix sum = BlockMatrix::Zero();
+                   for(int k = offsets(i); k < offsets(i + 1); ++k)
+                       sum += src_blocks(sort_index(k));
+                   dst_blocks(i) = sum;
+               });
+}
+
+template <typename T, int N>
+void MatrixFormatConverter<T, N>::release_pattern(uint64_t pattern_id)
+{
+    triplet_patterns.erase(pattern_id);
+}
+
 template <typename T, int N>
 void MatrixFormatConverter<T, N>::convert(const DeviceBCOOMatrix<T, N>& from,
                                           DeviceDenseMatrix<T>&         to,
@@ -434,7 +516,7 @@ void bsr2csr(cusparseHandle_t         handle,
     cusparseDirection_t dir = CUSPARSE_DIRECTION_COLUMN;
     int                 m   = mb * blockDim;
     int                 nnz = nnzb * blockDim * blockDim;  // number of elements
-    to.reshape(m, m);
+    to.reshape(m, nb * blockDim);
     col_indices.resize(nnz);
     values.resize(nnz);
     if constexpr(std::is_same_v<T, float>)
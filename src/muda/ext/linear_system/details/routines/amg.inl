@@ -0,0 +1,823 @@
+#include <muda/ext/eigen.h>
+namespace muda
+{
+namespace details::linear_system
+{
+    template <typename T, int N>
+    class AMGLevel
+    {
+      public:
+        using BlockMatrix = Eigen::Matrix<T, N, N>;
+
+        DeviceBSRMatrix<T, N>         A;
+        DeviceBSRMatrix<T, N>         P;  // to this level from the next one
+        DeviceBSRMatrix<T, N>         R;  // P^T
+        DeviceBuffer<BlockMatrix>     inv_diag;
+        std::vector<std::array<T, 2>> steps;  // see amg_smoother_steps()
+        T                             rho = 0;
+
+        // x, b: the correction and the restricted residual (not used on the
+        // finest level, the V-cycle gets them), r, d: smoother work
+        DeviceDenseVector<T> x;
+        DeviceDenseVector<T> b;
+        DeviceDenseVector<T> r;
+        DeviceDenseVector<T> d;
+    };
+
+    template <typename T>
+    class AMGPreconditioner : public AMGHierarchyBase
+    {
+      public:
+        // `stop`: device flag, the cycle is skipped while it is non-zero (nullptr: never)
+        virtual void apply(LinearSystemContext& ctx,
+                           CDenseVectorView<T>  r,
+                           DenseVectorView<T>   z,
+                           const int*           stop) = 0;
+    };
+
+    template <typename T, int N>
+    class AMGHierarchy : public AMGPreconditioner<T>
+    {
+      public:
+        std::vector<AMGLevel<T, N>> levels;
+        bool                        dense_coarse = false;
+
+        // dense coarsest level, LU factorized in place once by amg_build(),
+        // the cycles only run getrs
+        DeviceDenseMatrix<T>  coarse;
+        DeviceBuffer<int64_t> coarse_pivots;
+        DeviceVar<int>        coarse_info;
+        cusolverDnHandle_t    cusolver = nullptr;  // of the owning context
+        cusolverDnParams_t    params   = nullptr;
+
+        AMGHierarchy()                               = default;
+        AMGHierarchy(const AMGHierarchy&)            = delete;
+        AMGHierarchy& operator=(const AMGHierarchy&) = delete;
+        ~AMGHierarchy();
+
+        void apply(LinearSystemContext& ctx,
+                   CDenseVectorView<T>  r,
+                   DenseVectorView<T>   z,
+                   const int*           stop) override;
+    };
+
+    template <typename T, int N>
+    AMGHierarchy<T, N>::~AMGHierarchy()
+    {
+        if(params)
+            checkCudaErrors(cusolverDnDestroyParams(params));
+    }
+
+    template <typename T, int N>
+    void amg_copy(cudaStream_t stream, CBSRMatrixView<T, N> from, DeviceBSRMatrix<T, N>& to)
+    {
+        int rows = from.block_rows();
+        int nnzb = from.non_zero_blocks();
+
+        to.reshape(rows, from.block_cols());
+        to.resize(nnzb);
+        BufferLaunch(stream)
+            .copy(to.block_row_offsets(), CBufferView<int>{from.block_row_offsets(), 0, size_t(rows + 1)})
+            .copy(to.block_col_indices(), CBufferView<int>{from.block_col_indices(), 0, size_t(nnzb)})
+            .copy(to.block_values(),
+                  CBufferView<Eigen::Matrix<T, N, N>>{from.block_values(), 0, size_t(nnzb)});
+    }
+
+    // inverse diagonal blocks (block Jacobi) of a square BSR matrix
+    template <typename T, int N>
+    void amg_inverse_diagonal(LinearSystemContext&                  ctx,
+                              CBSRMatrixView<T, N>                  A,
+                              DeviceBuffer<Eigen::Matrix<T, N, N>>& inv_diag)
+    {
+        using BlockMatrix = Eigen::Matrix<T, N, N>;
+
+        inv_diag.resize(A.block_rows());
+        ParallelFor(0, ctx.stream())
+            .kernel_name(__FUNCTION__)
+            .apply(A.block_rows(),
+                   [offsets = A.block_row_offsets(),
+                    cols    = A.block_col_indices(),
+                    values  = A.block_values(),
+                    D = inv_diag.viewer().name("diag_blocks")] __device__(int i) mutable
+                   {
+                       BlockMatrix diag = BlockMatrix::Zero();
+                       for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+                           if(cols[k] == i)
+                               diag += values[k];
+                       D(i) = diag;
+                   });
+        pcg_preconditioner<T, N>(ctx, LinearSystemPreconditioner::BlockJacobi, inv_diag);
+    }
+
+    // power iteration on D^-1 A from amg_power_start(), v and w are work vectors
+    template <typename T, int N>
+    T amg_spectral_radius(LinearSystemContext&                        ctx,
+                          CBSRMatrixView<T, N>                        A,
+                          const DeviceBuffer<Eigen::Matrix<T, N, N>>& inv_diag,
+                          DenseVectorView<T>                          v,
+                          DenseVectorView<T>                          w,
+                          int                                         iterations)
+    {
+        DeviceVar<T> norm;
+
+        ParallelFor(0, ctx.stream())
+            .kernel_name("amg_power_start")
+            .apply(v.size(),
+                   [v = v.viewer().name("v")] __device__(int i) mutable
+                   { v(i) = amg_power_start<T>(i); });
+        ctx.norm<T>(v, norm.view());
+        ParallelFor(0, ctx.stream())
+            .kernel_name("amg_power_normalize")
+            .apply(v.size(),
+                   [v = v.viewer().name("v"), norm = norm.data()] __device__(int i) mutable
+                   { v(i) /= *norm; });
+
+        for(int k = 0; k < iterations; ++k)
+        {
+            ctx.spmv<T, N>(A, v, w);
+            ParallelFor(0, ctx.stream())
+                .kernel_name("amg_power_precondition")
+                .apply(inv_diag.size(),
+                       [w = w.viewer().name("w"),
+                        M = inv_diag.cviewer().name("inv_diag")] __device__(int i) mutable
+                       {
+                           Eigen::Vector<T, N> Dw = M(i) * w.segment<N>(i * N).as_eigen();
+                           w.segment<N>(i * N).as_eigen() = Dw;
+                       });
+            ctx.norm<T>(w, norm.view());
+            ParallelFor(0, ctx.stream())
+                .kernel_name("amg_power_step")
+                .apply(v.size(),
+                       [v    = v.viewer().name("v"),
+                        w    = w.cviewer().name("w"),
+                        norm = norm.data()] __device__(int i) mutable
+                       {
+                           if(*norm > T{0})
+                               v(i) = w(i) / *norm;
+                       });
+        }
+
+        T rho = 0;
+        BufferLaunch(ctx.stream()).copy(&rho, norm.view()).wait();
+        return rho;
+    }
+
+    // block CSR pattern and block Frobenius norms on the host, for amg_aggregate()
+    template <typename T, int N>
+    void amg_block_norms(cudaStream_t          stream,
+                         CBSRMatrixView<T, N>  A,
+                         std::vector<int>&     offsets,
+                         std::vector<int>&     cols,
+                         std::vector<T>&       norms)
+    {
+        int rows = A.block_rows();
+        int nnzb = A.non_zero_blocks();
+
+        DeviceBuffer<T> d_norms(nnzb);
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(nnzb,
+                   [values = A.block_values(),
+                    norms  = d_norms.viewer().name("norms")] __device__(int k) mutable
+                   { norms(k) = values[k].norm(); });
+
+        offsets.resize(rows + 1);
+        cols.resize(nnzb);
+        norms.resize(nnzb);
+        BufferLaunch(stream)
+            .copy(offsets.data(), CBufferView<int>{A.block_row_offsets(), 0, size_t(rows + 1)})
+            .copy(cols.data(), CBufferView<int>{A.block_col_indices(), 0, size_t(nnzb)})
+            .copy(norms.data(), d_norms.view())
+            .wait();
+    }
+
+    /**
+     * \brief P = (I - omega D^-1 A) P_tentative and R = P^T as triplets.
+     *
+     * P_tentative(i, J) = scales[J] * I for the block rows i of aggregate J,
+     * so P(i, J) = scales[J] (delta(i in J) I - omega sum_{k in J} D_i^-1 A_ik):
+     * triplet k for block k of A, triplet nnzb + i for the identity,
+     * duplicates are summed by convert(). Unaggregated rows and columns give
+     * zero blocks.
+     */
+    template <typename T, int N>
+    void amg_prolongator(cudaStream_t                                stream,
+                         CBSRMatrixView<T, N>                        A,
+                         const DeviceBuffer<Eigen::Matrix<T, N, N>>& inv_diag,
+                         const DeviceBuffer<int>&                    aggregates,
+                         const DeviceBuffer<T>&                      scales,
+                         T                                           omega,
+                         DeviceTripletMatrix<T, N>&                  P,
+                         DeviceTripletMatrix<T, N>&                  R)
+    {
+        using BlockMatrix = Eigen::Matrix<T, N, N>;
+
+        int rows  = A.block_rows();
+        int count = scales.size();
+        int nnzb  = A.non_zero_blocks();
+
+        P.reshape(rows, count);
+        P.resize_triplets(nnzb + rows);
+        R.reshape(count, rows);
+        R.resize_triplets(nnzb + rows);
+
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(rows,
+                   [omega,
+                    nnzb,
+                    offsets    = A.block_row_offsets(),
+                    cols       = A.block_col_indices(),
+                    values     = A.block_values(),
+                    M          = inv_diag.cviewer().name("inv_diag"),
+                    aggregates = aggregates.cviewer().name("aggregates"),
+                    scales     = scales.cviewer().name("scales"),
+                    P_rows     = P.block_row_indices().data(),
+                    P_cols     = P.block_col_indices().data(),
+                    P_values   = P.block_values().data(),
+                    R_rows     = R.block_row_indices().data(),
+                    R_cols     = R.block_col_indices().data(),
+                    R_values = R.block_values().data()] __device__(int i) mutable
+                   {
+                       auto emit = [&](int t, int J, const BlockMatrix& value)
+                       {
+                           P_rows[t]   = i;
+                           P_cols[t]   = J;
+                           P_values[t] = value;
+                           R_rows[t]   = J;
+                           R_cols[t]   = i;
+                           R_values[t] = value.transpose();
+                       };
+
+                       BlockMatrix Dinv = M(i);
+                       for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+                       {
+                           int J = aggregates(cols[k]);
+                           if(J < 0)
+                               emit(k, 0, BlockMatrix::Zero());
+                           else
+                               emit(k, J, (-omega * scales(J)) * Dinv * values[k]);
+                       }
+
+                       int J = aggregates(i);
+                       if(J < 0)
+                           emit(nnzb + i, 0, BlockMatrix::Zero());
+                       else
+                           emit(nnzb + i, J, scales(J) * BlockMatrix::Identity());
+                   });
+    }
+
+    // C = A * B
+    template <typename T>
+    void amg_spgemm(cusparseHandle_t          handle,
+                    cudaStream_t              stream,
+                    const DeviceCSRMatrix<T>& A,
+                    const DeviceCSRMatrix<T>& B,
+                    DeviceCSRMatrix<T>&       C)
+    {
+        constexpr auto op   = CUSPARSE_OPERATION_NON_TRANSPOSE;
+        constexpr auto alg  = CUSPARSE_SPGEMM_DEFAULT;
+        auto           type = cuda_data_type<T>();
+        T              alpha = 1;
+        T              beta  = 0;
+
+        C.reshape(A.rows(), B.cols());
+
+        cusparseSpMatDescr_t descr;
+        checkCudaErrors(cusparseCreateCsr(&descr,
+                                          A.rows(),
+                                          B.cols(),
+                                          0,
+                                          C.m_row_offsets.data(),
+                                          nullptr,
+                                          nullptr,
+                                          CUSPARSE_INDEX_32I,
+                                          CUSPARSE_INDEX_32I,
+                                          CUSPARSE_INDEX_BASE_ZERO,
+                                          type));
+        cusparseSpGEMMDescr_t spgemm;
+        checkCudaErrors(cusparseSpGEMM_createDescr(&spgemm));
+
+        size_t work_size = 0;
+        checkCudaErrors(cusparseSpGEMM_workEstimation(
+            handle, op, op, &alpha, A.descr(), B.descr(), &beta, descr, type, alg, spgemm, &work_size, nullptr));
+        DeviceBuffer<std::byte> work(work_size);
+        checkCudaErrors(cusparseSpGEMM_workEstimation(
+            handle, op, op, &alpha, A.descr(), B.descr(), &beta, descr, type, alg, spgemm, &work_size, work.data()));
+
+        size_t compute_size = 0;
+        checkCudaErrors(cusparseSpGEMM_compute(
+            handle, op, op, &alpha, A.descr(), B.descr(), &beta, descr, type, alg, spgemm, &compute_size, nullptr));
+        DeviceBuffer<std::byte> compute(compute_size);
+        checkCudaErrors(cusparseSpGEMM_compute(
+            handle, op, op, &alpha, A.descr(), B.descr(), &beta, descr, type, alg, spgemm, &compute_size, compute.data()));
+
+        int64_t rows = 0;
+        int64_t cols = 0;
+        int64_t nnz  = 0;
+        checkCudaErrors(cusparseSpMatGetSize(descr, &rows, &cols, &nnz));
+        C.m_col_indices.resize(nnz);
+        C.m_values.resize(nnz);
+        checkCudaErrors(cusparseCsrSetPointers(
+            descr, C.m_row_offsets.data(), C.m_col_indices.data(), C.m_values.data()));
+        checkCudaErrors(cusparseSpGEMM_copy(
+            handle, op, op, &alpha, A.descr(), B.descr(), &beta, descr, type, alg, spgemm));
+
+        // the work buffers are released here
+        checkCudaErrors(cudaStreamSynchronize(stream));
+        checkCudaErrors(cusparseSpGEMM_destroyDescr(spgemm));
+        checkCudaErrors(cusparseDestroySpMat(descr));
+    }
+
+    template <typename T, int N>
+    void amg_csr_to_bsr(cusparseHandle_t handle, const DeviceCSRMatrix<T>& from, DeviceBSRMatrix<T, N>& to)
+    {
+        constexpr auto dir = CUSPARSE_DIRECTION_COLUMN;
+        int            m   = from.rows();
+        int            n   = from.cols();
+
+        to.reshape((m + N - 1) / N, (n + N - 1) / N);
+
+        int nnzb = 0;
+        checkCudaErrors(cusparseXcsr2bsrNnz(handle,
+                                            dir,
+                                            m,
+                                            n,
+                                            from.legacy_descr(),
+                                            from.row_offsets().data(),
+                                            from.col_indices().data(),
+                                            N,
+                                            to.legacy_descr(),
+                                            to.block_row_offsets().data(),
+                                            &nnzb));
+        to.resize(nnzb);
+
+        auto values = reinterpret_cast<T*>(to.block_values().data());
+        if constexpr(std::is_same_v<T, float>)
+        {
+            checkCudaErrors(cusparseScsr2bsr(handle,
+                                             dir,
+                                             m,
+                                             n,
+                                             from.legacy_descr(),
+                                             from.values().data(),
+                                             from.row_offsets().data(),
+                                             from.col_indices().data(),
+                                             N,
+                                             to.legacy_descr(),
+                                             values,
+                                             to.block_row_offsets().data(),
+                                             to.block_col_indices().data()));
+        }
+        else if constexpr(std::is_same_v<T, double>)
+        {
+            checkCudaErrors(cusparseDcsr2bsr(handle,
+                                             dir,
+                                             m,
+                                             n,
+                                             from.legacy_descr(),
+                                             from.values().data(),
+                                             from.row_offsets().data(),
+                                             from.col_indices().data(),
+                                             N,
+                                             to.legacy_descr(),
+                                             values,
+                                             to.block_row_offsets().data(),
+                                             to.block_col_indices().data()));
+        }
+    }
+
+    template <typename T, int N>
+    void amg_dense(cudaStream_t stream, CBSRMatrixView<T, N> A, DeviceDenseMatrix<T>& dense)
+    {
+        int size = A.block_rows() * N;
+        dense.reshape(size, size);
+        BufferLaunch(stream).fill(dense.buffer_view(), T{0});
+
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(A.block_rows(),
+                   [offsets = A.block_row_offsets(),
+                    cols    = A.block_col_indices(),
+                    values  = A.block_values(),
+                    dst = dense.viewer().name("dense")] __device__(int i) mutable
+                   {
+                       for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+                           dst.block<N, N>(i * N, cols[k] * N).as_eigen() = values[k];
+                   });
+    }
+
+    // LU factorization of hierarchy.coarse, in place, false (and a warning) if singular
+    template <typename T, int N>
+    bool amg_coarse_factorize(cusolverDnHandle_t cusolver, AMGHierarchy<T, N>& hierarchy)
+    {
+        auto    type = cuda_data_type<T>();
+        auto    A    = hierarchy.coarse.view();
+        int64_t n    = A.row();
+        auto    lda  = static_cast<int64_t>(A.lda());
+
+        hierarchy.cusolver = cusolver;
+        checkCudaErrors(cusolverDnCreateParams(&hierarchy.params));
+        checkCudaErrors(cusolverDnSetAdvOptions(hierarchy.params, CUSOLVERDN_GETRF, CUSOLVER_ALG_0));
+
+        size_t d_lwork = 0;
+        size_t h_lwork = 0;
+        checkCudaErrors(cusolverDnXgetrf_bufferSize(
+            cusolver, hierarchy.params, n, n, type, A.data(), lda, type, &d_lwork, &h_lwork));
+
+        DeviceBuffer<std::byte> d_work(std::max<size_t>(d_lwork, 1));
+        std::vector<std::byte>  h_work(std::max<size_t>(h_lwork, 1));
+        hierarchy.coarse_pivots.resize(n);
+
+        checkCudaErrors(cusolverDnXgetrf(cusolver,
+                                         hierarchy.params,
+                                         n,
+                                         n,
+                                         type,
+                                         A.data(),
+                                         lda,
+                                         hierarchy.coarse_pivots.data(),
+                                         type,
+                                         d_work.data(),
+                                         d_lwork,
+                                         h_work.data(),
+                                         h_lwork,
+                                         hierarchy.coarse_info.data()));
+
+        // synchronizes, the workspace is released after this
+        int h_info = hierarchy.coarse_info;
+        if(h_info != 0)
+        {
+            MUDA_KERNEL_WARN_WITH_LOCATION("AMG: the LU factorization of the coarsest level returned info=%d",
+                                           h_info);
+            return false;
+        }
+        return true;
+    }
+
+    // dst = src, skipped while `*stop != 0`
+    template <typename T>
+    void amg_assign(cudaStream_t stream, CDenseVectorView<T> src, DenseVectorView<T> dst, const int* stop)
+    {
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(dst.size(),
+                   [src = src.cviewer().name("src"),
+                    dst = dst.viewer().name("dst"),
+                    stop] __device__(int i) mutable
+                   {
+                       if(stop && *stop)
+                           return;
+                       dst(i) = src(i);
+                   });
+    }
+
+    // y = a * A * x + b * y. With `stop` the custom BSR kernel is used, it is
+    // skipped while `*stop != 0`; cuSPARSE (N > 8 or no `stop`) always runs
+    template <typename T, int N>
+    void amg_spmv(LinearSystemContext& ctx,
+                  T                    a,
+                  CBSRMatrixView<T, N> A,
+                  CDenseVectorView<T>  x,
+                  T                    b,
+                  DenseVectorView<T>   y,
+                  const int*           stop)
+    {
+        if constexpr(N <= LinearSystemSpMVPolicy::max_custom_bsr_block_dim)
+        {
+            if(stop && A.block_rows() > 0)
+            {
+                detail::linear_system::bsr_spmv_custom<T, N>(ctx.stream(), a, A, x, b, y, stop);
+                return;
+            }
+        }
+        ctx.spmv<T, N>(a, A, x, b, y);
+    }
+
+    // x = A_coarse^-1 b with the factorization of amg_coarse_factorize()
+    template <typename T, int N>
+    void amg_coarse_solve(cudaStream_t         stream,
+                          AMGHierarchy<T, N>&  hierarchy,
+                          CDenseVectorView<T>  b,
+                          DenseVectorView<T>   x,
+                          const int*           stop)
+    {
+        auto    type = cuda_data_type<T>();
+        auto    A    = hierarchy.coarse.view();
+        int64_t n    = A.row();
+
+        amg_assign<T>(stream, b, x, stop);
+        // at most coarse_size rows, not skipped
+        checkCudaErrors(cusolverDnXgetrs(hierarchy.cusolver,
+                                         hierarchy.params,
+                                         CUBLAS_OP_N,
+                                         n,
+                                         1, /* nrhs */
+                                         type,
+                                         A.data(),
+                                         static_cast<int64_t>(A.lda()),
+                                         hierarchy.coarse_pivots.data(),
+                                         type,
+                                         x.data(),
+                                         n,
+                                         hierarchy.coarse_info.data()));
+    }
+
+    // d = c_d * d + c_r * D^-1 r, x += d (x = d if `assign`)
+    template <typename T, int N>
+    void amg_smoother_step(cudaStream_t                                stream,
+                           const DeviceBuffer<Eigen::Matrix<T, N, N>>& inv_diag,
+                           CDenseVectorView<T>                         r,
+                           T                                           c_d,
+                           T                                           c_r,
+                           DenseVectorView<T>                          d,
+                           DenseVectorView<T>                          x,
+                           bool                                        assign,
+                           const int*                                  stop)
+    {
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(inv_diag.size(),
+                   [M = inv_diag.cviewer().name("inv_diag"),
+                    r = r.cviewer().name("r"),
+                    d = d.viewer().name("d"),
+                    x = x.viewer().name("x"),
+                    c_d,
+                    c_r,
+                    assign,
+                    stop] __device__(int i) mutable
+                   {
+                       if(stop && *stop)
+                           return;
+                       Eigen::Vector<T, N> step = c_r * (M(i) * r.segment<N>(i * N).as_eigen());
+                       if(c_d != T{0})  // d is not initialized before the first step
+                           step += c_d * d.segment<N>(i * N).as_eigen();
+                       d.segment<N>(i * N).as_eigen() = step;
+                       if(assign)
+                           x.segment<N>(i * N).as_eigen() = step;
+                       else
+                           x.segment<N>(i * N).as_eigen() += step;
+                   });
+    }
+
+    template <typename T, int N>
+    void amg_smooth(LinearSystemContext& ctx,
+                    AMGLevel<T, N>&      level,
+                    CDenseVectorView<T>  b,
+                    DenseVectorView<T>   x,
+                    bool                 zero_guess,
+                    const int*           stop)
+    {
+        if(zero_guess && level.steps.empty())
+            BufferLaunch(ctx.stream()).fill(x.buffer_view(), T{0});
+
+        auto r = level.r.view();
+        for(size_t k = 0; k < level.steps.size(); ++k)
+        {
+            // the first residual of a zero guess is b
+            bool first = zero_guess && k == 0;
+            if(!first)
+            {
+                amg_assign<T>(ctx.stream(), b, r, stop);
+                amg_spmv<T, N>(ctx, T{-1}, level.A.cview(), x, T{1}, r, stop);
+            }
+            auto [c_d, c_r] = level.steps[k];
+            amg_smoother_step<T, N>(
+                ctx.stream(), level.inv_diag, first ? b : r.as_const(), c_d, c_r, level.d.view(), x, first, stop);
+        }
+    }
+
+    // x = V(b) on level l, symmetric: the same smoothing steps before and after
+    // the coarse correction
+    template <typename T, int N>
+    void amg_vcycle(LinearSystemContext& ctx,
+                    AMGHierarchy<T, N>&  hierarchy,
+                    size_t               l,
+                    CDenseVectorView<T>  b,
+                    DenseVectorView<T>   x,
+                    const int*           stop)
+    {
+        auto& level = hierarchy.levels[l];
+        bool  last  = l + 1 == hierarchy.levels.size();
+
+        if(last && hierarchy.dense_coarse)
+        {
+            amg_coarse_solve<T, N>(ctx.stream(), hierarchy, b, x, stop);
+            return;
+        }
+
+        amg_smooth<T, N>(ctx, level, b, x, true, stop);
+        if(!last)
+        {
+            auto& next = hierarchy.levels[l + 1];
+            auto  r    = level.r.view();
+
+            amg_assign<T>(ctx.stream(), b, r, stop);
+            amg_spmv<T, N>(ctx, T{-1}, level.A.cview(), x, T{1}, r, stop);
+            amg_spmv<T, N>(ctx, T{1}, level.R.cview(), r, T{0}, next.b.view(), stop);
+
+            amg_vcycle<T, N>(ctx, hierarchy, l + 1, next.b.cview(), next.x.view(), stop);
+
+            amg_spmv<T, N>(ctx, T{1}, level.P.cview(), next.x.cview(), T{1}, x, stop);
+        }
+        amg_smooth<T, N>(ctx, level, b, x, false, stop);
+    }
+
+    template <typename T, int N>
+    void AMGHierarchy<T, N>::apply(LinearSystemContext& ctx,
+                                   CDenseVectorView<T>  r,
+                                   DenseVectorView<T>   z,
+                                   const int*           stop)
+    {
+        size_t rows = levels.front().A.block_rows() * N;
+        MUDA_ASSERT(r.inc() == 1 && z.inc() == 1, "AMG: r and z must be contiguous");
+        MUDA_ASSERT(r.size() == rows && z.size() == rows,
+                    "AMG: dimension mismatch, A.rows=%lld, r.size=%lld, z.size=%lld",
+                    rows,
+                    r.size(),
+                    z.size());
+        amg_vcycle<T, N>(ctx, *this, 0, r, z, stop);
+    }
+}  // namespace details::linear_system
+
+template <typename T>
+details::linear_system::AMGPreconditioner<T>& LinearSystemContext::amg_hierarchy(uint64_t hierarchy_id)
+{
+    auto it = m_amg_hierarchies.find(hierarchy_id);
+    MUDA_ASSERT(it != m_amg_hierarchies.end(),
+                "No AMG hierarchy with id %llu, call amg_setup() first",
+                (unsigned long long)hierarchy_id);
+    auto h = dynamic_cast<details::linear_system::AMGPreconditioner<T>*>(it->second.get());
+    MUDA_ASSERT(h, "AMG hierarchy %llu was set up with another value type", (unsigned long long)hierarchy_id);
+    return *h;
+}
+
+template <typename T, int N>
+void LinearSystemContext::amg_build(details::linear_system::AMGHierarchy<T, N>& hierarchy,
+                                    const LinearSystemAMGInfo&                  info)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(info.max_levels >= 1 && info.sweeps >= 0 && info.power_iterations >= 1
+                    && info.chebyshev_degree >= 1,
+                "AMG: invalid max_levels=%d, sweeps=%d, power_iterations=%d or chebyshev_degree=%d",
+                info.max_levels,
+                info.sweeps,
+                info.power_iterations,
+                info.chebyshev_degree);
+
+    auto& levels = hierarchy.levels;
+    while(true)
+    {
+        size_t l     = levels.size() - 1;
+        auto   A     = levels[l].A.cview();
+        int    rows  = A.block_rows();
+        auto   n     = size_t(rows) * N;
+
+        if(l > 0)
+        {
+            levels[l].x.resize(n);
+            levels[l].b.resize(n);
+        }
+        if(n <= size_t(info.coarse_size))
+            break;
+
+        levels[l].r.resize(n);
+        levels[l].d.resize(n);
+        amg_inverse_diagonal<T, N>(*this, A, levels[l].inv_diag);
+        levels[l].rho = amg_spectral_radius<T, N>(
+            *this, A, levels[l].inv_diag, levels[l].r.view(), levels[l].d.view(), info.power_iterations);
+        levels[l].steps = amg_smoother_steps<T>(info, levels[l].rho);
+
+        if(static_cast<int>(levels.size()) == info.max_levels)
+            break;
+
+        // aggregation on the host, see amg_aggregate()
+        std::vector<int> offsets;
+        std::vector<int> cols;
+        std::vector<T>   norms;
+        std::vector<int> aggregates;
+        amg_block_norms<T, N>(stream(), A, offsets, cols, norms);
+        int count = amg_aggregate<T>(
+            rows, offsets, cols, norms, static_cast<T>(info.strength_threshold), aggregates);
+        if(count == 0 || count == rows)
+            break;
+
+        std::vector<T> scales(count, T{0});
+        for(int J : aggregates)
+            if(J >= 0)
+                scales[J] += T{1};
+        for(auto& s : scales)
+            s = T{1} / std::sqrt(s);
+
+        DeviceBuffer<int> d_aggregates(rows);
+        DeviceBuffer<T>   d_scales(count);
+        BufferLaunch(stream())
+            .copy(d_aggregates.view(), aggregates.data())
+            .copy(d_scales.view(), scales.data());
+
+        // smoothed prolongator, duplicates merged by the BCOO conversion
+        DeviceTripletMatrix<T, N> P_triplet;
+        DeviceTripletMatrix<T, N> R_triplet;
+        DeviceBCOOMatrix<T, N>    bcoo;
+        T omega = static_cast<T>(info.prolongation_weight) / levels[l].rho;
+        amg_prolongator<T, N>(
+            stream(), A, levels[l].inv_diag, d_aggregates, d_scales, omega, P_triplet, R_triplet);
+        convert(P_triplet, bcoo);
+        convert(bcoo, levels[l].P);
+        convert(R_triplet, bcoo);
+        convert(bcoo, levels[l].R);
+
+        // Galerkin product R A P on the scalar CSR matrices
+        DeviceCSRMatrix<T> A_csr;
+        DeviceCSRMatrix<T> P_csr;
+        DeviceCSRMatrix<T> R_csr;
+        DeviceCSRMatrix<T> AP;
+        DeviceCSRMatrix<T> RAP;
+        convert(levels[l].A, A_csr);
+        convert(levels[l].P, P_csr);
+        convert(levels[l].R, R_csr);
+
+        set_pointer_mode_host();
+        amg_spgemm<T>(cusparse(), stream(), A_csr, P_csr, AP);
+        amg_spgemm<T>(cusparse(), stream(), R_csr, AP, RAP);
+
+        auto& next = levels.emplace_back();
+        amg_csr_to_bsr<T, N>(cusparse(), RAP, next.A);
+    }
+
+    auto& last             = levels.back();
+    auto  n                = size_t(last.A.block_rows()) * N;
+    hierarchy.dense_coarse = n <= size_t(info.coarse_size);
+    if(hierarchy.dense_coarse)
+    {
+        amg_dense<T, N>(stream(), last.A.cview(), hierarchy.coarse);
+        hierarchy.dense_coarse = amg_coarse_factorize<T, N>(cusolver_dn(), hierarchy);
+        if(!hierarchy.dense_coarse)
+        {
+            // singular coarsest level: smoothed only
+            last.r.resize(n);
+            last.d.resize(n);
+            amg_inverse_diagonal<T, N>(*this, last.A.cview(), last.inv_diag);
+            last.rho = amg_spectral_radius<T, N>(
+                *this, last.A.cview(), last.inv_diag, last.r.view(), last.d.view(), info.power_iterations);
+            last.steps = amg_smoother_steps<T>(info, last.rho);
+        }
+    }
+
+    checkCudaErrors(cudaStreamSynchronize(stream()));
+}
+
+template <typename T, int N>
+void LinearSystemContext::amg_setup(CBSRMatrixView<T, N>       A,
+                                    uint64_t                   hierarchy_id,
+                                    const LinearSystemAMGInfo& info)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(!A.is_trans(), "AMG: BSRMatrix A must not be transposed");
+    MUDA_ASSERT(A.block_rows() == A.block_cols(), "AMG: A must be square");
+
+    auto hierarchy = std::make_unique<AMGHierarchy<T, N>>();
+    // no reallocation (DeviceBSRMatrix copies on it)
+    hierarchy->levels.reserve(std::max(info.max_levels, 1));
+    amg_copy<T, N>(stream(), A, hierarchy->levels.emplace_back().A);
+    amg_build<T, N>(*hierarchy, info);
+    m_amg_hierarchies[hierarchy_id] = std::move(hierarchy);
+}
+
+template <typename T, int N>
+void LinearSystemContext::amg_setup(const DeviceBCOOMatrix<T, N>& A,
+                                    uint64_t                      hierarchy_id,
+                                    const LinearSystemAMGInfo&    info)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(A.block_rows() == A.block_cols(), "AMG: A must be square");
+
+    auto hierarchy = std::make_unique<AMGHierarchy<T, N>>();
+    // no reallocation (DeviceBSRMatrix copies on it)
+    hierarchy->levels.reserve(std::max(info.max_levels, 1));
+    convert(A, hierarchy->levels.emplace_back().A);
+    amg_build<T, N>(*hierarchy, info);
+    m_amg_hierarchies[hierarchy_id] = std::move(hierarchy);
+}
+
+template <typename T>
+void LinearSystemContext::amg_apply(uint64_t hierarchy_id, CDenseVectorView<T> r, DenseVectorView<T> z)
+{
+    amg_hierarchy<T>(hierarchy_id).apply(*this, r, z, nullptr);
+}
+
+MUDA_INLINE bool LinearSystemContext::has_amg(uint64_t hierarchy_id) const
+{
+    return m_amg_hierarchies.find(hierarchy_id) != m_amg_hierarchies.end();
+}
+
+MUDA_INLINE void LinearSystemContext::release_amg(uint64_t hierarchy_id)
+{
+    // the buffers may still be in use by the stream
+    checkCudaErrors(cudaStreamSynchronize(stream()));
+    m_amg_hierarchies.erase(hierarchy_id);
+}
+}  // namespace muda
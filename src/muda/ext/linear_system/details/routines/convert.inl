@@ -8,6 +8,28 @@ void LinearSystemContext::convert(const DeviceTripletMatrix<T, N>& from,
     m_converter.convert(from, to);
 }
 
+template <typename T, int N>
+void LinearSystemContext::convert(const DeviceTripletMatrix<T, N>& from,
+                                  DeviceBCOOMatrix<T, N>&          to,
+                                  uint64_t                         pattern_id)
+{
+    m_converter.convert(from, to, pattern_id);
+}
+
+template <typename T, int N>
+void LinearSystemContext::convert_values_only(const DeviceTripletMatrix<T, N>& from,
+                                              DeviceBCOOMatrix<T, N>& to,
+                                              uint64_t pattern_id)
+{
+    m_converter.convert_values_only(from, to, pattern_id);
+}
+
+template <typename T, int N>
+void LinearSystemContext::release_pattern(uint64_t pattern_id)
+{
+    m_converter.release_pattern<T, N>(pattern_id);
+}
+
 // BCOO -> Dense Matrix
 template <typename T, int N>
 void LinearSystemContext::convert(const DeviceBCOOMatrix<T, N>& from,
@@ -0,0 +1,280 @@
+#include <algorithm>
+namespace muda
+{
+namespace details::linear_system
+{
+    constexpr int FusedReduceBlockSize = 256;
+    constexpr int FusedReduceMaxGrid   = 1024;
+
+    template <typename T, int M>
+    class FusedPointers
+    {
+      public:
+        T* data[M];
+    };
+
+    MUDA_INLINE int fused_reduce_grid(int size)
+    {
+        int grid = (size + FusedReduceBlockSize - 1) / FusedReduceBlockSize;
+        return std::clamp(grid, 1, FusedReduceMaxGrid);
+    }
+
+    // sums `acc` over the block, the result is in thread 0
+    template <typename T, int M>
+    MUDA_INLINE MUDA_DEVICE void fused_block_sum(T (&acc)[M])
+    {
+        __shared__ T s_acc[M][FusedReduceBlockSize / 32];
+
+        int lane = threadIdx.x & 31;
+        int warp = threadIdx.x / 32;
+
+#pragma unroll
+        for(int m = 0; m < M; ++m)
+            for(int offset = 16; offset > 0; offset >>= 1)
+                acc[m] += __shfl_down_sync(0xffffffff, acc[m], offset);
+
+        if(lane == 0)
+        {
+#pragma unroll
+            for(int m = 0; m < M; ++m)
+                s_acc[m][warp] = acc[m];
+        }
+        __syncthreads();
+
+        if(warp == 0)
+        {
+#pragma unroll
+            for(int m = 0; m < M; ++m)
+            {
+                acc[m] = lane < FusedReduceBlockSize / 32 ? s_acc[m][lane] : T{0};
+                for(int offset = 16; offset > 0; offset >>= 1)
+                    acc[m] += __shfl_down_sync(0xffffffff, acc[m], offset);
+            }
+        }
+    }
+
+    /**
+     * \brief One pass over `size` elements: `f(i, acc)` does the element-wise
+     * update of element i and adds its M terms to `acc`, the M sums go to
+     * `results` (device pointers).
+     *
+     * Deterministic (no atomics): per-block sums go to `partials`
+     * (`fused_reduce_grid(size) * M` elements), then one block adds them up.
+     */
+    template <typename T, int M, typename F>
+    void fused_reduce(cudaStream_t             stream,
+                      int                      size,
+                      F                        f,
+                      BufferView<T>            partials,
+                      FusedPointers<T, M>      results)
+    {
+        int grid = fused_reduce_grid(size);
+
+        Launch(grid, FusedReduceBlockSize, 0, stream)
+            .kernel_name("fused_reduce")
+            .apply(
+                [f, size, partials = partials.data()] __device__() mutable
+                {
+                    T acc[M];
+#pragma unroll
+                    for(int m = 0; m < M; ++m)
+                        acc[m] = T{0};
+
+                    for(int i = blockIdx.x * blockDim.x + threadIdx.x; i < size;
+                        i += gridDim.x * blockDim.x)
+                        f(i, acc);
+
+                    fused_block_sum<T, M>(acc);
+
+                    if(threadIdx.x == 0)
+                    {
+#pragma unroll
+                        for(int m = 0; m < M; ++m)
+                            partials[blockIdx.x * M + m] = acc[m];
+                    }
+                });
+
+        Launch(1, FusedReduceBlockSize, 0, stream)
+            .kernel_name("fused_reduce_partials")
+            .apply(
+                [grid, results, partials = partials.data()] __device__() mutable
+                {
+                    T acc[M];
+#pragma unroll
+                    for(int m = 0; m < M; ++m)
+                        acc[m] = T{0};
+
+                    for(int b = threadIdx.x; b < grid; b += blockDim.x)
+                    {
+#pragma unroll
+                        for(int m = 0; m < M; ++m)
+                            acc[m] += partials[b * M + m];
+                    }
+
+                    fused_block_sum<T, M>(acc);
+
+                    if(threadIdx.x == 0)
+                    {
+#pragma unroll
+                        for(int m = 0; m < M; ++m)
+                            *results.data[m] = acc[m];
+                    }
+                });
+    }
+
+    template <typename T>
+    MUDA_INLINE void fused_common_check(CDenseVectorView<T> x, int size)
+    {
+        MUDA_ASSERT(x.data(), "Vector is empty");
+        MUDA_ASSERT(x.inc() == 1, "Fused vector routines need contiguous vectors (inc=%d)", x.inc());
+        MUDA_ASSERT(x.size() == size,
+                    "Vector size mismatch, expected %d, got %d",
+                    size,
+                    (int)x.size());
+    }
+}  // namespace details::linear_system
+
+template <typename T>
+void LinearSystemContext::axpy_dot(const T&            alpha,
+                                   CDenseVectorView<T> x,
+                                   DenseVectorView<T>  y,
+                                   VarView<T>          y_dot_y)
+{
+    using namespace details::linear_system;
+    int size = y.size();
+    fused_common_check<T>(x, size);
+    fused_common_check<T>(y, size);
+
+    fused_reduce<T, 1>(
+        stream(),
+        size,
+        [a = alpha, x = x.data(), y = y.data()] __device__(int i, T* acc) mutable
+        {
+            T v = y[i] + a * x[i];
+            y[i] = v;
+            acc[0] += v * v;
+        },
+        temp_buffer<T>(fused_reduce_grid(size)),
+        FusedPointers<T, 1>{{y_dot_y.data()}});
+}
+
+template <typename T>
+void LinearSystemContext::axpy_dot(CVarView<T>         alpha,
+                                   CDenseVectorView<T> x,
+                                   DenseVectorView<T>  y,
+                                   VarView<T>          y_dot_y)
+{
+    using namespace details::linear_system;
+    int size = y.size();
+    fused_common_check<T>(x, size);
+    fused_common_check<T>(y, size);
+
+    fused_reduce<T, 1>(
+        stream(),
+        size,
+        [a = alpha.data(), x = x.data(), y = y.data()] __device__(int i, T* acc) mutable
+        {
+            T v = y[i] + *a * x[i];
+            y[i] = v;
+            acc[0] += v * v;
+        },
+        temp_buffer<T>(fused_reduce_grid(size)),
+        FusedPointers<T, 1>{{y_dot_y.data()}});
+}
+
+template <typename T, size_t M>
+void LinearSystemContext::multi_dot(const std::array<CDenseVectorView<T>, M>& xs,
+                                    const std::array<CDenseVectorView<T>, M>& ys,
+                                    std::array<VarView<T>, M> results)
+{
+    using namespace details::linear_system;
+    static_assert(M > 0, "multi_dot needs at least one pair");
+    constexpr int Count = static_cast<int>(M);
+
+    int                             size = xs[0].size();
+    FusedPointers<const T, Count>   x_ptrs;
+    FusedPointers<const T, Count>   y_ptrs;
+    FusedPointers<T, Count>         r_ptrs;
+    for(int m = 0; m < Count; ++m)
+    {
+        fused_common_check<T>(xs[m], size);
+        fused_common_check<T>(ys[m], size);
+        x_ptrs.data[m] = xs[m].data();
+        y_ptrs.data[m] = ys[m].data();
+        r_ptrs.data[m] = results[m].data();
+    }
+
+    fused_reduce<T, Count>(
+        stream(),
+        size,
+        [xs = x_ptrs, ys = y_ptrs] __device__(int i, T* acc) mutable
+        {
+#pragma unroll
+            for(int m = 0; m < Count; ++m)
+                acc[m] += xs.data[m][i] * ys.data[m][i];
+        },
+        temp_buffer<T>(fused_reduce_grid(size) * Count),
+        r_ptrs);
+}
+
+template <typename T>
+void LinearSystemContext::update_xr(const T&            alpha,
+                                    CDenseVectorView<T> p,
+                                    CDenseVectorView<T> Ap,
+                                    DenseVectorView<T>  x,
+                                    DenseVectorView<T>  r,
+                                    VarView<T>          r_dot_r)
+{
+    using namespace details::linear_system;
+    int size = x.size();
+    fused_common_check<T>(p, size);
+    fused_common_check<T>(Ap, size);
+    fused_common_check<T>(x, size);
+    fused_common_check<T>(r, size);
+
+    fused_reduce<T, 1>(
+        stream(),
+        size,
+        [a = alpha, p = p.data(), Ap = Ap.data(), x = x.data(), r = r.data()] __device__(
+            int i, T* acc) mutable
+        {
+            x[i] += a * p[i];
+            T v  = r[i] - a * Ap[i];
+            r[i] = v;
+            acc[0] += v * v;
+        },
+        temp_buffer<T>(fused_reduce_grid(size)),
+        FusedPointers<T, 1>{{r_dot_r.data()}});
+}
+
+template <typename T>
+void LinearSystemContext::update_xr(CVarView<T>         alpha,
+                                    CDenseVectorView<T> p,
+                                    CDenseVectorView<T> Ap,
+                                    DenseVectorView<T>  x,
+                                    DenseVectorView<T>  r,
+                                    VarView<T>          r_dot_r)
+{
+    using namespace details::linear_system;
+    int size = x.size();
+    fused_common_check<T>(p, size);
+    fused_common_check<T>(Ap, size);
+    fused_common_check<T>(x, size);
+    fused_common_check<T>(r, size);
+
+    fused_reduce<T, 1>(
+        stream(),
+        size,
+        [a = alpha.data(), p = p.data(), Ap = Ap.data(), x = x.data(), r = r.data()] __device__(
+            int i, T* acc) mutable
+        {
+            T alpha = *a;
+            x[i] += alpha * p[i];
+            T v  = r[i] - alpha * Ap[i];
+            r[i] = v;
+            acc[0] += v * v;
+        },
+        temp_buffer<T>(fused_reduce_grid(size)),
+        FusedPointers<T, 1>{{r_dot_r.data()}});
+}
+}  // namespace muda
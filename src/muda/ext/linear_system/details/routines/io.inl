@@ -0,0 +1,834 @@
+#include <limits>
+#include <memory>
+#include <muda/launch/memory.h>
+#include "io/matrix_market_text.inl"
+#include "io/matrix_market_binary.inl"
+namespace muda
+{
+namespace details::linear_system
+{
+    /**
+     * \brief Two pinned host buffers: the host fills (or reads) one while the
+     * stream copies the other.
+     */
+    class MatrixMarketStaging
+    {
+        std::byte*  m_host[2]   = {};
+        cudaEvent_t m_done[2]   = {};
+        size_t      m_byte_size = 0;
+
+      public:
+        MatrixMarketStaging(size_t byte_size)
+            : m_byte_size(byte_size)
+        {
+            for(int slot = 0; slot < 2; ++slot)
+            {
+                checkCudaErrors(cudaMallocHost(&m_host[slot], byte_size));
+                checkCudaErrors(cudaEventCreateWithFlags(&m_done[slot], cudaEventDisableTiming));
+            }
+        }
+        MatrixMarketStaging(const MatrixMarketStaging&)            = delete;
+        MatrixMarketStaging& operator=(const MatrixMarketStaging&) = delete;
+        ~MatrixMarketStaging()
+        {
+            for(int slot = 0; slot < 2; ++slot)
+            {
+                // copies may still be in flight on an early return
+                checkCudaErrors(cudaEventSynchronize(m_done[slot]));
+                checkCudaErrors(cudaEventDestroy(m_done[slot]));
+                checkCudaErrors(cudaFreeHost(m_host[slot]));
+            }
+        }
+
+        size_t     byte_size() const { return m_byte_size; }
+        std::byte* host(int slot) { return m_host[slot]; }
+        // marks the copies just enqueued from/to `slot`
+        void record(int slot, cudaStream_t stream)
+        {
+            checkCudaErrors(cudaEventRecord(m_done[slot], stream));
+        }
+        // waits for the copies last recorded on `slot`
+        void wait(int slot) { checkCudaErrors(cudaEventSynchronize(m_done[slot])); }
+    };
+
+    // rows | cols | values of `capacity` entries in one staging slot
+    template <typename T>
+    class MatrixMarketSlot
+    {
+      public:
+        int* rows;
+        int* cols;
+        T*   values;
+    };
+
+    inline size_t mm_align(size_t bytes)
+    {
+        return (bytes + 15) / 16 * 16;
+    }
+
+    template <typename T>
+    size_t mm_slot_byte_size(size_t capacity, size_t values_per_entry)
+    {
+        return mm_align(2 * capacity * sizeof(int)) + capacity * values_per_entry * sizeof(T);
+    }
+
+    template <typename T>
+    MatrixMarketSlot<T> mm_slot(std::byte* host, size_t capacity)
+    {
+        auto rows   = reinterpret_cast<int*>(host);
+        auto values = reinterpret_cast<T*>(host + mm_align(2 * capacity * sizeof(int)));
+        return MatrixMarketSlot<T>{rows, rows + capacity, values};
+    }
+
+    /**
+     * \brief dst (device) = T(src) (mapped file, `src_size` bytes per value),
+     * through the staging, `step` alternates the slots across calls.
+     */
+    template <typename T>
+    void mm_upload(cudaStream_t         stream,
+                   MatrixMarketStaging& staging,
+                   int&                 step,
+                   T*                   dst,
+                   const std::byte*     src,
+                   uint32_t             src_size,
+                   size_t               count)
+    {
+        size_t per_step = staging.byte_size() / sizeof(T);
+        for(size_t begin = 0; begin < count; begin += per_step, ++step)
+        {
+            size_t n    = std::min(per_step, count - begin);
+            int    slot = step & 1;
+            staging.wait(slot);
+            auto host = reinterpret_cast<T*>(staging.host(slot));
+            mm_convert_values(src + begin * src_size, src_size, n, host);
+            Memory(stream).upload(dst + begin, host, n * sizeof(T));
+            staging.record(slot, stream);
+        }
+    }
+
+    /**
+     * \brief For each of `steps` steps: `issue(step, slot)` enqueues the downloads
+     * of the step into `staging.host(slot)`, `consume(step, slot)` runs once they
+     * arrived. The downloads of a step overlap the consume of the previous one.
+     *
+     * \return false if a consume failed
+     */
+    template <typename Issue, typename Consume>
+    bool mm_download_steps(cudaStream_t         stream,
+                           MatrixMarketStaging& staging,
+                           int64_t              steps,
+                           Issue&&              issue,
+                           Consume&&            consume)
+    {
+        if(steps == 0)
+            return true;
+
+        issue(int64_t{0}, 0);
+        staging.record(0, stream);
+        for(int64_t step = 0; step < steps; ++step)
+        {
+            int slot = step & 1;
+            if(step + 1 < steps)
+            {
+                issue(step + 1, slot ^ 1);
+                staging.record(slot ^ 1, stream);
+            }
+            staging.wait(slot);
+            if(!consume(step, slot))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    void mm_download_write(cudaStream_t         stream,
+                           MatrixMarketStaging& staging,
+                           std::FILE*           file,
+                           const T*             src,
+                           size_t               count,
+                           bool&                ok)
+    {
+        int64_t per_step = staging.byte_size() / sizeof(T);
+        int64_t steps    = (int64_t(count) + per_step - 1) / per_step;
+        auto    size     = [&](int64_t step)
+        { return std::min<int64_t>(per_step, int64_t(count) - step * per_step); };
+
+        ok = ok
+             && mm_download_steps(
+                 stream,
+                 staging,
+                 steps,
+                 [&](int64_t step, int slot)
+                 {
+                     Memory(stream).download(staging.host(slot),
+                                             src + step * per_step,
+                                             size(step) * sizeof(T));
+                 },
+                 [&](int64_t step, int slot)
+                 {
+                     return std::fwrite(staging.host(slot), sizeof(T), size(step), file)
+                            == size_t(size(step));
+                 });
+    }
+
+    // one N x N block per scalar entry: block `offset + k` holds values[k] at (rows[k] % N, cols[k] % N)
+    template <typename T, int N>
+    void mm_scatter_blocks(cudaStream_t            stream,
+                           int                     count,
+                           const int*              rows,
+                           const int*              cols,
+                           const T*                values,
+                           int                     offset,
+                           int*                    block_rows,
+                           int*                    block_cols,
+                           Eigen::Matrix<T, N, N>* blocks)
+    {
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(count,
+                   [rows, cols, values, offset, block_rows, block_cols, blocks] __device__(
+                       int k) mutable
+                   {
+                       int  i     = rows[k];
+                       int  j     = cols[k];
+                       auto block = Eigen::Matrix<T, N, N>::Zero().eval();
+
+                       block(i % N, j % N)    = values[k];
+                       block_rows[offset + k] = i / N;
+                       block_cols[offset + k] = j / N;
+                       blocks[offset + k]     = block;
+                   });
+    }
+
+    // rows[k] = i for the entries k of row i
+    MUDA_INLINE void mm_expand_csr_rows(cudaStream_t stream, int rows, const int* row_offsets, int* row_indices)
+    {
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(rows,
+                   [row_offsets, row_indices] __device__(int i) mutable
+                   {
+                       for(int k = row_offsets[i]; k < row_offsets[i + 1]; ++k)
+                           row_indices[k] = i;
+                   });
+    }
+
+    template <typename T, int N>
+    auto mm_triplet_pointers(DeviceTripletMatrix<T, N>& A)
+    {
+        if constexpr(N == 1)
+            return std::make_tuple(A.row_indices().data(), A.col_indices().data(), A.values().data());
+        else
+            return std::make_tuple(A.block_row_indices().data(),
+                                   A.block_col_indices().data(),
+                                   A.block_values().data());
+    }
+
+    template <typename T, int N>
+    std::pair<int, int> mm_block_shape(const DeviceTripletMatrix<T, N>& A)
+    {
+        if constexpr(N == 1)
+            return {A.rows(), A.cols()};
+        else
+            return {A.block_rows(), A.block_cols()};
+    }
+
+    template <typename T, int N>
+    const char* mm_read_text(cudaStream_t                stream,
+                             std::string_view            path,
+                             const LinearSystemIOInfo&   info,
+                             DeviceTripletMatrix<T, N>&  A)
+    {
+        MatrixMarketTextReader reader;
+        if(!reader.open(path, info.chunk_byte_size))
+            return "can't open the file";
+
+        MatrixMarketHeader header;
+        if(!mm_parse_header(reader, header))
+            return "unsupported header (need a real/integer/pattern general/symmetric/skew-symmetric matrix)";
+        if(header.format != MatrixMarketFormat::Coordinate)
+            return "a sparse matrix needs the coordinate format";
+        if(header.rows % N != 0 || header.cols % N != 0)
+            return "rows/cols are not multiples of the block dim";
+
+        int64_t max_count = header.entries * (header.mirrored() ? 2 : 1);
+        if(max_count > std::numeric_limits<int>::max())
+            return "too many entries for the triplet matrix";
+
+        A.reshape(header.rows / N, header.cols / N);
+        A.resize_triplets(max_count);
+        auto [block_rows, block_cols, blocks] = mm_triplet_pointers(A);
+
+        int    threads  = mm_threads(info.threads);
+        size_t capacity = (reader.chunk_byte_size() / header.min_line_bytes() + 1)
+                          * (header.mirrored() ? 2 : 1);
+        MatrixMarketStaging staging(mm_slot_byte_size<T>(capacity, 1));
+
+        // N > 1: the scalar entries of one step, scattered into blocks on the device
+        DeviceBuffer<int> d_rows(N > 1 ? capacity : 0);
+        DeviceBuffer<int> d_cols(N > 1 ? capacity : 0);
+        DeviceBuffer<T>   d_values(N > 1 ? capacity : 0);
+
+        int64_t lines = 0;
+        int64_t count = 0;
+        for(int step = 0;; ++step)
+        {
+            auto text = reader.next_lines();
+            if(text.empty())
+                break;
+
+            int slot = step & 1;
+            staging.wait(slot);
+            auto s = mm_slot<T>(staging.host(slot), capacity);
+
+            int64_t step_lines = 0;
+            int64_t n = mm_parse_coordinate(text, header, threads, s.rows, s.cols, s.values, step_lines);
+            if(n < 0)
+                return "bad data line";
+            lines += step_lines;
+            if(count + n > max_count)
+                return "more entries than given in the size line";
+
+            if constexpr(N == 1)
+            {
+                Memory(stream)
+                    .upload(block_rows + count, s.rows, n * sizeof(int))
+                    .upload(block_cols + count, s.cols, n * sizeof(int))
+                    .upload(blocks + count, s.values, n * sizeof(T));
+            }
+            else
+            {
+                Memory(stream)
+                    .upload(d_rows.data(), s.rows, n * sizeof(int))
+                    .upload(d_cols.data(), s.cols, n * sizeof(int))
+                    .upload(d_values.data(), s.values, n * sizeof(T));
+                mm_scatter_blocks<T, N>(stream,
+                                        n,
+                                        d_rows.data(),
+                                        d_cols.data(),
+                                        d_values.data(),
+                                        count,
+                                        block_rows,
+                                        block_cols,
+                                        blocks);
+            }
+            staging.record(slot, stream);
+            count += n;
+        }
+        checkCudaErrors(cudaStreamSynchronize(stream));
+
+        if(lines != header.entries)
+            return "fewer entries than given in the size line";
+        A.resize_triplets(count);
+        return nullptr;
+    }
+
+    template <typename T, int N>
+    const char* mm_read_binary(cudaStream_t               stream,
+                               std::string_view           path,
+                               const LinearSystemIOInfo&  info,
+                               DeviceTripletMatrix<T, N>& A,
+                               bool&                      sorted_unique)
+    {
+        MappedFile file;
+        if(!file.open(path))
+            return "can't map the file";
+
+        MatrixMarketBinaryHeader header;
+        if(file.size() < sizeof(header))
+            return "not a .mtxb file";
+        std::memcpy(&header, file.data(), sizeof(header));
+        if(!header.valid(file.size()))
+            return "not a .mtxb file, or truncated";
+        if(header.kind != MatrixMarketBinaryKind::Coordinate)
+            return "the file holds a vector, not a matrix";
+        if(header.block_dim != N && header.block_dim != 1)
+            return "the block dim of the file doesn't match";
+
+        // valid(): count and the shape fit in int
+        int  count  = static_cast<int>(header.count);
+        auto rows   = file.data() + sizeof(header);
+        auto cols   = rows + size_t(count) * sizeof(int);
+        auto values = file.data() + header.value_offset();
+        if(mm_find_out_of_range(rows, count, header.block_rows) >= 0
+           || mm_find_out_of_range(cols, count, header.block_cols) >= 0)
+            return "an index is out of the matrix shape";
+
+        MatrixMarketStaging staging(info.chunk_byte_size);
+        int                 step = 0;
+
+        if(header.block_dim == N)
+        {
+            A.resize(header.block_rows, header.block_cols, count);
+            auto [block_rows, block_cols, blocks] = mm_triplet_pointers(A);
+            mm_upload(stream, staging, step, block_rows, rows, sizeof(int), count);
+            mm_upload(stream, staging, step, block_cols, cols, sizeof(int), count);
+            mm_upload(stream, staging, step, reinterpret_cast<T*>(blocks), values, header.value_size, size_t(count) * N * N);
+            sorted_unique = header.flags & MatrixMarketBinarySortedUnique;
+        }
+        else  // scalar file, one block per entry as for text files
+        {
+            if(header.block_rows % N != 0 || header.block_cols % N != 0)
+                return "rows/cols are not multiples of the block dim";
+
+            A.reshape(header.block_rows / N, header.block_cols / N);
+            A.resize_triplets(count);
+            auto [block_rows, block_cols, blocks] = mm_triplet_pointers(A);
+
+            int per_step = static_cast<int>(staging.byte_size() / sizeof(double));
+            DeviceBuffer<int> d_rows(std::min(per_step, count));
+            DeviceBuffer<int> d_cols(std::min(per_step, count));
+            DeviceBuffer<T>   d_values(std::min(per_step, count));
+            for(int begin = 0; begin < count; begin += per_step)
+            {
+                int n = std::min(per_step, count - begin);
+                mm_upload(stream, staging, step, d_rows.data(), rows + begin * sizeof(int), sizeof(int), n);
+                mm_upload(stream, staging, step, d_cols.data(), cols + begin * sizeof(int), sizeof(int), n);
+                mm_upload(stream,
+                          staging,
+                          step,
+                          d_values.data(),
+                          values + size_t(begin) * header.value_size,
+                          header.value_size,
+                          n);
+                mm_scatter_blocks<T, N>(stream,
+                                        n,
+                                        d_rows.data(),
+                                        d_cols.data(),
+                                        d_values.data(),
+                                        begin,
+                                        block_rows,
+                                        block_cols,
+                                        blocks);
+            }
+            sorted_unique = false;
+        }
+        checkCudaErrors(cudaStreamSynchronize(stream));
+        return nullptr;
+    }
+
+    template <typename T, int N>
+    const char* mm_read_matrix(cudaStream_t               stream,
+                               std::string_view           path,
+                               const LinearSystemIOInfo&  info,
+                               DeviceTripletMatrix<T, N>& A,
+                               bool&                      sorted_unique)
+    {
+        sorted_unique = false;
+        auto error    = mm_is_binary_path(path) ? mm_read_binary(stream, path, info, A, sorted_unique) :
+                                                  mm_read_text(stream, path, info, A);
+        if(error)
+            A.clear();
+        return error;
+    }
+
+    /**
+     * \brief Writes `count` N x N blocks (device pointers, block indices) of a
+     * `block_rows` x `block_cols` block matrix.
+     */
+    template <typename T, int N>
+    const char* mm_write_matrix(cudaStream_t              stream,
+                                std::string_view          path,
+                                const LinearSystemIOInfo& info,
+                                int                       block_rows,
+                                int                       block_cols,
+                                int                       count,
+                                const int*                rows,
+                                const int*                cols,
+                                const T*                  values,
+                                uint32_t                  flags)
+    {
+        bool binary = mm_is_binary_path(path);
+        std::unique_ptr<std::FILE, decltype(&std::fclose)> file{
+            std::fopen(std::string{path}.c_str(), binary ? "wb" : "w"), &std::fclose};
+        if(!file)
+            return "can't open the file";
+
+        // the matrix may have been filled on another stream
+        checkCudaErrors(cudaStreamSynchronize(stream));
+
+        bool ok = true;
+        if(binary)
+        {
+            MatrixMarketBinaryHeader header;
+            header.kind       = MatrixMarketBinaryKind::Coordinate;
+            header.value_size = sizeof(T);
+            header.block_dim  = N;
+            header.flags      = flags;
+            header.block_rows = block_rows;
+            header.block_cols = block_cols;
+            header.count      = count;
+            ok = std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+
+            MatrixMarketStaging staging(info.chunk_byte_size);
+            mm_download_write(stream, staging, file.get(), rows, count, ok);
+            mm_download_write(stream, staging, file.get(), cols, count, ok);
+            mm_download_write(stream, staging, file.get(), values, size_t(count) * N * N, ok);
+        }
+        else
+        {
+            MatrixMarketHeader header;
+            header.rows    = int64_t(block_rows) * N;
+            header.cols    = int64_t(block_cols) * N;
+            header.entries = int64_t(count) * N * N;
+            mm_write_header(file.get(), header);
+
+            // about 32 bytes per line
+            int64_t per_step = std::max<int64_t>(info.chunk_byte_size / (32 * N * N), 1);
+            int64_t steps    = (count + per_step - 1) / per_step;
+            auto    size     = [&](int64_t step)
+            { return std::min<int64_t>(per_step, count - step * per_step); };
+
+            int                      threads = mm_threads(info.threads);
+            std::vector<std::string> text;
+            MatrixMarketStaging      staging(mm_slot_byte_size<T>(per_step, N * N));
+
+            ok = mm_download_steps(
+                stream,
+                staging,
+                steps,
+                [&](int64_t step, int slot)
+                {
+                    auto s     = mm_slot<T>(staging.host(slot), per_step);
+                    auto begin = step * per_step;
+                    auto n     = size(step);
+                    Memory(stream)
+                        .download(s.rows, rows + begin, n * sizeof(int))
+                        .download(s.cols, cols + begin, n * sizeof(int))
+                        .download(s.values, values + begin * N * N, n * N * N * sizeof(T));
+                },
+                [&](int64_t step, int slot)
+                {
+                    auto s = mm_slot<T>(staging.host(slot), per_step);
+                    mm_format_coordinate(threads, N, size(step), s.rows, s.cols, s.values, text);
+                    for(auto& part : text)
+                        if(std::fwrite(part.data(), 1, part.size(), file.get()) != part.size())
+                            return false;
+                    return true;
+                });
+        }
+        return ok && std::fflush(file.get()) == 0 ? nullptr : "write failed";
+    }
+}  // namespace details::linear_system
+
+template <typename T, int N>
+bool LinearSystemContext::read_matrix_market(std::string_view           path,
+                                             DeviceTripletMatrix<T, N>& A,
+                                             const LinearSystemIOInfo&  info)
+{
+    using namespace details::linear_system;
+    bool sorted_unique;
+    auto error = mm_read_matrix(stream(), path, info, A, sorted_unique);
+    if(error)
+        MUDA_KERNEL_WARN_WITH_LOCATION("In calling label %s: read_matrix_market(%s) failed, %s",
+                                       std::string{label()}.c_str(),
+                                       std::string{path}.c_str(),
+                                       error);
+    label("");  // consumed here
+    return !error;
+}
+
+template <typename T, int N>
+bool LinearSystemContext::read_matrix_market(std::string_view          path,
+                                             DeviceBCOOMatrix<T, N>&   A,
+                                             const LinearSystemIOInfo& info)
+{
+    using namespace details::linear_system;
+    DeviceTripletMatrix<T, N> triplet;
+    bool                      sorted_unique;
+    auto error = mm_read_matrix(stream(), path, info, triplet, sorted_unique);
+    if(error)
+    {
+        MUDA_KERNEL_WARN_WITH_LOCATION("In calling label %s: read_matrix_market(%s) failed, %s",
+                                       std::string{label()}.c_str(),
+                                       std::string{path}.c_str(),
+                                       error);
+        A.clear();
+    }
+    else if(sorted_unique)  // written from a BCOO matrix, already in shape
+    {
+        A.clear();
+        static_cast<DeviceTripletMatrix<T, N>&>(A) = std::move(triplet);
+    }
+    else
+    {
+        convert(triplet, A);
+    }
+    label("");  // consumed here
+    return !error;
+}
+
+template <typename T>
+bool LinearSystemContext::read_matrix_market(std::string_view          path,
+                                             DeviceCSRMatrix<T>&       A,
+                                             const LinearSystemIOInfo& info)
+{
+    DeviceCOOMatrix<T> coo;
+    auto               ok = read_matrix_market(path, coo, info);
+    if(ok)
+        convert(std::move(coo), A);
+    else
+        A.clear();
+    return ok;
+}
+
+template <typename T>
+bool LinearSystemContext::read_matrix_market(std::string_view          path,
+                                             DeviceDenseVector<T>&     x,
+                                             const LinearSystemIOInfo& info)
+{
+    using namespace details::linear_system;
+
+    auto read = [&]() -> const char*
+    {
+        if(mm_is_binary_path(path))
+        {
+            MappedFile file;
+            if(!file.open(path))
+                return "can't map the file";
+            MatrixMarketBinaryHeader header;
+            if(file.size() < sizeof(header))
+                return "not a .mtxb file";
+            std::memcpy(&header, file.data(), sizeof(header));
+            if(!header.valid(file.size()))
+                return "not a .mtxb file, or truncated";
+            if(header.kind != MatrixMarketBinaryKind::Array)
+                return "the file holds a matrix, not a vector";
+
+            x.resize(header.count);
+            MatrixMarketStaging staging(info.chunk_byte_size);
+            int                 step = 0;
+            mm_upload(stream(),
+                      staging,
+                      step,
+                      x.view().data(),
+                      file.data() + header.value_offset(),
+                      header.value_size,
+                      header.count);
+            checkCudaErrors(cudaStreamSynchronize(stream()));
+            return nullptr;
+        }
+
+        MatrixMarketTextReader reader;
+        if(!reader.open(path, info.chunk_byte_size))
+            return "can't open the file";
+        MatrixMarketHeader header;
+        if(!mm_parse_header(reader, header))
+            return "unsupported header (need a real/integer general array)";
+        if(header.format != MatrixMarketFormat::Array || (header.rows != 1 && header.cols != 1))
+            return "a vector needs the array format with one row or column";
+        // mm_parse_header() bounds rows and cols by int max, one of them is 1
+        x.resize(header.entries);
+        int    threads  = mm_threads(info.threads);
+        size_t capacity = reader.chunk_byte_size() / header.min_line_bytes() + 1;
+        MatrixMarketStaging staging(capacity * sizeof(T));
+
+        int64_t count = 0;
+        for(int step = 0;; ++step)
+        {
+            auto text = reader.next_lines();
+            if(text.empty())
+                break;
+
+            int slot = step & 1;
+            staging.wait(slot);
+            auto    values = reinterpret_cast<T*>(staging.host(slot));
+            int64_t n      = mm_parse_array(text, threads, values);
+            if(n < 0)
+                return "bad data line";
+            if(count + n > header.entries)
+                return "more entries than given in the size line";
+            Memory(stream()).upload(x.view().data() + count, values, n * sizeof(T));
+            staging.record(slot, stream());
+            count += n;
+        }
+        checkCudaErrors(cudaStreamSynchronize(stream()));
+        return count == header.entries ? nullptr : "fewer entries than given in the size line";
+    };
+
+    auto error = read();
+    if(error)
+    {
+        MUDA_KERNEL_WARN_WITH_LOCATION("In calling label %s: read_matrix_market(%s) failed, %s",
+                                       std::string{label()}.c_str(),
+                                       std::string{path}.c_str(),
+                                       error);
+        x.resize(0);
+    }
+    label("");  // consumed here
+    return !error;
+}
+
+template <typename T, int N>
+bool LinearSystemContext::write_matrix_market(std::string_view                 path,
+                                              const DeviceTripletMatrix<T, N>& A,
+                                              const LinearSystemIOInfo&        info)
+{
+    using namespace details::linear_system;
+    auto [rows, cols, values]     = mm_triplet_pointers(remove_const(A));
+    auto [block_rows, block_cols] = mm_block_shape(A);
+    auto error                    = mm_write_matrix<T, N>(stream(),
+                                       path,
+                                       info,
+                                       block_rows,
+                                       block_cols,
+                                       A.triplet_count(),
+                                       rows,
+                                       cols,
+                                       reinterpret_cast<const T*>(values),
+                                       0);
+    if(error)
+        MUDA_KERNEL_WARN_WITH_LOCATION("In calling label %s: write_matrix_market(%s) failed, %s",
+                                       std::string{label()}.c_str(),
+                                       std::string{path}.c_str(),
+                                       error);
+    label("");  // consumed here
+    return !error;
+}
+
+template <typename T, int N>
+bool LinearSystemContext::write_matrix_market(std::string_view              path,
+                                              const DeviceBCOOMatrix<T, N>& A,
+                                              const LinearSystemIOInfo&     info)
+{
+    using namespace details::linear_system;
+    auto& triplet                 = static_cast<const DeviceTripletMatrix<T, N>&>(A);
+    auto [rows, cols, values]     = mm_triplet_pointers(remove_const(triplet));
+    auto [block_rows, block_cols] = mm_block_shape(triplet);
+    auto error                    = mm_write_matrix<T, N>(stream(),
+                                       path,
+                                       info,
+                                       block_rows,
+                                       block_cols,
+                                       A.triplet_count(),
+                                       rows,
+                                       cols,
+                                       reinterpret_cast<const T*>(values),
+                                       MatrixMarketBinarySortedUnique);
+    if(error)
+        MUDA_KERNEL_WARN_WITH_LOCATION("In calling label %s: write_matrix_market(%s) failed, %s",
+                                       std::string{label()}.c_str(),
+                                       std::string{path}.c_str(),
+                                       error);
+    label("");  // consumed here
+    return !error;
+}
+
+template <typename T>
+bool LinearSystemContext::write_matrix_market(std::string_view          path,
+                                              const DeviceCSRMatrix<T>& A,
+                                              const LinearSystemIOInfo& info)
+{
+    using namespace details::linear_system;
+
+    DeviceBuffer<int> row_indices(A.non_zeros());
+    mm_expand_csr_rows(stream(), A.rows(), A.row_offsets().data(), row_indices.data());
+
+    // the CSR entries are row-sorted and unique as a COO matrix
+    auto error = mm_write_matrix<T, 1>(stream(),
+                                       path,
+                                       info,
+                                       A.rows(),
+                                       A.cols(),
+                                       A.non_zeros(),
+                                       row_indices.data(),
+                                       A.col_indices().data(),
+                                       A.values().data(),
+                                       MatrixMarketBinarySortedUnique);
+    if(error)
+        MUDA_KERNEL_WARN_WITH_LOCATION("In calling label %s: write_matrix_market(%s) failed, %s",
+                                       std::string{label()}.c_str(),
+                                       std::string{path}.c_str(),
+                                       error);
+    label("");  // consumed here
+    return !error;
+}
+
+template <typename T>
+bool LinearSystemContext::write_matrix_market(std::string_view            path,
+                                              const DeviceDenseVector<T>& x,
+                                              const LinearSystemIOInfo&   info)
+{
+    using namespace details::linear_system;
+
+    auto write = [&]() -> const char*
+    {
+        bool binary = mm_is_binary_path(path);
+        std::unique_ptr<std::FILE, decltype(&std::fclose)> file{
+            std::fopen(std::string{path}.c_str(), binary ? "wb" : "w"), &std::fclose};
+        if(!file)
+            return "can't open the file";
+
+        // the vector may have been filled on another stream
+        checkCudaErrors(cudaStreamSynchronize(stream()));
+
+        const T* values = x.view().data();
+        int64_t  count  = x.size();
+        bool     ok     = true;
+        if(binary)
+        {
+            MatrixMarketBinaryHeader header;
+            header.kind       = MatrixMarketBinaryKind::Array;
+            header.value_size = sizeof(T);
+            header.block_rows = count;
+            header.block_cols = 1;
+            header.count      = count;
+            ok = std::fwrite(&header, sizeof(header), 1, file.get()) == 1;
+
+            MatrixMarketStaging staging(info.chunk_byte_size);
+            mm_download_write(stream(), staging, file.get(), values, count, ok);
+        }
+        else
+        {
+            MatrixMarketHeader header;
+            header.format  = MatrixMarketFormat::Array;
+            header.rows    = count;
+            header.cols    = 1;
+            header.entries = count;
+            mm_write_header(file.get(), header);
+
+            // about 26 bytes per line
+            int64_t per_step = std::max<int64_t>(info.chunk_byte_size / 26, 1);
+            int64_t steps    = (count + per_step - 1) / per_step;
+            auto    size     = [&](int64_t step)
+            { return std::min<int64_t>(per_step, count - step * per_step); };
+
+            int                      threads = mm_threads(info.threads);
+            std::vector<std::string> text;
+            MatrixMarketStaging      staging(per_step * sizeof(T));
+
+            ok = mm_download_steps(
+                stream(),
+                staging,
+                steps,
+                [&](int64_t step, int slot)
+                {
+                    Memory(stream()).download(staging.host(slot),
+                                              values + step * per_step,
+                                              size(step) * sizeof(T));
+                },
+                [&](int64_t step, int slot)
+                {
+                    mm_format_array(threads,
+                                    size(step),
+                                    reinterpret_cast<const T*>(staging.host(slot)),
+                                    text);
+                    for(auto& part : text)
+                        if(std::fwrite(part.data(), 1, part.size(), file.get()) != part.size())
+                            return false;
+                    return true;
+                });
+        }
+        return ok && std::fflush(file.get()) == 0 ? nullptr : "write failed";
+    };
+
+    auto error = write();
+    if(error)
+        MUDA_KERNEL_WARN_WITH_LOCATION("In calling label %s: write_matrix_market(%s) failed, %s",
+                                       std::string{label()}.c_str(),
+                                       std::string{path}.c_str(),
+                                       error);
+    label("");  // consumed here
+    return !error;
+}
+}  // namespace muda
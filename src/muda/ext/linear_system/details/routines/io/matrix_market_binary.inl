@@ -0,0 +1,229 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <muda/tools/platform.h>
+#if defined(MUDA_PLATFORM_WINDOWS)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+namespace muda::details::linear_system
+{
+enum class MatrixMarketBinaryKind : uint32_t
+{
+    Coordinate = 0,  // block triplets
+    Array      = 1,  // dense vector
+};
+
+enum MatrixMarketBinaryFlags : uint32_t
+{
+    // blocks are sorted by (row, col) and unique, as in a BCOO matrix
+    MatrixMarketBinarySortedUnique = 1,
+};
+
+/**
+ * \brief Header of a `.mtxb` file, followed by
+ * - Coordinate: int32 block_row[count], int32 block_col[count], value[count][N * N]
+ *   (blocks column-major)
+ * - Array: value[count]
+ *
+ * in the byte order of the machine that wrote it.
+ */
+class MatrixMarketBinaryHeader
+{
+  public:
+    char                   magic[8]   = {'M', 'U', 'D', 'A', 'M', 'T', 'X', 'B'};
+    uint32_t               version    = 1;
+    MatrixMarketBinaryKind kind       = MatrixMarketBinaryKind::Coordinate;
+    uint32_t               value_size = 0;  // sizeof(float) or sizeof(double)
+    int32_t                block_dim  = 1;
+    uint32_t               flags      = 0;
+    uint32_t               padding    = 0;
+    int64_t                block_rows = 0;
+    int64_t                block_cols = 0;
+    int64_t                count      = 0;  // blocks or vector entries
+    uint8_t                reserved[8] = {};
+
+    // byte_size() and value_offset() only don't overflow on a valid header
+    bool valid(size_t file_size) const
+    {
+        constexpr int64_t int_max = std::numeric_limits<int>::max();
+        if(std::memcmp(magic, MatrixMarketBinaryHeader{}.magic, sizeof(magic)) != 0
+           || version != 1 || (value_size != sizeof(float) && value_size != sizeof(double))
+           || (kind != MatrixMarketBinaryKind::Coordinate && kind != MatrixMarketBinaryKind::Array))
+            return false;
+        // the matrices and vectors are indexed with int
+        if(block_dim < 1 || block_rows < 0 || block_rows > int_max || block_cols < 0
+           || block_cols > int_max || count < 0 || count > int_max)
+            return false;
+        if(file_size < sizeof(MatrixMarketBinaryHeader))
+            return false;
+        // an empty matrix/vector has no payload to size the entries against
+        if(count == 0)
+            return true;
+
+        // bytes per entry, compared by division: no product can overflow
+        size_t payload = file_size - sizeof(MatrixMarketBinaryHeader);
+        size_t scalars = 1;
+        if(kind == MatrixMarketBinaryKind::Coordinate)
+        {
+            if(size_t(block_dim) > payload / value_size / size_t(block_dim))
+                return false;
+            scalars = size_t(block_dim) * size_t(block_dim);
+        }
+        size_t entry_size = scalars * value_size;
+        if(kind == MatrixMarketBinaryKind::Coordinate)
+            entry_size += 2 * sizeof(int32_t);
+        return size_t(count) <= payload / entry_size;
+    }
+
+    size_t value_offset() const
+    {
+        size_t offset = sizeof(MatrixMarketBinaryHeader);
+        if(kind == MatrixMarketBinaryKind::Coordinate)
+            offset += 2 * sizeof(int32_t) * size_t(count);
+        return offset;
+    }
+
+    size_t values_per_entry() const
+    {
+        return kind == MatrixMarketBinaryKind::Coordinate ? size_t(block_dim) * block_dim : 1;
+    }
+
+    size_t byte_size() const
+    {
+        return value_offset() + size_t(count) * values_per_entry() * value_size;
+    }
+};
+static_assert(sizeof(MatrixMarketBinaryHeader) == 64);
+
+// the first index out of [0, size) of `count` int32 indices at `indices`, or -1
+inline int64_t mm_find_out_of_range(const std::byte* indices, int count, int64_t size)
+{
+    for(int k = 0; k < count; ++k)
+    {
+        int32_t index;
+        std::memcpy(&index, indices + size_t(k) * sizeof(int32_t), sizeof(index));
+        if(index < 0 || index >= size)
+            return k;
+    }
+    return -1;
+}
+
+inline bool mm_is_binary_path(std::string_view path)
+{
+    constexpr std::string_view ext = ".mtxb";
+    return path.size() >= ext.size() && path.substr(path.size() - ext.size()) == ext;
+}
+
+/**
+ * \brief Read-only memory mapping of a whole file, pages are read on first touch.
+ */
+class MappedFile
+{
+    const std::byte* m_data = nullptr;
+    size_t           m_size = 0;
+#if defined(MUDA_PLATFORM_WINDOWS)
+    HANDLE m_file    = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile()
+    {
+#if defined(MUDA_PLATFORM_WINDOWS)
+        if(m_data)
+            UnmapViewOfFile(m_data);
+        if(m_mapping)
+            CloseHandle(m_mapping);
+        if(m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+#else
+        if(m_data)
+            munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+    }
+
+    bool open(std::string_view path)
+    {
+        std::string p{path};
+#if defined(MUDA_PLATFORM_WINDOWS)
+        m_file = CreateFileA(p.c_str(),
+                             GENERIC_READ,
+                             FILE_SHARE_READ,
+                             nullptr,
+                             OPEN_EXISTING,
+                             FILE_FLAG_SEQUENTIAL_SCAN,
+                             nullptr);
+        if(m_file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+            return false;
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(!m_mapping)
+            return false;
+        m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if(!m_data)
+            return false;
+        m_size = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(p.c_str(), O_RDONLY);
+        if(fd < 0)
+            return false;
+        struct stat st;
+        if(fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // the mapping keeps the file
+        if(data == MAP_FAILED)
+            return false;
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const std::byte*>(data);
+        m_size = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    const std::byte* data() const { return m_data; }
+    size_t           size() const { return m_size; }
+};
+
+// dst[i] = T(src[i]) for src of `src_size` bytes per value (float or double)
+template <typename T>
+void mm_convert_values(const std::byte* src, uint32_t src_size, size_t count, T* dst)
+{
+    if(src_size == sizeof(T))
+    {
+        std::memcpy(dst, src, count * sizeof(T));
+    }
+    else if(src_size == sizeof(float))
+    {
+        auto s = reinterpret_cast<const float*>(src);
+        for(size_t i = 0; i < count; ++i)
+            dst[i] = static_cast<T>(s[i]);
+    }
+    else
+    {
+        auto s = reinterpret_cast<const double*>(src);
+        for(size_t i = 0; i < count; ++i)
+            dst[i] = static_cast<T>(s[i]);
+    }
+}
+}  // namespace muda::details::linear_system
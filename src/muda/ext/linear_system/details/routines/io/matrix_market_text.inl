@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+namespace muda::details::linear_system
+{
+enum class MatrixMarketFormat
+{
+    Coordinate,
+    Array,
+};
+
+enum class MatrixMarketField
+{
+    Real,
+    Integer,
+    Pattern,
+};
+
+enum class MatrixMarketSymmetry
+{
+    General,
+    Symmetric,
+    SkewSymmetric,
+};
+
+class MatrixMarketHeader
+{
+  public:
+    MatrixMarketFormat   format   = MatrixMarketFormat::Coordinate;
+    MatrixMarketField    field    = MatrixMarketField::Real;
+    MatrixMarketSymmetry symmetry = MatrixMarketSymmetry::General;
+
+    int64_t rows    = 0;
+    int64_t cols    = 0;
+    int64_t entries = 0;  // data lines in the file
+
+    bool mirrored() const { return symmetry != MatrixMarketSymmetry::General; }
+
+    // the shortest data line ("1\n", "1 1\n", "1 1 1\n"), bounds the entries of a chunk
+    int min_line_bytes() const
+    {
+        if(format == MatrixMarketFormat::Array)
+            return 2;
+        return field == MatrixMarketField::Pattern ? 4 : 6;
+    }
+};
+
+inline int mm_threads(int threads)
+{
+    if(threads > 0)
+        return threads;
+    auto hw = static_cast<int>(std::thread::hardware_concurrency());
+    return hw > 0 ? hw : 1;
+}
+
+// f(part) for part in [0, parts), part 0 on the calling thread
+template <typename F>
+void mm_parallel(int parts, F&& f)
+{
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    for(int part = 1; part < parts; ++part)
+        workers.emplace_back([&f, part] { f(part); });
+    f(0);
+    for(auto& worker : workers)
+        worker.join();
+}
+
+inline bool mm_is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline std::string_view mm_next_token(std::string_view& s)
+{
+    size_t begin = 0;
+    while(begin < s.size() && (mm_is_blank(s[begin]) || s[begin] == '\n'))
+        ++begin;
+    size_t end = begin;
+    while(end < s.size() && !mm_is_blank(s[end]) && s[end] != '\n')
+        ++end;
+    auto token = s.substr(begin, end - begin);
+    s.remove_prefix(end);
+    return token;
+}
+
+inline bool mm_token_is(std::string_view token, std::string_view expected)
+{
+    return token.size() == expected.size()
+           && std::equal(token.begin(),
+                         token.end(),
+                         expected.begin(),
+                         [](char a, char b)
+                         { return std::tolower((unsigned char)a) == b; });
+}
+
+template <typename T>
+inline bool mm_parse_number(const char*& p, const char* end, T& value)
+{
+    while(p < end && mm_is_blank(*p))
+        ++p;
+    if(p < end && *p == '+')  // from_chars takes no explicit plus sign
+        ++p;
+    auto [ptr, ec] = std::from_chars(p, end, value);
+    if(ec != std::errc{})
+        return false;
+    p = ptr;
+    return true;
+}
+
+// splits `text` into at most `parts` pieces of whole lines, at least `min_bytes` each
+inline std::vector<std::string_view> mm_split_lines(std::string_view text, int parts, size_t min_bytes)
+{
+    parts = std::max(1, std::min<int>(parts, static_cast<int>(text.size() / min_bytes)));
+
+    std::vector<std::string_view> pieces;
+    pieces.reserve(parts);
+    size_t begin = 0;
+    for(int part = 0; part < parts; ++part)
+    {
+        size_t end = text.size();
+        if(part + 1 < parts)
+        {
+            end = std::max(begin, text.size() * (part + 1) / parts);
+            end = text.find('\n', end);
+            end = end == std::string_view::npos ? text.size() : end + 1;
+        }
+        pieces.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return pieces;
+}
+
+// calls f(line_begin, line_end) for each data line (not blank, not a comment)
+template <typename F>
+inline bool mm_for_each_line(std::string_view text, F&& f)
+{
+    const char* p   = text.data();
+    const char* end = p + text.size();
+    while(p < end)
+    {
+        auto line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if(!line_end)
+            line_end = end;
+
+        auto q = p;
+        while(q < line_end && mm_is_blank(*q))
+            ++q;
+        if(q < line_end && *q != '%')
+        {
+            if(!f(q, line_end))
+                return false;
+        }
+        p = line_end + 1;
+    }
+    return true;
+}
+
+inline int64_t mm_count_lines(std::string_view text)
+{
+    int64_t count = 0;
+    mm_for_each_line(text,
+                     [&](const char*, const char*)
+                     {
+                         ++count;
+                         return true;
+                     });
+    return count;
+}
+
+/**
+ * \brief Buffered reader handing out whole lines, `chunk_byte_size` bytes at a time,
+ * so a file of any size never has more than one chunk in host memory.
+ */
+class MatrixMarketTextReader
+{
+    std::FILE*        m_file = nullptr;
+    std::vector<char> m_chunk;
+    size_t            m_begin = 0;  // first byte not handed out yet
+    size_t            m_end   = 0;  // valid bytes in m_chunk
+    bool              m_eof   = false;
+
+    void refill()
+    {
+        if(m_eof)
+            return;
+        std::memmove(m_chunk.data(), m_chunk.data() + m_begin, m_end - m_begin);
+        m_end -= m_begin;
+        m_begin = 0;
+        m_end += std::fread(m_chunk.data() + m_end, 1, m_chunk.size() - m_end, m_file);
+        m_eof = m_end < m_chunk.size();
+    }
+
+  public:
+    MatrixMarketTextReader() = default;
+    MatrixMarketTextReader(const MatrixMarketTextReader&) = delete;
+    MatrixMarketTextReader& operator=(const MatrixMarketTextReader&) = delete;
+    ~MatrixMarketTextReader()
+    {
+        if(m_file)
+            std::fclose(m_file);
+    }
+
+    bool open(std::string_view path, size_t chunk_byte_size)
+    {
+        m_file = std::fopen(std::string{path}.c_str(), "rb");
+        if(!m_file)
+            return false;
+        // a line never spans more than one chunk
+        m_chunk.resize(std::max<size_t>(chunk_byte_size, 4096));
+        return true;
+    }
+
+    size_t chunk_byte_size() const { return m_chunk.size(); }
+
+    // the next line (without '\n'), false at the end of the file
+    bool next_line(std::string_view& line)
+    {
+        while(true)
+        {
+            auto begin = m_chunk.data() + m_begin;
+            auto nl = static_cast<const char*>(std::memchr(begin, '\n', m_end - m_begin));
+            if(nl)
+            {
+                line = std::string_view{begin, size_t(nl - begin)};
+                m_begin += line.size() + 1;
+                return true;
+            }
+            if(m_eof || (m_begin == 0 && m_end == m_chunk.size()))
+            {
+                // last line without '\n', or a line longer than a chunk
+                line    = std::string_view{begin, m_end - m_begin};
+                m_begin = m_end;
+                return !line.empty();
+            }
+            refill();
+        }
+    }
+
+    // whole lines of at most one chunk, empty at the end of the file
+    std::string_view next_lines()
+    {
+        refill();
+        auto begin = m_chunk.data() + m_begin;
+        auto size  = m_end - m_begin;
+        if(!m_eof)
+        {
+            // cut after the last '\n' (a line longer than the chunk is handed
+            // out as it is and fails to parse)
+            auto last = std::string_view{begin, size}.rfind('\n');
+            if(last != std::string_view::npos)
+                size = last + 1;
+        }
+        m_begin += size;
+        return std::string_view{begin, size};
+    }
+};
+
+inline bool mm_parse_header(MatrixMarketTextReader& reader, MatrixMarketHeader& header)
+{
+    std::string_view line;
+    if(!reader.next_line(line))
+        return false;
+
+    // %%MatrixMarket matrix <format> <field> <symmetry>
+    if(!mm_token_is(mm_next_token(line), "%%matrixmarket")
+       || !mm_token_is(mm_next_token(line), "matrix"))
+        return false;
+
+    auto format = mm_next_token(line);
+    if(mm_token_is(format, "coordinate"))
+        header.format = MatrixMarketFormat::Coordinate;
+    else if(mm_token_is(format, "array"))
+        header.format = MatrixMarketFormat::Array;
+    else
+        return false;
+
+    auto field = mm_next_token(line);
+    if(mm_token_is(field, "real") || mm_token_is(field, "double"))
+        header.field = MatrixMarketField::Real;
+    else if(mm_token_is(field, "integer"))
+        header.field = MatrixMarketField::Integer;
+    else if(mm_token_is(field, "pattern") && header.format == MatrixMarketFormat::Coordinate)
+        header.field = MatrixMarketField::Pattern;
+    else  // complex is not supported
+        return false;
+
+    auto symmetry = mm_next_token(line);
+    if(mm_token_is(symmetry, "general"))
+        header.symmetry = MatrixMarketSymmetry::General;
+    else if(mm_token_is(symmetry, "symmetric"))
+        header.symmetry = MatrixMarketSymmetry::Symmetric;
+    else if(mm_token_is(symmetry, "skew-symmetric"))
+        header.symmetry = MatrixMarketSymmetry::SkewSymmetric;
+    else
+        return false;
+
+    // packed (triangular) arrays are not supported
+    if(header.format == MatrixMarketFormat::Array && header.mirrored())
+        return false;
+
+    // comments, then the size line
+    while(reader.next_line(line))
+    {
+        const char* p   = line.data();
+        const char* end = p + line.size();
+        while(p < end && mm_is_blank(*p))
+            ++p;
+        if(p == end || *p == '%')
+            continue;
+
+        if(!mm_parse_number(p, end, header.rows) || !mm_parse_number(p, end, header.cols))
+            return false;
+        // the matrices and vectors are indexed with int, no overflow of rows * cols
+        constexpr int64_t int_max = std::numeric_limits<int>::max();
+        if(header.rows < 0 || header.rows > int_max || header.cols < 0 || header.cols > int_max)
+            return false;
+        if(header.format == MatrixMarketFormat::Coordinate)
+            return mm_parse_number(p, end, header.entries) && header.entries >= 0;
+        header.entries = header.rows * header.cols;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * \brief Parses the coordinate lines of `text` with `threads` threads into 0-based
+ * `rows`/`cols`/`values`: the entries in file order, then (symmetric files) the
+ * mirrored off-diagonal entries. `lines` receives the data lines of `text`.
+ *
+ * The outputs need room for `text.size() / header.min_line_bytes()` entries,
+ * twice that for symmetric files.
+ *
+ * \return the entries written, or -1 on a bad line
+ */
+template <typename T>
+int64_t mm_parse_coordinate(std::string_view          text,
+                            const MatrixMarketHeader& header,
+                            int                       threads,
+                            int*                      rows,
+                            int*                      cols,
+                            T*                        values,
+                            int64_t&                  lines)
+{
+    auto pieces = mm_split_lines(text, threads, 64 * 1024);
+    int  parts  = static_cast<int>(pieces.size());
+
+    std::vector<int64_t> offsets(parts + 1, 0);
+    std::vector<int64_t> mirrors(parts + 1, 0);
+    std::vector<char>    ok(parts, 1);
+
+    mm_parallel(parts, [&](int part) { offsets[part + 1] = mm_count_lines(pieces[part]); });
+    for(int part = 0; part < parts; ++part)
+        offsets[part + 1] += offsets[part];
+    lines = offsets[parts];
+
+    bool pattern = header.field == MatrixMarketField::Pattern;
+    mm_parallel(parts,
+                [&](int part)
+                {
+                    int64_t k = offsets[part];
+                    ok[part]  = mm_for_each_line(
+                        pieces[part],
+                        [&](const char* p, const char* end)
+                        {
+                            int64_t i, j;
+                            T       v = T{1};
+                            if(!mm_parse_number(p, end, i) || !mm_parse_number(p, end, j)
+                               || (!pattern && !mm_parse_number(p, end, v)))
+                                return false;
+                            if(i < 1 || i > header.rows || j < 1 || j > header.cols)
+                                return false;
+                            rows[k]   = static_cast<int>(i - 1);
+                            cols[k]   = static_cast<int>(j - 1);
+                            values[k] = v;
+                            mirrors[part + 1] += i != j;
+                            ++k;
+                            return true;
+                        });
+                });
+    if(std::find(ok.begin(), ok.end(), 0) != ok.end())
+        return -1;
+
+    if(!header.mirrored())
+        return lines;
+
+    for(int part = 0; part < parts; ++part)
+        mirrors[part + 1] += mirrors[part];
+
+    T sign = header.symmetry == MatrixMarketSymmetry::SkewSymmetric ? T{-1} : T{1};
+    mm_parallel(parts,
+                [&](int part)
+                {
+                    int64_t m = lines + mirrors[part];
+                    for(int64_t k = offsets[part]; k < offsets[part + 1]; ++k)
+                    {
+                        if(rows[k] == cols[k])
+                            continue;
+                        rows[m]   = cols[k];
+                        cols[m]   = rows[k];
+                        values[m] = sign * values[k];
+                        ++m;
+                    }
+                });
+    return lines + mirrors[parts];
+}
+
+// parses the array lines of `text` (one value per line), returns the count or -1
+template <typename T>
+int64_t mm_parse_array(std::string_view text, int threads, T* values)
+{
+    auto pieces = mm_split_lines(text, threads, 64 * 1024);
+    int  parts  = static_cast<int>(pieces.size());
+
+    std::vector<int64_t> offsets(parts + 1, 0);
+    std::vector<char>    ok(parts, 1);
+
+    mm_parallel(parts, [&](int part) { offsets[part + 1] = mm_count_lines(pieces[part]); });
+    for(int part = 0; part < parts; ++part)
+        offsets[part + 1] += offsets[part];
+
+    mm_parallel(parts,
+                [&](int part)
+                {
+                    int64_t k = offsets[part];
+                    ok[part]  = mm_for_each_line(pieces[part],
+                                                [&](const char* p, const char* end)
+                                                { return mm_parse_number(p, end, values[k++]); });
+                });
+    if(std::find(ok.begin(), ok.end(), 0) != ok.end())
+        return -1;
+    return offsets[parts];
+}
+
+template <typename T>
+inline void mm_append_number(std::string& out, T value)
+{
+    char buffer[32];
+    // shortest representation that reads back to the same value
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, end);
+}
+
+inline void mm_write_header(std::FILE*                file,
+                            const MatrixMarketHeader& header)
+{
+    bool coordinate = header.format == MatrixMarketFormat::Coordinate;
+    std::fprintf(file,
+                 "%%%%MatrixMarket matrix %s real general\n"
+                 "%% written by muda\n",
+                 coordinate ? "coordinate" : "array");
+    if(coordinate)
+        std::fprintf(file,
+                     "%lld %lld %lld\n",
+                     (long long)header.rows,
+                     (long long)header.cols,
+                     (long long)header.entries);
+    else
+        std::fprintf(file, "%lld %lld\n", (long long)header.rows, (long long)header.cols);
+}
+
+/**
+ * \brief Formats `count` N x N blocks (column-major values, block indices) as
+ * 1-based "i j v" lines, all N * N entries of a block, with `threads` threads:
+ * `out[part]` holds the lines of one contiguous range of blocks.
+ */
+template <typename T>
+void mm_format_coordinate(int                       threads,
+                          int                       N,
+                          int64_t                   count,
+                          const int*                rows,
+                          const int*                cols,
+                          const T*                  values,
+                          std::vector<std::string>& out)
+{
+    int parts = static_cast<int>(std::clamp<int64_t>(count / 4096, 1, threads));
+    out.resize(parts);
+    mm_parallel(parts,
+                [&](int part)
+                {
+                    int64_t begin = count * part / parts;
+                    int64_t end   = count * (part + 1) / parts;
+                    auto&   s     = out[part];
+                    s.clear();
+                    s.reserve((end - begin) * N * N * 32);
+                    for(int64_t k = begin; k < end; ++k)
+                    {
+                        const T* block = values + k * N * N;
+                        for(int r = 0; r < N; ++r)
+                            for(int c = 0; c < N; ++c)
+                            {
+                                mm_append_number(s, int64_t(rows[k]) * N + r + 1);
+                                s.push_back(' ');
+                                mm_append_number(s, int64_t(cols[k]) * N + c + 1);
+                                s.push_back(' ');
+                                mm_append_number(s, block[c * N + r]);
+                                s.push_back('\n');
+                            }
+                    }
+                });
+}
+
+// one value per line
+template <typename T>
+void mm_format_array(int threads, int64_t count, const T* values, std::vector<std::string>& out)
+{
+    int parts = static_cast<int>(std::clamp<int64_t>(count / 16384, 1, threads));
+    out.resize(parts);
+    mm_parallel(parts,
+                [&](int part)
+                {
+                    int64_t begin = count * part / parts;
+                    int64_t end   = count * (part + 1) / parts;
+                    auto&   s     = out[part];
+                    s.clear();
+                    s.reserve((end - begin) * 26);
+                    for(int64_t k = begin; k < end; ++k)
+                    {
+                        mm_append_number(s, values[k]);
+                        s.push_back('\n');
+                    }
+                });
+}
+}  // namespace muda::details::linear_system
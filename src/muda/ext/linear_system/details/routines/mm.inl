@@ -0,0 +1,620 @@
+#include <muda/ext/eigen.h>
+namespace muda
+{
+namespace details::linear_system
+{
+    // outputs (N * columns of one block row) a lane of the custom BSR kernel
+    // accumulates, wider X/Y are done in several passes over A
+    constexpr int BSRSpMMLaneOutputs = 4;
+
+    template <typename T>
+    MUDA_INLINE void spmm_common_check(CDenseMatrixView<T> X,
+                                       DenseMatrixView<T>  Y,
+                                       size_t              rows,
+                                       size_t              cols)
+    {
+        MUDA_ASSERT(X.data() && Y.data(), "X.data() and Y.data() should not be nullptr");
+        MUDA_ASSERT(!X.is_trans() && !Y.is_trans(),
+                    "SpMM needs column major X and Y, transposed views are not supported");
+        MUDA_ASSERT(X.col() == Y.col(),
+                    "X and Y must have the same number of columns, X.col()=%lld, Y.col()=%lld",
+                    X.col(),
+                    Y.col());
+        MUDA_ASSERT(X.row() == cols && Y.row() == rows,
+                    "Dimension mismatch in SPMM! A=(%lld,%lld), X.row()=%lld, Y.row()=%lld",
+                    rows,
+                    cols,
+                    X.row(),
+                    Y.row());
+    }
+
+    template <typename T>
+    MUDA_INLINE void block_common_check(CDenseMatrixView<T> X, CDenseMatrixView<T> Y)
+    {
+        MUDA_ASSERT(X.data() && Y.data(), "X.data() and Y.data() should not be nullptr");
+        MUDA_ASSERT(!X.is_trans() && !Y.is_trans(),
+                    "Block vector routines need column major X and Y, transposed views are not supported");
+        MUDA_ASSERT(X.row() == Y.row() && X.col() == Y.col(),
+                    "X (%lld,%lld) should be the same shape as Y (%lld,%lld)",
+                    X.row(),
+                    X.col(),
+                    Y.row(),
+                    Y.col());
+    }
+
+    // Y = b * Y, Y = 0 if b == 0 (no NaN from an uninitialized Y)
+    template <typename T>
+    void spmm_scale(cudaStream_t stream, const T& b, DenseMatrixView<T> Y)
+    {
+        int rows = Y.row();
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(rows * Y.col(),
+                   [b, rows, y = Y.data(), ldy = Y.lda()] __device__(int index) mutable
+                   {
+                       T& dst = y[size_t(index / rows) * ldy + index % rows];
+                       dst    = b == T{0} ? T{0} : b * dst;
+                   });
+    }
+
+    template <typename T>
+    void bsrmm(cusparseHandle_t          handle,
+               int                       block_rows,
+               int                       columns,
+               int                       block_cols,
+               int                       non_zeros,
+               const T*                  a,
+               const cusparseMatDescr_t& descrA,
+               const T*                  val_A,
+               const int*                block_row_offsets,
+               const int*                block_col_indices,
+               int                       N,
+               const T*                  X,
+               int                       ldx,
+               const T*                  b,
+               T*                        Y,
+               int                       ldy)
+    {
+        if constexpr(std::is_same_v<T, float>)
+        {
+            checkCudaErrors(cusparseSbsrmm(handle,
+                                           CUSPARSE_DIRECTION_COLUMN,
+                                           CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                           CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                           block_rows,
+                                           columns,
+                                           block_cols,
+                                           non_zeros,
+                                           a,
+                                           descrA,
+                                           val_A,
+                                           block_row_offsets,
+                                           block_col_indices,
+                                           N,
+                                           X,
+                                           ldx,
+                                           b,
+                                           Y,
+                                           ldy));
+        }
+        else if constexpr(std::is_same_v<T, double>)
+        {
+            checkCudaErrors(cusparseDbsrmm(handle,
+                                           CUSPARSE_DIRECTION_COLUMN,
+                                           CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                           CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                           block_rows,
+                                           columns,
+                                           block_cols,
+                                           non_zeros,
+                                           a,
+                                           descrA,
+                                           val_A,
+                                           block_row_offsets,
+                                           block_col_indices,
+                                           N,
+                                           X,
+                                           ldx,
+                                           b,
+                                           Y,
+                                           ldy));
+        }
+        else
+        {
+            static_assert(always_false_v<T>, "T must be float or double");
+        }
+    }
+
+    // Y = a * A * X + b * Y, one warp per block row like bsr_spmv_custom: the
+    // blocks are loaded cooperatively into shared memory once, then each lane
+    // owns BSRSpMMLaneOutputs (component, column) pairs of the row and runs
+    // over the staged blocks, so no reduction is needed
+    template <typename T, int N>
+    void bsr_spmm_custom(cudaStream_t         stream,
+                         const T&             a,
+                         CBSRMatrixView<T, N> A,
+                         CDenseMatrixView<T>  X,
+                         const T&             b,
+                         DenseMatrixView<T>   Y)
+    {
+        constexpr int Warps        = detail::linear_system::bsr_spmv_warps<T, N>();
+        constexpr int BlockScalars = N * N;
+        constexpr int ChunkBlocks  = 32;
+        constexpr int LaneOutputs  = BSRSpMMLaneOutputs;
+        constexpr int TileColumns  = std::max(1, 32 * LaneOutputs / N);
+
+        int block_rows = A.block_rows();
+        int columns    = X.col();
+        int grid_dim   = (block_rows + Warps - 1) / Warps;
+        int ldx        = X.lda();
+        int ldy        = Y.lda();
+
+        for(int first = 0; first < columns; first += TileColumns)
+        {
+            int outputs = std::min(TileColumns, columns - first) * N;
+
+            Launch(grid_dim, Warps * 32, 0, stream)
+                .kernel_name(__FUNCTION__)
+                .apply(
+                    [a,
+                     b,
+                     block_rows,
+                     outputs,
+                     ldx,
+                     ldy,
+                     offsets = A.block_row_offsets(),
+                     cols    = A.block_col_indices(),
+                     values  = reinterpret_cast<const T*>(A.block_values()),
+                     x       = X.data() + size_t(first) * ldx,
+                     y = Y.data() + size_t(first) * ldy] __device__() mutable
+                    {
+                        __shared__ T   s_blocks[Warps][ChunkBlocks * BlockScalars];
+                        __shared__ int s_cols[Warps][ChunkBlocks];
+
+                        int warp = threadIdx.x / 32;
+                        int lane = threadIdx.x & 31;
+                        int row  = blockIdx.x * Warps + warp;
+                        if(row >= block_rows)  // uniform in the warp
+                            return;
+
+                        int begin = offsets[row];
+                        int end   = offsets[row + 1];
+
+                        T acc[LaneOutputs];
+#pragma unroll
+                        for(int m = 0; m < LaneOutputs; ++m)
+                            acc[m] = T{0};
+
+                        for(int chunk = begin; chunk < end; chunk += ChunkBlocks)
+                        {
+                            int count = min(ChunkBlocks, end - chunk);
+
+                            const T* src = values + size_t(chunk) * BlockScalars;
+                            for(int t = lane; t < count * BlockScalars; t += 32)
+                                s_blocks[warp][t] = src[t];
+                            if(lane < count)
+                                s_cols[warp][lane] = cols[chunk + lane];
+                            __syncwarp();
+
+#pragma unroll
+                            for(int m = 0; m < LaneOutputs; ++m)
+                            {
+                                int t = lane + 32 * m;
+                                if(t >= outputs)
+                                    break;
+
+                                // component r of column k, blocks are column major
+                                int      r   = t % N;
+                                const T* x_k = x + size_t(t / N) * ldx;
+                                T        sum = T{0};
+                                for(int c = 0; c < count; ++c)
+                                {
+                                    const T* block = &s_blocks[warp][c * BlockScalars];
+                                    const T* seg_x = x_k + s_cols[warp][c] * N;
+#pragma unroll
+                                    for(int s = 0; s < N; ++s)
+                                        sum += block[s * N + r] * seg_x[s];
+                                }
+                                acc[m] += sum;
+                            }
+                            __syncwarp();
+                        }
+
+#pragma unroll
+                        for(int m = 0; m < LaneOutputs; ++m)
+                        {
+                            int t = lane + 32 * m;
+                            if(t >= outputs)
+                                break;
+                            T& dst = y[size_t(t / N) * ldy + row * N + t % N];
+                            dst = b == T{0} ? a * acc[m] : a * acc[m] + b * dst;
+                        }
+                    });
+        }
+    }
+
+    // results(k) = X.col(k) . Y.col(k), per-CTA sums of every column go to
+    // `partials` (grid * columns), then one CTA per column adds them up
+    template <typename T>
+    void block_dot(cudaStream_t        stream,
+                   CDenseMatrixView<T> X,
+                   CDenseMatrixView<T> Y,
+                   BufferView<T>       partials,
+                   DenseVectorView<T>  results)
+    {
+        int rows    = X.row();
+        int columns = X.col();
+        int grid    = fused_reduce_grid(rows);
+
+        Launch(dim3(grid, columns), dim3(FusedReduceBlockSize), 0, stream)
+            .kernel_name("block_dot")
+            .apply(
+                [rows,
+                 grid,
+                 x        = X.data(),
+                 ldx      = X.lda(),
+                 y        = Y.data(),
+                 ldy      = Y.lda(),
+                 partials = partials.data()] __device__() mutable
+                {
+                    const T* x_k = x + size_t(blockIdx.y) * ldx;
+                    const T* y_k = y + size_t(blockIdx.y) * ldy;
+
+                    T acc[1] = {T{0}};
+                    for(int i = blockIdx.x * blockDim.x + threadIdx.x; i < rows;
+                        i += gridDim.x * blockDim.x)
+                        acc[0] += x_k[i] * y_k[i];
+
+                    fused_block_sum<T, 1>(acc);
+
+                    if(threadIdx.x == 0)
+                        partials[blockIdx.y * grid + blockIdx.x] = acc[0];
+                });
+
+        Launch(columns, FusedReduceBlockSize, 0, stream)
+            .kernel_name("block_dot_partials")
+            .apply(
+                [grid, partials = partials.data(), results = results.data()] __device__() mutable
+                {
+                    T acc[1] = {T{0}};
+                    for(int b = threadIdx.x; b < grid; b += blockDim.x)
+                        acc[0] += partials[blockIdx.x * grid + b];
+
+                    fused_block_sum<T, 1>(acc);
+
+                    if(threadIdx.x == 0)
+                        results[blockIdx.x] = acc[0];
+                });
+    }
+}  // namespace details::linear_system
+
+template <typename T>
+void LinearSystemContext::generic_spmm(const T&             a,
+                                       cusparseOperation_t  op,
+                                       cusparseSpMatDescr_t A,
+                                       CDenseMatrixView<T>  X,
+                                       const T&             b,
+                                       DenseMatrixView<T>   Y)
+{
+    set_pointer_mode_host();
+
+    cusparseDnMatDescr_t x_descr;
+    cusparseDnMatDescr_t y_descr;
+    checkCudaErrors(cusparseCreateDnMat(&x_descr,
+                                        X.row(),
+                                        X.col(),
+                                        X.lda(),
+                                        const_cast<T*>(X.data()),
+                                        cuda_data_type<T>(),
+                                        CUSPARSE_ORDER_COL));
+    checkCudaErrors(cusparseCreateDnMat(
+        &y_descr, Y.row(), Y.col(), Y.lda(), Y.data(), cuda_data_type<T>(), CUSPARSE_ORDER_COL));
+
+    size_t buffer_size = 0;
+    checkCudaErrors(cusparseSpMM_bufferSize(cusparse(),
+                                            op,
+                                            CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                            &a,
+                                            A,
+                                            x_descr,
+                                            &b,
+                                            y_descr,
+                                            cuda_data_type<T>(),
+                                            LinearSystemAlgorithm::SPMM_ALG_DEFAULT,
+                                            &buffer_size));
+
+    auto buffer = temp_buffer(buffer_size);
+
+    checkCudaErrors(cusparseSpMM(cusparse(),
+                                 op,
+                                 CUSPARSE_OPERATION_NON_TRANSPOSE,
+                                 &a,
+                                 A,
+                                 x_descr,
+                                 &b,
+                                 y_descr,
+                                 cuda_data_type<T>(),
+                                 LinearSystemAlgorithm::SPMM_ALG_DEFAULT,
+                                 buffer.data()));
+
+    // descriptors only hold the shapes and pointers, the launch keeps its own copy
+    checkCudaErrors(cusparseDestroyDnMat(x_descr));
+    checkCudaErrors(cusparseDestroyDnMat(y_descr));
+}
+
+template <typename T, int N>
+void LinearSystemContext::spmm(const T&             a,
+                               CBSRMatrixView<T, N> A,
+                               CDenseMatrixView<T>  X,
+                               const T&             b,
+                               DenseMatrixView<T>   Y)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(!A.is_trans(), "SpMM with a transposed BSR matrix is not supported");
+    spmm_common_check<T>(X, Y, A.block_rows() * N, A.block_cols() * N);
+
+    if(X.col() == 0 || A.block_rows() == 0)
+        return;
+
+    if(m_spmv_policy.use_custom_bsr_spmm(N, A.is_trans()))
+    {
+        bsr_spmm_custom<T, N>(stream(), a, A, X, b, Y);
+        return;
+    }
+
+    set_pointer_mode_host();
+
+    bsrmm<T>(cusparse(),
+             A.block_rows(),
+             X.col(),
+             A.block_cols(),
+             A.non_zero_blocks(),
+             &a,
+             A.legacy_descr(),
+             (const T*)A.block_values(),
+             A.block_row_offsets(),
+             A.block_col_indices(),
+             N,
+             X.data(),
+             X.lda(),
+             &b,
+             Y.data(),
+             Y.lda());
+}
+
+template <typename T, int N>
+void LinearSystemContext::spmm(CBSRMatrixView<T, N> A, CDenseMatrixView<T> X, DenseMatrixView<T> Y)
+{
+    spmm(T{1}, A, X, T{0}, Y);
+}
+
+template <typename T>
+void LinearSystemContext::spmm(const T&            a,
+                               CCSRMatrixView<T>   A,
+                               CDenseMatrixView<T> X,
+                               const T&            b,
+                               DenseMatrixView<T>  Y)
+{
+    auto rows = A.is_trans() ? A.cols() : A.rows();
+    auto cols = A.is_trans() ? A.rows() : A.cols();
+    details::linear_system::spmm_common_check<T>(X, Y, rows, cols);
+
+    auto op = A.is_trans() ? CUSPARSE_OPERATION_TRANSPOSE : CUSPARSE_OPERATION_NON_TRANSPOSE;
+    generic_spmm(a, op, A.descr(), X, b, Y);
+}
+
+template <typename T>
+void LinearSystemContext::spmm(CCSRMatrixView<T> A, CDenseMatrixView<T> X, DenseMatrixView<T> Y)
+{
+    spmm(T{1}, A, X, T{0}, Y);
+}
+
+template <typename T, int N>
+void LinearSystemContext::spmm(const T&                 a,
+                               CTripletMatrixView<T, N> A,
+                               CDenseMatrixView<T>      X,
+                               const T&                 b,
+                               DenseMatrixView<T>       Y)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(A.extent() == A.total_extent() && A.triplet_count() == A.total_triplet_count(),
+                "submatrix or subview of a Triplet Matrix is not allowed in SPMM!");
+    spmm_common_check<T>(X, Y, A.total_block_rows() * N, A.total_block_cols() * N);
+
+    spmm_scale<T>(stream(), b, Y);
+
+    if(A.triplet_count() == 0)
+        return;
+
+    // the block stays in registers for all the columns
+    ParallelFor(0, stream())
+        .kernel_name(__FUNCTION__)
+        .apply(A.triplet_count(),
+               [a       = a,
+                A       = A.viewer().name("A"),
+                columns = int(X.col()),
+                x       = X.data(),
+                ldx     = X.lda(),
+                y       = Y.data(),
+                ldy     = Y.lda()] __device__(int index) mutable
+               {
+                   using Vector = Eigen::Vector<T, N>;
+
+                   auto&& [i, j, block] = A(index);
+                   Eigen::Matrix<T, N, N> scaled = a * block;
+
+                   for(int k = 0; k < columns; ++k)
+                   {
+                       Eigen::Map<const Vector> seg_x(x + size_t(k) * ldx + j * N);
+                       Vector v     = scaled * seg_x;
+                       T*     seg_y = y + size_t(k) * ldy + i * N;
+#pragma unroll
+                       for(int c = 0; c < N; ++c)
+                           muda::atomic_add(seg_y + c, v(c));
+                   }
+               });
+}
+
+template <typename T, int N>
+void LinearSystemContext::spmm(CTripletMatrixView<T, N> A, CDenseMatrixView<T> X, DenseMatrixView<T> Y)
+{
+    spmm<T, N>(T{1}, A, X, T{0}, Y);
+}
+
+template <typename T, int N>
+void LinearSystemContext::spmm(const T&                      a,
+                               const DeviceBCOOMatrix<T, N>& A,
+                               CDenseMatrixView<T>           X,
+                               const T&                      b,
+                               DenseMatrixView<T>            Y)
+{
+    using namespace details::linear_system;
+
+    spmm_common_check<T>(X, Y, A.block_rows() * N, A.block_cols() * N);
+
+    spmm_scale<T>(stream(), b, Y);
+
+    int count = A.non_zero_blocks();
+    if(count == 0)
+        return;
+
+    // as the segmented BCOO spmv, one block per lane kept in registers while
+    // the warp runs the segmented sum of each column
+    int grid_dim = (count + BCOOSpMVBlockSize - 1) / BCOOSpMVBlockSize;
+
+    Launch(grid_dim, BCOOSpMVBlockSize, 0, stream())
+        .kernel_name(__FUNCTION__)
+        .apply(
+            [a       = a,
+             A       = A.cview().viewer().name("A"),
+             columns = int(X.col()),
+             x       = X.data(),
+             ldx     = X.lda(),
+             y       = Y.data(),
+             ldy     = Y.lda(),
+             count   = count] __device__() mutable
+            {
+                using Vector = Eigen::Vector<T, N>;
+
+                int index = blockIdx.x * blockDim.x + threadIdx.x;
+                int lane  = threadIdx.x & 31;
+
+                int                    row   = -1;
+                int                    col   = 0;
+                Eigen::Matrix<T, N, N> block = Eigen::Matrix<T, N, N>::Zero();
+                if(index < count)
+                {
+                    auto&& [i, j, value] = A(index);
+
+                    row   = i;
+                    col   = j;
+                    block = a * value;
+                }
+
+                int next_row  = __shfl_down_sync(0xffffffff, row, 1);
+                int first_row = __shfl_sync(0xffffffff, row, 0);
+
+                bool is_tail = row >= 0 && (lane == 31 || next_row != row);
+                bool atomic  = row == first_row || lane == 31;
+
+                for(int k = 0; k < columns; ++k)
+                {
+                    Vector v = Vector::Zero();
+                    if(row >= 0)
+                        v = block * Eigen::Map<const Vector>(x + size_t(k) * ldx + col * N);
+
+                    warp_segmented_sum<T, N>(lane, row, v);
+
+                    if(!is_tail)
+                        continue;
+
+                    T* seg_y = y + size_t(k) * ldy + row * N;
+#pragma unroll
+                    for(int c = 0; c < N; ++c)
+                    {
+                        if(atomic)
+                            muda::atomic_add(seg_y + c, v(c));
+                        else  // the whole segment is in this warp
+                            seg_y[c] += v(c);
+                    }
+                }
+            });
+}
+
+template <typename T, int N>
+void LinearSystemContext::spmm(const DeviceBCOOMatrix<T, N>& A,
+                               CDenseMatrixView<T>           X,
+                               DenseMatrixView<T>            Y)
+{
+    spmm<T, N>(T{1}, A, X, T{0}, Y);
+}
+
+template <typename T>
+void LinearSystemContext::dot(CDenseMatrixView<T> X, CDenseMatrixView<T> Y, DenseVectorView<T> results)
+{
+    using namespace details::linear_system;
+    block_common_check<T>(X, Y);
+    fused_common_check<T>(results, X.col());
+
+    if(X.col() == 0)
+        return;
+
+    block_dot<T>(stream(), X, Y, temp_buffer<T>(fused_reduce_grid(X.row()) * X.col()), results);
+}
+
+template <typename T>
+void LinearSystemContext::axpby(const T& alpha, CDenseMatrixView<T> X, const T& beta, DenseMatrixView<T> Y)
+{
+    details::linear_system::block_common_check<T>(X, Y);
+
+    int rows = X.row();
+    ParallelFor(0, stream())
+        .kernel_name(__FUNCTION__)
+        .apply(rows * X.col(),
+               [a   = alpha,
+                b   = beta,
+                rows,
+                x   = X.data(),
+                ldx = X.lda(),
+                y   = Y.data(),
+                ldy = Y.lda()] __device__(int index) mutable
+               {
+                   int i  = index % rows;
+                   int k  = index / rows;
+                   T&  dst = y[size_t(k) * ldy + i];
+                   dst     = a * x[size_t(k) * ldx + i] + b * dst;
+               });
+}
+
+template <typename T>
+void LinearSystemContext::axpby(CDenseVectorView<T> alpha,
+                                CDenseMatrixView<T> X,
+                                CDenseVectorView<T> beta,
+                                DenseMatrixView<T>  Y)
+{
+    using namespace details::linear_system;
+    block_common_check<T>(X, Y);
+    fused_common_check<T>(alpha, X.col());
+    fused_common_check<T>(beta, X.col());
+
+    int rows = X.row();
+    ParallelFor(0, stream())
+        .kernel_name(__FUNCTION__)
+        .apply(rows * X.col(),
+               [a   = alpha.data(),
+                b   = beta.data(),
+                rows,
+                x   = X.data(),
+                ldx = X.lda(),
+                y   = Y.data(),
+                ldy = Y.lda()] __device__(int index) mutable
+               {
+                   int i  = index % rows;
+                   int k  = index / rows;
+                   T&  dst = y[size_t(k) * ldy + i];
+                   dst     = a[k] * x[size_t(k) * ldx + i] + b[k] * dst;
+               });
+}
+}  // namespace muda
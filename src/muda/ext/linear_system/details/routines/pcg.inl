@@ -0,0 +1,396 @@
+#include <muda/ext/eigen/inverse.h>
+#include <muda/ext/eigen/atomic.h>
+namespace muda
+{
+namespace details::linear_system
+{
+    enum PCGStatus : int
+    {
+        PCGRunning   = 0,
+        PCGConverged = 1,
+        PCGBreakdown = 2,  // p^T A p <= 0, A is not SPD
+    };
+
+    template <typename T>
+    class PCGState
+    {
+      public:
+        T   rz         = 0;
+        T   rz_new     = 0;
+        T   rr         = 0;
+        T   pAp        = 0;
+        T   alpha      = 0;  // 0 once the iteration stops
+        T   bb         = 0;
+        T   threshold  = 0;
+        T   beta       = 0;
+        int iterations = 0;
+        int status     = PCGRunning;
+    };
+
+    template <typename T, int N>
+    void pcg_common_check(int rows, CDenseVectorView<T> x, CDenseVectorView<T> b, const LinearSystemPCGInfo& info)
+    {
+        MUDA_ASSERT(x.data() && b.data(), "x.data() and b.data() should not be nullptr");
+        MUDA_ASSERT(x.inc() == 1 && b.inc() == 1, "PCG: x and b must be contiguous");
+        MUDA_ASSERT(x.size() == rows && b.size() == rows,
+                    "PCG: dimension mismatch, A.rows=%d, x.size=%d, b.size=%d",
+                    rows,
+                    x.size(),
+                    b.size());
+        MUDA_ASSERT(info.max_iterations >= 0 && info.check_interval > 0,
+                    "PCG: invalid max_iterations=%d or check_interval=%d",
+                    info.max_iterations,
+                    info.check_interval);
+    }
+
+    // diagonal blocks -> Jacobi/BlockJacobi preconditioner, in place
+    template <typename T, int N>
+    void pcg_preconditioner(LinearSystemContext&                  ctx,
+                            LinearSystemPreconditioner            preconditioner,
+                            DeviceBuffer<Eigen::Matrix<T, N, N>>& diag_blocks)
+    {
+        using BlockMatrix = Eigen::Matrix<T, N, N>;
+
+        ParallelFor(0, ctx.stream())
+            .kernel_name(__FUNCTION__)
+            .apply(diag_blocks.size(),
+                   [blocks = diag_blocks.viewer().name("diag_blocks"),
+                    preconditioner] __device__(int i) mutable
+                   {
+                       BlockMatrix& D = blocks(i);
+                       if(preconditioner == LinearSystemPreconditioner::BlockJacobi)
+                       {
+                           D = eigen::inverse(D);
+                       }
+                       else
+                       {
+                           BlockMatrix inv = BlockMatrix::Zero();
+                           for(int j = 0; j < N; ++j)
+                               inv(j, j) = D(j, j) != T{0} ? T{1} / D(j, j) : T{1};
+                           D = inv;
+                       }
+                   });
+    }
+
+    // z = M^-1 r, skipped once the iteration stops
+    template <typename T, int N>
+    void pcg_precondition(LinearSystemContext&                        ctx,
+                          const DeviceBuffer<Eigen::Matrix<T, N, N>>* inv_diag,
+                          CDenseVectorView<T>                         r,
+                          DenseVectorView<T>                          z,
+                          VarView<PCGState<T>>                        state)
+    {
+        if(!inv_diag)
+        {
+            ParallelFor(0, ctx.stream())
+                .kernel_name(__FUNCTION__)
+                .apply(r.size(),
+                       [r = r.viewer().name("r"),
+                        z = z.viewer().name("z"),
+                        s = state.viewer()] __device__(int i) mutable
+                       {
+                           if(s->status != PCGRunning)
+                               return;
+                           z(i) = r(i);
+                       });
+            return;
+        }
+
+        ParallelFor(0, ctx.stream())
+            .kernel_name(__FUNCTION__)
+            .apply(inv_diag->size(),
+                   [r = r.viewer().name("r"),
+                    z = z.viewer().name("z"),
+                    M = inv_diag->cviewer().name("inv_diag"),
+                    s = state.viewer()] __device__(int i) mutable
+                   {
+                       if(s->status != PCGRunning)
+                           return;
+                       z.segment<N>(i * N).as_eigen() = M(i) * r.segment<N>(i * N).as_eigen();
+                   });
+    }
+
+    // `spmv(a, x, b, y)`: y = a * A * x + b * y, `precondition(r, z, state)`: z = M^-1 r
+    template <typename T, typename SpMV, typename Precondition>
+    LinearSystemPCGResult pcg_iterate(LinearSystemContext&       ctx,
+                                      SpMV&&                     spmv,
+                                      Precondition&&             precondition,
+                                      DenseVectorView<T>         x,
+                                      CDenseVectorView<T>        b,
+                                      const LinearSystemPCGInfo& info)
+    {
+        auto n = x.size();
+
+        // own work vectors, `temp_buffer()` is shared with the spmv routines
+        DeviceDenseVector<T>   r(n), z(n), p(n), Ap(n);
+        DeviceVar<PCGState<T>> state;
+
+        auto s_ptr = state.data();
+        auto var   = [](T* ptr) { return VarView<T>{ptr}; };
+
+        PCGState<T> h_state;
+        BufferLaunch(ctx.stream()).copy(state.view(), &h_state);
+
+        // r = b - A x
+        spmv(T{1}, x.as_const(), T{0}, Ap.view());
+        ParallelFor(0, ctx.stream())
+            .kernel_name("pcg_residual")
+            .apply(n,
+                   [b  = b.viewer().name("b"),
+                    Ap = Ap.cview().viewer().name("Ap"),
+                    r  = r.view().viewer().name("r")] __device__(int i) mutable
+                   { r(i) = b(i) - Ap(i); });
+        precondition(r.cview(), z.view(), state.view());
+        BufferLaunch(ctx.stream()).copy(p.buffer_view(), z.buffer_view());
+
+        ctx.multi_dot<T, 3>({r.cview(), r.cview(), b},
+                            {z.cview(), r.cview(), b},
+                            {var(&s_ptr->rz), var(&s_ptr->rr), var(&s_ptr->bb)});
+
+        Launch(1, 1, 0, ctx.stream())
+            .kernel_name("pcg_init")
+            .apply([s   = state.viewer(),
+                    rel = static_cast<T>(info.rel_tolerance),
+                    abs = static_cast<T>(info.abs_tolerance)] __device__() mutable
+                   {
+                       auto tol     = max(rel * sqrt(s->bb), abs);
+                       s->threshold = tol * tol;
+                       s->status = s->rr <= s->threshold ? PCGConverged : PCGRunning;
+                   });
+
+        for(int k = 0; k < info.max_iterations; ++k)
+        {
+            if(k % info.check_interval == 0)
+            {
+                BufferLaunch(ctx.stream()).copy(&h_state, state.view()).wait();
+                if(h_state.status != PCGRunning)
+                    break;
+            }
+
+            spmv(T{1}, p.cview(), T{0}, Ap.view());
+            ctx.dot(p.cview(), Ap.cview(), var(&s_ptr->pAp));
+
+            Launch(1, 1, 0, ctx.stream())
+                .kernel_name("pcg_alpha")
+                .apply(
+                    [s = state.viewer()] __device__() mutable
+                    {
+                        if(s->status == PCGRunning && !(s->pAp > T{0}))
+                            s->status = PCGBreakdown;
+                        s->alpha = s->status == PCGRunning ? s->rz / s->pAp : T{0};
+                    });
+
+            // x += alpha p, r -= alpha Ap, rr = r . r in one pass
+            ctx.update_xr(CVarView<T>{&s_ptr->alpha},
+                          p.cview(),
+                          Ap.cview(),
+                          x,
+                          r.view(),
+                          var(&s_ptr->rr));
+
+            precondition(r.cview(), z.view(), state.view());
+            ctx.dot(r.cview(), z.cview(), var(&s_ptr->rz_new));
+
+            Launch(1, 1, 0, ctx.stream())
+                .kernel_name("pcg_step")
+                .apply([s = state.viewer()] __device__() mutable
+                       {
+                           if(s->status != PCGRunning)
+                               return;
+                           s->beta = s->rz_new / s->rz;
+                           s->rz   = s->rz_new;
+                           s->iterations += 1;
+                           if(s->rr <= s->threshold)
+                               s->status = PCGConverged;
+                       });
+
+            // p = z + beta p
+            ParallelFor(0, ctx.stream())
+                .kernel_name("pcg_update_p")
+                .apply(n,
+                       [z = z.cview().viewer().name("z"),
+                        p = p.view().viewer().name("p"),
+                        s = state.cviewer()] __device__(int i) mutable
+                       {
+                           if(s->status != PCGRunning)
+                               return;
+                           p(i) = z(i) + s->beta * p(i);
+                       });
+        }
+
+        BufferLaunch(ctx.stream()).copy(&h_state, state.view()).wait();
+
+        LinearSystemPCGResult result;
+        result.converged     = h_state.status == PCGConverged;
+        result.iterations    = h_state.iterations;
+        result.residual_norm = std::sqrt(static_cast<double>(h_state.rr));
+        return result;
+    }
+}  // namespace details::linear_system
+
+template <typename T, int N>
+LinearSystemPCGResult LinearSystemContext::pcg(CBSRMatrixView<T, N>       A,
+                                               DenseVectorView<T>         x,
+                                               CDenseVectorView<T>        b,
+                                               const LinearSystemPCGInfo& info)
+{
+    using BlockMatrix = Eigen::Matrix<T, N, N>;
+
+    MUDA_ASSERT(!A.is_trans(), "PCG: BSRMatrix A must not be transposed");
+    MUDA_ASSERT(A.block_rows() == A.block_cols(), "PCG: A must be square");
+    details::linear_system::pcg_common_check<T, N>(A.block_rows() * N, x, b, info);
+
+    bool amg = info.preconditioner == LinearSystemPreconditioner::AMG;
+    if(amg && !(info.amg_reuse && has_amg(info.amg_hierarchy_id)))
+        amg_setup(A, info.amg_hierarchy_id, info.amg);
+    auto amg_preconditioner = amg ? &amg_hierarchy<T>(info.amg_hierarchy_id) : nullptr;
+
+    DeviceBuffer<BlockMatrix> inv_diag;
+    if(info.preconditioner != LinearSystemPreconditioner::None && !amg)
+    {
+        inv_diag.resize(A.block_rows());
+        ParallelFor(0, stream())
+            .kernel_name(__FUNCTION__)
+            .apply(A.block_rows(),
+                   [offsets = A.block_row_offsets(),
+                    cols    = A.block_col_indices(),
+                    values  = A.block_values(),
+                    D = inv_diag.viewer().name("diag_blocks")] __device__(int i) mutable
+                   {
+                       BlockMatrix diag = BlockMatrix::Zero();
+                       for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+                           if(cols[k] == i)
+                               diag += values[k];
+                       D(i) = diag;
+                   });
+        details::linear_system::pcg_preconditioner<T, N>(*this, info.preconditioner, inv_diag);
+    }
+
+    return details::linear_system::pcg_iterate<T>(
+        *this,
+        [&](const T& a, CDenseVectorView<T> in, const T& c, DenseVectorView<T> out)
+        { spmv(a, A, in, c, out); },
+        [&](CDenseVectorView<T> r, DenseVectorView<T> z, VarView<details::linear_system::PCGState<T>> state)
+        {
+            // the V-cycle is skipped on the device once the iteration stops
+            if(amg_preconditioner)
+                amg_preconditioner->apply(*this, r, z, &state.data()->status);
+            else
+                details::linear_system::pcg_precondition<T, N>(
+                    *this,
+                    info.preconditioner != LinearSystemPreconditioner::None ? &inv_diag : nullptr,
+                    r,
+                    z,
+                    state);
+        },
+        x,
+        b,
+        info);
+}
+
+template <typename T>
+LinearSystemPCGResult LinearSystemContext::pcg(CCSRMatrixView<T>          A,
+                                               DenseVectorView<T>         x,
+                                               CDenseVectorView<T>        b,
+                                               const LinearSystemPCGInfo& info)
+{
+    using BlockMatrix = Eigen::Matrix<T, 1, 1>;
+
+    MUDA_ASSERT(!A.is_trans(), "PCG: CSRMatrix A must not be transposed");
+    MUDA_ASSERT(A.rows() == A.cols(), "PCG: A must be square");
+    details::linear_system::pcg_common_check<T, 1>(A.rows(), x, b, info);
+    MUDA_ASSERT(info.preconditioner != LinearSystemPreconditioner::AMG,
+                "PCG: the AMG preconditioner needs a BSRMatrix A");
+
+    // no block structure, BlockJacobi is Jacobi
+    DeviceBuffer<BlockMatrix> inv_diag;
+    if(info.preconditioner != LinearSystemPreconditioner::None)
+    {
+        inv_diag.resize(A.rows());
+        ParallelFor(0, stream())
+            .kernel_name(__FUNCTION__)
+            .apply(A.rows(),
+                   [offsets = A.row_offsets(),
+                    cols    = A.col_indices(),
+                    values  = A.values(),
+                    D = inv_diag.viewer().name("diag_blocks")] __device__(int i) mutable
+                   {
+                       T diag = 0;
+                       for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+                           if(cols[k] == i)
+                               diag += values[k];
+                       D(i)(0, 0) = diag;
+                   });
+        details::linear_system::pcg_preconditioner<T, 1>(
+            *this, LinearSystemPreconditioner::Jacobi, inv_diag);
+    }
+
+    return details::linear_system::pcg_iterate<T>(
+        *this,
+        [&](const T& a, CDenseVectorView<T> in, const T& c, DenseVectorView<T> out)
+        { spmv(a, A, in, c, out); },
+        [&](CDenseVectorView<T> r, DenseVectorView<T> z, VarView<details::linear_system::PCGState<T>> state)
+        {
+            details::linear_system::pcg_precondition<T, 1>(
+                *this,
+                info.preconditioner != LinearSystemPreconditioner::None ? &inv_diag : nullptr,
+                r,
+                z,
+                state);
+        },
+        x,
+        b,
+        info);
+}
+
+template <typename T, int N>
+LinearSystemPCGResult LinearSystemContext::pcg(CTripletMatrixView<T, N>   A,
+                                               DenseVectorView<T>         x,
+                                               CDenseVectorView<T>        b,
+                                               const LinearSystemPCGInfo& info)
+{
+    using BlockMatrix = Eigen::Matrix<T, N, N>;
+
+    MUDA_ASSERT(A.extent() == A.total_extent() && A.triplet_count() == A.total_triplet_count(),
+                "submatrix or subview of a Triplet Matrix is not allowed in PCG!");
+    MUDA_ASSERT(A.total_block_rows() == A.total_block_cols(), "PCG: A must be square");
+    details::linear_system::pcg_common_check<T, N>(A.total_block_rows() * N, x, b, info);
+    MUDA_ASSERT(info.preconditioner != LinearSystemPreconditioner::AMG,
+                "PCG: the AMG preconditioner needs a BSRMatrix A");
+
+    DeviceBuffer<BlockMatrix> inv_diag;
+    if(info.preconditioner != LinearSystemPreconditioner::None)
+    {
+        inv_diag.resize(A.total_block_rows(), BlockMatrix::Zero());
+        // duplicated triplets are summed
+        ParallelFor(0, stream())
+            .kernel_name(__FUNCTION__)
+            .apply(A.triplet_count(),
+                   [A = A.viewer().name("A"),
+                    D = inv_diag.viewer().name("diag_blocks")] __device__(int index) mutable
+                   {
+                       auto&& [i, j, block] = A(index);
+                       if(i == j)
+                           eigen::atomic_add(D(i), block);
+                   });
+        details::linear_system::pcg_preconditioner<T, N>(*this, info.preconditioner, inv_diag);
+    }
+
+    return details::linear_system::pcg_iterate<T>(
+        *this,
+        [&](const T& a, CDenseVectorView<T> in, const T& c, DenseVectorView<T> out)
+        { spmv(a, A, in, c, out); },
+        [&](CDenseVectorView<T> r, DenseVectorView<T> z, VarView<details::linear_system::PCGState<T>> state)
+        {
+            details::linear_system::pcg_precondition<T, N>(
+                *this,
+                info.preconditioner != LinearSystemPreconditioner::None ? &inv_diag : nullptr,
+                r,
+                z,
+                state);
+        },
+        x,
+        b,
+        info);
+}
+}  // namespace muda
@@ -1,2 +1,4 @@
 #include "solve/solve_dense.inl"
-#include "solve/solve_sparse.inl"
\ No newline at end of file
+#include "solve/solve_sparse.inl"
+#include "solve/solve_factorized.inl"
+#include "solve/solve_refined.inl"
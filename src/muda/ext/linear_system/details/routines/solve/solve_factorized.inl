@@ -0,0 +1,469 @@
+#include <algorithm>
+#include <numeric>
+#include <cusolverSp_LOWLEVEL_PREVIEW.h>
+namespace muda
+{
+namespace details::linear_system
+{
+    /**
+     * \brief Analysis of one sparsity pattern: B = P * A * P^T (fill-reducing
+     * reordering), the symbolic factorization of B and the buffers of the
+     * numeric factorization.
+     */
+    template <typename T>
+    class SparseFactorization : public SparseFactorizationBase
+    {
+      public:
+        LinearSystemFactorizationMethod method;
+        int                             rows      = 0;
+        int                             non_zeros = 0;
+        bool                            factorized = false;
+
+        DeviceBuffer<int> perm;         // B(i, j) = A(perm[i], perm[j])
+        DeviceBuffer<int> row_offsets;  // of B
+        DeviceBuffer<int> col_indices;  // of B
+        DeviceBuffer<int> value_map;    // B.values[k] = A.values[value_map[k]]
+        DeviceBuffer<T>   values;       // of B
+        DeviceBuffer<T>   b;            // permuted right-hand side
+        DeviceBuffer<T>   y;            // permuted solution
+
+        DeviceBuffer<std::byte> workspace;
+
+        cusparseMatDescr_t descr     = nullptr;
+        csrcholInfo_t      chol_info = nullptr;
+        csrqrInfo_t        qr_info   = nullptr;
+
+        SparseFactorization(LinearSystemFactorizationMethod method)
+            : method(method)
+        {
+            checkCudaErrors(cusparseCreateMatDescr(&descr));
+            checkCudaErrors(cusparseSetMatType(descr, CUSPARSE_MATRIX_TYPE_GENERAL));
+            checkCudaErrors(cusparseSetMatIndexBase(descr, CUSPARSE_INDEX_BASE_ZERO));
+            if(method == LinearSystemFactorizationMethod::Cholesky)
+                checkCudaErrors(cusolverSpCreateCsrcholInfo(&chol_info));
+            else
+                checkCudaErrors(cusolverSpCreateCsrqrInfo(&qr_info));
+        }
+
+        ~SparseFactorization()
+        {
+            if(chol_info)
+                checkCudaErrors(cusolverSpDestroyCsrcholInfo(chol_info));
+            if(qr_info)
+                checkCudaErrors(cusolverSpDestroyCsrqrInfo(qr_info));
+            if(descr)
+                checkCudaErrors(cusparseDestroyMatDescr(descr));
+        }
+    };
+
+    // fill-reducing permutation of the (host) pattern
+    MUDA_INLINE void sparse_reorder(cusolverSpHandle_t        handle,
+                                    LinearSystemReorderMethod method,
+                                    cusparseMatDescr_t        descr,
+                                    int                       rows,
+                                    int                       non_zeros,
+                                    const int*                row_offsets,
+                                    const int*                col_indices,
+                                    int*                      perm)
+    {
+        switch(method)
+        {
+            case LinearSystemReorderMethod::Symrcm:
+                checkCudaErrors(cusolverSpXcsrsymrcmHost(
+                    handle, rows, non_zeros, descr, row_offsets, col_indices, perm));
+                break;
+            case LinearSystemReorderMethod::Symamd:
+                checkCudaErrors(cusolverSpXcsrsymamdHost(
+                    handle, rows, non_zeros, descr, row_offsets, col_indices, perm));
+                break;
+            case LinearSystemReorderMethod::Csrmetisnd:
+                checkCudaErrors(cusolverSpXcsrmetisndHost(
+                    handle, rows, non_zeros, descr, row_offsets, col_indices, nullptr, perm));
+                break;
+            default:
+                std::iota(perm, perm + rows, 0);
+                break;
+        }
+    }
+
+    /**
+     * \brief B = P * A * P^T on the host: row i of B is row perm[i] of A, column j
+     * of A becomes inv_perm[j], columns sorted in each row. `value_map[k]` is the
+     * index in A of the k-th entry of B.
+     */
+    MUDA_INLINE void sparse_permute(int                     rows,
+                                    const std::vector<int>& row_offsets,
+                                    const std::vector<int>& col_indices,
+                                    const std::vector<int>& perm,
+                                    std::vector<int>&       B_row_offsets,
+                                    std::vector<int>&       B_col_indices,
+                                    std::vector<int>&       value_map)
+    {
+        std::vector<int> inv_perm(rows);
+        for(int i = 0; i < rows; ++i)
+            inv_perm[perm[i]] = i;
+
+        B_row_offsets.resize(rows + 1);
+        B_col_indices.resize(col_indices.size());
+        value_map.resize(col_indices.size());
+
+        B_row_offsets[0] = 0;
+        for(int i = 0; i < rows; ++i)
+        {
+            int src   = perm[i];
+            int begin = row_offsets[src];
+            int count = row_offsets[src + 1] - begin;
+            int dst   = B_row_offsets[i];
+
+            std::iota(value_map.begin() + dst, value_map.begin() + dst + count, begin);
+            std::sort(value_map.begin() + dst,
+                      value_map.begin() + dst + count,
+                      [&](int a, int b)
+                      { return inv_perm[col_indices[a]] < inv_perm[col_indices[b]]; });
+            for(int k = dst; k < dst + count; ++k)
+                B_col_indices[k] = inv_perm[col_indices[value_map[k]]];
+
+            B_row_offsets[i + 1] = dst + count;
+        }
+    }
+
+    // dst[k] = src[map[k]]
+    template <typename T>
+    void sparse_gather(cudaStream_t stream, int count, const int* map, const T* src, T* dst)
+    {
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(count,
+                   [map, src, dst] __device__(int k) mutable { dst[k] = src[map[k]]; });
+    }
+
+    // dst[map[k]] = src[k]
+    template <typename T>
+    void sparse_scatter(cudaStream_t stream, int count, const int* map, const T* src, T* dst)
+    {
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(count,
+                   [map, src, dst] __device__(int k) mutable { dst[map[k]] = src[k]; });
+    }
+
+    template <typename T>
+    void csrchol_buffer_info(cusolverSpHandle_t handle, SparseFactorization<T>& f, size_t* internal, size_t* workspace)
+    {
+        if constexpr(std::is_same_v<T, float>)
+            checkCudaErrors(cusolverSpScsrcholBufferInfo(handle,
+                                                         f.rows,
+                                                         f.non_zeros,
+                                                         f.descr,
+                                                         f.values.data(),
+                                                         f.row_offsets.data(),
+                                                         f.col_indices.data(),
+                                                         f.chol_info,
+                                                         internal,
+                                                         workspace));
+        else if constexpr(std::is_same_v<T, double>)
+            checkCudaErrors(cusolverSpDcsrcholBufferInfo(handle,
+                                                         f.rows,
+                                                         f.non_zeros,
+                                                         f.descr,
+                                                         f.values.data(),
+                                                         f.row_offsets.data(),
+                                                         f.col_indices.data(),
+                                                         f.chol_info,
+                                                         internal,
+                                                         workspace));
+        else
+            static_assert(always_false_v<T>, "Unsupported type");
+    }
+
+    // numeric factorization, returns the first zero pivot or -1
+    template <typename T>
+    int csrchol_factor(cusolverSpHandle_t handle, SparseFactorization<T>& f, T tol)
+    {
+        int position = -1;
+        if constexpr(std::is_same_v<T, float>)
+        {
+            checkCudaErrors(cusolverSpScsrcholFactor(handle,
+                                                     f.rows,
+                                                     f.non_zeros,
+                                                     f.descr,
+                                                     f.values.data(),
+                                                     f.row_offsets.data(),
+                                                     f.col_indices.data(),
+                                                     f.chol_info,
+                                                     f.workspace.data()));
+            checkCudaErrors(cusolverSpScsrcholZeroPivot(handle, f.chol_info, tol, &position));
+        }
+        else if constexpr(std::is_same_v<T, double>)
+        {
+            checkCudaErrors(cusolverSpDcsrcholFactor(handle,
+                                                     f.rows,
+                                                     f.non_zeros,
+                                                     f.descr,
+                                                     f.values.data(),
+                                                     f.row_offsets.data(),
+                                                     f.col_indices.data(),
+                                                     f.chol_info,
+                                                     f.workspace.data()));
+            checkCudaErrors(cusolverSpDcsrcholZeroPivot(handle, f.chol_info, tol, &position));
+        }
+        else
+            static_assert(always_false_v<T>, "Unsupported type");
+        return position;
+    }
+
+    template <typename T>
+    void csrchol_solve(cusolverSpHandle_t handle, SparseFactorization<T>& f)
+    {
+        if constexpr(std::is_same_v<T, float>)
+            checkCudaErrors(cusolverSpScsrcholSolve(
+                handle, f.rows, f.b.data(), f.y.data(), f.chol_info, f.workspace.data()));
+        else if constexpr(std::is_same_v<T, double>)
+            checkCudaErrors(cusolverSpDcsrcholSolve(
+                handle, f.rows, f.b.data(), f.y.data(), f.chol_info, f.workspace.data()));
+        else
+            static_assert(always_false_v<T>, "Unsupported type");
+    }
+
+    template <typename T>
+    void csrqr_buffer_info(cusolverSpHandle_t handle, SparseFactorization<T>& f, size_t* internal, size_t* workspace)
+    {
+        if constexpr(std::is_same_v<T, float>)
+            checkCudaErrors(cusolverSpScsrqrBufferInfoBatched(handle,
+                                                              f.rows,
+                                                              f.rows,
+                                                              f.non_zeros,
+                                                              f.descr,
+                                                              f.values.data(),
+                                                              f.row_offsets.data(),
+                                                              f.col_indices.data(),
+                                                              1,
+                                                              f.qr_info,
+                                                              internal,
+                                                              workspace));
+        else if constexpr(std::is_same_v<T, double>)
+            checkCudaErrors(cusolverSpDcsrqrBufferInfoBatched(handle,
+                                                              f.rows,
+                                                              f.rows,
+                                                              f.non_zeros,
+                                                              f.descr,
+                                                              f.values.data(),
+                                                              f.row_offsets.data(),
+                                                              f.col_indices.data(),
+                                                              1,
+                                                              f.qr_info,
+                                                              internal,
+                                                              workspace));
+        else
+            static_assert(always_false_v<T>, "Unsupported type");
+    }
+
+    // numeric QR + solve on the analyzed pattern
+    template <typename T>
+    void csrqr_solve(cusolverSpHandle_t handle, SparseFactorization<T>& f)
+    {
+        if constexpr(std::is_same_v<T, float>)
+            checkCudaErrors(cusolverSpScsrqrsvBatched(handle,
+                                                      f.rows,
+                                                      f.rows,
+                                                      f.non_zeros,
+                                                      f.descr,
+                                                      f.values.data(),
+                                                      f.row_offsets.data(),
+                                                      f.col_indices.data(),
+                                                      f.b.data(),
+                                                      f.y.data(),
+                                                      1,
+                                                      f.qr_info,
+                                                      f.workspace.data()));
+        else if constexpr(std::is_same_v<T, double>)
+            checkCudaErrors(cusolverSpDcsrqrsvBatched(handle,
+                                                      f.rows,
+                                                      f.rows,
+                                                      f.non_zeros,
+                                                      f.descr,
+                                                      f.values.data(),
+                                                      f.row_offsets.data(),
+                                                      f.col_indices.data(),
+                                                      f.b.data(),
+                                                      f.y.data(),
+                                                      1,
+                                                      f.qr_info,
+                                                      f.workspace.data()));
+        else
+            static_assert(always_false_v<T>, "Unsupported type");
+    }
+}  // namespace details::linear_system
+
+template <typename T>
+details::linear_system::SparseFactorization<T>& LinearSystemContext::factorization(uint64_t pattern_id)
+{
+    auto it = m_factorizations.find(pattern_id);
+    MUDA_ASSERT(it != m_factorizations.end(),
+                "No factorization with pattern id %llu, call analyze() first",
+                (unsigned long long)pattern_id);
+    auto f = dynamic_cast<details::linear_system::SparseFactorization<T>*>(it->second.get());
+    MUDA_ASSERT(f, "Factorization %llu was analyzed with another value type", (unsigned long long)pattern_id);
+    return *f;
+}
+
+template <typename T>
+std::unique_ptr<details::linear_system::SparseFactorization<T>> LinearSystemContext::sparse_analyze(
+    CCSRMatrixView<T> A, LinearSystemFactorizationMethod method)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(!A.is_trans(), "CSRMatrix A must not be transposed");
+    MUDA_ASSERT(A.rows() == A.cols(), "analyze: A must be square");
+
+    auto handle = cusolver_sp();
+    int  rows   = A.rows();
+    int  nnz    = A.non_zeros();
+
+    auto f       = std::make_unique<SparseFactorization<T>>(method);
+    f->rows      = rows;
+    f->non_zeros = nnz;
+
+    // the reordering and the permutation are host algorithms, done once per pattern
+    std::vector<int> row_offsets(rows + 1);
+    std::vector<int> col_indices(nnz);
+    BufferLaunch(stream())
+        .copy(row_offsets.data(), CBufferView<int>{A.row_offsets(), row_offsets.size()})
+        .copy(col_indices.data(), CBufferView<int>{A.col_indices(), col_indices.size()})
+        .wait();
+
+    std::vector<int> perm(rows);
+    sparse_reorder(handle,
+                   m_reorder.reorder_method(),
+                   A.legacy_descr(),
+                   rows,
+                   nnz,
+                   row_offsets.data(),
+                   col_indices.data(),
+                   perm.data());
+
+    std::vector<int> B_row_offsets, B_col_indices, value_map;
+    sparse_permute(rows, row_offsets, col_indices, perm, B_row_offsets, B_col_indices, value_map);
+
+    f->perm        = perm;
+    f->row_offsets = B_row_offsets;
+    f->col_indices = B_col_indices;
+    f->value_map   = value_map;
+    f->values.resize(nnz);
+    f->b.resize(rows);
+    f->y.resize(rows);
+
+    size_t internal  = 0;
+    size_t workspace = 0;
+    if(method == LinearSystemFactorizationMethod::Cholesky)
+    {
+        checkCudaErrors(cusolverSpXcsrcholAnalysis(
+            handle, rows, nnz, f->descr, f->row_offsets.data(), f->col_indices.data(), f->chol_info));
+        csrchol_buffer_info(handle, *f, &internal, &workspace);
+    }
+    else
+    {
+        checkCudaErrors(cusolverSpXcsrqrAnalysisBatched(
+            handle, rows, rows, nnz, f->descr, f->row_offsets.data(), f->col_indices.data(), f->qr_info));
+        csrqr_buffer_info(handle, *f, &internal, &workspace);
+    }
+    // the internal data (the factors) is allocated by cuSOLVER in the info
+    f->workspace.resize(std::max<size_t>(workspace, 1));
+    return f;
+}
+
+template <typename T>
+void LinearSystemContext::analyze(CCSRMatrixView<T>               A,
+                                  uint64_t                        pattern_id,
+                                  LinearSystemFactorizationMethod method)
+{
+    auto f  = sparse_analyze(A, method);
+    auto it = m_factorizations.find(pattern_id);
+    if(it == m_factorizations.end())
+    {
+        m_factorizations.emplace(pattern_id, std::move(f));
+        return;
+    }
+    // the buffers of the replaced factorization may still be in use by the
+    // stream, as in release_factorization()
+    checkCudaErrors(cudaStreamSynchronize(stream()));
+    it->second = std::move(f);
+}
+
+template <typename T>
+bool LinearSystemContext::sparse_factorize(details::linear_system::SparseFactorization<T>& f,
+                                           CCSRMatrixView<T>                               A)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(!A.is_trans(), "CSRMatrix A must not be transposed");
+    MUDA_ASSERT(A.rows() == f.rows && A.non_zeros() == f.non_zeros,
+                "factorize: A (rows=%d, nnz=%d) doesn't have the analyzed pattern (rows=%d, nnz=%d)",
+                A.rows(),
+                A.non_zeros(),
+                f.rows,
+                f.non_zeros);
+
+    sparse_gather(stream(), f.non_zeros, f.value_map.data(), A.values(), f.values.data());
+
+    f.factorized = true;
+    if(f.method == LinearSystemFactorizationMethod::QR)
+        return true;  // factorized in solve()
+
+    int position = csrchol_factor(cusolver_sp(), f, m_tolerance.solve_sparse_error_threshold<T>());
+    if(position >= 0)
+    {
+        // reported in B, the row of A is perm[position]
+        MUDA_KERNEL_WARN_WITH_LOCATION("In calling label %s: Cholesky factorization failed, A is not SPD (zero pivot at permuted row %d)",
+                                       std::string{label()}.c_str(),
+                                       position);
+        f.factorized = false;
+    }
+    label("");  // consumed here
+    return f.factorized;
+}
+
+template <typename T>
+bool LinearSystemContext::factorize(CCSRMatrixView<T> A, uint64_t pattern_id)
+{
+    return sparse_factorize(factorization<T>(pattern_id), A);
+}
+
+template <typename T>
+void LinearSystemContext::sparse_solve(details::linear_system::SparseFactorization<T>& f,
+                                       DenseVectorView<T>                              x,
+                                       CDenseVectorView<T>                             b)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(x.inc() == 1 && b.inc() == 1, "solve: x and b must be contiguous");
+    MUDA_ASSERT(x.size() == f.rows && b.size() == f.rows,
+                "solve: dimension mismatch, A.rows=%d, x.size=%d, b.size=%d",
+                f.rows,
+                (int)x.size(),
+                (int)b.size());
+
+    // B y = P b, x = P^T y
+    sparse_gather(stream(), f.rows, f.perm.data(), b.data(), f.b.data());
+    if(f.method == LinearSystemFactorizationMethod::Cholesky)
+        csrchol_solve(cusolver_sp(), f);
+    else
+        csrqr_solve(cusolver_sp(), f);
+    sparse_scatter(stream(), f.rows, f.perm.data(), f.y.data(), x.data());
+}
+
+template <typename T>
+void LinearSystemContext::solve(DenseVectorView<T> x, CDenseVectorView<T> b, uint64_t pattern_id)
+{
+    auto& f = factorization<T>(pattern_id);
+    MUDA_ASSERT(f.factorized, "solve: call factorize() on pattern %llu first", (unsigned long long)pattern_id);
+    sparse_solve(f, x, b);
+}
+
+MUDA_INLINE void LinearSystemContext::release_factorization(uint64_t pattern_id)
+{
+    // the buffers may still be in use by the stream
+    checkCudaErrors(cudaStreamSynchronize(stream()));
+    m_factorizations.erase(pattern_id);
+}
+}  // namespace muda
@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <cmath>
+namespace muda
+{
+namespace details::linear_system
+{
+    MUDA_INLINE void refine_common_check(CDenseVectorView<double> x,
+                                         CDenseVectorView<double> b,
+                                         size_t                   rows)
+    {
+        MUDA_ASSERT(x.data() && b.data(), "x.data() and b.data() should not be nullptr");
+        MUDA_ASSERT(x.inc() == 1 && b.inc() == 1, "solve_refined: x and b must be contiguous");
+        MUDA_ASSERT(x.size() == rows && b.size() == rows,
+                    "solve_refined: dimension mismatch, A.rows=%d, x.size=%d, b.size=%d",
+                    (int)rows,
+                    (int)x.size(),
+                    (int)b.size());
+    }
+
+    // low = float(high)
+    MUDA_INLINE void refine_to_low(cudaStream_t             stream,
+                                   CDenseVectorView<double> high,
+                                   DenseVectorView<float>   low)
+    {
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(high.size(),
+                   [high = high.cviewer().name("high"),
+                    low  = low.viewer().name("low")] __device__(int i) mutable
+                   { low(i) = static_cast<float>(high(i)); });
+    }
+
+    // high += double(low)
+    MUDA_INLINE void refine_add_correction(cudaStream_t            stream,
+                                           CDenseVectorView<float> low,
+                                           DenseVectorView<double> high)
+    {
+        ParallelFor(0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(high.size(),
+                   [low  = low.cviewer().name("low"),
+                    high = high.viewer().name("high")] __device__(int i) mutable
+                   { high(i) += static_cast<double>(low(i)); });
+    }
+
+    /**
+     * \brief The refinement loop: r = b - A x in double, stop if |r| is small
+     * enough, else `correct(r, x)` does x += A_low^-1 r (low precision solve).
+     */
+    template <typename Residual, typename Correct>
+    LinearSystemRefineResult refine(LinearSystemContext&          ctx,
+                                    DenseVectorView<double>       x,
+                                    CDenseVectorView<double>      b,
+                                    const LinearSystemRefineInfo& info,
+                                    Residual&&                    residual,
+                                    Correct&&                     correct)
+    {
+        DeviceDenseVector<double> r(x.size());
+
+        auto b_norm = ctx.norm(b);
+        auto tol    = std::max(info.rel_tolerance * b_norm, info.abs_tolerance);
+
+        LinearSystemRefineResult result;
+        while(true)
+        {
+            BufferLaunch(ctx.stream()).copy(r.buffer_view(), b.buffer_view());
+            residual(x.as_const(), r.view());  // r = b - A x
+            result.residual_norm = ctx.norm(r.cview());
+
+            if(result.residual_norm <= tol)
+            {
+                result.converged = true;
+                break;
+            }
+            // NaN or Inf: the low precision solve failed or diverged
+            if(!std::isfinite(result.residual_norm)
+               || result.iterations >= info.max_iterations)
+                break;
+
+            correct(r.cview(), x);
+            ++result.iterations;
+        }
+        return result;
+    }
+}  // namespace details::linear_system
+
+MUDA_INLINE LinearSystemRefineResult LinearSystemContext::solve_refined(DenseVectorView<double> x,
+                                                                        CDenseMatrixView<double> A,
+                                                                        CDenseVectorView<double> b,
+                                                                        const LinearSystemRefineInfo& info)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(!A.is_trans(), "solve_refined: DenseMatrix A must not be transposed");
+    MUDA_ASSERT(A.row() == A.col(), "solve_refined: A must be square");
+    refine_common_check(x, b, A.row());
+
+    int64_t n = A.row();
+
+    // float copy of A, factorized in place, kept for all the refinement steps
+    DeviceDenseMatrix<float> A_low(n, n, A.is_sym());
+    auto                     to_low = [&]
+    {
+        ParallelFor(0, stream())
+            .kernel_name("solve_refined_to_low")
+            .apply(n * n,
+                   [src = A.cviewer().name("A"), dst = A_low.viewer().name("A_low"), n] __device__(
+                       int k) mutable
+                   {
+                       auto i    = k % n;
+                       auto j    = k / n;
+                       dst(i, j) = static_cast<float>(src(i, j));
+                   });
+    };
+
+    auto cusolver = cusolver_dn();
+    auto type     = cuda_data_type<float>();
+    auto uplo     = CUBLAS_FILL_MODE_LOWER;
+    auto A_view   = A_low.view();
+    auto lda      = static_cast<int64_t>(A_view.lda());
+
+    cusolverDnParams_t params;
+    checkCudaErrors(cusolverDnCreateParams(&params));
+    checkCudaErrors(cusolverDnSetAdvOptions(params, CUSOLVERDN_GETRF, CUSOLVER_ALG_0));
+
+    // own workspace: temp_buffer() is reused by the double precision routines
+    DeviceBuffer<std::byte> d_work;
+    std::vector<std::byte>  h_work;
+    DeviceBuffer<int64_t>   pivots;
+    DeviceVar<int>          dev_info;
+
+    // Cholesky or LU of A_low in place, returns the info of cusolver
+    auto factorize = [&](bool cholesky) -> int
+    {
+        size_t d_lwork = 0;
+        size_t h_lwork = 0;
+        if(cholesky)
+            checkCudaErrors(cusolverDnXpotrf_bufferSize(
+                cusolver, params, uplo, n, type, A_view.data(), lda, type, &d_lwork, &h_lwork));
+        else
+            checkCudaErrors(cusolverDnXgetrf_bufferSize(
+                cusolver, params, n, n, type, A_view.data(), lda, type, &d_lwork, &h_lwork));
+
+        d_work.resize(std::max<size_t>(d_lwork, 1));
+        h_work.resize(std::max<size_t>(h_lwork, 1));
+
+        if(cholesky)
+        {
+            checkCudaErrors(cusolverDnXpotrf(cusolver,
+                                             params,
+                                             uplo,
+                                             n,
+                                             type,
+                                             A_view.data(),
+                                             lda,
+                                             type,
+                                             d_work.data(),
+                                             d_lwork,
+                                             h_work.data(),
+                                             h_lwork,
+                                             dev_info.data()));
+        }
+        else
+        {
+            pivots.resize(n);
+            checkCudaErrors(cusolverDnXgetrf(cusolver,
+                                             params,
+                                             n,
+                                             n,
+                                             type,
+                                             A_view.data(),
+                                             lda,
+                                             pivots.data(),
+                                             type,
+                                             d_work.data(),
+                                             d_lwork,
+                                             h_work.data(),
+                                             h_lwork,
+                                             dev_info.data()));
+        }
+        return dev_info;
+    };
+
+    to_low();
+    auto cholesky = A.is_sym();
+    int  h_info   = factorize(cholesky);
+    if(cholesky && h_info > 0)
+    {
+        // symmetric but not positive definite (e.g. indefinite, which solve()
+        // handles with LDL^T): LU of a fresh copy, potrf overwrote A_low
+        cholesky = false;
+        to_low();
+        h_info = factorize(cholesky);
+    }
+
+    if(h_info != 0)
+    {
+        checkCudaErrors(cusolverDnDestroyParams(params));
+        MUDA_KERNEL_WARN_WITH_LOCATION("In calling label %s: solve_refined failed, the float %s factorization returned info=%d",
+                                       std::string{label()}.c_str(),
+                                       cholesky ? "Cholesky" : "LU",
+                                       h_info);
+        label("");
+        return LinearSystemRefineResult{false, 0, static_cast<double>(norm(b))};
+    }
+
+    DeviceDenseVector<float> d(n);
+
+    auto result = refine(
+        *this,
+        x,
+        b,
+        info,
+        [&](CDenseVectorView<double> x, DenseVectorView<double> r)
+        { mv(A, -1.0, x, 1.0, r); },
+        [&](CDenseVectorView<double> r, DenseVectorView<double> x)
+        {
+            refine_to_low(stream(), r, d.view());
+            if(cholesky)
+                checkCudaErrors(cusolverDnXpotrs(
+                    cusolver, params, uplo, n, 1, type, A_view.data(), lda, type, d.view().data(), n, dev_info.data()));
+            else
+                checkCudaErrors(cusolverDnXgetrs(cusolver,
+                                                 params,
+                                                 CUBLAS_OP_N,
+                                                 n,
+                                                 1,
+                                                 type,
+                                                 A_view.data(),
+                                                 lda,
+                                                 pivots.data(),
+                                                 type,
+                                                 d.view().data(),
+                                                 n,
+                                                 dev_info.data()));
+            refine_add_correction(stream(), d.cview(), x);
+        });
+
+    checkCudaErrors(cusolverDnDestroyParams(params));
+    label("");  // consumed here
+    return result;
+}
+
+MUDA_INLINE LinearSystemRefineResult LinearSystemContext::solve_refined(DenseVectorView<double> x,
+                                                                        CCSRMatrixView<double> A,
+                                                                        CDenseVectorView<double> b,
+                                                                        const LinearSystemRefineInfo& info)
+{
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(!A.is_trans(), "solve_refined: CSRMatrix A must not be transposed");
+    MUDA_ASSERT(A.rows() == A.cols(), "solve_refined: A must be square");
+    refine_common_check(x, b, A.rows());
+
+    // float copy of A, same pattern
+    DeviceCSRMatrix<float> A_low;
+    A_low.reshape(A.rows(), A.cols());
+    A_low.m_col_indices.resize(A.non_zeros());
+    A_low.m_values.resize(A.non_zeros());
+    BufferLaunch(stream())
+        .copy(A_low.m_row_offsets.view(), CBufferView<int>{A.row_offsets(), size_t(A.rows() + 1)})
+        .copy(A_low.m_col_indices.view(), CBufferView<int>{A.col_indices(), size_t(A.non_zeros())});
+    ParallelFor(0, stream())
+        .kernel_name("solve_refined_to_low")
+        .apply(A.non_zeros(),
+               [src = A.values(), dst = A_low.m_values.viewer().name("values")] __device__(
+                   int i) mutable { dst(i) = static_cast<float>(src[i]); });
+
+    // float factorization, kept for all the refinement steps
+    auto factorization = sparse_analyze(A_low.cview(), info.sparse_method);
+    if(!sparse_factorize(*factorization, A_low.cview()))
+        return LinearSystemRefineResult{false, 0, static_cast<double>(norm(b))};
+
+    DeviceDenseVector<float> r_low(A.rows());
+    DeviceDenseVector<float> d(A.rows());
+
+    auto result = refine(
+        *this,
+        x,
+        b,
+        info,
+        [&](CDenseVectorView<double> x, DenseVectorView<double> r)
+        { spmv(-1.0, A, x, 1.0, r); },
+        [&](CDenseVectorView<double> r, DenseVectorView<double> x)
+        {
+            refine_to_low(stream(), r, r_low.view());
+            sparse_solve(*factorization, d.view(), r_low.cview());
+            refine_add_correction(stream(), d.cview(), x);
+        });
+
+    // the factorization may still be in use by the stream
+    checkCudaErrors(cudaStreamSynchronize(stream()));
+    return result;
+}
+}  // namespace muda
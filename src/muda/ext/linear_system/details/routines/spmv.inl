@@ -33,4 +33,5 @@ void LinearSystemContext::generic_spmv(const T&                  a,
 #include "spmv/coo_spmv.inl"
 #include "spmv/csr_spmv.inl"
 #include "spmv/bsr_spmv.inl"
-#include "spmv/triplet_spmv.inl"
\ No newline at end of file
+#include "spmv/triplet_spmv.inl"
+#include "spmv/bcoo_spmv.inl"
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include <muda/ext/eigen.h>
+namespace muda
+{
+namespace details::linear_system
+{
+    constexpr int BCOOSpMVBlockSize = 256;
+
+    // inclusive warp scan of `v`, segmented by `row` (rows sorted along the lanes)
+    template <typename T, int N>
+    MUDA_INLINE MUDA_DEVICE void warp_segmented_sum(int lane, int row, Eigen::Vector<T, N>& v)
+    {
+#pragma unroll
+        for(int offset = 1; offset < 32; offset <<= 1)
+        {
+            int                 up_row = __shfl_up_sync(0xffffffff, row, offset);
+            Eigen::Vector<T, N> up;
+#pragma unroll
+            for(int c = 0; c < N; ++c)
+                up(c) = __shfl_up_sync(0xffffffff, v(c), offset);
+            if(lane >= offset && up_row == row)
+                v += up;
+        }
+    }
+}  // namespace details::linear_system
+
+template <typename T, int N>
+void LinearSystemContext::spmv(const T&                      a,
+                               const DeviceBCOOMatrix<T, N>& A,
+                               CDenseVectorView<T>           x,
+                               const T&                      b,
+                               DenseVectorView<T>&           y)
+{
+    using namespace muda;
+    using namespace details::linear_system;
+
+    MUDA_ASSERT(A.block_cols() * N == x.size() && A.block_rows() * N == y.size(),
+                "Dimension mismatch in SPMV!");
+
+    if(b != T{0})
+    {
+        ParallelFor(0, stream())
+            .kernel_name(__FUNCTION__)
+            .apply(y.size(),
+                   [b = b, y = y.viewer().name("y")] __device__(int i) mutable
+                   { y(i) = b * y(i); });
+    }
+    else
+    {
+        BufferLaunch(stream()).fill(y.buffer_view(), T{0});
+    }
+
+    int count = A.non_zero_blocks();
+    if(count == 0)
+        return;
+
+    // one block per lane, the warp sums its row segments in registers,
+    // only the segments touching the first/last lane may be shared with
+    // the neighbor warps and are added atomically
+    int grid_dim = (count + BCOOSpMVBlockSize - 1) / BCOOSpMVBlockSize;
+
+    Launch(grid_dim, BCOOSpMVBlockSize, 0, stream())
+        .kernel_name(__FUNCTION__)
+        .apply(
+            [a     = a,
+             A     = A.cview().viewer().name("A"),
+             x     = x.viewer().name("x"),
+             y     = y.viewer().name("y"),
+             count = count] __device__() mutable
+            {
+                int index = blockIdx.x * blockDim.x + threadIdx.x;
+                int lane  = threadIdx.x & 31;
+
+                int                 row = -1;
+                Eigen::Vector<T, N> v   = Eigen::Vector<T, N>::Zero();
+                if(index < count)
+                {
+                    auto&& [i, j, block] = A(index);
+                    Eigen::Vector<T, N> vec_x = x.segment<N>(j * N).as_eigen();
+
+                    row = i;
+                    v   = a * block * vec_x;
+
+                    // unsorted rows would split a row into several segments
+                    // of one warp, racing on the non-atomic add below
+                    if constexpr(DEBUG_VIEWER)
+                    {
+                        int prev_row = index > 0 ? A(index - 1).block_row_index : 0;
+                        if(prev_row > i)
+                            MUDA_KERNEL_ERROR("spmv: BCOO blocks must be sorted by row, block %d has row %d after row %d",
+                                              index,
+                                              i,
+                                              prev_row);
+                    }
+                }
+
+                warp_segmented_sum<T, N>(lane, row, v);
+
+                int next_row  = __shfl_down_sync(0xffffffff, row, 1);
+                int first_row = __shfl_sync(0xffffffff, row, 0);
+
+                bool is_tail = lane == 31 || next_row != row;
+                if(row < 0 || !is_tail)
+                    return;
+
+                auto seg_y = y.segment<N>(row * N);
+                if(row == first_row || lane == 31)
+                    seg_y.atomic_add(v);
+                else  // the whole segment is in this warp
+                    seg_y.as_eigen() += v;
+            });
+}
+
+template <typename T, int N>
+void LinearSystemContext::spmv(const DeviceBCOOMatrix<T, N>& A,
+                               CDenseVectorView<T>           x,
+                               DenseVectorView<T>            y)
+{
+    spmv<T, N>(T{1}, A, x, T{0}, y);
+}
+}  // namespace muda
@@ -1,3 +1,4 @@
+#include <muda/ext/eigen.h>
 namespace muda
 {
 //using T         = double;
@@ -61,6 +62,107 @@ namespace detail::linear_system
             static_assert(always_false_v<T>, "T must be float or double");
         }
     }
+
+    // warps per CTA of the custom kernel, the staging buffer of a warp is
+    // 32 blocks and their x segments, kept under 32KB of shared memory per CTA
+    template <typename T, int N>
+    constexpr int bsr_spmv_warps()
+    {
+        constexpr int per_warp = 32 * (N * N + N) * sizeof(T);
+        constexpr int warps    = (32 * 1024) / per_warp;
+        return warps < 1 ? 1 : (warps > 8 ? 8 : warps);
+    }
+
+    // y = a * A * x + b * y, one warp per block row, blocks and x segments are
+    // loaded cooperatively (consecutive lanes read consecutive scalars) into
+    // shared memory, each lane multiplies one block, then a warp reduction.
+    // `stop`: optional device flag, nothing is done while it is non-zero
+    template <typename T, int N>
+    void bsr_spmv_custom(cudaStream_t         stream,
+                         const T&             a,
+                         CBSRMatrixView<T, N> A,
+                         CDenseVectorView<T>  x,
+                         const T&             b,
+                         DenseVectorView<T>&  y,
+                         const int*           stop = nullptr)
+    {
+        using Vector                 = Eigen::Vector<T, N>;
+        using BlockMatrix            = Eigen::Matrix<T, N, N>;
+        constexpr int Warps          = bsr_spmv_warps<T, N>();
+        constexpr int BlockScalars   = N * N;
+        constexpr int ChunkBlocks    = 32;
+
+        int block_rows = A.block_rows();
+        int grid_dim   = (block_rows + Warps - 1) / Warps;
+
+        Launch(grid_dim, Warps * 32, 0, stream)
+            .kernel_name(__FUNCTION__)
+            .apply(
+                [a,
+                 b,
+                 block_rows,
+                 offsets = A.block_row_offsets(),
+                 cols    = A.block_col_indices(),
+                 values  = reinterpret_cast<const T*>(A.block_values()),
+                 x       = x.data(),
+                 y       = y.data(),
+                 stop] __device__() mutable
+                {
+                    __shared__ T s_blocks[Warps][ChunkBlocks * BlockScalars];
+                    __shared__ T s_x[Warps][ChunkBlocks * N];
+
+                    int warp = threadIdx.x / 32;
+                    int lane = threadIdx.x & 31;
+                    int row  = blockIdx.x * Warps + warp;
+                    if(row >= block_rows || (stop && *stop))  // uniform in the warp
+                        return;
+
+                    int    begin = offsets[row];
+                    int    end   = offsets[row + 1];
+                    Vector sum   = Vector::Zero();
+
+                    for(int chunk = begin; chunk < end; chunk += ChunkBlocks)
+                    {
+                        int count = min(ChunkBlocks, end - chunk);
+
+                        const T* src = values + size_t(chunk) * BlockScalars;
+                        for(int t = lane; t < count * BlockScalars; t += 32)
+                            s_blocks[warp][t] = src[t];
+                        for(int t = lane; t < count * N; t += 32)
+                            s_x[warp][t] = x[cols[chunk + t / N] * N + t % N];
+                        __syncwarp();
+
+                        if(lane < count)
+                        {
+                            Eigen::Map<const BlockMatrix> block(&s_blocks[warp][lane * BlockScalars]);
+                            Eigen::Map<const Vector> seg_x(&s_x[warp][lane * N]);
+                            sum += block * seg_x;
+                        }
+                        __syncwarp();
+                    }
+
+                    // butterfly: every lane ends up with the full row sum,
+                    // lane c writes component c below
+#pragma unroll
+                    for(int offset = 16; offset > 0; offset >>= 1)
+                    {
+#pragma unroll
+                        for(int c = 0; c < N; ++c)
+                            sum(c) += __shfl_xor_sync(0xffffffff, sum(c), offset);
+                    }
+
+                    if(lane < N)
+                    {
+                        T value = 0;
+#pragma unroll
+                        for(int c = 0; c < N; ++c)
+                            if(c == lane)
+                                value = sum(c);
+                        T& dst = y[row * N + lane];
+                        dst    = b == T{0} ? a * value : a * value + b * dst;
+                    }
+                });
+    }
 }  // namespace detail::linear_system
 
 template <typename T, int N>
@@ -70,6 +172,14 @@ void LinearSystemContext::spmv(const T&             a,
                                const T&             b,
                                DenseVectorView<T>&  y)
 {
+    if(m_spmv_policy.use_custom_bsr(N, A.is_trans(), A.block_rows(), A.non_zero_blocks()))
+    {
+        MUDA_ASSERT(A.block_cols() * N == x.size() && A.block_rows() * N == y.size(),
+                    "Dimension mismatch in SPMV!");
+        detail::linear_system::bsr_spmv_custom<T, N>(stream(), a, A, x, b, y);
+        return;
+    }
+
     set_pointer_mode_host();
 
     auto op = A.is_trans() ? CUSPARSE_OPERATION_TRANSPOSE : CUSPARSE_OPERATION_NON_TRANSPOSE;
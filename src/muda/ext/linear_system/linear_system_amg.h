@@ -0,0 +1,399 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <map>
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <muda/muda_def.h>
+
+namespace muda
+{
+enum class LinearSystemAMGSmoother
+{
+    // damped block Jacobi: x += jacobi_weight / rho * D^-1 (b - A x)
+    Jacobi = 0,
+    // Chebyshev polynomial in D^-1 A on [chebyshev_lower, chebyshev_upper] * rho
+    Chebyshev = 1,
+};
+
+/**
+ * \brief Smoothed aggregation AMG for block-sparse systems (N x N blocks).
+ *
+ * D is the block diagonal of A, rho the spectral radius of D^-1 A estimated
+ * by a power iteration. The near-nullspace is the N block-constant vectors
+ * (one per component), so the coarse levels keep N x N blocks.
+ */
+class LinearSystemAMGInfo
+{
+  public:
+    // block rows i, j are strongly coupled if |A_ij| > strength_threshold * sqrt(|A_ii| |A_jj|),
+    // |.| the Frobenius norm of a block
+    double strength_threshold = 0.08;
+    // P = (I - w D^-1 A) P_tentative, w = prolongation_weight / rho
+    double prolongation_weight = 4.0 / 3.0;
+    int    max_levels          = 10;
+    // a level with at most this many (scalar) rows is solved densely, if the
+    // coarsening stops above it the last level is only smoothed
+    int coarse_size = 256;
+
+    LinearSystemAMGSmoother smoother = LinearSystemAMGSmoother::Chebyshev;
+    // pre- and post-smoothing sweeps of each level
+    int    sweeps           = 1;
+    double jacobi_weight    = 4.0 / 3.0;
+    int    chebyshev_degree = 2;
+    double chebyshev_lower  = 0.3;
+    double chebyshev_upper  = 1.1;
+    // power iterations estimating rho
+    int power_iterations = 10;
+};
+}  // namespace muda
+
+namespace muda::details::linear_system
+{
+// kept by LinearSystemContext per hierarchy id, see amg_setup()
+class AMGHierarchyBase
+{
+  public:
+    virtual ~AMGHierarchyBase() = default;
+};
+
+template <typename T>
+class AMGPreconditioner;
+
+template <typename T, int N>
+class AMGHierarchy;
+
+/**
+ * \brief Standard (Vanek) aggregation of the block rows of a square block
+ * CSR pattern, `norms` holds the Frobenius norm of each block.
+ *
+ * 1. a row whose strong neighbors are all free forms an aggregate with them
+ * 2. the remaining rows join the aggregate of a strong neighbor from 1.
+ * 3. the remaining rows form aggregates with their free strong neighbors
+ *
+ * Rows without strong neighbors stay unaggregated (-1).
+ * Returns the number of aggregates. Shared by the device setup and the host
+ * reference, so both build the same hierarchy.
+ */
+template <typename T>
+int amg_aggregate(int                     rows,
+                  const std::vector<int>& offsets,
+                  const std::vector<int>& cols,
+                  const std::vector<T>&   norms,
+                  T                       theta,
+                  std::vector<int>&       aggregates)
+{
+    std::vector<T> diag(rows, T{0});
+    for(int i = 0; i < rows; ++i)
+        for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+            if(cols[k] == i)
+                diag[i] = norms[k];
+
+    auto strong = [&](int i, int k)
+    {
+        int j = cols[k];
+        return j != i && norms[k] > theta * std::sqrt(diag[i] * diag[j]);
+    };
+
+    aggregates.assign(rows, -1);
+    int count = 0;
+
+    for(int i = 0; i < rows; ++i)
+    {
+        bool has_strong = false;
+        bool free       = true;
+        for(int k = offsets[i]; k < offsets[i + 1] && free; ++k)
+        {
+            if(!strong(i, k))
+                continue;
+            has_strong = true;
+            free       = aggregates[cols[k]] < 0;
+        }
+        if(aggregates[i] >= 0 || !has_strong || !free)
+            continue;
+
+        aggregates[i] = count;
+        for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+            if(strong(i, k))
+                aggregates[cols[k]] = count;
+        ++count;
+    }
+
+    std::vector<int> first_pass = aggregates;
+    for(int i = 0; i < rows; ++i)
+    {
+        if(aggregates[i] >= 0)
+            continue;
+        for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+        {
+            if(strong(i, k) && first_pass[cols[k]] >= 0)
+            {
+                aggregates[i] = first_pass[cols[k]];
+                break;
+            }
+        }
+    }
+
+    for(int i = 0; i < rows; ++i)
+    {
+        if(aggregates[i] >= 0)
+            continue;
+
+        bool has_strong = false;
+        for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+        {
+            if(strong(i, k) && aggregates[cols[k]] < 0)
+            {
+                aggregates[cols[k]] = count;
+                has_strong          = true;
+            }
+        }
+        if(has_strong)
+            aggregates[i] = count++;
+    }
+
+    return count;
+}
+
+// start vector of the power iteration, the same on host and device
+template <typename T>
+MUDA_INLINE MUDA_GENERIC T amg_power_start(int i)
+{
+    return T{1} + T((static_cast<unsigned int>(i) * 7919u) % 97u) / T{97};
+}
+
+/**
+ * \brief The steps of one smoothing pass, step k does
+ * d = c_d * d + c_r * D^-1 (b - A x), x += d with {c_d, c_r} = steps[k].
+ *
+ * Jacobi: c_d = 0, c_r = jacobi_weight / rho. Chebyshev: the three-term
+ * recurrence (Saad, Alg. 12.1), restarted every sweep.
+ */
+template <typename T>
+std::vector<std::array<T, 2>> amg_smoother_steps(const LinearSystemAMGInfo& info, T rho)
+{
+    std::vector<std::array<T, 2>> steps;
+    if(!(rho > T{0}))
+        return steps;
+
+    for(int sweep = 0; sweep < info.sweeps; ++sweep)
+    {
+        if(info.smoother == LinearSystemAMGSmoother::Jacobi)
+        {
+            steps.push_back({T{0}, static_cast<T>(info.jacobi_weight) / rho});
+            continue;
+        }
+
+        T upper = static_cast<T>(info.chebyshev_upper) * rho;
+        T lower = static_cast<T>(info.chebyshev_lower) * rho;
+        T theta = (upper + lower) / 2;
+        T delta = (upper - lower) / 2;
+        T sigma = theta / delta;
+        T rho_k = T{1} / sigma;
+
+        steps.push_back({T{0}, T{1} / theta});
+        for(int k = 1; k < info.chebyshev_degree; ++k)
+        {
+            T rho_next = T{1} / (2 * sigma - rho_k);
+            steps.push_back({rho_next * rho_k, 2 * rho_next / delta});
+            rho_k = rho_next;
+        }
+    }
+    return steps;
+}
+
+/**
+ * \brief Host reference of the AMG V-cycle of `LinearSystemContext`, same
+ * aggregation, smoothers and coarse solve on scalar Eigen sparse matrices,
+ * for testing without a GPU.
+ */
+template <typename T, int N>
+class AMGReference
+{
+  public:
+    using SparseMatrix = Eigen::SparseMatrix<T, Eigen::RowMajor>;
+    using Vector       = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+    using DenseMatrix  = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+    using BlockMatrix  = Eigen::Matrix<T, N, N>;
+
+    class Level
+    {
+      public:
+        SparseMatrix                  A;
+        SparseMatrix                  P;  // to this level from the next one
+        SparseMatrix                  R;  // P^T
+        std::vector<BlockMatrix>      inv_diag;
+        std::vector<std::array<T, 2>> steps;
+        T                             rho = 0;
+    };
+
+    std::vector<Level>          levels;
+    bool                        dense_coarse = false;
+    Eigen::PartialPivLU<DenseMatrix> coarse;
+
+    void setup(SparseMatrix A, const LinearSystemAMGInfo& info = {})
+    {
+        levels.clear();
+        while(true)
+        {
+            Level& level = levels.emplace_back();
+            level.A      = std::move(A);
+            int rows     = level.A.rows() / N;
+
+            if(level.A.rows() <= info.coarse_size)
+                break;
+
+            std::vector<int> offsets;
+            std::vector<int> cols;
+            std::vector<T>   norms;
+            block_pattern(level, offsets, cols, norms);
+            level.rho   = spectral_radius(level, info.power_iterations);
+            level.steps = amg_smoother_steps<T>(info, level.rho);
+
+            if(static_cast<int>(levels.size()) == info.max_levels)
+                break;
+
+            std::vector<int> aggregates;
+            int              count = amg_aggregate<T>(
+                rows, offsets, cols, norms, static_cast<T>(info.strength_threshold), aggregates);
+            if(count == 0 || count == rows)
+                break;
+
+            // tentative prolongator: the block-constant vectors of each aggregate, normalized
+            std::vector<int> sizes(count, 0);
+            for(int J : aggregates)
+                if(J >= 0)
+                    ++sizes[J];
+
+            std::vector<Eigen::Triplet<T>> triplets;
+            for(int i = 0; i < rows; ++i)
+            {
+                int J = aggregates[i];
+                if(J < 0)
+                    continue;
+                for(int a = 0; a < N; ++a)
+                    triplets.emplace_back(i * N + a, J * N + a, T{1} / std::sqrt(T(sizes[J])));
+            }
+            SparseMatrix P_tentative(rows * N, count * N);
+            P_tentative.setFromTriplets(triplets.begin(), triplets.end());
+
+            triplets.clear();
+            for(int i = 0; i < rows; ++i)
+                for(int a = 0; a < N; ++a)
+                    for(int b = 0; b < N; ++b)
+                        triplets.emplace_back(i * N + a, i * N + b, level.inv_diag[i](a, b));
+            SparseMatrix inv_diag(rows * N, rows * N);
+            inv_diag.setFromTriplets(triplets.begin(), triplets.end());
+
+            T            omega = static_cast<T>(info.prolongation_weight) / level.rho;
+            SparseMatrix AP    = level.A * P_tentative;
+            SparseMatrix DAP   = inv_diag * AP;
+            level.P            = P_tentative - omega * DAP;
+            level.R            = level.P.transpose();
+
+            SparseMatrix RA = level.R * level.A;
+            A               = RA * level.P;
+        }
+
+        dense_coarse = levels.back().A.rows() <= info.coarse_size;
+        if(dense_coarse)
+            coarse.compute(DenseMatrix(levels.back().A));
+    }
+
+    // z = M^-1 r, one V-cycle
+    void apply(const Vector& r, Vector& z) const { vcycle(0, r, z); }
+
+  private:
+    void vcycle(size_t l, const Vector& b, Vector& x) const
+    {
+        const Level& level = levels[l];
+        bool         last  = l + 1 == levels.size();
+        if(last && dense_coarse)
+        {
+            x = coarse.solve(b);
+            return;
+        }
+
+        x.setZero(b.size());
+        smooth(level, b, x);
+        if(!last)
+        {
+            Vector r = b - level.A * x;
+            Vector b_coarse = level.R * r;
+            Vector x_coarse;
+            vcycle(l + 1, b_coarse, x_coarse);
+            x += level.P * x_coarse;
+        }
+        smooth(level, b, x);
+    }
+
+    void smooth(const Level& level, const Vector& b, Vector& x) const
+    {
+        Vector d = Vector::Zero(x.size());
+        for(auto& [c_d, c_r] : level.steps)
+        {
+            Vector r = b - level.A * x;
+            for(size_t i = 0; i < level.inv_diag.size(); ++i)
+            {
+                auto seg_d = d.template segment<N>(i * N);
+                seg_d = c_d * seg_d + c_r * level.inv_diag[i] * r.template segment<N>(i * N);
+            }
+            x += d;
+        }
+    }
+
+    // block norms of the (sorted) block pattern and the inverse diagonal blocks
+    static void block_pattern(Level& level, std::vector<int>& offsets, std::vector<int>& cols, std::vector<T>& norms)
+    {
+        int rows = level.A.rows() / N;
+        offsets.assign(1, 0);
+        cols.clear();
+        norms.clear();
+        level.inv_diag.assign(rows, BlockMatrix::Zero());
+
+        for(int I = 0; I < rows; ++I)
+        {
+            std::map<int, T> squares;
+            for(int a = 0; a < N; ++a)
+            {
+                for(typename SparseMatrix::InnerIterator it(level.A, I * N + a); it; ++it)
+                {
+                    squares[it.col() / N] += it.value() * it.value();
+                    if(it.col() / N == I)
+                        level.inv_diag[I](a, it.col() % N) = it.value();
+                }
+            }
+            for(auto& [J, square] : squares)
+            {
+                cols.push_back(J);
+                norms.push_back(std::sqrt(square));
+            }
+            offsets.push_back(cols.size());
+            level.inv_diag[I] = level.inv_diag[I].inverse().eval();
+        }
+    }
+
+    static T spectral_radius(const Level& level, int iterations)
+    {
+        int    n = level.A.rows();
+        Vector v(n);
+        for(int i = 0; i < n; ++i)
+            v(i) = amg_power_start<T>(i);
+        v /= v.norm();
+
+        T rho = 0;
+        for(int k = 0; k < iterations; ++k)
+        {
+            Vector w = level.A * v;
+            for(size_t i = 0; i < level.inv_diag.size(); ++i)
+                w.template segment<N>(i * N) = level.inv_diag[i] * w.template segment<N>(i * N);
+            rho = w.norm();
+            if(!(rho > T{0}))
+                break;
+            v = w / rho;
+        }
+        return rho;
+    }
+};
+}  // namespace muda::details::linear_system
@@ -3,7 +3,10 @@
 #include <cusparse_v2.h>
 #include <cusolverDn.h>
 #include <cusolverSp.h>
+#include <array>
 #include <list>
+#include <memory>
+#include <unordered_map>
 #include <muda/buffer/device_buffer.h>
 #include <muda/literal/unit.h>
 #include <muda/mstl/span.h>
@@ -13,6 +16,12 @@
 #include <muda/ext/linear_system/linear_system_handles.h>
 #include <muda/ext/linear_system/linear_system_solve_tolerance.h>
 #include <muda/ext/linear_system/linear_system_solve_reorder.h>
+#include <muda/ext/linear_system/linear_system_spmv_policy.h>
+#include <muda/ext/linear_system/linear_system_amg.h>
+#include <muda/ext/linear_system/linear_system_pcg.h>
+#include <muda/ext/linear_system/linear_system_refine.h>
+#include <muda/ext/linear_system/linear_system_io.h>
+#include <muda/ext/linear_system/linear_system_factorization.h>
 namespace muda
 {
 class LinearSystemContextCreateInfo
@@ -53,8 +62,12 @@ class LinearSystemContext
 
     LinearSystemSolveTolerance m_tolerance;
     LinearSystemSolveReorder   m_reorder;
+    LinearSystemSpMVPolicy     m_spmv_policy;
     MatrixFormatConverter      m_converter;
 
+    std::unordered_map<uint64_t, std::unique_ptr<details::linear_system::SparseFactorizationBase>> m_factorizations;
+    std::unordered_map<uint64_t, std::unique_ptr<details::linear_system::AMGHierarchyBase>> m_amg_hierarchies;
+
   private:
     auto cublas() const { return m_handles.cublas(); }
     auto cusparse() const { return m_handles.cusparse(); }
@@ -81,6 +94,7 @@ class LinearSystemContext
 
     auto& tolerance() { return m_tolerance; }
     auto& reorder() { return m_reorder; }
+    auto& spmv_policy() { return m_spmv_policy; }
     auto  reserve_ratio() const { return m_handles.m_reserve_ratio; }
     void  reserve_ratio(float ratio) { m_handles.m_reserve_ratio = ratio; }
 
@@ -93,6 +107,22 @@ class LinearSystemContext
     template <typename T, int N>
     void convert(const DeviceTripletMatrix<T, N>& from, DeviceBCOOMatrix<T, N>& to);
 
+    // Triplet -> BCOO, keep the sort permutation and the segments as `pattern_id`
+    template <typename T, int N>
+    void convert(const DeviceTripletMatrix<T, N>& from,
+                 DeviceBCOOMatrix<T, N>&          to,
+                 uint64_t                         pattern_id);
+
+    // Triplet -> BCOO for a matrix with the same indices as the one
+    // `pattern_id` was made from (e.g. the next Newton iteration), no sort
+    template <typename T, int N>
+    void convert_values_only(const DeviceTripletMatrix<T, N>& from,
+                             DeviceBCOOMatrix<T, N>&          to,
+                             uint64_t                         pattern_id);
+
+    template <typename T, int N>
+    void release_pattern(uint64_t pattern_id);
+
     // BCOO -> Dense Matrix
     template <typename T, int N>
     void convert(const DeviceBCOOMatrix<T, N>& from,
@@ -200,6 +230,36 @@ class LinearSystemContext
     template <typename T>
     void plus(CDenseVectorView<T> x, CDenseVectorView<T> y, DenseVectorView<T> z);
 
+    /***********************************************************************************************
+                                           Fused Krylov
+                      one pass over the vectors, the results stay on the device
+    ***********************************************************************************************/
+    // y += alpha * x, y_dot_y = y . y
+    template <typename T>
+    void axpy_dot(const T& alpha, CDenseVectorView<T> x, DenseVectorView<T> y, VarView<T> y_dot_y);
+    template <typename T>
+    void axpy_dot(CVarView<T> alpha, CDenseVectorView<T> x, DenseVectorView<T> y, VarView<T> y_dot_y);
+    // results[k] = xs[k] . ys[k], all the dots in one pass
+    template <typename T, size_t M>
+    void multi_dot(const std::array<CDenseVectorView<T>, M>& xs,
+                   const std::array<CDenseVectorView<T>, M>& ys,
+                   std::array<VarView<T>, M>                 results);
+    // CG update: x += alpha * p, r -= alpha * Ap, r_dot_r = r . r
+    template <typename T>
+    void update_xr(const T&            alpha,
+                   CDenseVectorView<T> p,
+                   CDenseVectorView<T> Ap,
+                   DenseVectorView<T>  x,
+                   DenseVectorView<T>  r,
+                   VarView<T>          r_dot_r);
+    template <typename T>
+    void update_xr(CVarView<T>         alpha,
+                   CDenseVectorView<T> p,
+                   CDenseVectorView<T> Ap,
+                   DenseVectorView<T>  x,
+                   DenseVectorView<T>  r,
+                   VarView<T>          r_dot_r);
+
     /***********************************************************************************************
                                                 Spmv
                                         y = a * A * x + b * y
@@ -227,12 +287,78 @@ class LinearSystemContext
               DenseVectorView<T>&      y);
     template <typename T, int N>
     void spmv(CTripletMatrixView<T, N> A, CDenseVectorView<T> x, DenseVectorView<T> y);
+    // BCOO, row-sorted and unique blocks (as made by convert()): warp-level
+    // segmented reduction, atomics only for rows crossing a warp boundary.
+    // Blocks out of row order make lanes of one warp race on y: checked
+    // when DEBUG_VIEWER is on, pass A.cview() (the triplet path) instead
+    // for an unsorted A
+    template <typename T, int N>
+    void spmv(const T&                      a,
+              const DeviceBCOOMatrix<T, N>& A,
+              CDenseVectorView<T>           x,
+              const T&                      b,
+              DenseVectorView<T>&           y);
+    template <typename T, int N>
+    void spmv(const DeviceBCOOMatrix<T, N>& A, CDenseVectorView<T> x, DenseVectorView<T> y);
     // COO
     template <typename T>
     void spmv(const T& a, CCOOMatrixView<T> A, CDenseVectorView<T> x, const T& b, DenseVectorView<T>& y);
     template <typename T>
     void spmv(CCOOMatrixView<T> A, CDenseVectorView<T> x, DenseVectorView<T> y);
 
+    /***********************************************************************************************
+                                                Spmm
+                                        Y = a * A * X + b * Y
+    ***********************************************************************************************/
+    // X and Y are column major (e.g. DeviceDenseMatrix), one column per right-hand
+    // side, each block of A is read once for all the columns
+    // BSR: warp per block row, the blocks are staged in shared memory, see spmv_policy()
+    template <typename T, int N>
+    void spmm(const T&             a,
+              CBSRMatrixView<T, N> A,
+              CDenseMatrixView<T>  X,
+              const T&             b,
+              DenseMatrixView<T>   Y);
+    template <typename T, int N>
+    void spmm(CBSRMatrixView<T, N> A, CDenseMatrixView<T> X, DenseMatrixView<T> Y);
+    // CSR
+    template <typename T>
+    void spmm(const T& a, CCSRMatrixView<T> A, CDenseMatrixView<T> X, const T& b, DenseMatrixView<T> Y);
+    template <typename T>
+    void spmm(CCSRMatrixView<T> A, CDenseMatrixView<T> X, DenseMatrixView<T> Y);
+    // BCOO & Triplet
+    template <typename T, int N>
+    void spmm(const T&                 a,
+              CTripletMatrixView<T, N> A,
+              CDenseMatrixView<T>      X,
+              const T&                 b,
+              DenseMatrixView<T>       Y);
+    template <typename T, int N>
+    void spmm(CTripletMatrixView<T, N> A, CDenseMatrixView<T> X, DenseMatrixView<T> Y);
+    // BCOO, row-sorted and unique blocks (as made by convert()): warp-level segmented reduction
+    template <typename T, int N>
+    void spmm(const T&                      a,
+              const DeviceBCOOMatrix<T, N>& A,
+              CDenseMatrixView<T>           X,
+              const T&                      b,
+              DenseMatrixView<T>            Y);
+    template <typename T, int N>
+    void spmm(const DeviceBCOOMatrix<T, N>& A, CDenseMatrixView<T> X, DenseMatrixView<T> Y);
+
+    /***********************************************************************************************
+                                            Block Vectors
+                                the columns of X and Y are the vectors
+    ***********************************************************************************************/
+    // results(k) = X.col(k) . Y.col(k), the results stay on the device
+    template <typename T>
+    void dot(CDenseMatrixView<T> X, CDenseMatrixView<T> Y, DenseVectorView<T> results);
+    // Y = alpha * X + beta * Y
+    template <typename T>
+    void axpby(const T& alpha, CDenseMatrixView<T> X, const T& beta, DenseMatrixView<T> Y);
+    // Y.col(k) = alpha(k) * X.col(k) + beta(k) * Y.col(k)
+    template <typename T>
+    void axpby(CDenseVectorView<T> alpha, CDenseMatrixView<T> X, CDenseVectorView<T> beta, DenseMatrixView<T> Y);
+
 
     /***********************************************************************************************
                                                  Mv
@@ -266,7 +392,148 @@ class LinearSystemContext
     template <typename T>
     void solve(DenseVectorView<T> x, CCSRMatrixView<T> A, CDenseVectorView<T> b);
 
+    /***********************************************************************************************
+                                       Factorized Sparse Solve
+              analyze once per pattern, factorize once per matrix, solve once per right-hand side
+    ***********************************************************************************************/
+    // fill-reducing reordering (reorder()) and symbolic factorization of the pattern
+    // of A, kept as `pattern_id` (an existing factorization with this id is replaced,
+    // which synchronizes the stream first)
+    template <typename T>
+    void analyze(CCSRMatrixView<T>               A,
+                 uint64_t                        pattern_id,
+                 LinearSystemFactorizationMethod method = LinearSystemFactorizationMethod::Cholesky);
+    // numeric factorization of A, which must have the pattern `pattern_id` was analyzed with,
+    // false (and a warning) if A is not SPD (Cholesky), synchronizes the stream.
+    // QR: cuSOLVER has no separate numeric QR, this only takes the values, solve() factorizes
+    template <typename T>
+    bool factorize(CCSRMatrixView<T> A, uint64_t pattern_id);
+    // solve Ax = b with the last factorize() of `pattern_id`
+    template <typename T>
+    void solve(DenseVectorView<T> x, CDenseVectorView<T> b, uint64_t pattern_id);
+    void release_factorization(uint64_t pattern_id);
+
+    /***********************************************************************************************
+                                          Refined Solve
+                        A * x = b in double, factorized/solved in float
+    ***********************************************************************************************/
+    // x holds the initial guess and receives the solution, synchronizes the stream.
+    // Dense: A is copied to float and factorized once (Cholesky if A.is_sym(), LU if
+    // that fails, e.g. for a symmetric indefinite A, or if A is not symmetric)
+    LinearSystemRefineResult solve_refined(DenseVectorView<double>       x,
+                                           CDenseMatrixView<double>      A,
+                                           CDenseVectorView<double>      b,
+                                           const LinearSystemRefineInfo& info = {});
+    // Sparse: a float copy of A is factorized once with `info.sparse_method`
+    // (QR: cuSOLVER has no separate numeric QR, only the analysis is reused)
+    LinearSystemRefineResult solve_refined(DenseVectorView<double>       x,
+                                           CCSRMatrixView<double>        A,
+                                           CDenseVectorView<double>      b,
+                                           const LinearSystemRefineInfo& info = {});
+
+    /***********************************************************************************************
+                                                 AMG
+                   smoothed aggregation algebraic multigrid, as a preconditioner of A (SPD)
+    ***********************************************************************************************/
+    // build the hierarchy of A (A is copied), kept as `hierarchy_id` (an existing hierarchy
+    // with this id is replaced). The aggregation runs on the host from the block norms,
+    // the Galerkin products P^T A P use cuSPARSE SpGEMM. Synchronizes the stream.
+    template <typename T, int N>
+    void amg_setup(CBSRMatrixView<T, N> A, uint64_t hierarchy_id, const LinearSystemAMGInfo& info = {});
+    template <typename T, int N>
+    void amg_setup(const DeviceBCOOMatrix<T, N>& A,
+                   uint64_t                      hierarchy_id,
+                   const LinearSystemAMGInfo&    info = {});
+    // z = M^-1 r, one V-cycle of `hierarchy_id`
+    template <typename T>
+    void amg_apply(uint64_t hierarchy_id, CDenseVectorView<T> r, DenseVectorView<T> z);
+    bool has_amg(uint64_t hierarchy_id) const;
+    void release_amg(uint64_t hierarchy_id);
+
+    /***********************************************************************************************
+                                                 PCG
+                                        A * x = b, A is SPD
+    ***********************************************************************************************/
+    // x holds the initial guess and receives the solution, synchronizes the stream
+    template <typename T, int N>
+    LinearSystemPCGResult pcg(CBSRMatrixView<T, N>       A,
+                              DenseVectorView<T>         x,
+                              CDenseVectorView<T>        b,
+                              const LinearSystemPCGInfo& info = {});
+    template <typename T>
+    LinearSystemPCGResult pcg(CCSRMatrixView<T>          A,
+                              DenseVectorView<T>         x,
+                              CDenseVectorView<T>        b,
+                              const LinearSystemPCGInfo& info = {});
+    template <typename T, int N>
+    LinearSystemPCGResult pcg(CTripletMatrixView<T, N>   A,
+                              DenseVectorView<T>         x,
+                              CDenseVectorView<T>        b,
+                              const LinearSystemPCGInfo& info = {});
+
+    /***********************************************************************************************
+                                           Matrix Market
+                    `.mtxb` paths use the binary format (mmap), other paths the text format
+    ***********************************************************************************************/
+    // Text: real/integer/pattern coordinate files, general/symmetric/skew-symmetric
+    // (mirrored entries appended), streamed in chunks and parsed by `info.threads`.
+    // N > 1: one block per scalar entry, convert() to merge them; block matrices
+    // written to `.mtxb` keep their blocks.
+    // false (and a warning) on failure, A/x is cleared then. Synchronizes the stream.
+    template <typename T, int N>
+    bool read_matrix_market(std::string_view           path,
+                            DeviceTripletMatrix<T, N>& A,
+                            const LinearSystemIOInfo&  info = {});
+    // converted to BCOO, unless written from a BCOO/CSR matrix to `.mtxb`
+    template <typename T, int N>
+    bool read_matrix_market(std::string_view          path,
+                            DeviceBCOOMatrix<T, N>&   A,
+                            const LinearSystemIOInfo& info = {});
+    template <typename T>
+    bool read_matrix_market(std::string_view          path,
+                            DeviceCSRMatrix<T>&       A,
+                            const LinearSystemIOInfo& info = {});
+    // Text: array format, one row or column
+    template <typename T>
+    bool read_matrix_market(std::string_view          path,
+                            DeviceDenseVector<T>&     x,
+                            const LinearSystemIOInfo& info = {});
+
+    // Text: all N * N entries of each block, values in shortest round-trip form
+    template <typename T, int N>
+    bool write_matrix_market(std::string_view                 path,
+                             const DeviceTripletMatrix<T, N>& A,
+                             const LinearSystemIOInfo&        info = {});
+    template <typename T, int N>
+    bool write_matrix_market(std::string_view              path,
+                             const DeviceBCOOMatrix<T, N>& A,
+                             const LinearSystemIOInfo&     info = {});
+    template <typename T>
+    bool write_matrix_market(std::string_view          path,
+                             const DeviceCSRMatrix<T>& A,
+                             const LinearSystemIOInfo& info = {});
+    template <typename T>
+    bool write_matrix_market(std::string_view            path,
+                             const DeviceDenseVector<T>& x,
+                             const LinearSystemIOInfo&   info = {});
+
   private:
+    template <typename T>
+    details::linear_system::SparseFactorization<T>& factorization(uint64_t pattern_id);
+    // analyze()/factorize()/solve() on a factorization not kept by id
+    template <typename T>
+    std::unique_ptr<details::linear_system::SparseFactorization<T>> sparse_analyze(
+        CCSRMatrixView<T> A, LinearSystemFactorizationMethod method);
+    template <typename T>
+    bool sparse_factorize(details::linear_system::SparseFactorization<T>& f, CCSRMatrixView<T> A);
+    template <typename T>
+    void sparse_solve(details::linear_system::SparseFactorization<T>& f,
+                      DenseVectorView<T>                              x,
+                      CDenseVectorView<T>                             b);
+    template <typename T>
+    details::linear_system::AMGPreconditioner<T>& amg_hierarchy(uint64_t hierarchy_id);
+    template <typename T, int N>
+    void amg_build(details::linear_system::AMGHierarchy<T, N>& hierarchy, const LinearSystemAMGInfo& info);
     template <typename T>
     void generic_spmv(const T&                  a,
                       cusparseOperation_t       op,
@@ -275,6 +542,13 @@ class LinearSystemContext
                       const T&                  b,
                       cusparseDnVecDescr_t      y);
     template <typename T>
+    void generic_spmm(const T&             a,
+                      cusparseOperation_t  op,
+                      cusparseSpMatDescr_t A,
+                      CDenseMatrixView<T>  X,
+                      const T&             b,
+                      DenseMatrixView<T>   Y);
+    template <typename T>
     void sysv(DenseMatrixView<T> A_to_fact, DenseVectorView<T> b_to_x);
     template <typename T>
     void gesv(DenseMatrixView<T> A_to_fact, DenseVectorView<T> b_to_x);
@@ -286,7 +560,11 @@ class LinearSystemContext
 #include "details/routines/norm.inl"
 #include "details/routines/dot.inl"
 #include "details/routines/axpby.inl"
+#include "details/routines/fused.inl"
 #include "details/routines/spmv.inl"
 #include "details/routines/mv.inl"
 #include "details/routines/solve.inl"
+#include "details/routines/pcg.inl"
+#include "details/routines/amg.inl"
 #include "details/routines/mm.inl"
+#include "details/routines/io.inl"
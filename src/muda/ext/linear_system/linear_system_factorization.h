@@ -0,0 +1,23 @@
+#pragma once
+
+namespace muda
+{
+enum class LinearSystemFactorizationMethod
+{
+    Cholesky = 0,  // A = L * L^T, A is SPD
+    QR       = 1,  // A = Q * R, any non-singular A
+};
+}  // namespace muda
+
+namespace muda::details::linear_system
+{
+// kept by LinearSystemContext per pattern id, see analyze()
+class SparseFactorizationBase
+{
+  public:
+    virtual ~SparseFactorizationBase() = default;
+};
+
+template <typename T>
+class SparseFactorization;
+}  // namespace muda::details::linear_system
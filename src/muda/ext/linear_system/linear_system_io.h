@@ -0,0 +1,15 @@
+#pragma once
+#include <muda/literal/unit.h>
+
+namespace muda
+{
+class LinearSystemIOInfo
+{
+  public:
+    // text read/written per step, the host never holds more of the file than
+    // this (plus two pinned staging buffers for the entries of one step)
+    size_t chunk_byte_size = 4_M;
+    // threads parsing/formatting numbers, 0: all hardware threads
+    int threads = 0;
+};
+}  // namespace muda
@@ -0,0 +1,171 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <Eigen/Dense>
+#include <muda/ext/linear_system/linear_system_amg.h>
+
+namespace muda
+{
+enum class LinearSystemPreconditioner
+{
+    None,
+    // inverse of the diagonal
+    Jacobi,
+    // inverse of the N x N diagonal blocks (same as Jacobi for CSR)
+    BlockJacobi,
+    // one V-cycle of smoothed aggregation AMG (BSR only), see LinearSystemPCGInfo::amg
+    AMG,
+};
+
+class LinearSystemPCGInfo
+{
+  public:
+    int max_iterations = 1000;
+    // converged if |r| <= max(rel_tolerance * |b|, abs_tolerance)
+    double rel_tolerance = 1e-6;
+    double abs_tolerance = 0.0;
+
+    LinearSystemPreconditioner preconditioner = LinearSystemPreconditioner::BlockJacobi;
+
+    // AMG: the hierarchy `amg_hierarchy_id` is built from A with `amg` (see
+    // LinearSystemContext::amg_setup()) and kept, `amg_reuse` skips the setup
+    // if it already exists (e.g. solving with another right-hand side)
+    LinearSystemAMGInfo amg;
+    uint64_t            amg_hierarchy_id = 0;
+    bool                amg_reuse        = false;
+
+    // the convergence is decided on the device, the host reads the flag
+    // every `check_interval` iterations (one small readback), the
+    // iterations after the convergence are skipped on the device
+    int check_interval = 8;
+};
+
+class LinearSystemPCGResult
+{
+  public:
+    bool   converged     = false;
+    int    iterations    = 0;
+    double residual_norm = 0.0;  // |b - A x|, as tracked by the iteration
+};
+
+namespace details::linear_system
+{
+    /**
+     * \brief Host reference of `LinearSystemContext::pcg()`, same iteration
+     * and preconditioners, for testing without a GPU.
+     *
+     * A is given as block triplets (duplicates are summed), x holds the
+     * initial guess and receives the solution.
+     */
+    template <typename T, int N>
+    LinearSystemPCGResult pcg_reference(int                                     block_rows,
+                                        const std::vector<int>&                 row_indices,
+                                        const std::vector<int>&                 col_indices,
+                                        const std::vector<Eigen::Matrix<T, N, N>>& blocks,
+                                        std::vector<T>&                         x,
+                                        const std::vector<T>&                   b,
+                                        const LinearSystemPCGInfo&              info = {})
+    {
+        using Vector      = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+        using BlockMatrix = Eigen::Matrix<T, N, N>;
+
+        const int n = block_rows * N;
+
+        auto spmv = [&](const Vector& in, Vector& out)
+        {
+            out.setZero(n);
+            for(size_t k = 0; k < blocks.size(); ++k)
+                out.template segment<N>(row_indices[k] * N) +=
+                    blocks[k] * in.template segment<N>(col_indices[k] * N);
+        };
+
+        // preconditioner
+        std::vector<BlockMatrix> diag(block_rows, BlockMatrix::Zero());
+        for(size_t k = 0; k < blocks.size(); ++k)
+            if(row_indices[k] == col_indices[k])
+                diag[row_indices[k]] += blocks[k];
+        std::vector<BlockMatrix> inv_diag(block_rows, BlockMatrix::Identity());
+        for(int i = 0; i < block_rows; ++i)
+        {
+            if(info.preconditioner == LinearSystemPreconditioner::Jacobi)
+            {
+                inv_diag[i].setZero();
+                for(int j = 0; j < N; ++j)
+                    inv_diag[i](j, j) = diag[i](j, j) != T{0} ? T{1} / diag[i](j, j) : T{1};
+            }
+            else if(info.preconditioner == LinearSystemPreconditioner::BlockJacobi)
+            {
+                inv_diag[i] = diag[i].inverse();
+            }
+        }
+        AMGReference<T, N> amg;
+        if(info.preconditioner == LinearSystemPreconditioner::AMG)
+        {
+            std::vector<Eigen::Triplet<T>> triplets;
+            for(size_t k = 0; k < blocks.size(); ++k)
+                for(int a = 0; a < N; ++a)
+                    for(int c = 0; c < N; ++c)
+                        triplets.emplace_back(
+                            row_indices[k] * N + a, col_indices[k] * N + c, blocks[k](a, c));
+            typename AMGReference<T, N>::SparseMatrix A(n, n);
+            A.setFromTriplets(triplets.begin(), triplets.end());
+            amg.setup(std::move(A), info.amg);
+        }
+
+        auto precondition = [&](const Vector& in, Vector& out)
+        {
+            if(info.preconditioner == LinearSystemPreconditioner::AMG)
+            {
+                amg.apply(in, out);
+                return;
+            }
+            out.resize(n);
+            for(int i = 0; i < block_rows; ++i)
+                out.template segment<N>(i * N) = inv_diag[i] * in.template segment<N>(i * N);
+        };
+
+        Vector vx = Eigen::Map<const Vector>(x.data(), n);
+        Vector vb = Eigen::Map<const Vector>(b.data(), n);
+        Vector r, z, p, Ap;
+
+        spmv(vx, Ap);
+        r = vb - Ap;
+        precondition(r, z);
+        p = z;
+
+        T    rz        = r.dot(z);
+        T    rr        = r.dot(r);
+        auto tol       = std::max(info.rel_tolerance * std::sqrt(double(vb.dot(vb))),
+                            info.abs_tolerance);
+        T    threshold = static_cast<T>(tol * tol);
+
+        LinearSystemPCGResult result;
+        result.converged = rr <= threshold;
+        while(!result.converged && result.iterations < info.max_iterations)
+        {
+            spmv(p, Ap);
+            T pAp = p.dot(Ap);
+            if(!(pAp > T{0}))  // breakdown (not SPD)
+                break;
+            T alpha = rz / pAp;
+            vx += alpha * p;
+            r -= alpha * Ap;
+            rr = r.dot(r);
+            precondition(r, z);
+            T rz_new = r.dot(z);
+            T beta   = rz_new / rz;
+            rz       = rz_new;
+            p        = z + beta * p;
+
+            ++result.iterations;
+            result.converged = rr <= threshold;
+        }
+
+        result.residual_norm = std::sqrt(double(rr));
+        Eigen::Map<Vector>(x.data(), n) = vx;
+        return result;
+    }
+}  // namespace details::linear_system
+}  // namespace muda
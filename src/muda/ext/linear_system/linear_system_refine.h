@@ -0,0 +1,26 @@
+#pragma once
+#include <muda/ext/linear_system/linear_system_factorization.h>
+
+namespace muda
+{
+class LinearSystemRefineInfo
+{
+  public:
+    // refinement steps (each step is one low precision solve)
+    int max_iterations = 10;
+    // converged if |b - A x| <= max(rel_tolerance * |b|, abs_tolerance), in double
+    double rel_tolerance = 1e-12;
+    double abs_tolerance = 0.0;
+    // CSR A: Cholesky (A is SPD, factorized once) or QR (any non-singular A,
+    // refactorized by each step)
+    LinearSystemFactorizationMethod sparse_method = LinearSystemFactorizationMethod::Cholesky;
+};
+
+class LinearSystemRefineResult
+{
+  public:
+    bool   converged     = false;
+    int    iterations    = 0;    // low precision solves done
+    double residual_norm = 0.0;  // |b - A x| of the returned x
+};
+}  // namespace muda
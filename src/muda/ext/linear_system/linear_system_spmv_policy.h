@@ -0,0 +1,68 @@
+#pragma once
+
+namespace muda
+{
+enum class LinearSystemBSRSpMVAlgorithm
+{
+    // custom kernel if supported and expected to be faster, else cuSPARSE
+    Auto     = 0,
+    Custom   = 1,
+    CuSparse = 2,
+};
+
+class LinearSystemSpMVPolicy
+{
+    LinearSystemBSRSpMVAlgorithm m_bsr_algorithm = LinearSystemBSRSpMVAlgorithm::Auto;
+    int                          m_auto_max_block_dim = 8;
+
+  public:
+    // the custom BSR kernel stages whole blocks in shared memory, larger
+    // blocks leave too few warps per SM
+    static constexpr int max_custom_bsr_block_dim = 8;
+
+    LinearSystemBSRSpMVAlgorithm bsr_algorithm() const
+    {
+        return m_bsr_algorithm;
+    }
+    void bsr_algorithm(LinearSystemBSRSpMVAlgorithm algorithm)
+    {
+        m_bsr_algorithm = algorithm;
+    }
+
+    // `Auto` uses the custom kernel up to this block size
+    int  auto_max_block_dim() const { return m_auto_max_block_dim; }
+    void auto_max_block_dim(int N) { m_auto_max_block_dim = N; }
+
+    // the custom kernel does y = a * A * x + b * y for non-transposed A
+    // with N <= max_custom_bsr_block_dim. `Custom` silently falls back to
+    // cuSPARSE outside of that (transposed A or N > 8), it is a preference,
+    // not a guarantee
+    bool use_custom_bsr(int N, bool trans, int block_rows, int non_zero_blocks) const
+    {
+        if(trans || N > max_custom_bsr_block_dim || block_rows == 0)
+            return false;
+
+        switch(m_bsr_algorithm)
+        {
+            case LinearSystemBSRSpMVAlgorithm::Custom:
+                return true;
+            case LinearSystemBSRSpMVAlgorithm::CuSparse:
+                return false;
+            default:
+                // one warp per block row: nearly empty rows idle most lanes,
+                // cuSPARSE spreads them better
+                return N <= m_auto_max_block_dim && non_zero_blocks >= 2 * block_rows;
+        }
+    }
+
+    // SpMM: the lanes of the custom kernel own (component, column) pairs of
+    // the outputs, not blocks, so `Auto` always takes it; cusparse<t>bsrmm
+    // is kept for `CuSparse`
+    bool use_custom_bsr_spmm(int N, bool trans) const
+    {
+        if(trans || N > max_custom_bsr_block_dim)
+            return false;
+        return m_bsr_algorithm != LinearSystemBSRSpMVAlgorithm::CuSparse;
+    }
+};
+}  // namespace muda
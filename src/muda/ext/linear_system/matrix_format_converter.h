@@ -66,6 +66,23 @@ class MatrixFormatConverter
     template <typename T, int N>
     void convert(const DeviceTripletMatrix<T, N>& from, DeviceBCOOMatrix<T, N>& to);
 
+    // Triplet -> BCOO, keep the sort permutation and the segments of `from`
+    // as `pattern_id` (an existing pattern with this id is replaced)
+    template <typename T, int N>
+    void convert(const DeviceTripletMatrix<T, N>& from,
+                 DeviceBCOOMatrix<T, N>&          to,
+                 uint64_t                         pattern_id);
+
+    // Triplet -> BCOO, the indices of `from` must be the ones `pattern_id` was
+    // made from (only the values changed), no sort: one gather + sum kernel
+    template <typename T, int N>
+    void convert_values_only(const DeviceTripletMatrix<T, N>& from,
+                             DeviceBCOOMatrix<T, N>&          to,
+                             uint64_t                         pattern_id);
+
+    template <typename T, int N>
+    void release_pattern(uint64_t pattern_id);
+
     // BCOO -> Dense Matrix
     template <typename T, int N>
     void convert(const DeviceBCOOMatrix<T, N>& from,
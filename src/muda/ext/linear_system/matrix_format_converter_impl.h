@@ -1,4 +1,5 @@
 #pragma once
+#include <unordered_map>
 #include <muda/ext/linear_system/linear_system_handles.h>
 #include <muda/ext/linear_system/device_dense_matrix.h>
 #include <muda/ext/linear_system/device_dense_vector.h>
@@ -77,6 +78,21 @@ namespace details
 
         muda::DeviceBuffer<T> unique_values;
 
+        // sort permutation and segments of a Triplet -> BCOO conversion
+        class TripletPattern
+        {
+          public:
+            int    block_rows    = 0;
+            int    block_cols    = 0;
+            size_t triplet_count = 0;
+
+            muda::DeviceBuffer<int> sort_index;  // sorted position -> triplet
+            muda::DeviceBuffer<int> offsets;  // unique block -> [begin, end) in sort_index
+            muda::DeviceBuffer<int> row_indices;  // unique block indices
+            muda::DeviceBuffer<int> col_indices;
+        };
+        std::unordered_map<uint64_t, TripletPattern> triplet_patterns;
+
       public:
         MatrixFormatConverter(LinearSystemHandles& handles)
             : MatrixFormatConverterBase(handles, cuda_data_type<T>(), N)
@@ -96,6 +112,16 @@ namespace details
         void make_unique_blocks(const DeviceTripletMatrix<T, N>& from,
                                 DeviceBCOOMatrix<T, N>&          to);
 
+        // Triplet -> BCOO, keep the pattern as `pattern_id`
+        void convert(const DeviceTripletMatrix<T, N>& from,
+                     DeviceBCOOMatrix<T, N>&          to,
+                     uint64_t                         pattern_id);
+        // Triplet -> BCOO, reuse the pattern `pattern_id`
+        void convert_values_only(const DeviceTripletMatrix<T, N>& from,
+                                 DeviceBCOOMatrix<T, N>&          to,
+                                 uint64_t                         pattern_id);
+        void release_pattern(uint64_t pattern_id);
+
 
         // BCOO -> Dense Matrix
         void convert(const DeviceBCOOMatrix<T, N>& from,
@@ -9,5 +9,6 @@ class LinearSystemAlgorithm
   public:
     // convert for compatibility
     constexpr static cusparseSpMVAlg_t SPMV_ALG_DEFAULT = (cusparseSpMVAlg_t)0;
+    constexpr static cusparseSpMMAlg_t SPMM_ALG_DEFAULT = (cusparseSpMMAlg_t)0;
 };
 }  // namespace muda
\ No newline at end of file
@@ -29,6 +29,8 @@ MUDA_INLINE void GraphExec::upload(cudaStream_t stream)
 
 MUDA_INLINE void GraphExec::launch(cudaStream_t stream)
 {
+    // names recorded while building the graph
+    details::LaunchInfoCache::flush();
     checkCudaErrors(cudaGraphLaunch(m_handle, stream));
 }
 
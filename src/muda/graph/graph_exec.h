@@ -4,6 +4,7 @@
 #include <muda/graph/memory_node.h>
 #include <muda/graph/event_node.h>
 #include <muda/graph/graph_viewer.h>
+#include <muda/tools/launch_info_cache.h>
 
 namespace muda
 {
@@ -130,10 +130,13 @@ MUDA_HOST void Launch::invoke(F&& f)
 {
     check_input();
 
+    details::LaunchInfoCache::flush();
+
     using CallableType = raw_type_t<F>;
     auto callable = details::LaunchCallable<CallableType>{std::forward<F>(f), dim3{0}};
     details::generic_kernel<CallableType, UserTag>
         <<<m_grid_dim, m_block_dim, m_shared_mem_size, m_stream>>>(callable);
+    scan_non_finite();
 }
 
 template <typename F, typename UserTag>
@@ -142,11 +145,13 @@ MUDA_HOST void Launch::invoke(const dim3& active_dim, F&& f)
     check_input_with_range();
 
     dim3 grid_dim = calculate_grid_dim(active_dim);
+    details::LaunchInfoCache::flush();
 
     using CallableType = raw_type_t<F>;
     auto callable = details::LaunchCallable<CallableType>{std::forward<F>(f), active_dim};
     details::generic_kernel_with_range<CallableType, UserTag>
         <<<grid_dim, m_block_dim, m_shared_mem_size, m_stream>>>(callable);
+    scan_non_finite();
 }
 
 template <typename F, typename UserTag>
@@ -134,13 +134,13 @@ MUDA_INLINE void LaunchCore::wait(const ComputeGraphVar<cudaEvent_t>& e,
 
 MUDA_INLINE void LaunchCore::kernel_name(std::string_view name)
 {
-    if constexpr(muda::RUNTIME_CHECK_ON)
+    if constexpr(muda::CHECK_NAMES_ON)
         details::LaunchInfoCache::current_kernel_name(name);
 }
 
 MUDA_INLINE std::string_view muda::LaunchCore::kernel_name()
 {
-    if constexpr(muda::RUNTIME_CHECK_ON)
+    if constexpr(muda::CHECK_NAMES_ON)
         return details::LaunchInfoCache::current_kernel_name().host_string;
     else
         return "";
@@ -148,12 +148,22 @@ MUDA_INLINE std::string_view muda::LaunchCore::kernel_name()
 
 MUDA_INLINE MUDA_HOST void LaunchCore::pop_kernel_name()
 {
-#if MUDA_CHECK_ON
+#if MUDA_CHECK_LEVEL >= 2
     details::LaunchInfoCache::current_kernel_name("");
 #endif
 }
 
 
+MUDA_INLINE MUDA_HOST void LaunchCore::scan_non_finite()
+{
+#if MUDA_NON_FINITE_CHECK
+    if(m_check_non_finite)
+        NonFiniteSentinel::scan_watched(m_stream, kernel_name().data());
+    else
+        NonFiniteSentinel::drop_watched();
+#endif
+}
+
 MUDA_INLINE LaunchCore::~LaunchCore() MUDA_NOEXCEPT
 {
     if constexpr(muda::RUNTIME_CHECK_ON)
@@ -303,6 +313,13 @@ T& LaunchBase<T>::kernel_name(std::string_view name)
     return derived();
 }
 
+template <typename T>
+T& LaunchBase<T>::check_non_finite(bool on)
+{
+    m_check_non_finite = on;
+    return derived();
+}
+
 template <typename T>
 T& LaunchBase<T>::pop_kernel_name()
 {
@@ -341,4 +358,9 @@ MUDA_INLINE void wait_event(cudaEvent_t event)
 {
     Empty::wait_event(event);
 }
+
+MUDA_INLINE void flush_names()
+{
+    details::LaunchInfoCache::flush();
+}
 }  // namespace muda
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <muda/compute_graph/compute_graph.h>
+#include <muda/tools/memory_registry.h>
 #include "memory.h"
 namespace muda
 {
@@ -16,6 +17,7 @@ MUDA_HOST Memory& Memory::alloc_1d(T** ptr, size_t byte_size, bool async)
 #else
     checkCudaErrors(cudaMalloc(ptr, byte_size));
 #endif
+    MemoryRegistry::on_alloc(*ptr, byte_size, MemoryCategory::Buffer);
     return *this;
 }
 
@@ -27,6 +29,7 @@ MUDA_HOST Memory& Memory::alloc(T** ptr, size_t byte_size, bool async)
 
 MUDA_INLINE MUDA_HOST Memory& Memory::free(void* ptr, bool async)
 {
+    MemoryRegistry::on_free(ptr);
 #ifdef MUDA_WITH_ASYNC_MEMORY_ALLOC_FREE
     if(async)
         checkCudaErrors(cudaFreeAsync(ptr, stream()));
@@ -108,6 +111,7 @@ MUDA_HOST Memory& Memory::alloc_2d(T** ptr, size_t* pitch, size_t width_bytes, s
     MUDA_ASSERT(ComputeGraphBuilder::is_direct_launching(),
                 "alloc must be called in direct launching mode");
     checkCudaErrors(cudaMallocPitch(ptr, pitch, width_bytes, height));
+    MemoryRegistry::on_alloc(*ptr, (*pitch) * height, MemoryCategory::Buffer);
     return *this;
 }
 
@@ -223,6 +227,9 @@ MUDA_INLINE MUDA_HOST Memory& Memory::alloc_3d(cudaPitchedPtr*   pitched_ptr,
     MUDA_ASSERT(ComputeGraphBuilder::is_direct_launching(),
                 "alloc must be called in direct launching mode");
     checkCudaErrors(cudaMalloc3D(pitched_ptr, extent));
+    MemoryRegistry::on_alloc(pitched_ptr->ptr,
+                             pitched_ptr->pitch * extent.height * extent.depth,
+                             MemoryCategory::Buffer);
     return *this;
 }
 
@@ -165,6 +165,7 @@ MUDA_HOST void ParallelFor::invoke(int count, F&& f)
     // check_input(count);
     if(count > 0)
     {
+        details::LaunchInfoCache::flush();
         if(m_grid_dim <= 0)  // parallel for
         {
             // calculate the blocks we need
@@ -181,6 +182,7 @@ MUDA_HOST void ParallelFor::invoke(int count, F&& f)
                 <<<m_grid_dim, m_block_dim, m_shared_mem_size, m_stream>>>(callable);
         }
     }
+    scan_non_finite();
 }
 
 template <typename F, typename UserTag>
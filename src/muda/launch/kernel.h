@@ -2,6 +2,7 @@
 #include <cuda.h>
 #include <muda/muda_def.h>
 #include <muda/launch/stream_define.h>
+#include <muda/tools/launch_info_cache.h>
 #include <type_traits>
 
 namespace muda
@@ -60,6 +61,9 @@ class Kernel
     MUDA_GENERIC void operator()(Args&&... args) &&
     {
         static_assert(std::is_invocable_v<F, Args...>, "invalid arguments");
+#ifndef __CUDA_ARCH__
+        details::LaunchInfoCache::flush();
+#endif
 #if MUDA_WITH_DEVICE_STREAM_MODEL
         m_kernel<<<m_grid_dim, m_block_dim, m_shared_memory_size, m_stream>>>(
             std::forward<Args>(args)...);
@@ -8,13 +8,13 @@ class KernelLabel
   public:
     KernelLabel(std::string_view name)
     {
-        if constexpr(muda::RUNTIME_CHECK_ON)
+        if constexpr(muda::CHECK_NAMES_ON)
             details::LaunchInfoCache::current_kernel_name(name);
     }
 
     ~KernelLabel()
     {
-        if constexpr(muda::RUNTIME_CHECK_ON)
+        if constexpr(muda::CHECK_NAMES_ON)
             details::LaunchInfoCache::current_kernel_name("");
     }
 };
@@ -14,6 +14,7 @@
 #include <nvtx3/nvToolsExtCuda.h>
 #include <muda/type_traits/type_modifier.h>
 #include <muda/tools/launch_info_cache.h>
+#include <muda/viewer/non_finite.h>
 
 #include <muda/check/check_cuda_errors.h>
 #include <muda/muda_def.h>
@@ -46,7 +47,10 @@ class LaunchCore
     MUDA_GENERIC ::cudaStream_t stream() const { return m_stream; }
 
     ::cudaStream_t m_stream;
+    bool           m_check_non_finite = true;
     MUDA_HOST void pop_kernel_name();
+    // run the NaN/Inf scans of the viewers made for the kernel just launched
+    MUDA_HOST void scan_non_finite();
 
   public:
     static void             kernel_name(std::string_view name);
@@ -108,6 +112,10 @@ class LaunchBase : public LaunchCore
     T&               kernel_name(std::string_view name);
     std::string_view kernel_name() const { return Base::kernel_name(); }
 
+    // scan the floating buffers written through non-const viewers for NaN/Inf
+    // after the following kernel (MUDA_NON_FINITE_CHECK only), on by default
+    T& check_non_finite(bool on = true);
+
     // record an event on this point with current stream, you could use .when() to
     // capture this event for synchronization
     // flags:
@@ -179,6 +187,10 @@ Empty on();
 void wait_device();
 void wait_stream(::cudaStream_t stream);
 void wait_event(cudaEvent_t event);
+
+// upload the kernel/viewer names recorded since the last launch, the muda
+// launchers do it themselves, call it before a raw `<<<>>>` launch
+void flush_names();
 }  // namespace muda
 
 #include "details/launch_base.inl"
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <sstream>
+#include <fstream>
+#include <muda/tools/launch_info_cache.h>
 #include <muda/mstl/span.h>
 #include <muda/cub/device/device_radix_sort.h>
 namespace muda
@@ -55,16 +57,17 @@ MUDA_INLINE const T& LoggerMetaData::as()
 }
 
 MUDA_INLINE Logger::Logger(LoggerViewer* global_viewer, size_t meta_size, size_t buffer_size)
-    : m_meta_data_id(meta_size)
-    , m_meta_data(meta_size)
-    , m_sorted_meta_data_id(meta_size)
-    , m_sorted_meta_data(meta_size)
-    , m_h_meta_data(meta_size)
-    , m_buffer(buffer_size)
+    : m_h_meta_data(meta_size)
     , m_h_buffer(buffer_size)
     , m_log_viewer_ptr(global_viewer)
-    , m_offset(1)
 {
+    MemoryScope scope{MemoryCategory::Logger, "Logger"};
+    m_meta_data_id.resize(meta_size);
+    m_meta_data.resize(meta_size);
+    m_sorted_meta_data_id.resize(meta_size);
+    m_sorted_meta_data.resize(meta_size);
+    m_buffer.resize(buffer_size);
+    m_offset.resize(1);
     upload();
 }
 
@@ -105,14 +108,14 @@ MUDA_INLINE Logger& Logger::operator=(Logger&& other) noexcept
     return *this;
 }
 template <typename F>
-void Logger::_retrieve(F&& f)
+void Logger::_retrieve(Stream* stream, F&& f)
 {
     // don't allow automatic sync in this region
     // or it may cause infinite loop
     auto is_debug_sync = muda::Debug::is_debug_sync_all();
     muda::Debug::debug_sync_all(false);
 
-    download();
+    download(stream);
     //auto meta_data_span =
     //    span<details::LoggerMetaData>{m_h_meta_data}.subspan(0, m_h_offset.meta_data_offset);
     //std::stable_sort(meta_data_span.begin(),
@@ -126,13 +129,24 @@ void Logger::_retrieve(F&& f)
     f(meta_data_span);
 
     expand_if_needed();
-    upload();
+    upload(stream);
     muda::Debug::debug_sync_all(is_debug_sync);
 }
 MUDA_INLINE void Logger::retrieve(std::ostream& os)
+{
+    _retrieve_text(nullptr, os);
+}
+
+MUDA_INLINE void Logger::retrieve(Stream& stream, std::ostream& os)
+{
+    _retrieve_text(&stream, os);
+}
+
+MUDA_INLINE void Logger::_retrieve_text(Stream* stream, std::ostream& os)
 {
     std::stringstream ss;
     Logger::_retrieve(
+        stream,
         [&](const span<details::LoggerMetaData>& meta_data_span)
         {
             for(const auto& meta_data : meta_data_span)
@@ -147,9 +161,20 @@ MUDA_INLINE void Logger::retrieve(std::ostream& os)
 }
 
 MUDA_INLINE LoggerDataContainer Logger::retrieve_meta()
+{
+    return _retrieve_meta(nullptr);
+}
+
+MUDA_INLINE LoggerDataContainer Logger::retrieve_meta(Stream& stream)
+{
+    return _retrieve_meta(&stream);
+}
+
+MUDA_INLINE LoggerDataContainer Logger::_retrieve_meta(Stream* stream)
 {
     LoggerDataContainer ret;
     Logger::_retrieve(
+        stream,
         [&](const span<details::LoggerMetaData>& meta_data_span)
         {
             // copy buffer for safety
@@ -170,9 +195,47 @@ MUDA_INLINE LoggerDataContainer Logger::retrieve_meta()
     return ret;
 }
 
+MUDA_INLINE void Logger::retrieve_binary(std::ostream& os)
+{
+    LoggerBinaryData data;
+    Logger::_retrieve(
+        nullptr,
+        [&](const span<details::LoggerMetaData>& meta_data_span)
+        {
+            data.entries.resize(meta_data_span.size());
+            std::transform(meta_data_span.begin(),
+                           meta_data_span.end(),
+                           data.entries.begin(),
+                           [](const details::LoggerMetaData& meta_data)
+                           {
+                               return LoggerBinaryEntry{meta_data.id,
+                                                        static_cast<uint16_t>(meta_data.type),
+                                                        meta_data.exceeded,
+                                                        meta_data.size,
+                                                        meta_data.offset};
+                           });
+            data.payload.assign(m_h_buffer.begin(),
+                                m_h_buffer.begin() + m_h_offset.buffer_offset);
+            data.exceed_meta_data = m_h_offset.exceed_meta_data;
+            data.exceed_buffer    = m_h_offset.exceed_buffer;
+        });
+
+    data.string_tables.push_back({"kernel_name", details::LaunchInfoCache::kernel_names()});
+    data.string_tables.push_back({"viewer_name", details::LaunchInfoCache::view_names()});
+    write_logger_binary(os, data);
+}
+
+MUDA_INLINE void Logger::retrieve_binary(std::string_view path)
+{
+    std::ofstream file{std::string{path}, std::ios::binary};
+    MUDA_ASSERT(file.is_open(), "Logger: can't open %s", std::string{path}.c_str());
+    retrieve_binary(file);
+}
+
 MUDA_INLINE void Logger::expand_meta_data()
 {
-    auto new_size = m_meta_data.size() * 2;
+    MemoryScope scope{MemoryCategory::Logger, "Logger"};
+    auto        new_size = m_meta_data.size() * 2;
 
     m_meta_data_id.resize(new_size);
     m_meta_data.resize(new_size);
@@ -183,17 +246,20 @@ MUDA_INLINE void Logger::expand_meta_data()
 
 MUDA_INLINE void Logger::expand_buffer()
 {
-    auto new_size = m_buffer.size() * 2;
+    MemoryScope scope{MemoryCategory::Logger, "Logger"};
+    auto        new_size = m_buffer.size() * 2;
     m_buffer.resize(new_size);
 }
 
-MUDA_INLINE void Logger::upload()
+MUDA_INLINE void Logger::upload(Stream* stream)
 {
+    cudaStream_t s = stream ? stream->view() : nullptr;
+
     // reset
     m_h_offset = {};
-    m_offset   = {m_h_offset};
+    checkCudaErrors(cudaMemsetAsync(m_offset.data(), 0, sizeof(details::LoggerOffset), s));
 
-    m_viewer.m_offset       = m_offset.data();
+    m_viewer.m_offset            = m_offset.data();
     m_viewer.m_meta_data_id      = m_meta_data_id.data();
     m_viewer.m_meta_data_id_size = m_meta_data_id.size();
     m_viewer.m_meta_data         = m_meta_data.data();
@@ -201,46 +267,131 @@ MUDA_INLINE void Logger::upload()
     m_viewer.m_buffer            = m_buffer.data();
     m_viewer.m_buffer_size       = m_buffer.size();
 
+    upload_global_viewer(s);
+    // on a stream, the next kernels are ordered after the reset anyway
+    if(!stream)
+        checkCudaErrors(cudaDeviceSynchronize());
+}
+
+MUDA_INLINE void Logger::upload_global_viewer(cudaStream_t stream)
+{
     if(m_log_viewer_ptr)
     {
         checkCudaErrors(cudaMemcpyAsync(
-            m_log_viewer_ptr, &m_viewer, sizeof(m_viewer), cudaMemcpyHostToDevice, nullptr));
+            m_log_viewer_ptr, &m_viewer, sizeof(m_viewer), cudaMemcpyHostToDevice, stream));
+    }
+}
+
+MUDA_INLINE void Logger::set_level(LogLevel level)
+{
+    m_viewer.m_level = level;
+    upload_global_viewer();
+}
+
+namespace details
+{
+    // shared by `Logger::set_sampling()` and `StreamingLogger::set_sampling()`
+    MUDA_INLINE void check_logger_sampling(const LoggerSampling& sampling)
+    {
+        MUDA_ASSERT(sampling.every_nth > 0 && sampling.thread_stride > 0
+                        && sampling.thread_offset < sampling.thread_stride,
+                    "Logger: invalid sampling, every_nth=%u, thread_stride=%u, thread_offset=%u",
+                    sampling.every_nth,
+                    sampling.thread_stride,
+                    sampling.thread_offset);
     }
-    checkCudaErrors(cudaDeviceSynchronize());
+}  // namespace details
+
+MUDA_INLINE void Logger::set_sampling(const LoggerSampling& sampling)
+{
+    details::check_logger_sampling(sampling);
+    m_viewer.m_sampling = sampling;
+    upload_global_viewer();
 }
 
-MUDA_INLINE void Logger::download()
+namespace details
 {
+    // flag `offset->unordered` if the ids of the used meta data slots decrease anywhere
+    template <typename = void>
+    MUDA_GLOBAL void logger_check_order(const uint32_t* ids, uint32_t capacity, LoggerOffset* offset)
+    {
+        auto count  = min(offset->meta_data_offset, capacity);
+        auto stride = gridDim.x * blockDim.x;
+        for(auto i = blockIdx.x * blockDim.x + threadIdx.x + 1; i < count; i += stride)
+        {
+            if(ids[i] < ids[i - 1])
+            {
+                offset->unordered = 1;
+                return;
+            }
+        }
+    }
+}  // namespace details
+
+MUDA_INLINE void Logger::download(Stream* stream)
+{
+    cudaStream_t s    = stream ? stream->view() : nullptr;
+    auto         sync = [&]
+    {
+        if(stream)
+            checkCudaErrors(cudaStreamSynchronize(s));
+        else
+            checkCudaErrors(cudaDeviceSynchronize());
+    };
+
+    // ids are taken and meta data slots reserved in warp order, so the
+    // meta data is often already sorted and the radix sort can be skipped
+    if(m_meta_data_id.size() > 1)
+    {
+        constexpr uint32_t block_dim = 256;
+        uint32_t           grid_dim  = std::min<size_t>(
+            (m_meta_data_id.size() + block_dim - 1) / block_dim, 1024);
+        details::logger_check_order<<<grid_dim, block_dim, 0, s>>>(
+            m_meta_data_id.data(), m_meta_data_id.size(), m_offset.data());
+        checkCudaErrors(cudaGetLastError());
+    }
+
     // copy back
     std::vector<details::LoggerOffset> h_offset(1);
-    m_offset.copy_to(h_offset);
+    m_offset.copy_to(h_offset, s);
+    sync();
     m_h_offset = h_offset[0];
 
-    // sort meta data
+    // the offsets are not bounded on the device
+    m_h_offset.meta_data_offset =
+        std::min<size_t>(m_h_offset.meta_data_offset, m_meta_data.size());
+    m_h_offset.buffer_offset = std::min<size_t>(m_h_offset.buffer_offset, m_buffer.size());
 
-    DeviceRadixSort().SortPairs(m_meta_data_id.data(),
-                                m_sorted_meta_data_id.data(),
-                                m_meta_data.data(),
-                                m_sorted_meta_data.data(),
-                                m_h_offset.meta_data_offset);
+    auto meta_data = m_meta_data.data();
+    if(m_h_offset.unordered)
+    {
+        DeviceRadixSort(stream ? *stream : Stream::Default())
+            .SortPairs(m_meta_data_id.data(),
+                       m_sorted_meta_data_id.data(),
+                       m_meta_data.data(),
+                       m_sorted_meta_data.data(),
+                       m_h_offset.meta_data_offset);
+        meta_data = m_sorted_meta_data.data();
+    }
 
     if(m_h_offset.meta_data_offset > 0)
     {
         m_h_meta_data.resize(m_h_offset.meta_data_offset);
         checkCudaErrors(cudaMemcpyAsync(m_h_meta_data.data(),
-                                        m_sorted_meta_data.data(),
+                                        meta_data,
                                         m_h_meta_data.size() * sizeof(details::LoggerMetaData),
-                                        cudaMemcpyDeviceToHost));
+                                        cudaMemcpyDeviceToHost,
+                                        s));
     }
 
     if(m_h_offset.buffer_offset > 0)
     {
         m_h_buffer.resize(m_h_offset.buffer_offset);
         checkCudaErrors(cudaMemcpyAsync(
-            m_h_buffer.data(), m_buffer.data(), m_h_offset.buffer_offset, cudaMemcpyDeviceToHost));
+            m_h_buffer.data(), m_buffer.data(), m_h_offset.buffer_offset, cudaMemcpyDeviceToHost, s));
     }
 
-    checkCudaErrors(cudaDeviceSynchronize());
+    sync();
 }
 
 MUDA_INLINE void Logger::expand_if_needed()
@@ -266,36 +417,44 @@ MUDA_INLINE void Logger::expand_if_needed()
     }
 }
 
-MUDA_INLINE void Logger::put(std::ostream& os, const details::LoggerMetaData& meta_data) const
+namespace details
 {
-    auto buffer = m_h_buffer.data();
-    auto offset = meta_data.offset;
-    auto type   = meta_data.type;
+    // format one entry, `buffer` is the host copy of the log buffer
+    MUDA_INLINE void put_log(std::ostream& os, const char* buffer, const LoggerMetaData& meta_data)
+    {
+        auto offset = meta_data.offset;
+        auto type   = meta_data.type;
 #define MUDA_PUT_CASE(EnumT, T)                                                \
     case LoggerBasicType::EnumT:                                               \
         os << *reinterpret_cast<const T*>(buffer + offset);                    \
         break;
 
-    switch(type)
-    {
-        case LoggerBasicType::String:
-            os << buffer + offset;
-            break;
-            MUDA_PUT_CASE(Int8, int8_t);
-            MUDA_PUT_CASE(Int16, int16_t);
-            MUDA_PUT_CASE(Int32, int32_t);
-            MUDA_PUT_CASE(Int64, int64_t);
-            MUDA_PUT_CASE(UInt8, uint8_t);
-            MUDA_PUT_CASE(UInt16, uint16_t);
-            MUDA_PUT_CASE(UInt32, uint32_t);
-            MUDA_PUT_CASE(UInt64, uint64_t);
-            MUDA_PUT_CASE(Float, float);
-            MUDA_PUT_CASE(Double, double);
-        default:
-            MUDA_ERROR_WITH_LOCATION("Unknown type");
-            break;
-    }
+        switch(type)
+        {
+            case LoggerBasicType::String:
+                os << buffer + offset;
+                break;
+                MUDA_PUT_CASE(Int8, int8_t);
+                MUDA_PUT_CASE(Int16, int16_t);
+                MUDA_PUT_CASE(Int32, int32_t);
+                MUDA_PUT_CASE(Int64, int64_t);
+                MUDA_PUT_CASE(UInt8, uint8_t);
+                MUDA_PUT_CASE(UInt16, uint16_t);
+                MUDA_PUT_CASE(UInt32, uint32_t);
+                MUDA_PUT_CASE(UInt64, uint64_t);
+                MUDA_PUT_CASE(Float, float);
+                MUDA_PUT_CASE(Double, double);
+            default:
+                MUDA_ERROR_WITH_LOCATION("Unknown type");
+                break;
+        }
 #undef MUDA_PUT_CASE
+    }
+}  // namespace details
+
+MUDA_INLINE void Logger::put(std::ostream& os, const details::LoggerMetaData& meta_data) const
+{
+    details::put_log(os, m_h_buffer.data(), meta_data);
 }
 
 MUDA_INLINE Logger::~Logger() {}
@@ -1,17 +1,57 @@
 #include <muda/atomic.h>
+#include <muda/cuda/cooperative_groups.h>
 
 namespace muda
 {
+namespace details
+{
+    /**
+     * \brief Reserve `size` units at `*offset`, the lanes of a warp that
+     * arrive together share a single atomic and get consecutive ranges
+     * (in lane order).
+     *
+     * The offset is not bounded, the caller checks the returned range
+     * against the capacity.
+     */
+    MUDA_INLINE MUDA_DEVICE uint32_t warp_aggregated_reserve(uint32_t* offset, uint32_t size)
+    {
+        namespace cg = cooperative_groups;
+
+        auto     g    = cg::coalesced_threads();
+        auto     rank = g.thread_rank();
+        uint32_t end  = size;  // inclusive prefix sum of the sizes
+        for(unsigned d = 1; d < g.size(); d <<= 1)
+        {
+            auto v = g.shfl_up(end, d);
+            if(rank >= d)
+                end += v;
+        }
+
+        uint32_t base = 0;
+        if(rank == g.size() - 1)
+            base = atomic_add(offset, end);
+        base = g.shfl(base, g.size() - 1);
+        return base + end - size;
+    }
+
+    // payload entries are padded to words, so that scalars are stored with
+    // (coalesced) word writes
+    inline constexpr uint32_t LoggerPayloadAlignment = sizeof(uint32_t);
+}  // namespace details
+
 MUDA_INLINE MUDA_DEVICE LogProxy::LogProxy(LoggerViewer& viewer)
     : m_viewer(&viewer)
 {
     MUDA_KERNEL_ASSERT(m_viewer->m_buffer && m_viewer->m_meta_data,
                        "LoggerViewer is not initialized");
-    m_log_id = atomic_add(&(m_viewer->m_offset->log_id), 1u);
+    m_log_id = details::warp_aggregated_reserve(&(m_viewer->m_offset->log_id), 1u);
 }
 template <bool IsFmt>
 MUDA_INLINE MUDA_DEVICE LogProxy& LogProxy::push_string(const char* str)
 {
+    if(!m_viewer)  // filtered out
+        return *this;
+
     auto strlen = [](const char* s)
     {
         size_t len = 0;
@@ -39,6 +79,9 @@ MUDA_INLINE MUDA_DEVICE LogProxy& LogProxy::push_string(const char* str)
 template <typename T>
 MUDA_DEVICE void LogProxy::push_fmt_arg(const T& obj, LoggerFmtArg func)
 {
+    if(!m_viewer)  // filtered out
+        return;
+
     details::LoggerMetaData meta;
     meta.type    = LoggerBasicType::Object;
     meta.size    = sizeof(T);
@@ -50,6 +93,8 @@ MUDA_DEVICE void LogProxy::push_fmt_arg(const T& obj, LoggerFmtArg func)
 MUDA_INLINE MUDA_DEVICE bool LogProxy::push_data(const details::LoggerMetaData& meta,
                                             const void*                    data)
 {
+    if(!m_viewer)  // filtered out
+        return false;
     return m_viewer->push_data(meta, data);
 }
 
@@ -61,51 +106,61 @@ MUDA_INLINE MUDA_DEVICE LogProxy& LogProxy::operator<<(const char* str)
 template <typename T>
 MUDA_INLINE MUDA_DEVICE LogProxy& LoggerViewer::operator<<(const T& t)
 {
-    m_proxy = LogProxy(*this);
-    m_proxy << t;
-    return m_proxy;
+    auto& proxy = info();
+    proxy << t;
+    return proxy;
 }
 
 template <bool IsFmt>
 MUDA_INLINE MUDA_DEVICE LogProxy& LoggerViewer::push_string(const char* str)
 {
-    m_proxy = LogProxy(*this);
-    m_proxy.push_string<IsFmt>(str);
-    return m_proxy;
+    auto& proxy = info();
+    proxy.push_string<IsFmt>(str);
+    return proxy;
 }
 
 MUDA_INLINE MUDA_DEVICE LogProxy& LoggerViewer::operator<<(const char* s)
 {
-    m_proxy = LogProxy(*this);
-    m_proxy << s;
+    auto& proxy = info();
+    proxy << s;
+    return proxy;
+}
+
+template <LogLevel Level>
+MUDA_INLINE MUDA_DEVICE LogProxy& LoggerViewer::log()
+{
+    // a null proxy drops everything pushed to it, no id is taken
+    if constexpr(static_cast<int>(Level) < LOG_MIN_LEVEL)
+        m_proxy = LogProxy{};
+    else
+        m_proxy = accept(Level) ? LogProxy(*this) : LogProxy{};
     return m_proxy;
 }
 
-MUDA_INLINE MUDA_DEVICE uint32_t next_idx(uint32_t* data_offset, uint32_t size, uint32_t total_size)
+MUDA_INLINE MUDA_DEVICE bool LoggerViewer::accept(LogLevel level)
 {
+    if(level < m_level)
+        return false;
 
-    uint32_t old = *data_offset;
-    if(old + size >= total_size)
-        return ~0u;
-    uint32_t assumed;
-    do
+    if(m_sampling.thread_stride > 1)
     {
-        assumed         = old;
-        auto new_offset = old + size;
-        old             = atomic_cas(data_offset, assumed, new_offset);
-        if(old + size >= total_size)
-        {
-            old = ~0u;
-            break;
-        }
-    } while(assumed != old);
-    return old;
+        auto block = blockIdx.x + gridDim.x * (blockIdx.y + gridDim.y * blockIdx.z);
+        auto thread = threadIdx.x + blockDim.x * (threadIdx.y + blockDim.y * threadIdx.z);
+        auto id = static_cast<uint64_t>(block) * (blockDim.x * blockDim.y * blockDim.z) + thread;
+        if(id % m_sampling.thread_stride != m_sampling.thread_offset)
+            return false;
+    }
+
+    if(m_sampling.every_nth > 1)
+        return m_sample_counter++ % m_sampling.every_nth == 0;
+
+    return true;
 }
 
 MUDA_INLINE MUDA_DEVICE uint32_t LoggerViewer::next_meta_data_idx() const
 {
-    auto idx = next_idx(&(m_offset->meta_data_offset), 1u, m_meta_data_size);
-    if(idx == ~0u)
+    auto idx = details::warp_aggregated_reserve(&(m_offset->meta_data_offset), 1u);
+    if(idx >= static_cast<uint32_t>(m_meta_data_size))
     {
         atomic_cas(&(m_offset->exceed_meta_data), 0u, 1u);
         return ~0u;
@@ -115,8 +170,11 @@ MUDA_INLINE MUDA_DEVICE uint32_t LoggerViewer::next_meta_data_idx() const
 
 MUDA_INLINE MUDA_DEVICE uint32_t LoggerViewer::next_buffer_idx(uint32_t size) const
 {
-    auto idx = next_idx(&(m_offset->buffer_offset), size, m_buffer_size);
-    if(idx == ~0u)
+    constexpr auto A = details::LoggerPayloadAlignment;
+
+    auto padded = (size + A - 1) / A * A;
+    auto idx    = details::warp_aggregated_reserve(&(m_offset->buffer_offset), padded);
+    if(idx + size > static_cast<uint32_t>(m_buffer_size) || idx + size < idx)
     {
         atomic_cas(&(m_offset->exceed_buffer), 0u, 1u);
         return ~0u;
@@ -152,8 +210,23 @@ MUDA_INLINE MUDA_DEVICE bool LoggerViewer::push_data(details::LoggerMetaData met
     meta.offset              = buffer_idx;
     m_meta_data[meta_idx]    = meta;
     m_meta_data_id[meta_idx] = meta.id;
-    for(int i = 0; i < meta.size; ++i)
-        m_buffer[buffer_idx + i] = reinterpret_cast<const char*>(data)[i];
+
+    // buffer_idx is word aligned, copy by words if the source is too
+    auto src = reinterpret_cast<const char*>(data);
+    auto dst = m_buffer + buffer_idx;
+    if(reinterpret_cast<uintptr_t>(src) % sizeof(uint32_t) == 0)
+    {
+        auto words = meta.size / sizeof(uint32_t);
+        for(uint32_t i = 0; i < words; ++i)
+            reinterpret_cast<uint32_t*>(dst)[i] = reinterpret_cast<const uint32_t*>(src)[i];
+        for(uint32_t i = words * sizeof(uint32_t); i < meta.size; ++i)
+            dst[i] = src[i];
+    }
+    else
+    {
+        for(uint32_t i = 0; i < meta.size; ++i)
+            dst[i] = src[i];
+    }
     return true;
 }
-}  // namespace muda
+}  // namespace muda
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include <sstream>
+#include <algorithm>
+#include <muda/tools/memory_registry.h>
+
+namespace muda
+{
+MUDA_INLINE StreamingLogger::StreamingLogger(Sink sink, cudaStream_t stream, size_t meta_size, size_t buffer_size)
+    : m_stream(stream)
+    , m_sink(std::move(sink))
+{
+    MemoryScope scope{MemoryCategory::Logger, "StreamingLogger"};
+    checkCudaErrors(cudaStreamCreateWithFlags(&m_copy_stream, cudaStreamNonBlocking));
+    for(auto& r : m_regions)
+    {
+        r.meta_data_id.resize(meta_size);
+        r.meta_data.resize(meta_size);
+        r.buffer.resize(buffer_size);
+        r.offset.resize(1);
+        checkCudaErrors(cudaMallocHost(&r.h_offset, sizeof(details::LoggerOffset)));
+        checkCudaErrors(cudaEventCreateWithFlags(&r.retired, cudaEventDisableTiming));
+    }
+    activate(m_regions[m_active]);
+    m_worker = std::thread([this] { worker_loop(); });
+}
+
+MUDA_INLINE StreamingLogger::StreamingLogger(std::string_view path,
+                                             cudaStream_t     stream,
+                                             size_t           meta_size,
+                                             size_t           buffer_size)
+    : StreamingLogger(Sink{}, stream, meta_size, buffer_size)
+{
+    // nothing is queued yet, so the worker doesn't touch the sink
+    m_file.open(std::string{path}, std::ios::out | std::ios::app);
+    MUDA_ASSERT(m_file.is_open(), "StreamingLogger: can't open %s", std::string{path}.c_str());
+    m_sink = [this](std::string_view text)
+    {
+        m_file.write(text.data(), text.size());
+        m_file.flush();
+    };
+}
+
+MUDA_INLINE StreamingLogger::~StreamingLogger()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_worker.join();
+
+    // we don't check the error here to prevent exception when app is shutting down
+    for(auto& r : m_regions)
+    {
+        cudaFreeHost(r.h_offset);
+        cudaEventDestroy(r.retired);
+    }
+    cudaStreamDestroy(m_copy_stream);
+}
+
+MUDA_INLINE LoggerViewer StreamingLogger::viewer() const
+{
+    return m_viewer;
+}
+
+MUDA_INLINE void StreamingLogger::activate(Region& r)
+{
+    if(r.grow_meta_data || r.grow_buffer)
+    {
+        MemoryScope scope{MemoryCategory::Logger, "StreamingLogger"};
+        if(r.grow_meta_data)
+        {
+            auto old_size = r.meta_data.size();
+            r.meta_data_id.resize(old_size * 2);
+            r.meta_data.resize(old_size * 2);
+            r.grow_meta_data = false;
+            MUDA_KERNEL_WARN_WITH_LOCATION(
+                "StreamingLogger meta data buffer expanded %d => %d", old_size, old_size * 2);
+        }
+        if(r.grow_buffer)
+        {
+            auto old_size = r.buffer.size();
+            r.buffer.resize(old_size * 2);
+            r.grow_buffer = false;
+            MUDA_KERNEL_WARN_WITH_LOCATION(
+                "StreamingLogger buffer expanded %d => %d", old_size, old_size * 2);
+        }
+    }
+
+    // reset in stream order, after the previous drain of this region
+    checkCudaErrors(cudaMemsetAsync(r.offset.data(), 0, sizeof(details::LoggerOffset), m_stream));
+
+    m_viewer.m_offset            = r.offset.data();
+    m_viewer.m_meta_data_id      = r.meta_data_id.data();
+    m_viewer.m_meta_data_id_size = r.meta_data_id.size();
+    m_viewer.m_meta_data         = r.meta_data.data();
+    m_viewer.m_meta_data_size    = r.meta_data.size();
+    m_viewer.m_buffer            = r.buffer.data();
+    m_viewer.m_buffer_size       = r.buffer.size();
+}
+
+MUDA_INLINE void StreamingLogger::flip()
+{
+    auto& retired = m_regions[m_active];
+    auto& next    = m_regions[1 - m_active];
+
+    // the offset readback and the event are ordered after every kernel
+    // that logged into this region on `m_stream`
+    checkCudaErrors(cudaMemcpyAsync(retired.h_offset,
+                                    retired.offset.data(),
+                                    sizeof(details::LoggerOffset),
+                                    cudaMemcpyDeviceToHost,
+                                    m_stream));
+    checkCudaErrors(cudaEventRecord(retired.retired, m_stream));
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        retired.draining = true;
+        m_queue.push_back(&retired);
+        m_cv.notify_all();
+        // back pressure: the worker is still copying the other region back
+        m_cv.wait(lock, [&] { return !next.draining; });
+    }
+
+    m_active = 1 - m_active;
+    activate(next);
+}
+
+MUDA_INLINE void StreamingLogger::flush()
+{
+    flip();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&] { return m_queue.empty() && m_in_flight == 0; });
+}
+
+MUDA_INLINE size_t StreamingLogger::overflow_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_overflow;
+}
+
+MUDA_INLINE void StreamingLogger::worker_loop()
+{
+    while(true)
+    {
+        Region* r = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_stop || !m_queue.empty(); });
+            if(m_queue.empty())
+                return;
+            r = m_queue.front();
+            m_queue.pop_front();
+            ++m_in_flight;
+        }
+
+        drain(*r);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_in_flight;
+        }
+        m_cv.notify_all();
+    }
+}
+
+MUDA_INLINE void StreamingLogger::drain(Region& r)
+{
+    // wait for this region only, not for the device
+    checkCudaErrors(cudaEventSynchronize(r.retired));
+    auto offset = *r.h_offset;
+
+    auto meta_count = std::min<size_t>(offset.meta_data_offset, r.meta_data.size());
+    auto buffer_size = std::min<size_t>(offset.buffer_offset, r.buffer.size());
+    r.h_meta_data.resize(meta_count);
+    r.h_buffer.resize(buffer_size);
+    if(meta_count > 0)
+        checkCudaErrors(cudaMemcpyAsync(r.h_meta_data.data(),
+                                        r.meta_data.data(),
+                                        meta_count * sizeof(details::LoggerMetaData),
+                                        cudaMemcpyDeviceToHost,
+                                        m_copy_stream));
+    if(buffer_size > 0)
+        checkCudaErrors(cudaMemcpyAsync(r.h_buffer.data(),
+                                        r.buffer.data(),
+                                        buffer_size,
+                                        cudaMemcpyDeviceToHost,
+                                        m_copy_stream));
+    checkCudaErrors(cudaStreamSynchronize(m_copy_stream));
+
+    // the device side of the region can be reused from now on
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        r.draining       = false;
+        r.grow_meta_data = offset.exceed_meta_data;
+        r.grow_buffer    = offset.exceed_buffer;
+        if(offset.exceed_meta_data || offset.exceed_buffer)
+            ++m_overflow;
+    }
+    m_cv.notify_all();
+
+    // the host copies are only touched by this thread
+    auto by_id = [](const details::LoggerMetaData& a, const details::LoggerMetaData& b)
+    { return a.id < b.id; };
+    if(!std::is_sorted(r.h_meta_data.begin(), r.h_meta_data.end(), by_id))
+        std::stable_sort(r.h_meta_data.begin(), r.h_meta_data.end(), by_id);
+
+    std::stringstream ss;
+    for(const auto& meta_data : r.h_meta_data)
+    {
+        if(meta_data.exceeded)
+            ss << "[log_id " << meta_data.id << ": buffer exceeded]";
+        else
+            details::put_log(ss, r.h_buffer.data(), meta_data);
+    }
+
+    auto text = ss.str();
+    if(!text.empty() && m_sink)
+        m_sink(text);
+}
+}  // namespace muda
@@ -7,6 +7,8 @@
 #include <muda/buffer/device_var.h>
 #include <vector>
 #include <muda/tools/temp_buffer.h>
+#include <muda/launch/stream.h>
+#include <muda/logger/logger_binary.h>
 
 namespace muda
 {
@@ -62,6 +64,23 @@ class Logger
 
     MUDA_NODISCARD LoggerDataContainer retrieve_meta();
 
+    /**
+     * \brief Retrieve the logs of the kernels launched on `stream`: the
+     * readback, sort and copies are ordered on `stream` and only `stream` is
+     * synchronized, other streams keep running.
+     *
+     * All the kernels using this logger must be ordered on `stream`.
+     * (Growing the buffers after an overflow still synchronizes the device,
+     * because of `cudaFree`.)
+     */
+    void retrieve(Stream& stream, std::ostream& o = std::cout);
+    MUDA_NODISCARD LoggerDataContainer retrieve_meta(Stream& stream);
+
+    // dump the raw entries and payload in the binary format of `logger_binary.h`,
+    // without formatting, use the `muda_log_decode` tool to read it offline
+    void retrieve_binary(std::string_view path);
+    void retrieve_binary(std::ostream& os);
+
     MUDA_NODISCARD bool is_meta_data_full() const
     {
         return m_h_offset.exceed_meta_data;
@@ -77,14 +96,28 @@ class Logger
         return m_log_viewer_ptr ? *m_log_viewer_ptr : m_viewer;
     }
 
+    // messages below `level` are dropped on the device, only affects the
+    // viewers taken after the call (and the global viewer)
+    void set_level(LogLevel level);
+    MUDA_NODISCARD LogLevel level() const { return m_viewer.m_level; }
+
+    // drop messages on the device by thread id / every n-th message
+    void set_sampling(const LoggerSampling& sampling);
+    MUDA_NODISCARD const LoggerSampling& sampling() const
+    {
+        return m_viewer.m_sampling;
+    }
+
   private:
     friend class LaunchCore;
     friend class Debug;
     void expand_meta_data();
     void expand_buffer();
-    void upload();
-    void download();
+    // `stream == nullptr` => default stream and device-wide synchronization
+    void upload(Stream* stream = nullptr);
+    void download(Stream* stream = nullptr);
     void expand_if_needed();
+    void upload_global_viewer(cudaStream_t stream = nullptr);
 
     //details::LoggerMetaData* m_meta_data;
     //size_t                   m_meta_data_size;
@@ -110,7 +143,9 @@ class Logger
     LoggerViewer* m_log_viewer_ptr = nullptr;
     LoggerViewer  m_viewer;
     template <typename F>
-    void _retrieve(F&&);
+    void                _retrieve(Stream* stream, F&&);
+    void                _retrieve_text(Stream* stream, std::ostream& os);
+    LoggerDataContainer _retrieve_meta(Stream* stream);
     void put(std::ostream& os, const details::LoggerMetaData& meta_data) const;
 };
 //MUDA_INLINE __device__ LoggerViewer cout;
@@ -49,11 +49,15 @@ namespace details
     class LoggerOffset
     {
       public:
-        uint32_t log_id           = 0;
+        uint32_t log_id = 0;
+        // reservations are not bounded, so the offsets may run past the
+        // capacity when exceeded, clamp them before use
         uint32_t meta_data_offset = 0;
         uint32_t exceed_meta_data = 0;  // false
         uint32_t buffer_offset    = 0;
         uint32_t exceed_buffer    = 0;  // false
+        // set by the retrieval if the meta data ids are not in order
+        uint32_t unordered = 0;  // false
     };
 }  // namespace details
 }  // namespace muda
\ No newline at end of file
@@ -0,0 +1,423 @@
+/*****************************************************************//**
+ * \file   logger_binary.h
+ * \brief  Versioned binary dump of Logger content, see `Logger::retrieve_binary()`.
+ *
+ * Pure host C++ (no CUDA dependency), so that offline tools like
+ * `muda_log_decode` can read and format the dumps.
+ *
+ * layout (little endian, version 1):
+ *  LoggerBinaryHeader
+ *  LoggerBinaryEntry[entry_count]        (sorted by log id)
+ *  char[payload_size]                    (the raw log buffer)
+ *  string tables[string_table_count], each:
+ *      u32 name_size, char[name_size], u32 string_count,
+ *      string_count x (u32 size, char[size])
+ *********************************************************************/
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <iomanip>
+#include <muda/logger/logger_basic_data.h>
+
+namespace muda
+{
+inline std::string_view enum_name(LoggerBasicType t)
+{
+    switch(t)
+    {
+        case LoggerBasicType::None:
+            return "None";
+        case LoggerBasicType::Int8:
+            return "Int8";
+        case LoggerBasicType::Int16:
+            return "Int16";
+        case LoggerBasicType::Int32:
+            return "Int32";
+        case LoggerBasicType::Int64:
+            return "Int64";
+        case LoggerBasicType::Long:
+            return "Long";
+        case LoggerBasicType::LongLong:
+            return "LongLong";
+        case LoggerBasicType::UInt8:
+            return "UInt8";
+        case LoggerBasicType::UInt16:
+            return "UInt16";
+        case LoggerBasicType::UInt32:
+            return "UInt32";
+        case LoggerBasicType::UInt64:
+            return "UInt64";
+        case LoggerBasicType::ULong:
+            return "ULong";
+        case LoggerBasicType::ULongLong:
+            return "ULongLong";
+        case LoggerBasicType::Float:
+            return "Float";
+        case LoggerBasicType::Double:
+            return "Double";
+        case LoggerBasicType::String:
+            return "String";
+        case LoggerBasicType::FmtString:
+            return "FmtString";
+        case LoggerBasicType::Object:
+            return "Object";
+        default:
+            return "Unknown";
+    }
+}
+
+// one log entry on disk, the payload is in the payload section at `offset`
+class LoggerBinaryEntry
+{
+  public:
+    uint32_t id       = ~0u;
+    uint16_t type     = 0;  // LoggerBasicType
+    uint16_t exceeded = 0;
+    uint32_t size     = 0;
+    uint32_t offset   = 0;
+
+    LoggerBasicType basic_type() const
+    {
+        return static_cast<LoggerBasicType>(type);
+    }
+};
+static_assert(sizeof(LoggerBinaryEntry) == 16);
+
+class LoggerStringTable
+{
+  public:
+    std::string              name;  // e.g. "kernel_name", "viewer_name"
+    std::vector<std::string> strings;
+};
+
+class LoggerBinaryData
+{
+  public:
+    std::vector<LoggerBinaryEntry> entries;
+    std::vector<char>              payload;
+    std::vector<LoggerStringTable> string_tables;
+    uint32_t                       exceed_meta_data = 0;
+    uint32_t                       exceed_buffer    = 0;
+
+    const LoggerStringTable* string_table(std::string_view name) const
+    {
+        for(auto& t : string_tables)
+            if(t.name == name)
+                return &t;
+        return nullptr;
+    }
+};
+
+namespace details
+{
+    inline constexpr char     LoggerBinaryMagic[8] = {'M', 'U', 'D', 'A', 'L', 'O', 'G', '\0'};
+    inline constexpr uint32_t LoggerBinaryVersion  = 1;
+
+    class LoggerBinaryHeader
+    {
+      public:
+        char     magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint32_t entry_size;
+        uint32_t string_table_count;
+        uint64_t entry_count;
+        uint64_t payload_size;
+        uint32_t exceed_meta_data;
+        uint32_t exceed_buffer;
+    };
+
+    template <typename T>
+    void write_pod(std::ostream& os, const T& v)
+    {
+        os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    template <typename T>
+    bool read_pod(std::istream& is, T& v)
+    {
+        return static_cast<bool>(is.read(reinterpret_cast<char*>(&v), sizeof(T)));
+    }
+
+    // read `count` elements, growing `v` chunk by chunk: a corrupted count
+    // fails at the end of the stream instead of allocating it upfront
+    template <typename Container>
+    bool read_array(std::istream& is, Container& v, uint64_t count)
+    {
+        using T               = typename Container::value_type;
+        constexpr size_t chunk = (size_t{1} << 20) / sizeof(T);
+
+        v.clear();
+        while(v.size() < count)
+        {
+            size_t begin = v.size();
+            size_t n     = static_cast<size_t>(std::min<uint64_t>(chunk, count - begin));
+            v.resize(begin + n);
+            if(!is.read(reinterpret_cast<char*>(v.data() + begin), n * sizeof(T)))
+                return false;
+        }
+        return true;
+    }
+
+    // bytes from the read position to the end, or -1 if the stream can't seek
+    inline int64_t remaining_bytes(std::istream& is)
+    {
+        auto pos = is.tellg();
+        if(pos < 0)
+            return -1;
+        is.seekg(0, std::ios::end);
+        auto end = is.tellg();
+        is.clear();
+        is.seekg(pos);
+        return end < pos ? -1 : static_cast<int64_t>(end - pos);
+    }
+
+    inline void write_string(std::ostream& os, std::string_view s)
+    {
+        write_pod(os, static_cast<uint32_t>(s.size()));
+        os.write(s.data(), s.size());
+    }
+
+    inline bool read_string(std::istream& is, std::string& s)
+    {
+        uint32_t size = 0;
+        if(!read_pod(is, size))
+            return false;
+        return read_array(is, s, size);
+    }
+
+    // bytes of a value of `type`, 0 if the size varies (String, Long/ULong
+    // are 4 or 8 bytes) or the type can't be formatted offline
+    inline constexpr uint32_t logger_value_size(LoggerBasicType type)
+    {
+        switch(type)
+        {
+            case LoggerBasicType::Int8:
+            case LoggerBasicType::UInt8:
+                return 1;
+            case LoggerBasicType::Int16:
+            case LoggerBasicType::UInt16:
+                return 2;
+            case LoggerBasicType::Int32:
+            case LoggerBasicType::UInt32:
+            case LoggerBasicType::Float:
+                return 4;
+            case LoggerBasicType::Int64:
+            case LoggerBasicType::LongLong:
+            case LoggerBasicType::UInt64:
+            case LoggerBasicType::ULongLong:
+            case LoggerBasicType::Double:
+                return 8;
+            default:
+                return 0;
+        }
+    }
+}  // namespace details
+
+inline void write_logger_binary(std::ostream& os, const LoggerBinaryData& data)
+{
+    details::LoggerBinaryHeader header;
+    std::memcpy(header.magic, details::LoggerBinaryMagic, sizeof(header.magic));
+    header.version            = details::LoggerBinaryVersion;
+    header.header_size        = sizeof(details::LoggerBinaryHeader);
+    header.entry_size         = sizeof(LoggerBinaryEntry);
+    header.string_table_count = static_cast<uint32_t>(data.string_tables.size());
+    header.entry_count        = data.entries.size();
+    header.payload_size       = data.payload.size();
+    header.exceed_meta_data   = data.exceed_meta_data;
+    header.exceed_buffer      = data.exceed_buffer;
+
+    details::write_pod(os, header);
+    os.write(reinterpret_cast<const char*>(data.entries.data()),
+             data.entries.size() * sizeof(LoggerBinaryEntry));
+    os.write(data.payload.data(), data.payload.size());
+    for(auto& table : data.string_tables)
+    {
+        details::write_string(os, table.name);
+        details::write_pod(os, static_cast<uint32_t>(table.strings.size()));
+        for(auto& s : table.strings)
+            details::write_string(os, s);
+    }
+}
+
+// \return an empty string on success, otherwise the reason of the failure
+inline std::string read_logger_binary(std::istream& is, LoggerBinaryData& data)
+{
+    details::LoggerBinaryHeader header;
+    if(!details::read_pod(is, header))
+        return "file too short";
+    if(std::memcmp(header.magic, details::LoggerBinaryMagic, sizeof(header.magic)) != 0)
+        return "not a muda log file";
+    if(header.version > details::LoggerBinaryVersion)
+        return "unsupported version " + std::to_string(header.version);
+    if(header.entry_size != sizeof(LoggerBinaryEntry))
+        return "unsupported entry size " + std::to_string(header.entry_size);
+
+    if(header.header_size < sizeof(header))
+        return "invalid header size " + std::to_string(header.header_size);
+
+    // newer minor versions may append fields to the header
+    if(!is.ignore(header.header_size - sizeof(header)))
+        return "file too short";
+
+    // compared by division, the sizes may be anything in a corrupted file
+    if(auto remaining = details::remaining_bytes(is); remaining >= 0)
+    {
+        auto bytes = static_cast<uint64_t>(remaining);
+        if(header.entry_count > bytes / sizeof(LoggerBinaryEntry))
+            return "truncated entries";
+        bytes -= header.entry_count * sizeof(LoggerBinaryEntry);
+        if(header.payload_size > bytes)
+            return "truncated payload";
+    }
+
+    data.exceed_meta_data = header.exceed_meta_data;
+    data.exceed_buffer    = header.exceed_buffer;
+    if(!details::read_array(is, data.entries, header.entry_count))
+        return "truncated entries";
+    if(!details::read_array(is, data.payload, header.payload_size))
+        return "truncated payload";
+
+    // tables and strings are appended as they are read, like read_array()
+    data.string_tables.clear();
+    for(uint32_t t = 0; t < header.string_table_count; ++t)
+    {
+        auto&    table = data.string_tables.emplace_back();
+        uint32_t count = 0;
+        if(!details::read_string(is, table.name) || !details::read_pod(is, count))
+            return "truncated string table";
+        for(uint32_t k = 0; k < count; ++k)
+            if(!details::read_string(is, table.strings.emplace_back()))
+                return "truncated string table";
+    }
+    return {};
+}
+
+/**
+ * \brief Format the value of one entry, as `Logger::retrieve()` does.
+ *
+ * \return false if the type can't be formatted offline (Object/FmtString)
+ */
+inline bool put_log_value(std::ostream& os, const LoggerBinaryData& data, const LoggerBinaryEntry& e)
+{
+    if(e.exceeded)
+    {
+        os << "[log_id " << e.id << ": buffer exceeded]";
+        return true;
+    }
+    if(static_cast<size_t>(e.offset) + e.size > data.payload.size())
+        return false;
+
+    // the values below are read with their own width, which must be the
+    // entry size, or a crafted entry reads past the payload
+    auto type = e.basic_type();
+    if(type == LoggerBasicType::Long || type == LoggerBasicType::ULong)
+    {
+        if(e.size != 4 && e.size != 8)
+            return false;
+    }
+    else if(type != LoggerBasicType::String && e.size != details::logger_value_size(type))
+        return false;
+
+    auto p = data.payload.data() + e.offset;
+    auto as = [p](auto v)
+    {
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    };
+
+    switch(type)
+    {
+        case LoggerBasicType::String:
+            os << std::string_view{p, e.size ? e.size - 1 : 0};  // drop the '\0'
+            break;
+        case LoggerBasicType::Int8:
+            os << static_cast<int>(as(int8_t{}));
+            break;
+        case LoggerBasicType::Int16:
+            os << as(int16_t{});
+            break;
+        case LoggerBasicType::Int32:
+            os << as(int32_t{});
+            break;
+        case LoggerBasicType::Int64:
+        case LoggerBasicType::LongLong:
+            os << as(int64_t{});
+            break;
+        case LoggerBasicType::Long:
+            if(e.size == 4)
+                os << as(int32_t{});
+            else
+                os << as(int64_t{});
+            break;
+        case LoggerBasicType::UInt8:
+            os << static_cast<unsigned>(as(uint8_t{}));
+            break;
+        case LoggerBasicType::UInt16:
+            os << as(uint16_t{});
+            break;
+        case LoggerBasicType::UInt32:
+            os << as(uint32_t{});
+            break;
+        case LoggerBasicType::UInt64:
+        case LoggerBasicType::ULongLong:
+            os << as(uint64_t{});
+            break;
+        case LoggerBasicType::ULong:
+            if(e.size == 4)
+                os << as(uint32_t{});
+            else
+                os << as(uint64_t{});
+            break;
+        case LoggerBasicType::Float:
+            os << as(float{});
+            break;
+        case LoggerBasicType::Double:
+            os << as(double{});
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+inline void put_json_string(std::ostream& os, std::string_view s)
+{
+    os << '"';
+    for(char c : s)
+    {
+        switch(c)
+        {
+            case '"':
+                os << "\\\"";
+                break;
+            case '\\':
+                os << "\\\\";
+                break;
+            case '\n':
+                os << "\\n";
+                break;
+            case '\t':
+                os << "\\t";
+                break;
+            case '\r':
+                os << "\\r";
+                break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20)
+                    os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                       << static_cast<int>(c) << std::dec << std::setfill(' ');
+                else
+                    os << c;
+        }
+    }
+    os << '"';
+}
+}  // namespace muda
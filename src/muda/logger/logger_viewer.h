@@ -1,11 +1,31 @@
 #pragma once
 #include <muda/logger/logger_basic_data.h>
 #include <muda/muda_def.h>
+#include <muda/muda_config.h>
 #include <muda/check/check_cuda_errors.h>
 #include <muda/literal/unit.h>
 #include <muda/viewer/dense.h>
 namespace muda
 {
+enum class LogLevel : uint32_t
+{
+    Trace = 0,
+    Debug = 1,
+    Info  = 2,  // plain `logger << ...`
+    Warn  = 3,
+    Off   = 4,
+};
+
+class LoggerSampling
+{
+  public:
+    // keep every n-th message of each thread (counted per copy of the viewer)
+    uint32_t every_nth = 1;
+    // keep only the threads with (global linear thread id % thread_stride == thread_offset)
+    uint32_t thread_stride = 1;
+    uint32_t thread_offset = 0;
+};
+
 class LoggerViewer;
 class LogProxy
 {
@@ -79,6 +99,22 @@ class LoggerViewer
     MUDA_DEVICE LogProxy& push_string(const char* str);
     MUDA_DEVICE LogProxy  proxy() { return LogProxy(*this); }
 
+    /**
+     * \brief Start a message of the given level, the message is dropped
+     * (without touching the log buffer) if it is below the runtime level or
+     * filtered out by the sampling, and compiled out if it is below
+     * `MUDA_LOG_MIN_LEVEL`.
+     *
+     * usage:
+     *  logger.debug() << "x=" << x << "\n";
+     */
+    template <LogLevel Level>
+    MUDA_DEVICE LogProxy& log();
+    MUDA_DEVICE LogProxy& trace() { return log<LogLevel::Trace>(); }
+    MUDA_DEVICE LogProxy& debug() { return log<LogLevel::Debug>(); }
+    MUDA_DEVICE LogProxy& info() { return log<LogLevel::Info>(); }
+    MUDA_DEVICE LogProxy& warn() { return log<LogLevel::Warn>(); }
+
     LogProxy m_proxy;
 
   public:
@@ -92,10 +128,16 @@ class LoggerViewer
     int                      m_buffer_size       = 0;
     details::LoggerOffset*   m_offset            = nullptr;
 
+    // runtime filter, set by `Logger::set_level()`/`Logger::set_sampling()`
+    LogLevel       m_level = LogLevel::Trace;
+    LoggerSampling m_sampling;
+    uint32_t       m_sample_counter = 0;
+
+    MUDA_DEVICE bool     accept(LogLevel level);
     MUDA_DEVICE uint32_t next_meta_data_idx() const;
     MUDA_DEVICE uint32_t next_buffer_idx(uint32_t size) const;
     MUDA_DEVICE bool push_data(details::LoggerMetaData meta, const void* data);
 };
 }  // namespace muda
 
-#include <muda/logger/details/logger_viewer.inl>
\ No newline at end of file
+#include <muda/logger/details/logger_viewer.inl>
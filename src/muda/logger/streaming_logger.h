@@ -0,0 +1,126 @@
+/*****************************************************************//**
+ * \file   streaming_logger.h
+ * \brief  A double-buffered Logger that drains to a sink on a background
+ * thread, without device-wide synchronization.
+ *
+ * Kernels log into the *active* region through `viewer()`. `flip()` retires
+ * the active region in stream order and activates the other one; a host
+ * thread waits for the retired region (on its event only), copies it back,
+ * decodes it and appends the text to the sink.
+ *
+ * usage:
+ *  StreamingLogger logger{"sim.log"};
+ *  for(int frame = 0; frame < N; ++frame)
+ *  {
+ *      ParallelFor(256, 0, stream).apply(n,
+ *          [logger = logger.viewer()] __device__(int i) mutable
+ *          { logger << "i=" << i << "\n"; });
+ *      logger.flip();  // take a new viewer() after flip
+ *  }
+ *  logger.flush();
+ *********************************************************************/
+
+#pragma once
+#include <array>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <fstream>
+#include <functional>
+#include <string_view>
+#include <condition_variable>
+#include <muda/logger/logger.h>
+
+namespace muda
+{
+class StreamingLogger
+{
+    static constexpr size_t DEFAULT_META_SIZE   = 1_M;
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 8_M;
+
+  public:
+    // receives the decoded text of one retired region
+    using Sink = std::function<void(std::string_view)>;
+
+    StreamingLogger(Sink         sink,
+                    cudaStream_t stream      = nullptr,
+                    size_t       meta_size   = DEFAULT_META_SIZE,
+                    size_t       buffer_size = DEFAULT_BUFFER_SIZE);
+
+    // append to a file
+    StreamingLogger(std::string_view path,
+                    cudaStream_t     stream      = nullptr,
+                    size_t           meta_size   = DEFAULT_META_SIZE,
+                    size_t           buffer_size = DEFAULT_BUFFER_SIZE);
+
+    // flushes the active region
+    ~StreamingLogger();
+
+    StreamingLogger(const StreamingLogger&)            = delete;
+    StreamingLogger& operator=(const StreamingLogger&) = delete;
+
+    // viewer of the active region, only valid until the next `flip()`
+    MUDA_NODISCARD LoggerViewer viewer() const;
+
+    // retire the active region (stream-ordered) and activate the other one,
+    // blocks only if the other region is still being drained
+    void flip();
+
+    // flip and wait until everything retired has reached the sink
+    void flush();
+
+    // number of retired regions that ran out of meta data or buffer space
+    // (the overflowed entries are dropped), such a region is grown before it
+    // is activated again
+    MUDA_NODISCARD size_t overflow_count() const;
+
+    // see `Logger::set_level()`/`Logger::set_sampling()`, only affects the
+    // viewers taken after the call
+    void set_level(LogLevel level) { m_viewer.m_level = level; }
+    void set_sampling(const LoggerSampling& sampling)
+    {
+        details::check_logger_sampling(sampling);
+        m_viewer.m_sampling = sampling;
+    }
+
+  private:
+    class Region
+    {
+      public:
+        details::TempBuffer<uint32_t>                meta_data_id;
+        details::TempBuffer<details::LoggerMetaData> meta_data;
+        details::TempBuffer<char>                    buffer;
+        details::TempBuffer<details::LoggerOffset>   offset;
+        details::LoggerOffset* h_offset = nullptr;  // pinned
+        cudaEvent_t            retired  = nullptr;
+        bool                   draining = false;
+        bool                   grow_meta_data = false;
+        bool                   grow_buffer    = false;
+
+        std::vector<details::LoggerMetaData> h_meta_data;
+        std::vector<char>                    h_buffer;
+    };
+
+    void activate(Region& r);
+    void drain(Region& r);
+    void worker_loop();
+
+    cudaStream_t          m_stream      = nullptr;
+    cudaStream_t          m_copy_stream = nullptr;
+    Sink                  m_sink;
+    std::ofstream         m_file;
+    std::array<Region, 2> m_regions;
+    size_t                m_active = 0;
+    LoggerViewer          m_viewer;
+
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Region*>     m_queue;
+    bool                    m_stop      = false;
+    size_t                  m_in_flight = 0;
+    size_t                  m_overflow  = 0;
+    std::thread             m_worker;
+};
+}  // namespace muda
+
+#include "details/streaming_logger.inl"
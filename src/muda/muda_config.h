@@ -1,15 +1,62 @@
 #pragma once
+// runtime check level:
+//  0 = off      no check at all, zero overhead.
+//  1 = bounds   cheap bounds checks / asserts in viewers and trap on error,
+//               no viewer/kernel name recording (viewers stay small, no
+//               name strings), a compare + branch per access.
+//  2 = full     all viewer checks with viewer and kernel names in the error
+//               messages, names are recorded at every launch (host string
+//               cache lookups) and carried by every viewer.
+//  3 = sync_all full, and `Debug::debug_sync_all()` is on by default: every
+//               launch is synchronized to report errors at the faulting
+//               kernel, serializes the whole program.
+// if not given, MUDA_CHECK_ON=1 means level 2 (full), as before.
+#ifndef MUDA_CHECK_LEVEL
+#if defined(MUDA_CHECK_ON) && MUDA_CHECK_ON
+#define MUDA_CHECK_LEVEL 2
+#else
+#define MUDA_CHECK_LEVEL 0
+#endif
+#endif
 #ifndef MUDA_CHECK_ON
-#define MUDA_CHECK_ON 0
+#define MUDA_CHECK_ON (MUDA_CHECK_LEVEL >= 1)
 #endif
 #ifndef MUDA_COMPUTE_GRAPH_ON
 #define MUDA_COMPUTE_GRAPH_ON 0
 #endif
+// NaN/Inf sentinel on viewer accesses, independent of the check level,
+// see <muda/viewer/non_finite.h>
+#ifndef MUDA_NON_FINITE_CHECK
+#define MUDA_NON_FINITE_CHECK 0
+#endif
+// warp access tracing of viewers, see <muda/viewer/access_profile.h>
+#ifndef MUDA_ACCESS_PROFILE
+#define MUDA_ACCESS_PROFILE 0
+#endif
+// log statements below this level are compiled out:
+// 0 = trace, 1 = debug, 2 = info, 3 = warn, 4 = off
+#ifndef MUDA_LOG_MIN_LEVEL
+#define MUDA_LOG_MIN_LEVEL 0
+#endif
 
 namespace muda
 {
-constexpr bool RUNTIME_CHECK_ON = MUDA_CHECK_ON;
+enum class CheckLevel : int
+{
+    Off     = 0,
+    Bounds  = 1,
+    Full    = 2,
+    SyncAll = 3,
+};
+
+constexpr CheckLevel CHECK_LEVEL      = static_cast<CheckLevel>(MUDA_CHECK_LEVEL);
+constexpr bool       RUNTIME_CHECK_ON = CHECK_LEVEL >= CheckLevel::Bounds;
+// record and carry viewer/kernel names
+constexpr bool CHECK_NAMES_ON   = CHECK_LEVEL >= CheckLevel::Full;
 constexpr bool COMPUTE_GRAPH_ON = MUDA_COMPUTE_GRAPH_ON;
+constexpr bool NON_FINITE_CHECK_ON = MUDA_NON_FINITE_CHECK;
+constexpr bool ACCESS_PROFILE_ON   = MUDA_ACCESS_PROFILE;
+constexpr int  LOG_MIN_LEVEL    = MUDA_LOG_MIN_LEVEL;
 namespace config
 {
     constexpr bool on(bool cond = false)
@@ -19,6 +66,8 @@ namespace config
 }  // namespace config
 // debug viewer
 constexpr bool DEBUG_VIEWER = config::on(true);
+// debug viewer with viewer/kernel names in the messages of the index checks
+constexpr bool FULL_DEBUG_VIEWER = DEBUG_VIEWER && CHECK_LEVEL >= CheckLevel::Full;
 // trap on error happens
 constexpr bool TRAP_ON_ERROR = config::on(true);
 // light workload block size
@@ -6,11 +6,29 @@
 #include <unordered_map>
 #include <string>
 #include <muda/tools/string_pointer.h>
+#include <muda/tools/memory_registry.h>
 #include <vector>
 #include <cstring>
+#include <tuple>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 namespace muda::details
 {
+/**
+ * \brief Strings with a stable host and device address (kernel/viewer names).
+ *
+ * A new string is only written to the host buffer, the device copy is
+ * allocated on the first insertion into a buffer and filled by `flush()`,
+ * which uploads everything inserted since the last flush with one copy per
+ * buffer. `flush_all()` flushes every cache with pending strings, the
+ * launchers, cub wrappers and `Kernel` call it before each launch (call
+ * `muda::flush_names()` before a raw `<<<>>>` launch of named viewers).
+ *
+ * The empty string has no device copy (`device_string == nullptr`).
+ * Thread safe, one cache can be shared by all the host threads.
+ */
 class HostDeviceStringCache
 {
     class StringLocation
@@ -23,13 +41,20 @@ class HostDeviceStringCache
 
     std::unordered_map<std::string, StringLocation> m_string_map;
 
-    std::vector<char*> m_device_string_buffers;
-    std::vector<char*> m_host_string_buffers;
+    std::vector<char*>  m_device_string_buffers;
+    std::vector<char*>  m_host_string_buffers;
+    std::vector<size_t> m_buffer_used;
 
     size_t m_current_buffer_offset;
     size_t m_buffer_size;
 
-    StringPointer m_empty_string_pointer{};
+    // everything before (m_flushed_buffer, m_flushed_offset) is on the device
+    size_t       m_flushed_buffer = 0;
+    size_t       m_flushed_offset = 0;
+    cudaStream_t m_upload_stream  = nullptr;
+    mutable std::mutex m_mutex;
+
+    StringPointer m_empty_string_pointer{nullptr, const_cast<char*>(""), 0};
 
   public:
     HostDeviceStringCache(size_t buffer_size = 4_M)
@@ -38,27 +63,24 @@ class HostDeviceStringCache
     {
         m_device_string_buffers.reserve(32);
         m_host_string_buffers.reserve(32);
-
-        char* s;
-        checkCudaErrors(cudaMalloc(&s, m_buffer_size * sizeof(char)));
-        m_device_string_buffers.emplace_back(s);
-        m_host_string_buffers.emplace_back(new char[m_buffer_size]);
-
-        m_empty_string_pointer = get_string_pointer("");  // insert empty string
     }
     ~HostDeviceStringCache()
     {
+        unregister_pending();
+        // we don't check the error here to prevent exception when app is shutting down
         for(auto s : m_device_string_buffers)
+        {
+            MemoryRegistry::on_free(s);
             cudaFree(s);
+        }
         for(auto s : m_host_string_buffers)
             delete[] s;
+        if(m_upload_stream)
+            cudaStreamDestroy(m_upload_stream);
     }
-    // delete copy
+    // the addresses are handed out, no copy or move
     HostDeviceStringCache(const HostDeviceStringCache&)            = delete;
     HostDeviceStringCache& operator=(const HostDeviceStringCache&) = delete;
-    // move
-    HostDeviceStringCache(HostDeviceStringCache&&)            = default;
-    HostDeviceStringCache& operator=(HostDeviceStringCache&&) = default;
 
     StringPointer operator[](std::string_view s)
     {
@@ -66,12 +88,142 @@ class HostDeviceStringCache
         {
             return m_empty_string_pointer;
         }
-        return get_string_pointer(s);
+        bool inserted = false;
+        auto ptr      = get_string_pointer(s, inserted);
+        if(inserted)  // outside of m_mutex, `flush_all()` locks in the other order
+            register_pending();
+        return ptr;
+    }
+
+    // upload the strings inserted since the last flush, blocks on a private
+    // stream only
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if(!_has_pending())
+            return;
+
+        if(!m_upload_stream)
+            checkCudaErrors(cudaStreamCreateWithFlags(&m_upload_stream, cudaStreamNonBlocking));
+
+        auto last = m_host_string_buffers.size() - 1;
+        for(auto b = m_flushed_buffer; b <= last; ++b)
+        {
+            auto begin = b == m_flushed_buffer ? m_flushed_offset : 0;
+            auto end   = b == last ? m_current_buffer_offset : m_buffer_used[b];
+            if(end > begin)
+                checkCudaErrors(cudaMemcpyAsync(m_device_string_buffers[b] + begin,
+                                                m_host_string_buffers[b] + begin,
+                                                end - begin,
+                                                cudaMemcpyHostToDevice,
+                                                m_upload_stream));
+        }
+        checkCudaErrors(cudaStreamSynchronize(m_upload_stream));
+
+        m_flushed_buffer = last;
+        m_flushed_offset = m_current_buffer_offset;
+    }
+
+    bool has_pending() const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        return _has_pending();
+    }
+
+    // flush every cache of the process that has pending strings
+    static void flush_all()
+    {
+        auto& p = pending();
+        if(!p.any.load(std::memory_order_acquire))  // fast path, nothing new
+            return;
+        std::lock_guard<std::mutex> lock{p.mutex};
+        for(auto cache : p.caches)
+            cache->flush();
+        p.caches.clear();
+        p.any.store(false, std::memory_order_release);
+    }
+
+    // all cached strings, in insertion order
+    std::vector<std::string> strings() const
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        std::vector<std::pair<const std::string*, const StringLocation*>> items;
+        items.reserve(m_string_map.size());
+        for(auto& [str, loc] : m_string_map)
+            items.push_back({&str, &loc});
+        std::sort(items.begin(),
+                  items.end(),
+                  [](const auto& a, const auto& b)
+                  {
+                      return std::tie(a.second->buffer_index, a.second->offset)
+                             < std::tie(b.second->buffer_index, b.second->offset);
+                  });
+        std::vector<std::string> ret;
+        ret.reserve(items.size());
+        for(auto& [str, loc] : items)
+            ret.push_back(*str);
+        return ret;
     }
 
   private:
-    StringPointer get_string_pointer(std::string_view s)
+    bool _has_pending() const
     {
+        return !m_host_string_buffers.empty()
+               && (m_flushed_buffer != m_host_string_buffers.size() - 1
+                   || m_flushed_offset != m_current_buffer_offset);
+    }
+
+    class Pending
+    {
+      public:
+        std::mutex                          mutex;
+        std::vector<HostDeviceStringCache*> caches;
+        std::atomic<bool>                   any{false};
+    };
+
+    // leaked on purpose: the caches are function-local statics too and
+    // unregister themselves on destruction, which may run after the exit-time
+    // destruction of any static made later than them
+    static Pending& pending()
+    {
+        static Pending* p = new Pending;
+        return *p;
+    }
+
+    void register_pending()
+    {
+        auto&                       p = pending();
+        std::lock_guard<std::mutex> lock{p.mutex};
+        if(std::find(p.caches.begin(), p.caches.end(), this) == p.caches.end())
+            p.caches.push_back(this);
+        p.any.store(true, std::memory_order_release);
+    }
+
+    void unregister_pending()
+    {
+        auto&                       p = pending();
+        std::lock_guard<std::mutex> lock{p.mutex};
+        p.caches.erase(std::remove(p.caches.begin(), p.caches.end(), this),
+                       p.caches.end());
+    }
+
+    void new_buffer()
+    {
+        if(!m_host_string_buffers.empty())
+            m_buffer_used.back() = m_current_buffer_offset;
+
+        char* s;
+        checkCudaErrors(cudaMalloc(&s, m_buffer_size * sizeof(char)));
+        MemoryRegistry::on_alloc(s, m_buffer_size * sizeof(char), MemoryCategory::StringCache);
+        m_device_string_buffers.emplace_back(s);
+        m_host_string_buffers.emplace_back(new char[m_buffer_size]);
+        m_buffer_used.emplace_back(0);
+        m_current_buffer_offset = 0;
+    }
+
+    StringPointer get_string_pointer(std::string_view s, bool& inserted)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
         auto         str           = std::string{s};
         auto         it            = m_string_map.find(str);
         char*        device_string = nullptr;
@@ -87,36 +239,32 @@ class HostDeviceStringCache
         }
         else  // need insert
         {
-            auto  zero_end_length = str.size() + 1;
-            auto& loc             = m_string_map[str];  // insert
-
-            if(m_current_buffer_offset + zero_end_length > m_buffer_size)  // need new buffer
-            {
-                char* s;
-                checkCudaErrors(cudaMalloc(&s, m_buffer_size * sizeof(char)));
-                m_device_string_buffers.emplace_back(s);
-                m_host_string_buffers.emplace_back(new char[m_buffer_size]);
-                m_current_buffer_offset = 0;
-            }
+            auto zero_end_length = str.size() + 1;
+            MUDA_ASSERT(zero_end_length <= m_buffer_size,
+                        "HostDeviceStringCache: string of size %d exceeds the buffer size %d",
+                        (int)zero_end_length,
+                        (int)m_buffer_size);
+
+            // the device buffer is only allocated on the first insertion
+            if(m_host_string_buffers.empty()
+               || m_current_buffer_offset + zero_end_length > m_buffer_size)  // need new buffer
+                new_buffer();
+
+            auto& loc = m_string_map[str];  // insert
 
             auto device_buffer = m_device_string_buffers.back();
             auto host_buffer   = m_host_string_buffers.back();
 
-            // copy string to host buffer (with '\0' end)
+            // copy string to host buffer (with '\0' end), uploaded by `flush()`
             host_buffer[m_current_buffer_offset + str.size()] = '\0';
             std::memcpy(host_buffer + m_current_buffer_offset, str.data(), str.size());
 
-            // copy string from host buffer to device buffer
-            checkCudaErrors(cudaMemcpy(device_buffer + m_current_buffer_offset,
-                                       host_buffer + m_current_buffer_offset,
-                                       str.size() + 1,
-                                       cudaMemcpyHostToDevice));
-
             loc.buffer_index = m_host_string_buffers.size() - 1;
             loc.offset       = m_current_buffer_offset;
             loc.size         = zero_end_length;  // include '\0'
 
             m_current_buffer_offset += zero_end_length;
+            inserted = true;
 
             device_string = device_buffer + loc.offset;
             host_string   = host_buffer + loc.offset;
@@ -125,4 +273,4 @@ class HostDeviceStringCache
         return StringPointer{device_string, host_string, str_length};
     }
 };
-}  // namespace muda::details
\ No newline at end of file
+}  // namespace muda::details
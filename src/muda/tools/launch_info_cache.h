@@ -5,29 +5,36 @@ namespace muda::details
 class LaunchInfoCache
 {
   private:
-    HostDeviceStringCache m_view_name_string_cache;
-    HostDeviceStringCache m_kernel_name_string_cache;
-    HostDeviceStringCache m_capture_name_string_cache;
+    // shared by all the host threads, only the current names are per thread
+    class NameCaches
+    {
+      public:
+        HostDeviceStringCache view_name_string_cache;
+        HostDeviceStringCache kernel_name_string_cache;
+        HostDeviceStringCache capture_name_string_cache;
+    };
+
+    StringPointer m_current_kernel_name{nullptr, const_cast<char*>(""), 0};
+    StringPointer m_current_capture_name{nullptr, const_cast<char*>(""), 0};
 
-    StringPointer m_current_kernel_name;
-    StringPointer m_current_capture_name;
+    LaunchInfoCache() MUDA_NOEXCEPT = default;
 
-    LaunchInfoCache() MUDA_NOEXCEPT
+    static NameCaches& caches() MUDA_NOEXCEPT
     {
-        m_current_kernel_name = m_kernel_name_string_cache[std::string_view{""}];
-        m_current_capture_name = m_capture_name_string_cache[std::string_view{""}];
+        static NameCaches caches;
+        return caches;
     }
 
   public:
 
     static auto view_name(std::string_view name) MUDA_NOEXCEPT
     {
-        return instance().m_view_name_string_cache[name];
+        return caches().view_name_string_cache[name];
     }
     static auto current_kernel_name(std::string_view name) MUDA_NOEXCEPT
     {
         auto& ins                 = instance();
-        ins.m_current_kernel_name = ins.m_kernel_name_string_cache[name];
+        ins.m_current_kernel_name = caches().kernel_name_string_cache[name];
         return ins.m_current_kernel_name;
     }
 
@@ -39,7 +46,7 @@ class LaunchInfoCache
     static auto current_capture_name(std::string_view name) MUDA_NOEXCEPT
     {
         auto& ins                  = instance();
-        ins.m_current_capture_name = ins.m_capture_name_string_cache[name];
+        ins.m_current_capture_name = caches().capture_name_string_cache[name];
         return ins.m_current_capture_name;
     }
 
@@ -48,10 +55,21 @@ class LaunchInfoCache
         return instance().m_current_capture_name;
     }
 
+    // kernel/viewer names seen by the process, in insertion order
+    static auto kernel_names()
+    {
+        return caches().kernel_name_string_cache.strings();
+    }
+    static auto view_names() { return caches().view_name_string_cache.strings(); }
+
+    // upload the names recorded since the last flush, called before a launch
+    // (also flushes the other string caches, e.g. the field entry names)
+    static void flush() { HostDeviceStringCache::flush_all(); }
+
     static LaunchInfoCache& instance() MUDA_NOEXCEPT
     {
         thread_local static LaunchInfoCache instance;
         return instance;
     }
 };
-}  // namespace muda::details
\ No newline at end of file
+}  // namespace muda::details
@@ -0,0 +1,322 @@
+/*****************************************************************//**
+ * \file   memory_registry.h
+ * \brief  Opt-in accounting of all device memory allocated by muda.
+ *
+ * Every muda allocation (DeviceBuffer, DeviceVar, TempBuffer, string caches,
+ * Logger, LinearSystemContext, Field ...) reports to the registry. When the
+ * registry is enabled, each allocation is tagged with a category and an
+ * optional name, so that current/peak usage can be attributed and the live
+ * allocations can be dumped at exit.
+ *
+ * usage:
+ *  MemoryRegistry::enable();
+ *  {
+ *      MemoryScope scope{MemoryCategory::Other, "my_solver"};
+ *      DeviceBuffer<float> buffer(1024); // tagged as Other/"my_solver"
+ *  }
+ *  MemoryRegistry::report(std::cout);
+ *********************************************************************/
+
+#pragma once
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <muda/muda_def.h>
+
+namespace muda
+{
+enum class MemoryCategory : uint8_t
+{
+    Buffer,        // DeviceBuffer/DeviceVar/... allocated through `Memory`
+    TempBuffer,    // details::TempBuffer
+    StringCache,   // HostDeviceStringCache (kernel/viewer names)
+    Logger,        // Logger meta data and buffers
+    LinearSystem,  // LinearSystemContext temp buffers
+    Field,         // Field data buffers
+    Debug,         // NonFiniteSentinel/AccessProfiler records
+    Other,
+    Max
+};
+
+inline std::string_view enum_name(MemoryCategory c)
+{
+    switch(c)
+    {
+        case MemoryCategory::Buffer:
+            return "Buffer";
+        case MemoryCategory::TempBuffer:
+            return "TempBuffer";
+        case MemoryCategory::StringCache:
+            return "StringCache";
+        case MemoryCategory::Logger:
+            return "Logger";
+        case MemoryCategory::LinearSystem:
+            return "LinearSystem";
+        case MemoryCategory::Field:
+            return "Field";
+        case MemoryCategory::Debug:
+            return "Debug";
+        case MemoryCategory::Other:
+            return "Other";
+        default:
+            return "Unknown";
+    }
+}
+
+class MemoryCategoryStats
+{
+  public:
+    size_t current_bytes = 0;
+    size_t peak_bytes    = 0;
+    size_t alloc_count   = 0;
+    size_t free_count    = 0;
+};
+
+class MemoryAllocationInfo
+{
+  public:
+    void*          ptr      = nullptr;
+    size_t         bytes    = 0;
+    MemoryCategory category = MemoryCategory::Other;
+    std::string    name;
+};
+
+class MemoryRegistry
+{
+    static constexpr size_t CategoryCount = static_cast<size_t>(MemoryCategory::Max);
+
+    class ScopeInfo
+    {
+      public:
+        MemoryCategory category;
+        std::string    name;
+    };
+
+    class Impl
+    {
+      public:
+        std::mutex                                      mutex;
+        std::unordered_map<void*, MemoryAllocationInfo> allocations;
+        std::array<MemoryCategoryStats, CategoryCount>  stats;
+        size_t                                          current_bytes = 0;
+        size_t                                          peak_bytes    = 0;
+        bool                                            report_at_exit = false;
+        bool                                            atexit_registered = false;
+    };
+
+    static auto& _is_enabled()
+    {
+        static std::atomic<bool> m_is_enabled(false);
+        return m_is_enabled;
+    }
+
+    static Impl& impl()
+    {
+        // intentionally leaked, so that allocations freed during static
+        // destruction can still be reported safely
+        static Impl* m_impl = new Impl{};
+        return *m_impl;
+    }
+
+    static auto& scopes()
+    {
+        thread_local static std::vector<ScopeInfo> m_scopes;
+        return m_scopes;
+    }
+
+    friend class MemoryScope;
+
+  public:
+    // turn on/off the registry, allocations happening when the registry is
+    // off are not tracked (and their free is ignored)
+    static void enable(bool value = true) { _is_enabled() = value; }
+    static bool is_enabled()
+    {
+        return _is_enabled().load(std::memory_order_relaxed);
+    }
+
+    // dump the live allocations to std::cerr when the program exits
+    static void report_at_exit(bool value = true)
+    {
+        auto&                       r = impl();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.report_at_exit = value;
+        if(value && !r.atexit_registered)
+        {
+            r.atexit_registered = true;
+            std::atexit(
+                []
+                {
+                    if(impl().report_at_exit)
+                        report_live(std::cerr);
+                });
+        }
+    }
+
+    // called by muda internally
+    // if there is an active `MemoryScope`, the scope category and name override
+    // the default category
+    static void on_alloc(void* ptr, size_t bytes, MemoryCategory default_category)
+    {
+        if(!is_enabled() || !ptr)
+            return;
+        auto& s = scopes();
+        if(s.empty())
+            on_alloc(ptr, bytes, default_category, "");
+        else
+            on_alloc(ptr, bytes, s.back().category, s.back().name);
+    }
+
+    static void on_alloc(void* ptr, size_t bytes, MemoryCategory category, std::string_view name)
+    {
+        if(!is_enabled() || !ptr)
+            return;
+        auto&                       r = impl();
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        auto [it, inserted] = r.allocations.try_emplace(
+            ptr, MemoryAllocationInfo{ptr, bytes, category, std::string{name}});
+        if(!inserted)  // the pointer was reused by the driver before we saw the free
+        {
+            release(r, it->second);
+            it->second = MemoryAllocationInfo{ptr, bytes, category, std::string{name}};
+        }
+
+        auto& st = r.stats[static_cast<size_t>(category)];
+        st.current_bytes += bytes;
+        st.peak_bytes = std::max(st.peak_bytes, st.current_bytes);
+        st.alloc_count++;
+        r.current_bytes += bytes;
+        r.peak_bytes = std::max(r.peak_bytes, r.current_bytes);
+    }
+
+    static void on_free(void* ptr)
+    {
+        if(!is_enabled() || !ptr)
+            return;
+        auto&                       r = impl();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto                        it = r.allocations.find(ptr);
+        if(it == r.allocations.end())  // allocated before the registry was enabled
+            return;
+        release(r, it->second);
+        r.allocations.erase(it);
+    }
+
+    static MemoryCategoryStats stats(MemoryCategory category)
+    {
+        auto&                       r = impl();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        return r.stats[static_cast<size_t>(category)];
+    }
+
+    static size_t current_bytes()
+    {
+        auto&                       r = impl();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        return r.current_bytes;
+    }
+
+    static size_t peak_bytes()
+    {
+        auto&                       r = impl();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        return r.peak_bytes;
+    }
+
+    // reset the peak of all categories to their current value
+    static void reset_peak()
+    {
+        auto&                       r = impl();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for(auto& st : r.stats)
+            st.peak_bytes = st.current_bytes;
+        r.peak_bytes = r.current_bytes;
+    }
+
+    // live allocations sorted by size (largest first)
+    static std::vector<MemoryAllocationInfo> live_allocations()
+    {
+        std::vector<MemoryAllocationInfo> ret;
+        {
+            auto&                       r = impl();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            ret.reserve(r.allocations.size());
+            for(auto& [ptr, info] : r.allocations)
+                ret.push_back(info);
+        }
+        std::sort(ret.begin(),
+                  ret.end(),
+                  [](const MemoryAllocationInfo& a, const MemoryAllocationInfo& b)
+                  { return a.bytes > b.bytes; });
+        return ret;
+    }
+
+    // print current/peak bytes per category
+    static void report(std::ostream& os = std::cout)
+    {
+        os << "[muda] device memory usage (current / peak / allocs / frees):\n";
+        for(size_t i = 0; i < CategoryCount; ++i)
+        {
+            auto c  = static_cast<MemoryCategory>(i);
+            auto st = stats(c);
+            os << "  " << std::left << std::setw(14) << enum_name(c) << std::right
+               << std::setw(14) << st.current_bytes << " / " << std::setw(14)
+               << st.peak_bytes << " / " << st.alloc_count << " / "
+               << st.free_count << "\n";
+        }
+        os << "  " << std::left << std::setw(14) << "Total" << std::right
+           << std::setw(14) << current_bytes() << " / " << std::setw(14)
+           << peak_bytes() << "\n";
+    }
+
+    // print all live allocations
+    static void report_live(std::ostream& os = std::cout)
+    {
+        auto live = live_allocations();
+        os << "[muda] " << live.size() << " live device allocation(s):\n";
+        for(auto& info : live)
+        {
+            os << "  " << info.ptr << " " << std::setw(14) << info.bytes << " bytes ["
+               << enum_name(info.category) << "]";
+            if(!info.name.empty())
+                os << " " << info.name;
+            os << "\n";
+        }
+    }
+
+  private:
+    static void release(Impl& r, const MemoryAllocationInfo& info)
+    {
+        auto& st = r.stats[static_cast<size_t>(info.category)];
+        st.current_bytes -= info.bytes;
+        st.free_count++;
+        r.current_bytes -= info.bytes;
+    }
+};
+
+/**
+ * \brief Tag all muda allocations happening on this thread in the scope
+ * with a category and a name.
+ */
+class MemoryScope
+{
+  public:
+    MemoryScope(MemoryCategory category, std::string_view name = "")
+    {
+        MemoryRegistry::scopes().push_back({category, std::string{name}});
+    }
+    ~MemoryScope() { MemoryRegistry::scopes().pop_back(); }
+
+    MemoryScope(const MemoryScope&)            = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+};
+}  // namespace muda
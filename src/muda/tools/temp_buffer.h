@@ -1,6 +1,7 @@
 #pragma once
 #include <cuda_runtime.h>
 #include <muda/check/check.h>
+#include <muda/tools/memory_registry.h>
 namespace muda::details
 {
 template <typename T>
@@ -16,6 +17,7 @@ class TempBuffer
         if(m_data)
         {
             // we don't check the error here to prevent exception when app is shutting down
+            MemoryRegistry::on_free(m_data);
             cudaFree(m_data);
         }
     }
@@ -87,8 +89,10 @@ class TempBuffer
         }
         T* new_data = nullptr;
         checkCudaErrors(cudaMalloc(&new_data, new_cap * sizeof(T)));
+        MemoryRegistry::on_alloc(new_data, new_cap * sizeof(T), MemoryCategory::TempBuffer);
         if(m_data)
         {
+            MemoryRegistry::on_free(m_data);
             checkCudaErrors(cudaFree(m_data));
         }
         m_data     = new_data;
@@ -112,6 +116,7 @@ class TempBuffer
         m_capacity = 0;
         if(m_data)
         {
+            MemoryRegistry::on_free(m_data);
             checkCudaErrors(cudaFree(m_data));
             m_data = nullptr;
         }
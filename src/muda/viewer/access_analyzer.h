@@ -0,0 +1,166 @@
+/*****************************************************************//**
+ * \file   access_analyzer.h
+ * \brief  Host analysis of warp access traces of viewers, see
+ *         <muda/viewer/access_profile.h>.
+ *
+ * Pure host C++ (no CUDA dependency), so recorded traces can be analyzed
+ * and tested anywhere.
+ *
+ * For every warp-wide request (one viewer access of the active lanes):
+ *  - sectors:   distinct 32-byte sectors touched by the request
+ *  - ideal:     sectors of the same bytes packed contiguously
+ *  - coalesced: sectors <= ideal + 1 (a misaligned start is tolerated)
+ *  - strides:   address delta (bytes) between consecutive active lanes
+ *********************************************************************/
+
+#pragma once
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace muda
+{
+class AccessTrace
+{
+  public:
+    std::string kernel_name;
+    std::string viewer_name;
+    uint32_t    element_size = 0;  // bytes accessed by each lane
+    uint32_t    active_mask  = 0;  // lanes that took part in the request
+    std::array<uint64_t, 32> address{};  // indexed by lane id
+
+    int active_count() const
+    {
+        int n = 0;
+        for(int lane = 0; lane < 32; ++lane)
+            n += (active_mask >> lane) & 1u;
+        return n;
+    }
+};
+
+class AccessPatternStats
+{
+  public:
+    static constexpr uint64_t SectorSize = 32;
+
+    std::string viewer_name;
+    size_t      requests           = 0;
+    size_t      coalesced_requests = 0;
+    size_t      sectors            = 0;
+    size_t      ideal_sectors      = 0;
+    // stride in bytes -> count
+    std::map<int64_t, size_t> stride_histogram;
+
+    double sectors_per_request() const
+    {
+        return requests ? double(sectors) / requests : 0.0;
+    }
+    double ideal_sectors_per_request() const
+    {
+        return requests ? double(ideal_sectors) / requests : 0.0;
+    }
+    double coalesced_fraction() const
+    {
+        return requests ? double(coalesced_requests) / requests : 1.0;
+    }
+    // the most frequent stride (0 if no stride has been seen)
+    int64_t dominant_stride() const
+    {
+        auto it = std::max_element(stride_histogram.begin(),
+                                   stride_histogram.end(),
+                                   [](auto& a, auto& b) { return a.second < b.second; });
+        return it == stride_histogram.end() ? 0 : it->first;
+    }
+
+    void add(const AccessTrace& t)
+    {
+        std::vector<uint64_t> touched;
+        touched.reserve(64);
+        int     active    = 0;
+        int64_t last_addr = 0;
+        for(int lane = 0; lane < 32; ++lane)
+        {
+            if(!((t.active_mask >> lane) & 1u))
+                continue;
+            auto addr = t.address[lane];
+            auto size = std::max<uint64_t>(t.element_size, 1);
+            for(auto s = addr / SectorSize; s <= (addr + size - 1) / SectorSize; ++s)
+                touched.push_back(s);
+            if(active > 0)
+                ++stride_histogram[static_cast<int64_t>(addr) - last_addr];
+            last_addr = static_cast<int64_t>(addr);
+            ++active;
+        }
+        if(active == 0)
+            return;
+
+        std::sort(touched.begin(), touched.end());
+        auto n     = size_t(std::unique(touched.begin(), touched.end()) - touched.begin());
+        auto bytes = uint64_t(active) * std::max<uint64_t>(t.element_size, 1);
+        auto ideal = size_t((bytes + SectorSize - 1) / SectorSize);
+
+        ++requests;
+        sectors += n;
+        ideal_sectors += ideal;
+        if(n <= ideal + 1)
+            ++coalesced_requests;
+    }
+};
+
+/**
+ * \brief Statistics per viewer name, the least coalesced viewer first (the
+ * first candidate to re-layout).
+ */
+inline std::vector<AccessPatternStats> analyze_access(const std::vector<AccessTrace>& traces)
+{
+    std::map<std::string, AccessPatternStats> by_name;
+    for(auto& t : traces)
+    {
+        auto& s = by_name[t.viewer_name];
+        s.viewer_name = t.viewer_name;
+        s.add(t);
+    }
+
+    std::vector<AccessPatternStats> ret;
+    ret.reserve(by_name.size());
+    for(auto& [name, s] : by_name)
+        ret.push_back(std::move(s));
+    std::sort(ret.begin(),
+              ret.end(),
+              [](const AccessPatternStats& a, const AccessPatternStats& b)
+              {
+                  auto ra = a.sectors_per_request() / std::max(a.ideal_sectors_per_request(), 1.0);
+                  auto rb = b.sectors_per_request() / std::max(b.ideal_sectors_per_request(), 1.0);
+                  return ra > rb;
+              });
+    return ret;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const AccessPatternStats& s)
+{
+    os << "viewer [" << (s.viewer_name.empty() ? "~" : s.viewer_name) << "]: "
+       << s.requests << " request(s), " << std::fixed << std::setprecision(2)
+       << s.sectors_per_request() << " sectors/request (ideal "
+       << s.ideal_sectors_per_request() << "), "
+       << s.coalesced_fraction() * 100 << "% coalesced" << std::defaultfloat;
+    if(!s.stride_histogram.empty())
+    {
+        os << ", strides(bytes):";
+        for(auto& [stride, count] : s.stride_histogram)
+            os << " " << stride << "x" << count;
+    }
+    return os;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const std::vector<AccessPatternStats>& stats)
+{
+    for(auto& s : stats)
+        os << s << "\n";
+    return os;
+}
+}  // namespace muda
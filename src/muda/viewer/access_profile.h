@@ -0,0 +1,261 @@
+/*****************************************************************//**
+ * \file   access_profile.h
+ * \brief  Warp access tracing of viewers (`MUDA_ACCESS_PROFILE=1`).
+ *
+ * Every element access through `Dense*`, `DenseVectorViewer` and
+ * `FieldEntryViewer` is a request: the lanes of a warp accessing the same
+ * viewer together are grouped, and the addresses of the group are stored as
+ * one sample (every n-th request, see `AccessProfiler::set_sample_every()`)
+ * to a process-wide device buffer. `AccessProfiler::report()` downloads the
+ * samples and analyzes them per viewer name, see <muda/viewer/access_analyzer.h>.
+ *
+ * For field entries of vector/matrix type, the address of the first
+ * component is recorded (the stride of the other components is the same).
+ *
+ * Viewer and kernel names are only known with `MUDA_CHECK_LEVEL >= 2`,
+ * otherwise all the accesses are reported under "~".
+ *
+ * usage:
+ *  AccessProfiler::reset();
+ *  ... launch kernels ...
+ *  std::cout << AccessProfiler::report();
+ *********************************************************************/
+
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <type_traits>
+#include <cuda_runtime.h>
+#include <muda/muda_def.h>
+#include <muda/muda_config.h>
+#include <muda/check/check_cuda_errors.h>
+#include <muda/tools/memory_registry.h>
+#include <muda/viewer/non_finite.h>
+#include <muda/viewer/access_analyzer.h>
+
+namespace muda
+{
+namespace details
+{
+    class AccessSample
+    {
+      public:
+        uint64_t    address[32];
+        uint32_t    active_mask;
+        uint32_t    element_size;
+        const char* kernel_name;  // host strings of the string cache
+        const char* viewer_name;
+    };
+
+    class AccessProfileBuffer
+    {
+      public:
+        AccessSample* samples      = nullptr;
+        uint32_t      capacity     = 0;
+        uint32_t      sample_every = 1;
+        uint32_t      requests     = 0;  // all the requests, sampled or not
+        uint32_t      count        = 0;  // samples taken, may exceed the capacity
+    };
+
+    MUDA_INLINE MUDA_GENERIC void record_access(AccessProfileBuffer* buffer,
+                                                const void*          address,
+                                                uint32_t             element_size,
+                                                const char*          kernel_name,
+                                                const char* viewer_name) MUDA_NOEXCEPT
+    {
+#ifdef __CUDA_ARCH__
+        if(!buffer)
+            return;
+
+        unsigned int lane;
+        asm volatile("mov.u32 %0, %%laneid;" : "=r"(lane));
+        // the same instruction may access different viewers in one warp
+        auto group = __match_any_sync(__activemask(),
+                                      reinterpret_cast<unsigned long long>(viewer_name));
+        auto leader = static_cast<unsigned int>(__ffs(group) - 1);
+
+        uint32_t slot = ~0u;
+        if(lane == leader)
+        {
+            auto request = atomicAdd(&buffer->requests, 1u);
+            if(request % buffer->sample_every == 0)
+            {
+                slot = atomicAdd(&buffer->count, 1u);
+                if(slot >= buffer->capacity)
+                    slot = ~0u;
+            }
+        }
+        slot = __shfl_sync(group, slot, leader);
+        if(slot == ~0u)
+            return;
+
+        auto& sample         = buffer->samples[slot];
+        sample.address[lane] = reinterpret_cast<uint64_t>(address);
+        if(lane == leader)
+        {
+            sample.active_mask  = group;
+            sample.element_size = element_size;
+            sample.kernel_name  = kernel_name;
+            sample.viewer_name  = viewer_name;
+        }
+#endif
+    }
+
+    // address and size of the accessed element (first component of eigen maps)
+    template <typename T>
+    MUDA_INLINE MUDA_GENERIC void accessed_range(const T&     v,
+                                                 const void*& address,
+                                                 uint32_t& size) MUDA_NOEXCEPT
+    {
+        if constexpr(is_eigen_like<T>::value)
+        {
+            address = v.data();
+            size    = sizeof(typename T::Scalar);
+        }
+        else
+        {
+            address = &v;
+            size    = sizeof(T);
+        }
+    }
+}  // namespace details
+
+class AccessProfiler
+{
+    static constexpr uint32_t DEFAULT_CAPACITY = 64 * 1024;
+
+    class State
+    {
+      public:
+        details::AccessProfileBuffer  host;
+        details::AccessProfileBuffer* device = nullptr;
+
+        State()
+        {
+            checkCudaErrors(cudaMalloc(&device, sizeof(details::AccessProfileBuffer)));
+            MemoryRegistry::on_alloc(device, sizeof(details::AccessProfileBuffer), MemoryCategory::Debug);
+            allocate_samples(DEFAULT_CAPACITY);
+            checkCudaErrors(cudaMemcpy(device, &host, sizeof(host), cudaMemcpyHostToDevice));
+        }
+
+        ~State()
+        {
+            // we don't check the error here to prevent exception when app is shutting down
+            free_samples();
+            MemoryRegistry::on_free(device);
+            cudaFree(device);
+        }
+
+        State(const State&)            = delete;
+        State& operator=(const State&) = delete;
+
+        void allocate_samples(uint32_t capacity)
+        {
+            auto bytes = capacity * sizeof(details::AccessSample);
+            checkCudaErrors(cudaMalloc(&host.samples, bytes));
+            MemoryRegistry::on_alloc(host.samples, bytes, MemoryCategory::Debug);
+            host.capacity = capacity;
+        }
+
+        void free_samples()
+        {
+            MemoryRegistry::on_free(host.samples);
+            cudaFree(host.samples);
+            host.samples  = nullptr;
+            host.capacity = 0;
+        }
+    };
+
+    static State& state()
+    {
+        static State s;  // allocated on first use
+        return s;
+    }
+
+  public:
+    // the process-wide device buffer, allocated on first use
+    static details::AccessProfileBuffer* buffer() { return state().device; }
+
+    /**
+     * \brief Keep at most `capacity` samples, drops the current ones.
+     *
+     * Waits for the whole device: the kernels of any stream may still record
+     * to the old samples. The new (empty) header is uploaded on `stream`.
+     */
+    static void set_capacity(uint32_t capacity, cudaStream_t stream = nullptr)
+    {
+        MUDA_ASSERT(capacity > 0, "AccessProfiler: capacity must be > 0");
+        auto& s = state();
+        checkCudaErrors(cudaDeviceSynchronize());
+        s.free_samples();
+        s.allocate_samples(capacity);
+        reset(stream);
+    }
+
+    // sample one request out of `n` (counted over the whole device)
+    static void set_sample_every(uint32_t n, cudaStream_t stream = nullptr)
+    {
+        MUDA_ASSERT(n > 0, "AccessProfiler: sample_every must be > 0");
+        auto& s             = state();
+        s.host.sample_every = n;
+        reset(stream);
+    }
+
+    // synchronizes `stream`
+    static std::vector<AccessTrace> traces(cudaStream_t stream = nullptr)
+    {
+        auto&                        s = state();
+        details::AccessProfileBuffer header;
+        checkCudaErrors(cudaMemcpyAsync(
+            &header, s.device, sizeof(header), cudaMemcpyDeviceToHost, stream));
+        checkCudaErrors(cudaStreamSynchronize(stream));
+
+        auto count = std::min(header.count, header.capacity);
+        std::vector<details::AccessSample> samples(count);
+        checkCudaErrors(cudaMemcpyAsync(samples.data(),
+                                        header.samples,
+                                        count * sizeof(details::AccessSample),
+                                        cudaMemcpyDeviceToHost,
+                                        stream));
+        checkCudaErrors(cudaStreamSynchronize(stream));
+
+        std::vector<AccessTrace> ret(count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            auto& from        = samples[i];
+            auto& to          = ret[i];
+            to.kernel_name    = from.kernel_name ? from.kernel_name : "";
+            to.viewer_name    = from.viewer_name ? from.viewer_name : "";
+            to.element_size   = from.element_size;
+            to.active_mask    = from.active_mask;
+            for(int lane = 0; lane < 32; ++lane)
+                to.address[lane] = from.address[lane];
+        }
+        return ret;
+    }
+
+    // requests seen since the last reset (sampled or not)
+    static uint32_t requests(cudaStream_t stream = nullptr)
+    {
+        details::AccessProfileBuffer header;
+        checkCudaErrors(cudaMemcpyAsync(
+            &header, state().device, sizeof(header), cudaMemcpyDeviceToHost, stream));
+        checkCudaErrors(cudaStreamSynchronize(stream));
+        return header.requests;
+    }
+
+    // synchronizes `stream`
+    static std::vector<AccessPatternStats> report(cudaStream_t stream = nullptr)
+    {
+        return analyze_access(traces(stream));
+    }
+
+    static void reset(cudaStream_t stream = nullptr)
+    {
+        auto& s = state();
+        // the counters of `s.host` are always 0
+        checkCudaErrors(cudaMemcpyAsync(
+            s.device, &s.host, sizeof(s.host), cudaMemcpyHostToDevice, stream));
+    }
+};
+}  // namespace muda
@@ -26,6 +26,8 @@ class DenseViewerBase : public ViewerBase<IsConst>
 
     MUDA_GENERIC explicit DenseViewerBase(auto_const_t<T>* p) MUDA_NOEXCEPT : m_data(p)
     {
+        this->template watch_non_finite<T>(details::NonFiniteDenseRange<T>{
+            reinterpret_cast<const std::byte*>(p), make_int3(1, 1, 1), make_int3(0, 0, 0), 1});
     }
 
     MUDA_GENERIC auto as_const() const MUDA_NOEXCEPT
@@ -41,6 +43,7 @@ class DenseViewerBase : public ViewerBase<IsConst>
     MUDA_GENERIC auto_const_t<T>& operator*() MUDA_NOEXCEPT
     {
         check();
+        this->record_access(*m_data);
         return *m_data;
     }
 
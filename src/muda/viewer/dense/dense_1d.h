@@ -48,6 +48,8 @@ class Dense1DBase : public ViewerBase<IsConst>
     MUDA_GENERIC Dense1DBase(auto_const_t<T>* p, int dim) MUDA_NOEXCEPT : m_data(p),
                                                                           m_dim(dim)
     {
+        this->template watch_non_finite<T>(details::NonFiniteDenseRange<T>{
+            reinterpret_cast<const std::byte*>(p), make_int3(dim, 1, 1), make_int3(sizeof(T), 0, 0), 1});
     }
 
     MUDA_GENERIC auto as_const() const MUDA_NOEXCEPT
@@ -64,7 +66,9 @@ class Dense1DBase : public ViewerBase<IsConst>
     MUDA_GENERIC auto_const_t<T>& operator()(int x) MUDA_NOEXCEPT
     {
         check();
-        return m_data[map(x)];
+        auto& v = m_data[map(x)];
+        this->record_access(v);
+        return v;
     }
 
     MUDA_GENERIC const T& operator()(int x) const MUDA_NOEXCEPT
@@ -132,13 +136,20 @@ class Dense1DBase : public ViewerBase<IsConst>
 
     MUDA_GENERIC int map(int x) const MUDA_NOEXCEPT
     {
-        if constexpr(DEBUG_VIEWER)
+        if constexpr(FULL_DEBUG_VIEWER)
+        {
             if(!(x >= 0 && x < m_dim))
                 MUDA_KERNEL_ERROR("Dense1D[%s:%s]: out of range, index=(%d) m_dim=(%d)",
                                   this->name(),
                                   this->kernel_name(),
                                   x,
                                   m_dim);
+        }
+        else if constexpr(DEBUG_VIEWER)  // bounds only
+        {
+            if(static_cast<unsigned>(x) >= static_cast<unsigned>(m_dim))
+                MUDA_KERNEL_ERROR("Dense1D: out of range, index=(%d) m_dim=(%d)", x, m_dim);
+        }
         return x;
     }
 };
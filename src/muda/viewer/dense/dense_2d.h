@@ -47,6 +47,11 @@ class Dense2DBase : public ViewerBase<IsConst>  // TODO
           m_dim(dim),
           m_pitch_bytes(pitch_bytes)
     {
+        this->template watch_non_finite<T>(details::NonFiniteDenseRange<T>{
+            reinterpret_cast<const std::byte*>(p) + offset.x * pitch_bytes + offset.y * sizeof(T),
+            make_int3(dim.x, dim.y, 1),
+            make_int3(pitch_bytes, sizeof(T), 0),
+            2});
     }
 
     MUDA_GENERIC auto as_const() const MUDA_NOEXCEPT
@@ -69,7 +74,9 @@ class Dense2DBase : public ViewerBase<IsConst>  // TODO
         y += m_offset.y;
         auto height_begin =
             reinterpret_cast<auto_const_t<std::byte>*>(m_data) + x * m_pitch_bytes;
-        return *((auto_const_t<T>*)(height_begin) + y);
+        auto& v = *((auto_const_t<T>*)(height_begin) + y);
+        this->record_access(v);
+        return v;
     }
 
     MUDA_GENERIC auto_const_t<T>& operator()(const int2& xy) MUDA_NOEXCEPT
@@ -131,7 +138,8 @@ class Dense2DBase : public ViewerBase<IsConst>  // TODO
   protected:
     MUDA_INLINE MUDA_GENERIC void check_range(int x, int y) const MUDA_NOEXCEPT
     {
-        if constexpr(DEBUG_VIEWER)
+        if constexpr(FULL_DEBUG_VIEWER)
+        {
             if(!(x >= 0 && x < m_dim.x && y >= 0 && y < m_dim.y))
             {
                 MUDA_KERNEL_ERROR("Dense2D[%s:%s]: out of range, index=(%d,%d) dim=(%d,%d)",
@@ -142,6 +150,17 @@ class Dense2DBase : public ViewerBase<IsConst>  // TODO
                                   m_dim.x,
                                   m_dim.y);
             }
+        }
+        else if constexpr(DEBUG_VIEWER)  // bounds only
+        {
+            if((static_cast<unsigned>(x) >= static_cast<unsigned>(m_dim.x))
+               | (static_cast<unsigned>(y) >= static_cast<unsigned>(m_dim.y)))
+                MUDA_KERNEL_ERROR("Dense2D: out of range, index=(%d,%d) dim=(%d,%d)",
+                                  x,
+                                  y,
+                                  m_dim.x,
+                                  m_dim.y);
+        }
     }
 
     MUDA_INLINE MUDA_GENERIC void check() const MUDA_NOEXCEPT
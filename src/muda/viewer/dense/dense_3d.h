@@ -50,6 +50,8 @@ class Dense3DBase : public ViewerBase<IsConst>
           m_pitch_bytes(pitch_bytes),
           m_pitch_bytes_area(pitch_bytes_area)
     {
+        this->template watch_non_finite<T>(details::NonFiniteDenseRange<T>{
+            reinterpret_cast<const std::byte*>(p), dim, make_int3(pitch_bytes_area, pitch_bytes, sizeof(T)), 3});
     }
 
     MUDA_GENERIC auto as_const() const MUDA_NOEXCEPT
@@ -68,7 +70,9 @@ class Dense3DBase : public ViewerBase<IsConst>
         check_range(x, y, z);
         auto depth_begin = reinterpret_cast<std::byte*>(m_data) + x * m_pitch_bytes_area;
         auto height_begin = depth_begin + y * m_pitch_bytes;
-        return *(reinterpret_cast<T*>(height_begin) + z);
+        auto& v = *(reinterpret_cast<T*>(height_begin) + z);
+        this->record_access(v);
+        return v;
     }
 
     MUDA_GENERIC auto_const_t<T>& operator()(const int3& xyz) MUDA_NOEXCEPT
@@ -138,7 +142,7 @@ class Dense3DBase : public ViewerBase<IsConst>
   protected:
     MUDA_INLINE MUDA_GENERIC void check_range(int x, int y, int z) const MUDA_NOEXCEPT
     {
-        if constexpr(DEBUG_VIEWER)
+        if constexpr(FULL_DEBUG_VIEWER)
         {
             if(!(x >= 0 && x < m_dim.x && y >= 0 && y < m_dim.y && z >= 0
                  && z < m_dim.z))
@@ -152,6 +156,19 @@ class Dense3DBase : public ViewerBase<IsConst>
                                   m_dim.y,
                                   m_dim.z);
         }
+        else if constexpr(DEBUG_VIEWER)  // bounds only
+        {
+            if((static_cast<unsigned>(x) >= static_cast<unsigned>(m_dim.x))
+               | (static_cast<unsigned>(y) >= static_cast<unsigned>(m_dim.y))
+               | (static_cast<unsigned>(z) >= static_cast<unsigned>(m_dim.z)))
+                MUDA_KERNEL_ERROR("Dense3D: out of range, index=(%d,%d,%d) dim=(%d,%d,%d)",
+                                  x,
+                                  y,
+                                  z,
+                                  m_dim.x,
+                                  m_dim.y,
+                                  m_dim.z);
+        }
     }
 
     MUDA_INLINE MUDA_GENERIC void check() const MUDA_NOEXCEPT
@@ -0,0 +1,354 @@
+/*****************************************************************//**
+ * \file   non_finite.h
+ * \brief  NaN/Inf sentinel of viewers (`MUDA_NON_FINITE_CHECK=1`).
+ *
+ * A non-const `Dense*`, `DenseVectorViewer` or `FieldEntryViewer` of
+ * floating type made on the host is watched: after the next kernel launched
+ * by `Launch`/`ParallelFor`, every element the viewer covers is scanned on
+ * the launch stream. The first non-finite element found is recorded to a
+ * process-wide device record (kernel name, viewer name, index, value) with a
+ * single atomic, later ones only bump the counter.
+ *
+ * So the report names the kernel that wrote the NaN/Inf and the viewer (i.e.
+ * the buffer) it was written through. Const viewers are never scanned, and
+ * the scans are skipped for a launch with `check_non_finite(false)`.
+ *
+ * The scan covers the whole range of the viewer, not only the elements the
+ * kernel wrote: launch kernels that only fill a part of an uninitialized
+ * buffer with `check_non_finite(false)`.
+ *
+ * usage:
+ *  ... launch kernels ...
+ *  auto r = NonFiniteSentinel::report();
+ *  if(r.found) std::cout << r;
+ *  NonFiniteSentinel::reset();
+ *********************************************************************/
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+#include <type_traits>
+#include <cuda_runtime.h>
+#include <muda/muda_def.h>
+#include <muda/muda_config.h>
+#include <muda/check/check_cuda_errors.h>
+#include <muda/tools/memory_registry.h>
+
+namespace muda
+{
+namespace details
+{
+    class NonFiniteRecord
+    {
+      public:
+        // number of non-finite elements found, the first one fills the rest
+        unsigned int count    = 0;
+        int          index[3] = {-1, -1, -1};
+        double       value    = 0;
+        // host strings of the string cache, null if names are not recorded
+        const char* kernel_name = nullptr;
+        const char* viewer_name = nullptr;
+    };
+
+    template <typename T, typename = void>
+    struct is_eigen_like : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_eigen_like<T, std::void_t<typename T::Scalar, decltype(std::declval<const T&>().coeff(0, 0))>>
+        : std::true_type
+    {
+    };
+
+    template <typename T>
+    constexpr bool is_floating_v = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    // the element types the sentinel scans: float, double and eigen types of them
+    template <typename T, typename = void>
+    struct is_non_finite_checked : std::bool_constant<is_floating_v<T>>
+    {
+    };
+
+    template <typename T>
+    struct is_non_finite_checked<T, std::enable_if_t<is_eigen_like<T>::value>>
+        : std::bool_constant<is_floating_v<typename T::Scalar>>
+    {
+    };
+
+    // exponent bits all set <=> NaN or Inf
+    MUDA_INLINE MUDA_GENERIC bool is_non_finite(float v) MUDA_NOEXCEPT
+    {
+        unsigned int bits;
+        ::memcpy(&bits, &v, sizeof(bits));
+        return (bits & 0x7f800000u) == 0x7f800000u;
+    }
+
+    MUDA_INLINE MUDA_GENERIC bool is_non_finite(double v) MUDA_NOEXCEPT
+    {
+        unsigned long long bits;
+        ::memcpy(&bits, &v, sizeof(bits));
+        return (bits & 0x7ff0000000000000ull) == 0x7ff0000000000000ull;
+    }
+
+    // first non-finite value of `v` (or 0), for the types the sentinel checks
+    template <typename T>
+    MUDA_INLINE MUDA_GENERIC bool find_non_finite(const T& v, double& value) MUDA_NOEXCEPT
+    {
+        if constexpr(is_floating_v<T>)
+        {
+            value = v;
+            return is_non_finite(v);
+        }
+        else if constexpr(is_eigen_like<T>::value)
+        {
+            if constexpr(is_floating_v<typename T::Scalar>)
+            {
+                for(int c = 0; c < v.cols(); ++c)
+                    for(int r = 0; r < v.rows(); ++r)
+                        if(is_non_finite(v.coeff(r, c)))
+                        {
+                            value = v.coeff(r, c);
+                            return true;
+                        }
+            }
+            return false;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    MUDA_INLINE MUDA_GENERIC void report_non_finite(NonFiniteRecord* record,
+                                                    double           value,
+                                                    int              x,
+                                                    int              y,
+                                                    int              z,
+                                                    const char*      kernel_name,
+                                                    const char* viewer_name) MUDA_NOEXCEPT
+    {
+#ifdef __CUDA_ARCH__
+        if(!record)
+            return;
+        if(atomicAdd(&record->count, 1u) == 0)
+        {
+            record->index[0]    = x;
+            record->index[1]    = y;
+            record->index[2]    = z;
+            record->value       = value;
+            record->kernel_name = kernel_name;
+            record->viewer_name = viewer_name;
+        }
+#endif
+    }
+
+    /**
+     * \brief The elements of a (pitched) dense viewer, up to 3 dimensions.
+     *
+     * Element (x, y, z) is at `data + x * stride.x + y * stride.y + z * stride.z`
+     * (strides in bytes), the indices past `rank` are reported as -1.
+     */
+    template <typename T>
+    class NonFiniteDenseRange
+    {
+      public:
+        const std::byte* data = nullptr;
+        int3             dim{0, 1, 1};
+        int3             stride{0, 0, 0};
+        int              rank = 1;
+
+        MUDA_GENERIC int size() const MUDA_NOEXCEPT
+        {
+            return data ? dim.x * dim.y * dim.z : 0;
+        }
+
+        MUDA_GENERIC bool find(int i, double& value, int* index) const MUDA_NOEXCEPT
+        {
+            int z = i % dim.z;
+            int y = (i / dim.z) % dim.y;
+            int x = i / (dim.y * dim.z);
+            auto p = data + x * static_cast<size_t>(stride.x)
+                     + y * static_cast<size_t>(stride.y) + z * static_cast<size_t>(stride.z);
+            index[0] = x;
+            index[1] = rank > 1 ? y : -1;
+            index[2] = rank > 2 ? z : -1;
+            return find_non_finite(*reinterpret_cast<const T*>(p), value);
+        }
+    };
+
+    template <typename Range>
+    MUDA_GLOBAL void non_finite_scan(Range            range,
+                                     NonFiniteRecord* record,
+                                     const char*      kernel_name,
+                                     const char*      viewer_name)
+    {
+        auto size = range.size();
+        for(int i = blockIdx.x * blockDim.x + threadIdx.x; i < size; i += gridDim.x * blockDim.x)
+        {
+            double value;
+            int    index[3];
+            if(range.find(i, value, index))
+                report_non_finite(record, value, index[0], index[1], index[2], kernel_name, viewer_name);
+        }
+    }
+}  // namespace details
+
+class NonFiniteReport
+{
+  public:
+    bool         found = false;
+    unsigned int count = 0;  // number of non-finite elements found
+    std::string  kernel_name;
+    std::string  viewer_name;
+    int          index[3] = {-1, -1, -1};  // unused dimensions are -1
+    double       value    = 0;
+
+    friend std::ostream& operator<<(std::ostream& os, const NonFiniteReport& r)
+    {
+        if(!r.found)
+            return os << "no non-finite value";
+        os << "non-finite value " << r.value << " at (" << r.index[0];
+        for(int i = 1; i < 3 && r.index[i] >= 0; ++i)
+            os << "," << r.index[i];
+        os << ") of viewer [" << (r.viewer_name.empty() ? "~" : r.viewer_name)
+           << "] written by kernel [" << (r.kernel_name.empty() ? "~" : r.kernel_name)
+           << "], " << r.count << " non-finite element(s) in total";
+        return os;
+    }
+};
+
+class NonFiniteSentinel
+{
+    using ScanFunc = std::function<void(cudaStream_t, const char* kernel_name, const char* viewer_name)>;
+
+    // a viewer made on this host thread since the last launch
+    class Watch
+    {
+      public:
+        uint64_t    token       = 0;
+        const char* viewer_name = nullptr;
+        ScanFunc    scan;
+    };
+
+    // viewers made but never launched are dropped past this
+    static constexpr size_t MAX_WATCHES = 4096;
+
+    static std::vector<Watch>& watches()
+    {
+        thread_local static std::vector<Watch> w;
+        return w;
+    }
+
+    static uint64_t next_token()
+    {
+        thread_local static uint64_t token = 0;
+        return ++token;
+    }
+
+  public:
+    // the process-wide device record, allocated on first use
+    static details::NonFiniteRecord* record()
+    {
+        static details::NonFiniteRecord* r = []
+        {
+            details::NonFiniteRecord* ptr = nullptr;
+            details::NonFiniteRecord  init;
+            checkCudaErrors(cudaMalloc(&ptr, sizeof(details::NonFiniteRecord)));
+            MemoryRegistry::on_alloc(ptr, sizeof(details::NonFiniteRecord), MemoryCategory::Debug);
+            checkCudaErrors(cudaMemcpy(ptr, &init, sizeof(init), cudaMemcpyHostToDevice));
+            return ptr;  // lives until the process exits
+        }();
+        return r;
+    }
+
+    /**
+     * \brief Scan the elements of `range` after the next launch of this host
+     * thread, called by the non-const viewers on construction.
+     *
+     * \return a token to name the watch with, 0 if nothing is watched
+     */
+    template <typename Range>
+    static uint64_t watch(const Range& range, const char* viewer_name = nullptr)
+    {
+        if(range.size() <= 0)
+            return 0;
+
+        auto& w = watches();
+        if(w.size() >= MAX_WATCHES)
+            w.erase(w.begin(), w.begin() + MAX_WATCHES / 2);
+
+        auto& watch       = w.emplace_back();
+        watch.token       = next_token();
+        watch.viewer_name = viewer_name;
+        watch.scan = [range](cudaStream_t stream, const char* kernel_name, const char* viewer_name)
+        {
+            constexpr int block_dim = 256;
+            int grid_dim = std::min((range.size() + block_dim - 1) / block_dim, 1024);
+            details::non_finite_scan<Range>
+                <<<grid_dim, block_dim, 0, stream>>>(range, record(), kernel_name, viewer_name);
+        };
+        return watch.token;
+    }
+
+    // the viewer was named after it was made
+    static void name_watch(uint64_t token, const char* viewer_name)
+    {
+        if(token == 0)
+            return;
+        auto& w = watches();
+        for(auto it = w.rbegin(); it != w.rend(); ++it)
+            if(it->token == token)
+            {
+                it->viewer_name = viewer_name;
+                return;
+            }
+    }
+
+    // scan the watched viewers on `stream` (stream-ordered after the kernel
+    // just launched) and forget them, called by the launchers
+    static void scan_watched(cudaStream_t stream, const char* kernel_name)
+    {
+        auto& w = watches();
+        for(auto& watch : w)
+            watch.scan(stream, kernel_name, watch.viewer_name);
+        checkCudaErrors(cudaGetLastError());
+        w.clear();
+    }
+
+    // forget the watched viewers, e.g. for a launch with `check_non_finite(false)`
+    static void drop_watched() { watches().clear(); }
+
+    // synchronizes `stream`
+    static NonFiniteReport report(cudaStream_t stream = nullptr)
+    {
+        details::NonFiniteRecord r;
+        checkCudaErrors(cudaMemcpyAsync(&r, record(), sizeof(r), cudaMemcpyDeviceToHost, stream));
+        checkCudaErrors(cudaStreamSynchronize(stream));
+
+        NonFiniteReport ret;
+        ret.found = r.count > 0;
+        ret.count = r.count;
+        if(ret.found)
+        {
+            ret.kernel_name = r.kernel_name ? r.kernel_name : "";
+            ret.viewer_name = r.viewer_name ? r.viewer_name : "";
+            std::memcpy(ret.index, r.index, sizeof(ret.index));
+            ret.value = r.value;
+        }
+        return ret;
+    }
+
+    static void reset(cudaStream_t stream = nullptr)
+    {
+        static const details::NonFiniteRecord init;
+        checkCudaErrors(cudaMemcpyAsync(record(), &init, sizeof(init), cudaMemcpyHostToDevice, stream));
+    }
+};
+}  // namespace muda
@@ -9,6 +9,8 @@
 #include <muda/assert.h>
 #include <muda/tools/launch_info_cache.h>
 #include <muda/tools/fuzzy.h>
+#include <muda/viewer/non_finite.h>
+#include <muda/viewer/access_profile.h>
 #include <muda/type_traits/type_modifier.h>
 
 namespace muda
@@ -33,25 +35,36 @@ class ViewerBase
   private:
     // friend class details::ViewerBaseAccessor;
 
-#if MUDA_CHECK_ON
+#if MUDA_CHECK_LEVEL >= 2
     details::StringPointer m_viewer_name;
     details::StringPointer m_kernel_name;
 #else
     char m_dummy = 0; // a dummy member to avoid empty class 
+#endif
+#if MUDA_NON_FINITE_CHECK
+    uint64_t m_non_finite_watch = 0;  // see NonFiniteSentinel::watch()
+#endif
+#if MUDA_ACCESS_PROFILE
+    details::AccessProfileBuffer* m_access_profile = nullptr;
 #endif
   public:
     MUDA_GENERIC ViewerBase()
     {
-#if MUDA_CHECK_ON
+#if MUDA_CHECK_LEVEL >= 2
 #ifndef __CUDA_ARCH__
         m_kernel_name = details::LaunchInfoCache::current_kernel_name();
 #endif
+#endif
+#if MUDA_ACCESS_PROFILE
+#ifndef __CUDA_ARCH__
+        m_access_profile = AccessProfiler::buffer();
+#endif
 #endif
     }
 
     MUDA_GENERIC const char* name() const MUDA_NOEXCEPT
     {
-#if MUDA_CHECK_ON
+#if MUDA_CHECK_LEVEL >= 2
         auto n = m_viewer_name.auto_select();
         if(n && *n != '\0')
             return n;
@@ -61,7 +74,7 @@ class ViewerBase
 
     MUDA_GENERIC const char* kernel_name() const MUDA_NOEXCEPT
     {
-#if MUDA_CHECK_ON
+#if MUDA_CHECK_LEVEL >= 2
         auto n = m_kernel_name.auto_select();
         if(n && n != '\0')
             return n;
@@ -78,23 +91,75 @@ class ViewerBase
   protected:
     MUDA_INLINE MUDA_HOST void name(const char* n) MUDA_NOEXCEPT
     {
-#if MUDA_CHECK_ON
+#if MUDA_CHECK_LEVEL >= 2
         m_viewer_name = details::LaunchInfoCache::view_name(n);
+#if MUDA_NON_FINITE_CHECK
+        NonFiniteSentinel::name_watch(m_non_finite_watch, m_viewer_name.host_string);
+#endif
 #endif
     }
 
     MUDA_INLINE MUDA_GENERIC void name(details::StringPointer pointer) MUDA_NOEXCEPT
     {
-#if MUDA_CHECK_ON
+#if MUDA_CHECK_LEVEL >= 2
         m_viewer_name = pointer;
+#if MUDA_NON_FINITE_CHECK
+#ifndef __CUDA_ARCH__
+        NonFiniteSentinel::name_watch(m_non_finite_watch, m_viewer_name.host_string);
+#endif
+#endif
 #endif
     }
 
     MUDA_INLINE MUDA_GENERIC void copy_name(const ViewerBase& other) MUDA_NOEXCEPT
     {
-#if MUDA_CHECK_ON
+#if MUDA_CHECK_LEVEL >= 2
         m_kernel_name = other.m_kernel_name;
         m_viewer_name = other.m_viewer_name;
+#if MUDA_NON_FINITE_CHECK
+#ifndef __CUDA_ARCH__
+        NonFiniteSentinel::name_watch(m_non_finite_watch, m_viewer_name.host_string);
+#endif
+#endif
+#endif
+#if MUDA_ACCESS_PROFILE
+        m_access_profile = other.m_access_profile;
+#endif
+    }
+
+    // NaN/Inf sentinel: scan the elements of a non-const viewer made on the
+    // host after the next launch, a no-op unless MUDA_NON_FINITE_CHECK
+    template <typename T, typename Range>
+    MUDA_INLINE MUDA_GENERIC void watch_non_finite(const Range& range) MUDA_NOEXCEPT
+    {
+#if MUDA_NON_FINITE_CHECK
+#ifndef __CUDA_ARCH__
+        if constexpr(IsNonConst && details::is_non_finite_checked<std::remove_const_t<T>>::value)
+        {
+#if MUDA_CHECK_LEVEL >= 2
+            m_non_finite_watch = NonFiniteSentinel::watch(range, m_viewer_name.host_string);
+#else
+            m_non_finite_watch = NonFiniteSentinel::watch(range);
+#endif
+        }
+#endif
+#endif
+    }
+
+    // warp access tracing of an accessed element, a no-op unless MUDA_ACCESS_PROFILE
+    template <typename T>
+    MUDA_INLINE MUDA_GENERIC void record_access(const T& value) const MUDA_NOEXCEPT
+    {
+#if MUDA_ACCESS_PROFILE
+        const void* address;
+        uint32_t    size;
+        details::accessed_range(value, address, size);
+#if MUDA_CHECK_LEVEL >= 2
+        details::record_access(
+            m_access_profile, address, size, m_kernel_name.host_string, m_viewer_name.host_string);
+#else
+        details::record_access(m_access_profile, address, size, nullptr, nullptr);
+#endif
 #endif
     }
 };
@@ -0,0 +1,153 @@
+#include <catch2/catch.hpp>
+#include <muda/muda.h>
+#include <muda/ext/linear_system.h>
+using namespace muda;
+using namespace Eigen;
+
+template <typename T, int BlockDim>
+void test_convert_values_only(int block_row_size, int non_zero_block_count)
+{
+    using BlockMatrix = Eigen::Matrix<T, BlockDim, BlockDim>;
+
+    LinearSystemContext ctx;
+
+    std::vector<int>         row_indices(non_zero_block_count);
+    std::vector<int>         col_indices(non_zero_block_count);
+    std::vector<BlockMatrix> blocks(non_zero_block_count);
+
+    for(int i = 0; i < non_zero_block_count; ++i)  // random pattern with duplicates
+    {
+        row_indices[i] = std::rand() % block_row_size;
+        col_indices[i] = std::rand() % block_row_size;
+        blocks[i]      = BlockMatrix::Random();
+    }
+
+    DeviceTripletMatrix<T, BlockDim> A_triplet;
+    A_triplet.reshape(block_row_size, block_row_size);
+    A_triplet.resize_triplets(non_zero_block_count);
+    A_triplet.block_row_indices().copy_from(row_indices.data());
+    A_triplet.block_col_indices().copy_from(col_indices.data());
+    A_triplet.block_values().copy_from(blocks.data());
+
+    constexpr uint64_t pattern_id = 42;
+
+    DeviceBCOOMatrix<T, BlockDim> A_bcoo;
+    ctx.convert(A_triplet, A_bcoo, pattern_id);
+
+    auto download = [](const DeviceBCOOMatrix<T, BlockDim>& A,
+                       std::vector<int>&                    rows,
+                       std::vector<int>&                    cols,
+                       std::vector<BlockMatrix>&            values)
+    {
+        rows.resize(A.non_zero_blocks());
+        cols.resize(A.non_zero_blocks());
+        values.resize(A.non_zero_blocks());
+        A.block_row_indices().copy_to(rows.data());
+        A.block_col_indices().copy_to(cols.data());
+        A.block_values().copy_to(values.data());
+    };
+
+    // new values, same pattern
+    for(auto& block : blocks)
+        block = BlockMatrix::Random();
+    A_triplet.block_values().copy_from(blocks.data());
+
+    DeviceBCOOMatrix<T, BlockDim> expected;
+    ctx.convert(A_triplet, expected);
+
+    DeviceBCOOMatrix<T, BlockDim> A_reuse;
+    ctx.convert_values_only(A_triplet, A_reuse, pattern_id);
+    ctx.sync();
+
+    std::vector<int>         expected_rows, expected_cols, rows, cols;
+    std::vector<BlockMatrix> expected_values, values;
+    download(expected, expected_rows, expected_cols, expected_values);
+    download(A_reuse, rows, cols, values);
+
+    REQUIRE(A_reuse.block_rows() == expected.block_rows());
+    REQUIRE(A_reuse.block_cols() == expected.block_cols());
+    REQUIRE(rows == expected_rows);
+    REQUIRE(cols == expected_cols);
+    REQUIRE(values.size() == expected_values.size());
+    for(size_t i = 0; i < values.size(); ++i)
+        REQUIRE(values[i].isApprox(expected_values[i]));
+
+    // into the BCOO the pattern was made with
+    ctx.convert_values_only(A_triplet, A_bcoo, pattern_id);
+    ctx.sync();
+    download(A_bcoo, rows, cols, values);
+    REQUIRE(rows == expected_rows);
+    for(size_t i = 0; i < values.size(); ++i)
+        REQUIRE(values[i].isApprox(expected_values[i]));
+
+    ctx.release_pattern<T, BlockDim>(pattern_id);
+}
+
+TEST_CASE("convert_values_only", "[linear_system]")
+{
+    test_convert_values_only<float, 3>(10, 40);
+    test_convert_values_only<float, 3>(1000, 8000);
+    test_convert_values_only<double, 12>(100, 888);
+}
+
+template <typename T, int BlockDim>
+void test_convert_bsr2csr(int block_row_size, int block_col_size, int non_zero_block_count)
+{
+    using BlockMatrix = Eigen::Matrix<T, BlockDim, BlockDim>;
+
+    LinearSystemContext ctx;
+
+    std::vector<int>         row_indices(non_zero_block_count);
+    std::vector<int>         col_indices(non_zero_block_count);
+    std::vector<BlockMatrix> blocks(non_zero_block_count);
+
+    Eigen::MatrixX<T> dense = Eigen::MatrixX<T>::Zero(block_row_size * BlockDim,
+                                                      block_col_size * BlockDim);
+    for(int i = 0; i < non_zero_block_count; ++i)  // random pattern with duplicates
+    {
+        row_indices[i] = std::rand() % block_row_size;
+        col_indices[i] = std::rand() % block_col_size;
+        blocks[i]      = BlockMatrix::Random();
+        dense.template block<BlockDim, BlockDim>(row_indices[i] * BlockDim,
+                                                 col_indices[i] * BlockDim) += blocks[i];
+    }
+
+    DeviceTripletMatrix<T, BlockDim> A_triplet;
+    A_triplet.reshape(block_row_size, block_col_size);
+    A_triplet.resize_triplets(non_zero_block_count);
+    A_triplet.block_row_indices().copy_from(row_indices.data());
+    A_triplet.block_col_indices().copy_from(col_indices.data());
+    A_triplet.block_values().copy_from(blocks.data());
+
+    DeviceBCOOMatrix<T, BlockDim> A_bcoo;
+    ctx.convert(A_triplet, A_bcoo);
+    DeviceBSRMatrix<T, BlockDim> A_bsr;
+    ctx.convert(A_bcoo, A_bsr);
+    DeviceCSRMatrix<T> A_csr;
+    ctx.convert(A_bsr, A_csr);
+    ctx.sync();
+
+    REQUIRE(A_csr.rows() == block_row_size * BlockDim);
+    REQUIRE(A_csr.cols() == block_col_size * BlockDim);
+
+    std::vector<int> offsets(A_csr.rows() + 1);
+    std::vector<int> cols(A_csr.m_col_indices.size());
+    std::vector<T>   values(A_csr.m_values.size());
+    A_csr.row_offsets().copy_to(offsets.data());
+    A_csr.col_indices().copy_to(cols.data());
+    A_csr.values().copy_to(values.data());
+
+    Eigen::MatrixX<T> result = Eigen::MatrixX<T>::Zero(dense.rows(), dense.cols());
+    for(int i = 0; i < A_csr.rows(); ++i)
+        for(int k = offsets[i]; k < offsets[i + 1]; ++k)
+            result(i, cols[k]) += values[k];
+    REQUIRE(result.isApprox(dense));
+}
+
+TEST_CASE("convert_bsr2csr", "[linear_system]")
+{
+    // rectangular, e.g. the prolongators of a multigrid hierarchy
+    test_convert_bsr2csr<float, 3>(10, 4, 30);
+    test_convert_bsr2csr<double, 3>(4, 10, 30);
+    test_convert_bsr2csr<double, 2>(100, 100, 800);
+}
@@ -48,8 +48,65 @@ void test_dense_vector(int dim)
     REQUIRE(h_res.isApprox(gt_plus));
 }
 
+template <typename T>
+void test_fused_vector(int dim)
+{
+    LinearSystemContext ctx;
+    VectorX<T>          h_x  = VectorX<T>::Random(dim);
+    VectorX<T>          h_y  = VectorX<T>::Random(dim);
+    VectorX<T>          h_p  = VectorX<T>::Random(dim);
+    VectorX<T>          h_Ap = VectorX<T>::Random(dim);
+    VectorX<T>          h_res;
+
+    DeviceDenseVector<T> x  = h_x;
+    DeviceDenseVector<T> y  = h_y;
+    DeviceDenseVector<T> p  = h_p;
+    DeviceDenseVector<T> Ap = h_Ap;
+
+    DeviceBuffer<T> results(3);
+    std::vector<T>  h_results(3);
+    auto            result = [&](int i) { return VarView<T>{results.data() + i}; };
+
+    // axpy_dot
+    T alpha = 0.5;
+    ctx.axpy_dot(alpha, x.cview(), y.view(), result(0));
+    results.view().copy_to(h_results.data());
+    y.copy_to(h_res);
+    VectorX<T> gt_y = h_y + alpha * h_x;
+    REQUIRE(h_res.isApprox(gt_y));
+    REQUIRE(Approx(h_results[0]).epsilon(1e-4) == gt_y.dot(gt_y));
+
+    // multi_dot
+    ctx.multi_dot<T, 3>({x.cview(), x.cview(), p.cview()},
+                        {y.cview(), x.cview(), Ap.cview()},
+                        {result(0), result(1), result(2)});
+    results.view().copy_to(h_results.data());
+    REQUIRE(Approx(h_results[0]).epsilon(1e-4) == h_x.dot(gt_y));
+    REQUIRE(Approx(h_results[1]).epsilon(1e-4) == h_x.dot(h_x));
+    REQUIRE(Approx(h_results[2]).epsilon(1e-4) == h_p.dot(h_Ap));
+
+    // update_xr, alpha on the device
+    DeviceVar<T> d_alpha = alpha;
+    ctx.update_xr(CVarView<T>{d_alpha.data()}, p.cview(), Ap.cview(), x.view(), y.view(), result(0));
+    results.view().copy_to(h_results.data());
+    VectorX<T> gt_x = h_x + alpha * h_p;
+    VectorX<T> gt_r = gt_y - alpha * h_Ap;
+    x.copy_to(h_res);
+    REQUIRE(h_res.isApprox(gt_x));
+    y.copy_to(h_res);
+    REQUIRE(h_res.isApprox(gt_r));
+    REQUIRE(Approx(h_results[0]).epsilon(1e-4) == gt_r.dot(gt_r));
+}
+
 TEST_CASE("dense_vector", "[linear_system]")
 {
     test_dense_vector<double>(1000);
     test_dense_vector<float>(1000);
+}
+
+TEST_CASE("fused_vector", "[linear_system]")
+{
+    test_fused_vector<double>(1000);
+    test_fused_vector<double>(1 << 20);  // more blocks than the partial sums
+    test_fused_vector<float>(1000);
 }
\ No newline at end of file
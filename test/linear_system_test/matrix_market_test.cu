@@ -0,0 +1,261 @@
+#include <catch2/catch.hpp>
+#include <muda/muda.h>
+#include <muda/ext/linear_system.h>
+#include <cstdio>
+using namespace muda;
+using namespace Eigen;
+
+template <typename T, int N>
+Eigen::MatrixX<T> to_dense(const DeviceTripletMatrix<T, N>& A)
+{
+    std::vector<int> rows(A.triplet_count());
+    std::vector<int> cols(A.triplet_count());
+    if constexpr(N == 1)
+    {
+        std::vector<T> values(A.triplet_count());
+        A.row_indices().copy_to(rows.data());
+        A.col_indices().copy_to(cols.data());
+        A.values().copy_to(values.data());
+
+        Eigen::MatrixX<T> dense = Eigen::MatrixX<T>::Zero(A.rows(), A.cols());
+        for(size_t k = 0; k < values.size(); ++k)
+            dense(rows[k], cols[k]) += values[k];
+        return dense;
+    }
+    else
+    {
+        std::vector<Eigen::Matrix<T, N, N>> values(A.triplet_count());
+        A.block_row_indices().copy_to(rows.data());
+        A.block_col_indices().copy_to(cols.data());
+        A.block_values().copy_to(values.data());
+
+        Eigen::MatrixX<T> dense =
+            Eigen::MatrixX<T>::Zero(A.block_rows() * N, A.block_cols() * N);
+        for(size_t k = 0; k < values.size(); ++k)
+            dense.template block<N, N>(rows[k] * N, cols[k] * N) += values[k];
+        return dense;
+    }
+}
+
+template <typename T, int N>
+void test_matrix_market(int block_rows, int non_zero_blocks, std::string_view path)
+{
+    using BlockMatrix = Eigen::Matrix<T, N, N>;
+
+    LinearSystemContext ctx;
+    LinearSystemIOInfo  info;
+    info.chunk_byte_size = 64 * 1024;  // many steps even for small files
+
+    std::vector<int>         row_indices(non_zero_blocks);
+    std::vector<int>         col_indices(non_zero_blocks);
+    std::vector<BlockMatrix> blocks(non_zero_blocks);
+    for(int i = 0; i < non_zero_blocks; ++i)  // with duplicates
+    {
+        row_indices[i] = std::rand() % block_rows;
+        col_indices[i] = std::rand() % block_rows;
+        blocks[i]      = BlockMatrix::Random();
+    }
+
+    DeviceTripletMatrix<T, N> A;
+    A.reshape(block_rows, block_rows);
+    A.resize_triplets(non_zero_blocks);
+    if constexpr(N == 1)
+    {
+        std::vector<T> values(non_zero_blocks);
+        for(int i = 0; i < non_zero_blocks; ++i)
+            values[i] = blocks[i](0, 0);
+        A.row_indices().copy_from(row_indices.data());
+        A.col_indices().copy_from(col_indices.data());
+        A.values().copy_from(values.data());
+    }
+    else
+    {
+        A.block_row_indices().copy_from(row_indices.data());
+        A.block_col_indices().copy_from(col_indices.data());
+        A.block_values().copy_from(blocks.data());
+    }
+    auto expected = to_dense(A);
+
+    // Triplet
+    DeviceTripletMatrix<T, N> A_read;
+    REQUIRE(ctx.write_matrix_market(path, A, info));
+    REQUIRE(ctx.read_matrix_market(path, A_read, info));
+    REQUIRE(to_dense(A_read) == expected);  // exact: shortest round-trip text
+
+    // BCOO
+    DeviceBCOOMatrix<T, N> A_bcoo;
+    DeviceBCOOMatrix<T, N> A_bcoo_read;
+    ctx.convert(A, A_bcoo);
+    REQUIRE(ctx.write_matrix_market(path, A_bcoo, info));
+    REQUIRE(ctx.read_matrix_market(path, A_bcoo_read, info));
+    REQUIRE(A_bcoo_read.triplet_count() == A_bcoo.triplet_count());
+    REQUIRE(to_dense(A_bcoo_read).isApprox(expected));
+
+    std::remove(std::string{path}.c_str());
+}
+
+TEST_CASE("matrix_market", "[linear_system]")
+{
+    test_matrix_market<float, 1>(100, 1000, "muda_matrix_market_test.mtx");
+    test_matrix_market<double, 1>(1000, 20000, "muda_matrix_market_test.mtxb");
+    test_matrix_market<float, 3>(100, 1000, "muda_matrix_market_test.mtx");
+    test_matrix_market<double, 3>(1000, 20000, "muda_matrix_market_test.mtxb");
+}
+
+TEST_CASE("matrix_market_csr_vector", "[linear_system]")
+{
+    LinearSystemContext ctx;
+
+    // symmetric file: the lower triangle is mirrored
+    {
+        std::FILE* file = std::fopen("muda_matrix_market_test.mtx", "w");
+        std::fputs(
+            "%%MatrixMarket matrix coordinate real symmetric\n"
+            "% comment\n"
+            "3 3 4\n"
+            "1 1 4.0\n"
+            "2 1 -1\n"
+            "3 2 -1.5e0\n"
+            "3 3 2\n",
+            file);
+        std::fclose(file);
+    }
+
+    Eigen::MatrixXd expected(3, 3);
+    expected << 4, -1, 0,  //
+        -1, 0, -1.5,       //
+        0, -1.5, 2;
+
+    DeviceCSRMatrix<double> A;
+    REQUIRE(ctx.read_matrix_market("muda_matrix_market_test.mtx", A));
+    REQUIRE(A.non_zeros() == 6);
+
+    Eigen::VectorXd           x        = Eigen::VectorXd::Random(3);
+    DeviceDenseVector<double> x_device = x;
+    DeviceDenseVector<double> y_device(3);
+    ctx.spmv(A.cview(), x_device.cview(), y_device.view());
+    Eigen::VectorXd y;
+    y_device.copy_to(y);
+    REQUIRE(y.isApprox(expected * x));
+
+    // CSR round trip, binary and text
+    for(auto path : {"muda_matrix_market_test.mtxb", "muda_matrix_market_test.mtx"})
+    {
+        DeviceCSRMatrix<double> A_read;
+        REQUIRE(ctx.write_matrix_market(path, A));
+        REQUIRE(ctx.read_matrix_market(path, A_read));
+        REQUIRE(A_read.non_zeros() == A.non_zeros());
+        ctx.spmv(A_read.cview(), x_device.cview(), y_device.view());
+        y_device.copy_to(y);
+        REQUIRE(y.isApprox(expected * x));
+        std::remove(path);
+    }
+
+    // Dense Vector
+    Eigen::VectorXf v = Eigen::VectorXf::Random(100000);
+    for(auto path : {"muda_matrix_market_test.mtxb", "muda_matrix_market_test.mtx"})
+    {
+        DeviceDenseVector<float> v_device = v;
+        DeviceDenseVector<float> v_read;
+        REQUIRE(ctx.write_matrix_market(path, v_device));
+        REQUIRE(ctx.read_matrix_market(path, v_read));
+        Eigen::VectorXf v_host;
+        v_read.copy_to(v_host);
+        REQUIRE(v_host == v);
+        std::remove(path);
+    }
+
+    // not a matrix market file
+    DeviceTripletMatrix<double, 1> bad;
+    REQUIRE_FALSE(ctx.read_matrix_market("muda_matrix_market_test_missing.mtx", bad));
+}
+
+TEST_CASE("matrix_market_empty", "[linear_system]")
+{
+    LinearSystemContext ctx;
+    for(auto path : {"muda_matrix_market_test.mtx", "muda_matrix_market_test.mtxb"})
+    {
+        // a shape but no entries, the binary file has no payload at all
+        DeviceTripletMatrix<double, 3> A;
+        A.reshape(5, 4);
+        DeviceTripletMatrix<double, 3> A_read;
+        REQUIRE(ctx.write_matrix_market(path, A));
+        REQUIRE(ctx.read_matrix_market(path, A_read));
+        REQUIRE(A_read.block_rows() == 5);
+        REQUIRE(A_read.block_cols() == 4);
+        REQUIRE(A_read.triplet_count() == 0);
+        std::remove(path);
+    }
+}
+
+TEST_CASE("matrix_market_malformed", "[linear_system]")
+{
+    using Header = details::linear_system::MatrixMarketBinaryHeader;
+
+    LinearSystemContext ctx;
+    auto path = "muda_matrix_market_test.mtxb";
+
+    auto write_binary = [&](const Header& header, const std::vector<int>& rows, const std::vector<int>& cols)
+    {
+        std::FILE* file = std::fopen(path, "wb");
+        std::fwrite(&header, sizeof(header), 1, file);
+        std::fwrite(rows.data(), sizeof(int), rows.size(), file);
+        std::fwrite(cols.data(), sizeof(int), cols.size(), file);
+        std::vector<double> values(rows.size() * header.block_dim * header.block_dim, 1.0);
+        std::fwrite(values.data(), sizeof(double), values.size(), file);
+        std::fclose(file);
+    };
+
+    Header header;
+    header.value_size = sizeof(double);
+    header.block_dim  = 1;
+    header.block_rows = 4;
+    header.block_cols = 4;
+    header.count      = 3;
+
+    // well formed, as a reference
+    write_binary(header, {0, 1, 3}, {0, 2, 3});
+    DeviceTripletMatrix<double, 1> A;
+    REQUIRE(ctx.read_matrix_market(path, A));
+    REQUIRE(A.triplet_count() == 3);
+
+    // an index out of the declared shape
+    write_binary(header, {0, 4, 3}, {0, 2, 3});
+    REQUIRE_FALSE(ctx.read_matrix_market(path, A));
+    write_binary(header, {0, 1, 3}, {0, -1, 3});
+    REQUIRE_FALSE(ctx.read_matrix_market(path, A));
+
+    // a count larger than the file, small enough to overflow the byte size
+    Header huge_count = header;
+    huge_count.count  = int64_t(1) << 61;
+    write_binary(huge_count, {0, 1, 3}, {0, 2, 3});
+    REQUIRE_FALSE(ctx.read_matrix_market(path, A));
+
+    // a shape that doesn't fit in int
+    Header huge_shape     = header;
+    huge_shape.block_rows = int64_t(1) << 32;
+    write_binary(huge_shape, {0, 1, 3}, {0, 2, 3});
+    REQUIRE_FALSE(ctx.read_matrix_market(path, A));
+
+    // a block_dim whose square overflows
+    Header huge_block    = header;
+    huge_block.block_dim = std::numeric_limits<int32_t>::max();
+    write_binary(huge_block, {}, {});
+    REQUIRE_FALSE(ctx.read_matrix_market(path, A));
+    std::remove(path);
+
+    // text vectors with a size line out of range
+    auto text_path = "muda_matrix_market_test.mtx";
+    for(auto size_line : {"-1 1\n", "3000000000 1\n", "2 3\n"})
+    {
+        std::FILE* file = std::fopen(text_path, "w");
+        std::fputs("%%MatrixMarket matrix array real general\n", file);
+        std::fputs(size_line, file);
+        std::fputs("1\n2\n", file);
+        std::fclose(file);
+
+        DeviceDenseVector<double> v;
+        REQUIRE_FALSE(ctx.read_matrix_market(text_path, v));
+    }
+    std::remove(text_path);
+}
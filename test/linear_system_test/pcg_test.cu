@@ -0,0 +1,299 @@
+#include <catch2/catch.hpp>
+#include <muda/muda.h>
+#include <muda/ext/linear_system.h>
+using namespace muda;
+using namespace Eigen;
+
+// SPD block matrix: block 1D Laplacian (off-diagonal -B) + identity,
+// B = C^T C is SPD, the diagonal block is 2B + I (duplicated triplets)
+template <typename T, int BlockDim>
+void make_spd_blocks(int                                                block_row_size,
+                     std::vector<int>&                                  row_indices,
+                     std::vector<int>&                                  col_indices,
+                     std::vector<Eigen::Matrix<T, BlockDim, BlockDim>>& blocks)
+{
+    using BlockMatrix = Eigen::Matrix<T, BlockDim, BlockDim>;
+
+    for(int i = 0; i < block_row_size; ++i)
+    {
+        BlockMatrix C = BlockMatrix::Random();
+        BlockMatrix B = C.transpose() * C + BlockMatrix::Identity();
+
+        row_indices.push_back(i);
+        col_indices.push_back(i);
+        blocks.push_back(B + BlockMatrix::Identity());
+        row_indices.push_back(i);
+        col_indices.push_back(i);
+        blocks.push_back(B);
+
+        if(i + 1 < block_row_size)
+        {
+            row_indices.push_back(i);
+            col_indices.push_back(i + 1);
+            blocks.push_back(-B * T(0.5));
+            row_indices.push_back(i + 1);
+            col_indices.push_back(i);
+            blocks.push_back(-B * T(0.5));
+        }
+    }
+}
+
+template <typename T, int BlockDim>
+void test_pcg(int block_row_size, LinearSystemPreconditioner preconditioner)
+{
+    int dimension = BlockDim * block_row_size;
+
+    LinearSystemContext ctx;
+
+    std::vector<int>                                  row_indices;
+    std::vector<int>                                  col_indices;
+    std::vector<Eigen::Matrix<T, BlockDim, BlockDim>> blocks;
+    make_spd_blocks<T, BlockDim>(block_row_size, row_indices, col_indices, blocks);
+
+    Eigen::MatrixX<T> dense_A = Eigen::MatrixX<T>::Zero(dimension, dimension);
+    for(size_t i = 0; i < blocks.size(); ++i)
+        dense_A.template block<BlockDim, BlockDim>(row_indices[i] * BlockDim, col_indices[i] * BlockDim) +=
+            blocks[i];
+
+    Eigen::VectorX<T> dense_b = Eigen::VectorX<T>::Random(dimension);
+    Eigen::VectorX<T> ground_truth = dense_A.ldlt().solve(dense_b);
+
+    LinearSystemPCGInfo info;
+    info.preconditioner = preconditioner;
+    info.rel_tolerance  = std::is_same_v<T, float> ? 1e-5 : 1e-10;
+    info.max_iterations = 10 * dimension;
+
+    // host reference
+    std::vector<T> ref_x(dimension, T{0});
+    std::vector<T> ref_b(dense_b.data(), dense_b.data() + dimension);
+    auto           ref = details::linear_system::pcg_reference<T, BlockDim>(
+        block_row_size, row_indices, col_indices, blocks, ref_x, ref_b, info);
+    REQUIRE(ref.converged);
+    REQUIRE(Eigen::Map<Eigen::VectorX<T>>(ref_x.data(), dimension).isApprox(ground_truth, 1e-3));
+
+    DeviceTripletMatrix<T, BlockDim> A_triplet;
+    A_triplet.reshape(block_row_size, block_row_size);
+    A_triplet.resize_triplets(blocks.size());
+    A_triplet.block_row_indices().copy_from(row_indices.data());
+    A_triplet.block_col_indices().copy_from(col_indices.data());
+    A_triplet.block_values().copy_from(blocks.data());
+
+    DeviceDenseVector<T> b = dense_b;
+    DeviceDenseVector<T> x(dimension);
+    Eigen::VectorX<T>    host_x;
+
+    auto check = [&](const LinearSystemPCGResult& result)
+    {
+        REQUIRE(result.converged);
+        REQUIRE(result.iterations <= info.max_iterations);
+        x.copy_to(host_x);
+        REQUIRE(host_x.isApprox(ground_truth, 1e-3));
+    };
+
+    {
+        x.fill(0);
+        check(ctx.pcg(A_triplet.cview(), x.view(), b.cview(), info));
+    }
+
+    DeviceBCOOMatrix<T, BlockDim> A_bcoo;
+    ctx.convert(A_triplet, A_bcoo);
+    {
+        x.fill(0);
+        check(ctx.pcg(A_bcoo.cview(), x.view(), b.cview(), info));
+    }
+
+    DeviceBSRMatrix<T, BlockDim> A_bsr;
+    ctx.convert(A_bcoo, A_bsr);
+    {
+        x.fill(0);
+        check(ctx.pcg(A_bsr.cview(), x.view(), b.cview(), info));
+    }
+
+    DeviceCSRMatrix<T> A_csr;
+    ctx.convert(A_bsr, A_csr);
+    {
+        // block Jacobi falls back to Jacobi
+        x.fill(0);
+        check(ctx.pcg(A_csr.cview(), x.view(), b.cview(), info));
+    }
+
+    // already converged: no iteration
+    {
+        auto loose          = info;
+        loose.rel_tolerance = 1e-2;
+        auto result = ctx.pcg(A_bsr.cview(), x.view(), b.cview(), loose);
+        REQUIRE(result.converged);
+        REQUIRE(result.iterations == 0);
+    }
+}
+
+TEST_CASE("pcg", "[linear_system]")
+{
+    for(auto preconditioner : {LinearSystemPreconditioner::None,
+                               LinearSystemPreconditioner::Jacobi,
+                               LinearSystemPreconditioner::BlockJacobi})
+    {
+        test_pcg<float, 3>(10, preconditioner);
+        test_pcg<float, 3>(100, preconditioner);
+        test_pcg<double, 3>(1000, preconditioner);
+        test_pcg<double, 12>(100, preconditioner);
+    }
+}
+
+// SPD block matrix: anisotropic block 7-point Laplacian on a g^3 grid with a
+// small shift, hard for (block) Jacobi, the near nullspace AMG is built for
+template <typename T, int BlockDim>
+void make_grid_blocks(int                                                g,
+                      std::vector<int>&                                  row_indices,
+                      std::vector<int>&                                  col_indices,
+                      std::vector<Eigen::Matrix<T, BlockDim, BlockDim>>& blocks)
+{
+    using BlockMatrix = Eigen::Matrix<T, BlockDim, BlockDim>;
+    using BlockVector = Eigen::Vector<T, BlockDim>;
+
+    auto index = [g](int x, int y, int z) { return (z * g + y) * g + x; };
+    for(int z = 0; z < g; ++z)
+        for(int y = 0; y < g; ++y)
+            for(int x = 0; x < g; ++x)
+            {
+                int         i    = index(x, y, z);
+                BlockMatrix diag = BlockMatrix::Identity() * T(1e-3);
+                for(int d = 0; d < 3; ++d)
+                {
+                    BlockVector e = BlockVector::Unit(d % BlockDim);
+                    BlockMatrix K = BlockMatrix::Identity() + 2 * e * e.transpose();
+                    for(int s : {-1, 1})
+                    {
+                        int n[3] = {x, y, z};
+                        n[d] += s;
+                        diag += K;
+                        if(n[d] < 0 || n[d] >= g)
+                            continue;
+                        row_indices.push_back(i);
+                        col_indices.push_back(index(n[0], n[1], n[2]));
+                        blocks.push_back(-K);
+                    }
+                }
+                row_indices.push_back(i);
+                col_indices.push_back(i);
+                blocks.push_back(diag);
+            }
+}
+
+template <typename T, int BlockDim>
+void test_pcg_amg(int g, LinearSystemAMGSmoother smoother)
+{
+    int block_row_size = g * g * g;
+    int dimension      = BlockDim * block_row_size;
+
+    LinearSystemContext ctx;
+
+    std::vector<int>                                  row_indices;
+    std::vector<int>                                  col_indices;
+    std::vector<Eigen::Matrix<T, BlockDim, BlockDim>> blocks;
+    make_grid_blocks<T, BlockDim>(g, row_indices, col_indices, blocks);
+
+    std::vector<Eigen::Triplet<T>> triplets;
+    for(size_t k = 0; k < blocks.size(); ++k)
+        for(int a = 0; a < BlockDim; ++a)
+            for(int c = 0; c < BlockDim; ++c)
+                triplets.emplace_back(
+                    row_indices[k] * BlockDim + a, col_indices[k] * BlockDim + c, blocks[k](a, c));
+    Eigen::SparseMatrix<T> sparse_A(dimension, dimension);
+    sparse_A.setFromTriplets(triplets.begin(), triplets.end());
+
+    Eigen::VectorX<T> dense_b      = Eigen::VectorX<T>::Random(dimension);
+    Eigen::VectorX<T> ground_truth = Eigen::SimplicialLDLT<Eigen::SparseMatrix<T>>(sparse_A).solve(dense_b);
+
+    LinearSystemPCGInfo info;
+    info.preconditioner   = LinearSystemPreconditioner::AMG;
+    info.amg.smoother     = smoother;
+    info.amg_hierarchy_id = 7;
+    info.rel_tolerance    = std::is_same_v<T, float> ? 1e-5 : 1e-10;
+    info.max_iterations   = dimension;
+
+    // host reference
+    std::vector<T> ref_x(dimension, T{0});
+    std::vector<T> ref_b(dense_b.data(), dense_b.data() + dimension);
+    auto           ref = details::linear_system::pcg_reference<T, BlockDim>(
+        block_row_size, row_indices, col_indices, blocks, ref_x, ref_b, info);
+    REQUIRE(ref.converged);
+    REQUIRE(Eigen::Map<Eigen::VectorX<T>>(ref_x.data(), dimension).isApprox(ground_truth, 1e-3));
+
+    DeviceTripletMatrix<T, BlockDim> A_triplet;
+    A_triplet.reshape(block_row_size, block_row_size);
+    A_triplet.resize_triplets(blocks.size());
+    A_triplet.block_row_indices().copy_from(row_indices.data());
+    A_triplet.block_col_indices().copy_from(col_indices.data());
+    A_triplet.block_values().copy_from(blocks.data());
+
+    DeviceBCOOMatrix<T, BlockDim> A_bcoo;
+    ctx.convert(A_triplet, A_bcoo);
+    DeviceBSRMatrix<T, BlockDim> A_bsr;
+    ctx.convert(A_bcoo, A_bsr);
+
+    DeviceDenseVector<T> b = dense_b;
+    DeviceDenseVector<T> x(dimension);
+    Eigen::VectorX<T>    host_x;
+
+    auto check = [&](const LinearSystemPCGResult& result)
+    {
+        REQUIRE(result.converged);
+        x.copy_to(host_x);
+        REQUIRE(host_x.isApprox(ground_truth, 1e-3));
+    };
+
+    LinearSystemPCGResult amg;
+    {
+        x.fill(0);
+        amg = ctx.pcg(A_bsr.cview(), x.view(), b.cview(), info);
+        check(amg);
+        // same hierarchy up to rounding
+        REQUIRE(std::abs(amg.iterations - ref.iterations) <= 2);
+    }
+
+    {
+        // the hierarchy of the last solve
+        auto reuse      = info;
+        reuse.amg_reuse = true;
+        x.fill(0);
+        auto result = ctx.pcg(A_bsr.cview(), x.view(), b.cview(), reuse);
+        check(result);
+        REQUIRE(result.iterations == amg.iterations);
+    }
+
+    {
+        auto jacobi           = info;
+        jacobi.preconditioner = LinearSystemPreconditioner::BlockJacobi;
+        x.fill(0);
+        auto result = ctx.pcg(A_bsr.cview(), x.view(), b.cview(), jacobi);
+        check(result);
+        REQUIRE(amg.iterations * 2 < result.iterations);
+    }
+
+    {
+        // one V-cycle, from a BCOO matrix
+        ctx.amg_setup(A_bcoo, 8, info.amg);
+        DeviceDenseVector<T> z(dimension);
+        ctx.amg_apply<T>(8, b.cview(), z.view());
+        ctx.release_amg(8);
+        REQUIRE(!ctx.has_amg(8));
+
+        details::linear_system::AMGReference<T, BlockDim> reference;
+        reference.setup(typename decltype(reference)::SparseMatrix(sparse_A), info.amg);
+        Eigen::VectorX<T> ref_z;
+        reference.apply(dense_b, ref_z);
+
+        z.copy_to(host_x);
+        REQUIRE(host_x.isApprox(ref_z, std::is_same_v<T, float> ? 1e-3 : 1e-6));
+    }
+    ctx.release_amg(info.amg_hierarchy_id);
+}
+
+TEST_CASE("pcg_amg", "[linear_system]")
+{
+    test_pcg_amg<float, 3>(12, LinearSystemAMGSmoother::Chebyshev);
+    test_pcg_amg<double, 3>(12, LinearSystemAMGSmoother::Jacobi);
+    test_pcg_amg<double, 3>(20, LinearSystemAMGSmoother::Chebyshev);
+    test_pcg_amg<double, 2>(16, LinearSystemAMGSmoother::Chebyshev);
+}
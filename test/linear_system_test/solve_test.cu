@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 #include <muda/muda.h>
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 #include <muda/ext/linear_system.h>
 using namespace muda;
 using namespace Eigen;
@@ -106,4 +107,211 @@ TEST_CASE("solve", "[linear_system]")
     test_linear_system_solve<float>(10);
     test_linear_system_solve<float>(100);
     test_linear_system_solve<float>(1000);
-}
\ No newline at end of file
+}
+void test_linear_system_solve_refined(int dim, bool sym)
+{
+    using T = double;
+
+    Eigen::VectorX<T> ra = Eigen::VectorX<T>::Random(dim);
+    for(int i = 0; i < dim; ++i)
+    {
+        if(ra(i) < 0.2)
+            ra(i) = 0.0;  // make A sparse
+    }
+    Eigen::MatrixX<T> A_dense = ra * ra.transpose() + Eigen::MatrixX<T>::Identity(dim, dim);
+    if(!sym)
+        A_dense(0, dim - 1) += 0.5;
+
+    Eigen::VectorX<T> x = Eigen::VectorX<T>::Random(dim);
+    Eigen::VectorX<T> b = A_dense * x;
+
+    LinearSystemRefineInfo info;
+    info.rel_tolerance = 1e-12;
+    info.sparse_method = sym ? LinearSystemFactorizationMethod::Cholesky :
+                               LinearSystemFactorizationMethod::QR;
+
+    LinearSystemContext  ctx;
+    DeviceDenseVector<T> b_device = b;
+    DeviceDenseVector<T> x_device(dim);
+    Eigen::VectorX<T>    x_host;
+
+    {  // dense
+        DeviceDenseMatrix<T> A_device = A_dense;
+        A_device.sym(sym);
+
+        x_device.fill(0);
+        auto result = ctx.solve_refined(x_device.view(), A_device.cview(), b_device.cview(), info);
+        REQUIRE(result.converged);
+        REQUIRE(result.residual_norm <= info.rel_tolerance * b.norm());
+        x_device.copy_to(x_host);
+        // beyond float accuracy
+        REQUIRE((x_host - x).norm() <= 1e-9 * x.norm());
+    }
+
+    {  // sparse
+        std::vector<int> row_indices;
+        std::vector<int> col_indices;
+        std::vector<T>   values;
+        for(int i = 0; i < dim; ++i)
+            for(int j = 0; j < dim; j++)
+                if(A_dense(i, j) != 0.0)
+                {
+                    row_indices.push_back(i);
+                    col_indices.push_back(j);
+                    values.push_back(A_dense(i, j));
+                }
+
+        DeviceTripletMatrix<T, 1> A_triplet;
+        A_triplet.reshape(dim, dim);
+        A_triplet.resize_triplets(values.size());
+        A_triplet.row_indices().copy_from(row_indices.data());
+        A_triplet.col_indices().copy_from(col_indices.data());
+        A_triplet.values().copy_from(values.data());
+
+        DeviceCOOMatrix<T> A_coo;
+        ctx.convert(A_triplet, A_coo);
+        DeviceCSRMatrix<T> A_csr;
+        ctx.convert(A_coo, A_csr);
+
+        x_device.fill(0);
+        auto result = ctx.solve_refined(x_device.view(), A_csr.cview(), b_device.cview(), info);
+        REQUIRE(result.converged);
+        x_device.copy_to(x_host);
+        REQUIRE((x_host - x).norm() <= 1e-9 * x.norm());
+    }
+}
+
+// symmetric indefinite: the float Cholesky fails, the LU fallback must solve it
+void test_linear_system_solve_refined_indefinite(int dim)
+{
+    using T = double;
+
+    Eigen::MatrixX<T> A_dense = Eigen::MatrixX<T>::Zero(dim, dim);
+    for(int i = 0; i < dim; ++i)
+    {
+        A_dense(i, i) = (i % 2 ? -1.0 : 1.0) * (2.0 + i % 5);
+        if(i + 1 < dim)
+            A_dense(i, i + 1) = A_dense(i + 1, i) = 0.5;
+    }
+
+    Eigen::VectorX<T> x = Eigen::VectorX<T>::Random(dim);
+    Eigen::VectorX<T> b = A_dense * x;
+
+    LinearSystemRefineInfo info;
+    info.rel_tolerance = 1e-12;
+
+    LinearSystemContext  ctx;
+    DeviceDenseMatrix<T> A_device = A_dense;
+    A_device.sym(true);
+    DeviceDenseVector<T> b_device = b;
+    DeviceDenseVector<T> x_device(dim);
+    x_device.fill(0);
+
+    auto result = ctx.solve_refined(x_device.view(), A_device.cview(), b_device.cview(), info);
+    REQUIRE(result.converged);
+    Eigen::VectorX<T> x_host;
+    x_device.copy_to(x_host);
+    REQUIRE((x_host - x).norm() <= 1e-9 * x.norm());
+}
+
+TEST_CASE("solve_refined", "[linear_system]")
+{
+    test_linear_system_solve_refined(10, true);
+    test_linear_system_solve_refined(100, true);
+    test_linear_system_solve_refined(100, false);
+    test_linear_system_solve_refined(500, false);
+    test_linear_system_solve_refined_indefinite(10);
+    test_linear_system_solve_refined_indefinite(200);
+}
+
+template <typename T>
+void test_linear_system_solve_factorized(int dim, LinearSystemFactorizationMethod method)
+{
+    // 2D Laplacian-like SPD pattern, the values change, the pattern doesn't
+    int  n      = static_cast<int>(std::sqrt(dim));
+    auto make_A = [&](T shift)
+    {
+        std::vector<Eigen::Triplet<T>> triplets;
+        for(int i = 0; i < n; ++i)
+            for(int j = 0; j < n; ++j)
+            {
+                int k = i * n + j;
+                triplets.emplace_back(k, k, 4 + shift);
+                if(i > 0)
+                    triplets.emplace_back(k, k - n, -1);
+                if(i + 1 < n)
+                    triplets.emplace_back(k, k + n, -1);
+                if(j > 0)
+                    triplets.emplace_back(k, k - 1, -1);
+                if(j + 1 < n)
+                    triplets.emplace_back(k, k + 1, -1);
+            }
+        return triplets;
+    };
+
+    LinearSystemContext ctx;
+    ctx.reorder().reoder_method(LinearSystemReorderMethod::Symamd);
+
+    auto to_csr = [&](const std::vector<Eigen::Triplet<T>>& triplets)
+    {
+        std::vector<int> row_indices, col_indices;
+        std::vector<T>   values;
+        for(auto& t : triplets)
+        {
+            row_indices.push_back(t.row());
+            col_indices.push_back(t.col());
+            values.push_back(t.value());
+        }
+        DeviceTripletMatrix<T, 1> A_triplet;
+        A_triplet.reshape(n * n, n * n);
+        A_triplet.resize_triplets(values.size());
+        A_triplet.row_indices().copy_from(row_indices.data());
+        A_triplet.col_indices().copy_from(col_indices.data());
+        A_triplet.values().copy_from(values.data());
+
+        DeviceCOOMatrix<T> A_coo;
+        ctx.convert(A_triplet, A_coo);
+        DeviceCSRMatrix<T> A_csr;
+        ctx.convert(A_coo, A_csr);
+        return A_csr;
+    };
+
+    constexpr uint64_t pattern_id = 7;
+
+    auto triplets = make_A(0);
+    auto A_csr    = to_csr(triplets);
+    ctx.analyze(A_csr.cview(), pattern_id, method);
+
+    for(T shift : {T{0}, T{0.5}, T{2}})  // refactorize, reuse the analysis
+    {
+        triplets = make_A(shift);
+        A_csr    = to_csr(triplets);
+
+        Eigen::SparseMatrix<T> A(n * n, n * n);
+        A.setFromTriplets(triplets.begin(), triplets.end());
+
+        REQUIRE(ctx.factorize(A_csr.cview(), pattern_id));
+        for(int rhs = 0; rhs < 2; ++rhs)  // several solves per factorization
+        {
+            Eigen::VectorX<T>    x        = Eigen::VectorX<T>::Random(n * n);
+            Eigen::VectorX<T>    b        = A * x;
+            DeviceDenseVector<T> b_device = b;
+            DeviceDenseVector<T> x_device(n * n);
+
+            ctx.solve(x_device.view(), b_device.cview(), pattern_id);
+            ctx.sync();
+            Eigen::VectorX<T> x_host;
+            x_device.copy_to(x_host);
+            REQUIRE(x_host.isApprox(x, T{1e-4}));
+        }
+    }
+
+    ctx.release_factorization(pattern_id);
+}
+
+TEST_CASE("solve_factorized", "[linear_system]")
+{
+    test_linear_system_solve_factorized<float>(100, LinearSystemFactorizationMethod::Cholesky);
+    test_linear_system_solve_factorized<double>(2500, LinearSystemFactorizationMethod::Cholesky);
+    test_linear_system_solve_factorized<double>(2500, LinearSystemFactorizationMethod::QR);
+}
@@ -75,6 +75,22 @@ void test_sparse_matrix(int block_row_size, int non_zero_block_count)
         REQUIRE(host_b.isApprox(ground_truth));
     }
 
+    {
+        // segmented (atomic-free) BCOO spmv
+        b.fill(0);
+        ctx.spmv(A_bcoo, x.cview(), b.view());
+        ctx.sync();
+        b.copy_to(host_b);
+        REQUIRE(host_b.isApprox(ground_truth));
+
+        // y = a * A * x + b * y
+        auto y = b.view();
+        ctx.spmv(T{2}, A_bcoo, x.cview(), T{-1}, y);
+        ctx.sync();
+        b.copy_to(host_b);
+        REQUIRE(host_b.isApprox(ground_truth));
+    }
+
     DeviceDenseMatrix<T> A;
 
     DeviceCOOMatrix<T> A_coo;
@@ -115,6 +131,25 @@ void test_sparse_matrix(int block_row_size, int non_zero_block_count)
         REQUIRE(host_b.isApprox(ground_truth));
     }
 
+    for(auto algorithm : {LinearSystemBSRSpMVAlgorithm::Custom, LinearSystemBSRSpMVAlgorithm::CuSparse})
+    {
+        ctx.spmv_policy().bsr_algorithm(algorithm);
+
+        b.fill(0);
+        ctx.spmv(A_bsr.cview(), x.cview(), b.view());
+        ctx.sync();
+        b.copy_to(host_b);
+        REQUIRE(host_b.isApprox(ground_truth));
+
+        // y = a * A * x + b * y
+        auto y = b.view();
+        ctx.spmv(T{2}, A_bsr.cview(), x.cview(), T{-1}, y);
+        ctx.sync();
+        b.copy_to(host_b);
+        REQUIRE(host_b.isApprox(ground_truth));
+    }
+    ctx.spmv_policy().bsr_algorithm(LinearSystemBSRSpMVAlgorithm::Auto);
+
     DeviceCSRMatrix<T> A_csr;
     ctx.convert(A_bsr, A_csr);
     {
@@ -136,13 +171,127 @@ void test_sparse_matrix(int block_row_size, int non_zero_block_count)
     }
 }
 
+TEST_CASE("spmv_policy", "[linear_system]")
+{
+    LinearSystemSpMVPolicy policy;
+    policy.bsr_algorithm(LinearSystemBSRSpMVAlgorithm::Custom);
+    REQUIRE(policy.use_custom_bsr(3, false, 10, 10));
+    REQUIRE(policy.use_custom_bsr(LinearSystemSpMVPolicy::max_custom_bsr_block_dim, false, 10, 1));
+    REQUIRE_FALSE(policy.use_custom_bsr(12, false, 10, 100));
+    REQUIRE_FALSE(policy.use_custom_bsr(3, true, 10, 100));
+
+    policy.bsr_algorithm(LinearSystemBSRSpMVAlgorithm::CuSparse);
+    REQUIRE_FALSE(policy.use_custom_bsr(3, false, 10, 100));
+
+    // `Auto` leaves nearly empty rows to cuSPARSE
+    policy.bsr_algorithm(LinearSystemBSRSpMVAlgorithm::Auto);
+    REQUIRE(policy.use_custom_bsr(3, false, 10, 20));
+    REQUIRE_FALSE(policy.use_custom_bsr(3, false, 10, 19));
+}
+
 TEST_CASE("spmv", "[linear_system]")
 {
     test_sparse_matrix<float, 3>(10, 40);
     test_sparse_matrix<float, 3>(100, 400);
     test_sparse_matrix<float, 3>(1000, 4000);
 
+    test_sparse_matrix<double, 6>(10, 24);
+    test_sparse_matrix<double, 6>(1000, 8000);
+
+    // the largest block the custom BSR kernel takes
+    test_sparse_matrix<float, 8>(10, 24);
+    test_sparse_matrix<double, 8>(1000, 8000);
+    test_sparse_matrix<double, 2>(1000, 1500);
+
+    // cuSPARSE only, `Custom` falls back
     test_sparse_matrix<float, 12>(10, 24);
     test_sparse_matrix<float, 12>(100, 888);
     test_sparse_matrix<float, 12>(1000, 7992);
-}
\ No newline at end of file
+}
+template <typename T, int BlockDim>
+void test_spmm(int block_row_size, int non_zero_block_count, int columns)
+{
+    using BlockMatrix = Eigen::Matrix<T, BlockDim, BlockDim>;
+    int dimension     = BlockDim * block_row_size;
+
+    LinearSystemContext ctx;
+
+    std::vector<int>         row_indices(non_zero_block_count);
+    std::vector<int>         col_indices(non_zero_block_count);
+    std::vector<BlockMatrix> blocks(non_zero_block_count);
+    Eigen::MatrixX<T> dense_A = Eigen::MatrixX<T>::Zero(dimension, dimension);
+    for(int i = 0; i < non_zero_block_count; ++i)
+    {
+        row_indices[i] = std::rand() % block_row_size;
+        col_indices[i] = std::rand() % block_row_size;
+        blocks[i]      = BlockMatrix::Random();
+        dense_A.template block<BlockDim, BlockDim>(row_indices[i] * BlockDim,
+                                                   col_indices[i] * BlockDim) += blocks[i];
+    }
+
+    DeviceTripletMatrix<T, BlockDim> A_triplet;
+    A_triplet.reshape(block_row_size, block_row_size);
+    A_triplet.resize_triplets(non_zero_block_count);
+    A_triplet.block_row_indices().copy_from(row_indices.data());
+    A_triplet.block_col_indices().copy_from(col_indices.data());
+    A_triplet.block_values().copy_from(blocks.data());
+
+    DeviceBCOOMatrix<T, BlockDim> A_bcoo;
+    ctx.convert(A_triplet, A_bcoo);
+    DeviceBSRMatrix<T, BlockDim> A_bsr;
+    ctx.convert(A_bcoo, A_bsr);
+    DeviceCSRMatrix<T> A_csr;
+    ctx.convert(A_bsr, A_csr);
+
+    Eigen::MatrixX<T>    host_X = Eigen::MatrixX<T>::Random(dimension, columns);
+    Eigen::MatrixX<T>    host_Y = Eigen::MatrixX<T>::Random(dimension, columns);
+    DeviceDenseMatrix<T> X      = host_X;
+    DeviceDenseMatrix<T> Y      = host_Y;
+
+    // Y = 2 * A * X - Y
+    Eigen::MatrixX<T> ground_truth = T{2} * dense_A * host_X - host_Y;
+    Eigen::MatrixX<T> result;
+    auto              check = [&](auto&& f)
+    {
+        Y = host_Y;
+        f();
+        ctx.sync();
+        Y.copy_to(result);
+        REQUIRE(result.isApprox(ground_truth));
+    };
+
+    check([&] { ctx.spmm(T{2}, A_triplet.cview(), X.cview(), T{-1}, Y.view()); });
+    check([&] { ctx.spmm(T{2}, A_bcoo, X.cview(), T{-1}, Y.view()); });
+    check([&] { ctx.spmm(T{2}, A_csr.cview(), X.cview(), T{-1}, Y.view()); });
+    for(auto algorithm : {LinearSystemBSRSpMVAlgorithm::Custom, LinearSystemBSRSpMVAlgorithm::CuSparse})
+    {
+        ctx.spmv_policy().bsr_algorithm(algorithm);
+        check([&] { ctx.spmm(T{2}, A_bsr.cview(), X.cview(), T{-1}, Y.view()); });
+    }
+
+    // block dot / axpby
+    Y = host_Y;
+    DeviceDenseVector<T> dots(columns);
+    ctx.dot(X.cview(), Y.cview(), dots.view());
+    Eigen::VectorX<T> host_dots;
+    dots.copy_to(host_dots);
+    REQUIRE(host_dots.isApprox(host_X.cwiseProduct(host_Y).colwise().sum().transpose()));
+
+    Eigen::VectorX<T>    alpha = Eigen::VectorX<T>::Random(columns);
+    Eigen::VectorX<T>    beta  = Eigen::VectorX<T>::Random(columns);
+    DeviceDenseVector<T> alpha_device = alpha;
+    DeviceDenseVector<T> beta_device  = beta;
+    ctx.axpby(alpha_device.cview(), X.cview(), beta_device.cview(), Y.view());
+    ctx.sync();
+    Y.copy_to(result);
+    REQUIRE(result.isApprox(host_X * alpha.asDiagonal() + host_Y * beta.asDiagonal()));
+}
+
+TEST_CASE("spmm", "[linear_system]")
+{
+    test_spmm<float, 3>(100, 400, 8);
+    test_spmm<double, 3>(1000, 8000, 12);
+    test_spmm<double, 3>(100, 400, 50);  // more columns than one pass of the custom BSR kernel
+    test_spmm<double, 6>(1000, 8000, 6);
+    test_spmm<float, 12>(100, 888, 8);  // cuSPARSE only
+}
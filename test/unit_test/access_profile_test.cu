@@ -0,0 +1,113 @@
+#include <catch2/catch.hpp>
+#include <muda/muda.h>
+#include <muda/container.h>
+#include <muda/viewer/access_analyzer.h>
+
+using namespace muda;
+
+// a full warp reading `stride` bytes apart, starting at `base`
+static AccessTrace make_trace(std::string name, uint64_t base, uint64_t stride, uint32_t size)
+{
+    AccessTrace t;
+    t.viewer_name  = std::move(name);
+    t.element_size = size;
+    t.active_mask  = ~0u;
+    for(int lane = 0; lane < 32; ++lane)
+        t.address[lane] = base + lane * stride;
+    return t;
+}
+
+void access_analyzer_test()
+{
+    std::vector<AccessTrace> traces;
+    // SoA float: 128 bytes => 4 sectors, coalesced
+    traces.push_back(make_trace("soa", 1024, 4, 4));
+    // AoS float of a 48-byte struct: one sector per lane
+    traces.push_back(make_trace("aos", 4096, 48, 4));
+    traces.push_back(make_trace("aos", 8192, 48, 4));
+    // misaligned start, still coalesced
+    traces.push_back(make_trace("soa", 1024 + 8, 4, 4));
+    // half warp
+    auto half = make_trace("soa", 2048, 4, 4);
+    half.active_mask = 0x0000ffffu;
+    traces.push_back(half);
+
+    auto stats = analyze_access(traces);
+    REQUIRE(stats.size() == 2);
+
+    auto& aos = stats[0];  // the worst first
+    REQUIRE(aos.viewer_name == "aos");
+    REQUIRE(aos.requests == 2);
+    REQUIRE(aos.sectors_per_request() == Approx(32.0));
+    REQUIRE(aos.ideal_sectors_per_request() == Approx(4.0));
+    REQUIRE(aos.coalesced_fraction() == Approx(0.0));
+    REQUIRE(aos.dominant_stride() == 48);
+    REQUIRE(aos.stride_histogram.at(48) == 62);
+
+    auto& soa = stats[1];
+    REQUIRE(soa.viewer_name == "soa");
+    REQUIRE(soa.requests == 3);
+    REQUIRE(soa.sectors == 4 + 5 + 2);
+    REQUIRE(soa.coalesced_fraction() == Approx(1.0));
+    REQUIRE(soa.stride_histogram.size() == 1);
+    REQUIRE(soa.stride_histogram.at(4) == 31 + 31 + 15);
+}
+
+void access_profile_test()
+{
+    constexpr int N = 1024;
+    // the same floats, read as SoA and as AoS (stride 3)
+    DeviceBuffer<float> soa(N);
+    DeviceBuffer<float> aos(3 * N);
+    soa.fill(1.0f);
+    aos.fill(1.0f);
+    DeviceVar<float> sum = 0;
+
+    AccessProfiler::reset();
+    ParallelFor(256)
+        .kernel_name(__FUNCTION__)
+        .apply(N,
+               [soa = soa.cviewer().name("soa"),
+                aos = aos.cviewer().name("aos"),
+                sum = sum.viewer()] __device__(int i) mutable
+               {
+                   auto v = soa(i) + aos(3 * i);
+                   atomic_add(sum.data(), v);
+               });
+
+    if constexpr(ACCESS_PROFILE_ON)
+        REQUIRE(AccessProfiler::requests() == 2 * N / 32);
+    auto stats = AccessProfiler::report();
+    if constexpr(!ACCESS_PROFILE_ON)
+    {
+        // nothing is recorded
+        REQUIRE(AccessProfiler::requests() == 0);
+        REQUIRE(stats.empty());
+    }
+    else if constexpr(CHECK_NAMES_ON)
+    {
+        REQUIRE(stats.size() == 2);
+        REQUIRE(stats[0].viewer_name == "aos");
+        REQUIRE(stats[0].dominant_stride() == 3 * sizeof(float));
+        REQUIRE(stats[1].viewer_name == "soa");
+        REQUIRE(stats[1].coalesced_fraction() == Approx(1.0));
+    }
+    else
+    {
+        // no names, both viewers under ""
+        REQUIRE(stats.size() == 1);
+        REQUIRE(stats[0].viewer_name.empty());
+        REQUIRE(stats[0].requests == 2 * N / 32);
+    }
+    AccessProfiler::reset();
+}
+
+TEST_CASE("access_analyzer_test", "[viewer]")
+{
+    access_analyzer_test();
+}
+
+TEST_CASE("access_profile_test", "[viewer]")
+{
+    access_profile_test();
+}
@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+#include <muda/muda.h>
+#include <muda/container.h>
+#include <algorithm>
+
+using namespace muda;
+
+void append_buffer_test()
+{
+    constexpr int N = 10000;
+
+    // push every multiple of 3, starting with a too small buffer
+    DeviceAppendBuffer<int> buffer(16);
+    auto retry = buffer.grow_and_retry(
+        [&](AppendBufferViewer<int> out)
+        {
+            ParallelFor(256)
+                .apply(N,
+                       [out] __device__(int i) mutable
+                       {
+                           if(i % 3 == 0)
+                               out.push(i);
+                       })
+                .wait();
+        });
+
+    REQUIRE(retry == 1);
+    REQUIRE(!buffer.overflowed());
+    REQUIRE(buffer.size() == (N + 2) / 3);
+
+    std::vector<int> h_res;
+    buffer.copy_to(h_res);
+    std::sort(h_res.begin(), h_res.end());
+    for(int i = 0; i < h_res.size(); ++i)
+        REQUIRE(h_res[i] == 3 * i);
+
+    // append 2 slots per thread after the existing elements, enough capacity
+    auto old_size = buffer.size();
+    buffer.reserve(old_size + 2 * 100);
+    retry = buffer.grow_and_retry(
+        [&](AppendBufferViewer<int> out)
+        {
+            ParallelFor(256)
+                .apply(100,
+                       [out] __device__(int i) mutable
+                       {
+                           auto begin = out.reserve(2);
+                           if(begin >= 0)
+                           {
+                               out(begin)     = -i;
+                               out(begin + 1) = -i;
+                           }
+                       })
+                .wait();
+        });
+    REQUIRE(retry == 0);
+    REQUIRE(buffer.size() == old_size + 200);
+
+    buffer.clear();
+    REQUIRE(buffer.size() == 0);
+    REQUIRE(!buffer.overflowed());
+}
+
+TEST_CASE("append_buffer_test", "[container]")
+{
+    append_buffer_test();
+}
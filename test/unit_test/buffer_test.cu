@@ -219,6 +219,87 @@ TEST_CASE("buffer_test", "[buffer]")
         buffer.copy_to(h_res);
         REQUIRE(h_res == gt);
     }
+
+    SECTION("copy_batch_plan")
+    {
+        using Range = details::buffer::CopyBatchRange<int>;
+        int dst[16];
+        int src[16];
+        // [0,4) and [4,8) are adjacent in both dst and src, [10,12) is not
+        std::vector<Range> ranges{{dst + 4, src + 4, 4},
+                                  {dst + 10, src + 12, 2},
+                                  {dst + 0, src + 0, 4},
+                                  {dst + 8, src + 8, 0}};
+        auto total = details::buffer::plan_copy_batch(ranges);
+        REQUIRE(total == 10);
+        REQUIRE(ranges.size() == 2);
+        REQUIRE(ranges[0].dst == dst);
+        REQUIRE(ranges[0].count == 8);
+        REQUIRE(ranges[1].begin == 8);
+        REQUIRE(ranges[1].src == src + 12);
+    }
+
+    SECTION("copy_batch")
+    {
+        DeviceBuffer<int> src(100);
+        DeviceBuffer<int> dst(100);
+        std::vector<int>  h_src(100);
+        for(int i = 0; i < 100; ++i)
+            h_src[i] = i;
+        src = h_src;
+        dst.fill(-1);
+
+        std::vector<BufferView<int>>  dst_views;
+        std::vector<CBufferView<int>> src_views;
+        std::vector<int>              gt(100, -1);
+        // reverse the order of every 10-element chunk, except the first two
+        // chunks which are adjacent and will be merged
+        for(int c = 0; c < 10; ++c)
+        {
+            int src_chunk = c < 2 ? c : 11 - c;
+            dst_views.push_back(dst.view(c * 10, 10));
+            src_views.push_back(src.view(src_chunk * 10, 10));
+            for(int i = 0; i < 10; ++i)
+                gt[c * 10 + i] = h_src[src_chunk * 10 + i];
+        }
+
+        BufferLaunch().copy_batch(dst_views, src_views).wait();
+
+        std::vector<int> h_res;
+        dst.copy_to(h_res);
+        REQUIRE(h_res == gt);
+    }
+
+    SECTION("vectorized_fill_copy")
+    {
+        // odd offsets/sizes exercise the scalar head and tail of the 16-byte path
+        DeviceBuffer<char> src(1000);
+        DeviceBuffer<char> dst(1000);
+        src.fill('a');
+        dst.fill('z');
+        src.view(3, 501).fill('b');
+
+        std::vector<char> h_res;
+        src.copy_to(h_res);
+        for(int i = 0; i < 1000; ++i)
+            REQUIRE(h_res[i] == ((i >= 3 && i < 504) ? 'b' : 'a'));
+
+        // same misalignment: vectorized
+        dst.view(7, 901).copy_from(src.view(7, 901));
+        // different misalignment: per-element fallback
+        dst.view(0, 5).copy_from(src.view(2, 5));
+
+        dst.copy_to(h_res);
+        for(int i = 0; i < 1000; ++i)
+        {
+            char gt = i < 5              ? (i + 2 >= 3 ? 'b' : 'a') :
+                      i < 7              ? 'z' :
+                      i >= 908           ? 'z' :
+                      (i >= 3 && i < 504) ? 'b' :
+                                            'a';
+            REQUIRE(h_res[i] == gt);
+        }
+    }
 }
 
 TEST_CASE("buffer_2d_test", "[buffer]")
@@ -296,6 +377,28 @@ TEST_CASE("buffer_2d_test", "[buffer]")
                                 [](int v) { return v == 1 || v == 3 || v == 4; }));
         }
     }
+
+    SECTION("vectorized_fill_copy")
+    {
+        DeviceBuffer2D<short> src;
+        DeviceBuffer2D<short> dst;
+        src.resize(Extent2D{33, 77}, 1);
+        dst.resize(Extent2D{33, 77}, 0);
+
+        // subview with an odd column offset, rows are still 16-byte pitched
+        src.view().subview(Offset2D{2, 3}, Extent2D{20, 61}).fill(2);
+        dst.view().copy_from(src.view());
+
+        std::vector<short> h_res;
+        dst.copy_to(h_res);
+        auto dense = make_dense_2d(h_res.data(), 33, 77);
+        for(int i = 0; i < 33; ++i)
+            for(int j = 0; j < 77; ++j)
+            {
+                bool inside = i >= 2 && i < 22 && j >= 3 && j < 64;
+                REQUIRE(dense(i, j) == (inside ? 2 : 1));
+            }
+    }
 }
 
 
@@ -1387,3 +1387,74 @@ TEST_CASE("device_partition", "[cub]")
         REQUIRE(h_keys_out == gt_keys_out);
     }
 }
+
+void cub_temp_size_cache_host()
+{
+    auto& site = CubTempSizeCache::site("cub_temp_size_cache_host");
+    CubTempSizeCache::reset_stats();
+
+    size_t bytes = 0;
+    REQUIRE(!CubTempSizeCache::lookup(site, 0, 1000, 0, bytes));  // miss
+    CubTempSizeCache::store(site, 0, 1000, 0, 4096);
+    REQUIRE(CubTempSizeCache::lookup(site, 0, 1000, 0, bytes));  // hit
+    REQUIRE(bytes == 4096);
+    REQUIRE(CubTempSizeCache::lookup(site, 0, 600, 0, bytes));  // same bucket, smaller
+    REQUIRE(bytes == 4096);
+    REQUIRE(!CubTempSizeCache::lookup(site, 0, 1020, 0, bytes));  // same bucket, larger
+    CubTempSizeCache::store(site, 0, 1020, 0, 4200);
+    REQUIRE(CubTempSizeCache::lookup(site, 0, 1000, 0, bytes));
+    REQUIRE(bytes == 4200);
+    REQUIRE(!CubTempSizeCache::lookup(site, 0, 1000, 1, bytes));  // other extra key
+    REQUIRE(!CubTempSizeCache::lookup(site, 0, 5000, 0, bytes));  // other bucket
+    REQUIRE(!CubTempSizeCache::lookup(site, 1, 1000, 0, bytes));  // other device
+
+    auto stats = CubTempSizeCache::stats();
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 5);
+
+    // a site is looked up by name, not made again
+    REQUIRE(&CubTempSizeCache::site("cub_temp_size_cache_host") == &site);
+
+    CubTempSizeCache::enable(false);
+    REQUIRE(!CubTempSizeCache::lookup(site, 0, 1000, 0, bytes));
+    REQUIRE(CubTempSizeCache::stats().bypassed == 1);
+    CubTempSizeCache::enable(true);
+
+    CubTempSizeCache::clear();
+    REQUIRE(!CubTempSizeCache::lookup(site, 0, 1000, 0, bytes));
+    CubTempSizeCache::reset_stats();
+}
+
+void cub_temp_size_cache_device()
+{
+    constexpr int        N = 1000;
+    DeviceBuffer<int>    in(N);
+    DeviceVar<int>       out;
+    std::vector<int>     h_in(N, 1);
+    in = h_in;
+
+    CubTempSizeCache::reset_stats();
+    for(int i = 0; i < 3; ++i)
+        DeviceReduce().Sum(in.data(), out.data(), N);
+    int h_out = out;
+    REQUIRE(h_out == N);
+    // the first call may hit if the same Sum<> already ran in this process
+    auto stats = CubTempSizeCache::stats();
+    REQUIRE(stats.hits + stats.misses == 3);
+    REQUIRE(stats.hits >= 2);
+
+    // bypass
+    DeviceReduce().temp_size_cache(false).Sum(in.data(), out.data(), N / 2);
+    h_out = out;
+    REQUIRE(h_out == N / 2);
+    stats = CubTempSizeCache::stats();
+    REQUIRE(stats.hits + stats.misses == 3);
+    REQUIRE(stats.bypassed == 1);
+    CubTempSizeCache::reset_stats();
+}
+
+TEST_CASE("cub_temp_size_cache", "[cub]")
+{
+    cub_temp_size_cache_host();
+    cub_temp_size_cache_device();
+}
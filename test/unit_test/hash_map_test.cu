@@ -0,0 +1,71 @@
+#include <catch2/catch.hpp>
+#include <muda/muda.h>
+#include <muda/container.h>
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+using namespace muda;
+
+void hash_map_test()
+{
+    using Key = uint64_t;
+
+    std::mt19937                     rng(42);
+    std::uniform_int_distribution<Key> dist(0, 1 << 16);
+
+    std::vector<Key> h_keys(20000);
+    std::vector<int> h_values(h_keys.size());
+    for(size_t i = 0; i < h_keys.size(); ++i)
+    {
+        h_keys[i]   = dist(rng);
+        h_values[i] = (int)i;
+    }
+    std::vector<Key> h_erase(h_keys.begin(), h_keys.begin() + 5000);
+
+    // duplicate keys in one bulk insert keep an arbitrary value,
+    // so we only insert unique keys
+    std::sort(h_keys.begin(), h_keys.end());
+    h_keys.erase(std::unique(h_keys.begin(), h_keys.end()), h_keys.end());
+    h_values.resize(h_keys.size());
+
+    HostHashMap<Key, int> ref;
+    ref.insert(h_keys, h_values);
+    ref.erase(h_erase);
+
+    // start small to exercise rehash
+    DeviceHashMap<Key, int> map(16, 0.6f);
+    map.insert(DeviceBuffer<Key>(h_keys), DeviceBuffer<int>(h_values));
+    map.erase(DeviceBuffer<Key>(h_erase));
+    REQUIRE(map.size() == ref.size());
+
+    std::vector<Key> h_query(1 << 16);
+    std::iota(h_query.begin(), h_query.end(), 0);
+
+    std::vector<int> gt;
+    ref.find(h_query, gt, -1);
+
+    DeviceBuffer<Key> query(h_query);
+    DeviceBuffer<int> found(h_query.size());
+    map.find(query, found, -1);
+
+    std::vector<int> res;
+    found.copy_to(res);
+    REQUIRE(res == gt);
+
+    // in-kernel lookups through the viewer
+    DeviceBuffer<int> hit(h_query.size());
+    ParallelFor(256)
+        .apply(query.size(),
+               [map = map.cviewer(), query = query.cviewer(), hit = hit.viewer()] __device__(
+                   int i) mutable { hit(i) = map.contains(query(i)) ? 1 : 0; })
+        .wait();
+    hit.copy_to(res);
+    for(size_t i = 0; i < res.size(); ++i)
+        REQUIRE(res[i] == (gt[i] != -1 ? 1 : 0));
+}
+
+TEST_CASE("hash_map_test", "[container]")
+{
+    hash_map_test();
+}
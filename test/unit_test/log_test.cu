@@ -1,5 +1,8 @@
 #include <catch2/catch.hpp>
 #include <muda/muda.h>
+#include <algorithm>
+#include <numeric>
+#include <sstream>
 using namespace muda;
 
 void log_test()
@@ -31,3 +34,232 @@ TEST_CASE("log_test", "[log]")
 {
     log_test();
 }
+
+void streaming_log_test()
+{
+    Stream stream;
+
+    auto log_frames = [&](StreamingLogger& logger)
+    {
+        for(int frame = 0; frame < 4; ++frame)
+        {
+            ParallelFor(32, 0, stream)
+                .apply(100,
+                       [logger = logger.viewer(), frame] __device__(int i) mutable
+                       { logger << frame << ":" << i << "\n"; });
+            logger.flip();
+        }
+        logger.flush();
+    };
+
+    // large enough regions: every record arrives whole, frame by frame
+    {
+        std::string text;
+        {
+            StreamingLogger logger{[&](std::string_view s) { text += s; }, stream};
+            log_frames(logger);
+            REQUIRE(logger.overflow_count() == 0);
+        }
+
+        std::stringstream             ss{text};
+        std::string                   line;
+        std::vector<std::vector<int>> records(4);
+        int                           last_frame = 0;
+        while(std::getline(ss, line))
+        {
+            auto colon = line.find(':');
+            REQUIRE(colon != std::string::npos);
+            int frame = std::stoi(line.substr(0, colon));
+            REQUIRE(frame >= last_frame);
+            REQUIRE(frame < 4);
+            last_frame = frame;
+            records[frame].push_back(std::stoi(line.substr(colon + 1)));
+        }
+
+        // threads of a frame log in any order
+        std::vector<int> expected(100);
+        std::iota(expected.begin(), expected.end(), 0);
+        for(auto& frame : records)
+        {
+            std::sort(frame.begin(), frame.end());
+            REQUIRE(frame == expected);
+        }
+    }
+
+    // small regions to exercise the overflow/grow path
+    {
+        std::string text;
+        {
+            StreamingLogger logger{[&](std::string_view s) { text += s; }, stream, 64, 1024};
+            log_frames(logger);
+            REQUIRE(logger.overflow_count() > 0);
+        }
+        REQUIRE(!text.empty());
+    }
+}
+
+TEST_CASE("streaming_log_test", "[log]")
+{
+    streaming_log_test();
+}
+
+void binary_log_test()
+{
+    Logger logger_;
+    ParallelFor(32).apply(4,
+                          [logger = logger_.viewer()] __device__(int i) mutable
+                          { logger << "i=" << i << ";"; });
+
+    std::stringstream file;
+    logger_.retrieve_binary(file);
+
+    LoggerBinaryData data;
+    REQUIRE(read_logger_binary(file, data).empty());
+    REQUIRE(data.entries.size() == 12);
+    REQUIRE(data.string_table("kernel_name") != nullptr);
+
+    std::stringstream text;
+    std::vector<int>  values;
+    for(auto& e : data.entries)
+    {
+        REQUIRE(put_log_value(text, data, e));
+        if(e.basic_type() == LoggerBasicType::Int32)
+        {
+            std::stringstream v;
+            put_log_value(v, data, e);
+            values.push_back(std::stoi(v.str()));
+        }
+    }
+    std::sort(values.begin(), values.end());
+    REQUIRE(values == std::vector<int>{0, 1, 2, 3});
+    REQUIRE(text.str().find("i=") != std::string::npos);
+
+    // not a log file
+    std::stringstream garbage{"definitely not a muda log"};
+    REQUIRE(!read_logger_binary(garbage, data).empty());
+
+    // corrupted headers are rejected before anything is allocated
+    auto corrupted = [&](auto&& modify)
+    {
+        auto bytes = file.str();
+        details::LoggerBinaryHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        modify(header);
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        std::stringstream is{bytes};
+        LoggerBinaryData  result;
+        return read_logger_binary(is, result);
+    };
+    REQUIRE(!corrupted([](auto& h) { h.header_size = 4; }).empty());
+    REQUIRE(!corrupted([](auto& h) { h.entry_count = ~uint64_t{0}; }).empty());
+    REQUIRE(!corrupted([](auto& h) { h.payload_size = uint64_t{1} << 62; }).empty());
+    REQUIRE(!corrupted([](auto& h) { h.string_table_count = ~0u; }).empty());
+    REQUIRE(corrupted([](auto&) {}).empty());
+
+    // an entry whose size doesn't match its type is not formatted, nor read
+    // past the end of the payload
+    LoggerBinaryEntry bad;
+    bad.id     = 0;
+    bad.type   = static_cast<uint16_t>(LoggerBasicType::Double);
+    bad.size   = 0;
+    bad.offset = static_cast<uint32_t>(data.payload.size());
+    std::stringstream bad_text;
+    REQUIRE(!put_log_value(bad_text, data, bad));
+    bad.size   = 4;
+    bad.offset = 0;
+    REQUIRE(!put_log_value(bad_text, data, bad));
+    bad.type = static_cast<uint16_t>(LoggerBasicType::Long);
+    bad.size = 2;
+    REQUIRE(!put_log_value(bad_text, data, bad));
+    REQUIRE(bad_text.str().empty());
+}
+
+TEST_CASE("binary_log_test", "[log]")
+{
+    binary_log_test();
+}
+
+void log_order_test()
+{
+    Logger logger_;
+    // every thread logs, divergent lanes reserve separately
+    ParallelFor(128).apply(4096,
+                           [logger = logger_.viewer()] __device__(int i) mutable
+                           {
+                               if(i % 3 == 0)
+                                   logger << i << "\n";
+                               else
+                                   logger << "odd" << i << "\n";
+                           });
+
+    auto meta = logger_.retrieve_meta();
+    auto data = meta.meta_data();
+    size_t expected = 0;
+    for(int i = 0; i < 4096; ++i)
+        expected += i % 3 == 0 ? 2 : 3;
+    REQUIRE(data.size() == expected);
+    for(size_t i = 1; i < data.size(); ++i)
+        REQUIRE(data[i - 1].id <= data[i].id);
+}
+
+TEST_CASE("log_order_test", "[log]")
+{
+    log_order_test();
+}
+
+void log_level_test()
+{
+    Logger logger_;
+    logger_.set_level(LogLevel::Info);
+    ParallelFor(64).apply(256,
+                          [logger = logger_.viewer()] __device__(int i) mutable
+                          {
+                              logger.trace() << "trace " << i << "\n";
+                              logger.debug() << "debug " << i << "\n";
+                              logger.info() << i;
+                              logger.warn() << i;
+                          });
+    // only info and warn, one entry each
+    REQUIRE(logger_.retrieve_meta().meta_data().size() == 2 * 256);
+
+    logger_.set_level(LogLevel::Trace);
+    logger_.set_sampling(LoggerSampling{3, 4, 1});  // every 3rd message of every 4th thread
+    ParallelFor(64).apply(256,
+                          [logger = logger_.viewer()] __device__(int i) mutable
+                          {
+                              for(int k = 0; k < 6; ++k)
+                                  logger << k;
+                          });
+    REQUIRE(logger_.retrieve_meta().meta_data().size() == 256 / 4 * 2);
+}
+
+TEST_CASE("log_level_test", "[log]")
+{
+    log_level_test();
+}
+
+void log_stream_test()
+{
+    Stream s0, s1;
+    Logger l0, l1;
+    for(int frame = 0; frame < 3; ++frame)
+    {
+        ParallelFor(32, 0, s0).apply(64,
+                                     [logger = l0.viewer()] __device__(int i) mutable
+                                     { logger << i; });
+        ParallelFor(32, 0, s1).apply(16,
+                                     [logger = l1.viewer()] __device__(int i) mutable
+                                     { logger << i; });
+
+        // each retrieval only waits for its own stream
+        REQUIRE(l0.retrieve_meta(s0).meta_data().size() == 64);
+        std::stringstream ss;
+        l1.retrieve(s1, ss);
+        REQUIRE(!ss.str().empty());
+    }
+}
+
+TEST_CASE("log_stream_test", "[log]")
+{
+    log_stream_test();
+}
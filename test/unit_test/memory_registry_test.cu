@@ -0,0 +1,50 @@
+#include <catch2/catch.hpp>
+#include <muda/muda.h>
+#include <muda/container.h>
+#include <muda/tools/memory_registry.h>
+
+using namespace muda;
+
+void memory_registry_test()
+{
+    MemoryRegistry::enable();
+
+    auto buffer_before = MemoryRegistry::stats(MemoryCategory::Buffer);
+    auto other_before  = MemoryRegistry::stats(MemoryCategory::Other);
+    {
+        DeviceBuffer<int> buffer(1024);
+        auto buffer_stats = MemoryRegistry::stats(MemoryCategory::Buffer);
+        REQUIRE(buffer_stats.current_bytes == buffer_before.current_bytes + 1024 * sizeof(int));
+        REQUIRE(buffer_stats.alloc_count == buffer_before.alloc_count + 1);
+
+        {
+            MemoryScope         scope{MemoryCategory::Other, "memory_registry_test"};
+            DeviceBuffer<float> tagged(256);
+            auto other_stats = MemoryRegistry::stats(MemoryCategory::Other);
+            REQUIRE(other_stats.current_bytes
+                    == other_before.current_bytes + 256 * sizeof(float));
+
+            auto live = MemoryRegistry::live_allocations();
+            auto it   = std::find_if(live.begin(),
+                                   live.end(),
+                                   [&](const MemoryAllocationInfo& info)
+                                   { return info.ptr == tagged.data(); });
+            REQUIRE(it != live.end());
+            REQUIRE(it->name == "memory_registry_test");
+            REQUIRE(it->category == MemoryCategory::Other);
+        }
+
+        auto other_stats = MemoryRegistry::stats(MemoryCategory::Other);
+        REQUIRE(other_stats.current_bytes == other_before.current_bytes);
+        REQUIRE(other_stats.peak_bytes >= other_before.current_bytes + 256 * sizeof(float));
+    }
+    auto buffer_after = MemoryRegistry::stats(MemoryCategory::Buffer);
+    REQUIRE(buffer_after.current_bytes == buffer_before.current_bytes);
+
+    MemoryRegistry::enable(false);
+}
+
+TEST_CASE("memory_registry_test", "[memory]")
+{
+    memory_registry_test();
+}
@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 #include <muda/muda.h>
 #include <muda/container.h>
+#include <muda/cub/cub.h>
 
 using namespace muda;
 
@@ -9,3 +10,76 @@ TEST_CASE("named_viewer_test", "[viewer]")
     auto v = Dense1D<float>(nullptr, 1);
     REQUIRE(v.name() == std::string("~"));
 }
+
+TEST_CASE("check_level_test", "[viewer]")
+{
+    // build with -DMUDA_CHECK_LEVEL=0..3 to cover each level
+    REQUIRE(RUNTIME_CHECK_ON == (CHECK_LEVEL >= CheckLevel::Bounds));
+    REQUIRE(DEBUG_VIEWER == RUNTIME_CHECK_ON);
+    REQUIRE(CHECK_NAMES_ON == (CHECK_LEVEL >= CheckLevel::Full));
+    REQUIRE(FULL_DEBUG_VIEWER == CHECK_NAMES_ON);
+
+    // names are only carried from the full level on
+    auto v = Dense1D<float>(nullptr, 1);
+    v.name("v");
+    REQUIRE(v.name() == std::string(CHECK_NAMES_ON ? "v" : "~"));
+
+    // in-range subviews and indices pass the checks of every level
+    DeviceBuffer<int> buffer(16);
+    buffer.fill(0);
+    ParallelFor(32)
+        .kernel_name("check_level_test")
+        .apply(8,
+               [b = buffer.viewer().name("b")] __device__(int i) mutable
+               {
+                   auto sub = b.subview(8, 8);
+                   sub(i)   = i;
+               });
+    std::vector<int> host;
+    buffer.copy_to(host);
+    for(int i = 0; i < 16; ++i)
+        REQUIRE(host[i] == (i < 8 ? 0 : i - 8));
+}
+
+__global__ void copy_viewer_name(Dense1D<char> out, CDense1D<int> v)
+{
+    auto n = v.name();
+    int  i = 0;
+    for(; n[i] != '\0' && i < out.dim() - 1; ++i)
+        out(i) = n[i];
+    out(i) = '\0';
+}
+
+TEST_CASE("name_flush_test", "[viewer]")
+{
+    // a cache with a string that is not on the device yet
+    details::HostDeviceStringCache cache;
+    cache["name_flush_test"];
+    REQUIRE(cache.has_pending());
+
+    // flushed before a cub call
+    DeviceBuffer<int> input(16);
+    DeviceVar<int>    sum;
+    input.fill(1);
+    DeviceReduce().Sum(input.data(), sum.data(), input.size());
+    REQUIRE(!cache.has_pending());
+    REQUIRE(int(sum) == 16);
+
+    // flushed before a Kernel launch
+    cache["name_flush_test_kernel"];
+    REQUIRE(cache.has_pending());
+    DeviceBuffer<char> out(64);
+    Kernel{copy_viewer_name}(out.viewer(), input.cviewer());
+    REQUIRE(!cache.has_pending());
+
+    // a raw launch sees the name once flushed
+    cache["name_flush_test_raw"];
+    auto v = input.cviewer().name("name_flush_test_raw_viewer");
+    flush_names();
+    REQUIRE(!cache.has_pending());
+    copy_viewer_name<<<1, 1>>>(out.viewer(), v);
+    std::vector<char> host;
+    out.copy_to(host);
+    REQUIRE(std::string(host.data())
+            == std::string(CHECK_NAMES_ON ? "name_flush_test_raw_viewer" : "~"));
+}
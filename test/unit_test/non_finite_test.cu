@@ -0,0 +1,102 @@
+#include <catch2/catch.hpp>
+#include <muda/muda.h>
+#include <muda/container.h>
+
+using namespace muda;
+
+void non_finite_test()
+{
+    DeviceBuffer<float> a(64);
+    a.fill(1.0f);
+    NonFiniteSentinel::reset();
+
+    ParallelFor(32)
+        .kernel_name("produce_nan")
+        .apply(a.size(),
+               [a = a.viewer().name("a")] __device__(int i) mutable
+               {
+                   if(i == 17)
+                       a(i) = a(i) * nanf("");
+               });
+
+    auto report = NonFiniteSentinel::report();
+    if constexpr(!NON_FINITE_CHECK_ON)
+    {
+        // no scan at all
+        REQUIRE(!report.found);
+        REQUIRE(report.count == 0);
+        return;
+    }
+
+    // the kernel that wrote the NaN is blamed
+    REQUIRE(report.found);
+    REQUIRE(report.count == 1);
+    REQUIRE(report.index[0] == 17);
+    REQUIRE(report.index[1] == -1);
+    REQUIRE(std::isnan(report.value));
+    if constexpr(CHECK_NAMES_ON)
+    {
+        REQUIRE(report.viewer_name == "a");
+        REQUIRE(report.kernel_name == "produce_nan");
+    }
+    NonFiniteSentinel::reset();
+
+    // reading the NaN through a const viewer is not reported again
+    DeviceVar<int> nan_count = 0;
+    ParallelFor(32)
+        .kernel_name("consume_nan")
+        .apply(a.size(),
+               [a = a.cviewer().name("a"), nan_count = nan_count.viewer()] __device__(int i) mutable
+               {
+                   if(isnan(a(i)))
+                       atomic_add(nan_count.data(), 1);
+               });
+    REQUIRE(!NonFiniteSentinel::report().found);
+    REQUIRE(int(nan_count) == 1);
+
+    // nor is an uninitialized buffer that is only read
+    DeviceBuffer<double> uninit(128);
+    DeviceVar<int>       touched = 0;
+    ParallelFor(32)
+        .kernel_name("read_uninit")
+        .apply(uninit.size(),
+               [u = uninit.cviewer(), touched = touched.viewer()] __device__(int i) mutable
+               {
+                   if(u(i) == 0.0)
+                       atomic_add(touched.data(), 1);
+               });
+    REQUIRE(!NonFiniteSentinel::report().found);
+
+    // nor by a launch that opts out
+    a.fill(1.0f);
+    ParallelFor(32)
+        .kernel_name("opt_out")
+        .check_non_finite(false)
+        .apply(a.size(),
+               [a = a.viewer().name("a")] __device__(int i) mutable
+               {
+                   if(i == 3)
+                       a(i) = 1.0f / 0.0f;
+               });
+    REQUIRE(!NonFiniteSentinel::report().found);
+
+    // pitched 2D, reported with both indices
+    DeviceBuffer2D<double> b(Extent2D{5, 7});
+    b.fill(0.0);
+    Launch()
+        .kernel_name("produce_inf")
+        .apply([b = b.viewer().name("b")] __device__() mutable
+               { b(2, 3) = 1.0 / b(0, 0); });
+    report = NonFiniteSentinel::report();
+    REQUIRE(report.found);
+    REQUIRE(report.count == 1);
+    REQUIRE(report.index[0] == 2);
+    REQUIRE(report.index[1] == 3);
+    REQUIRE(std::isinf(report.value));
+    NonFiniteSentinel::reset();
+}
+
+TEST_CASE("non_finite_test", "[viewer]")
+{
+    non_finite_test();
+}
@@ -0,0 +1,222 @@
+/*****************************************************************//**
+ * \file   muda_log_decode.cpp
+ * \brief  Offline decoder of `Logger::retrieve_binary()` dumps.
+ *
+ * usage:
+ *  muda_log_decode <log.bin> [--json] [--id <id>] [--id-range <begin> <end>]
+ *                  [--type <Int32,Float,String,...>] [--tables] [-o <out>]
+ *********************************************************************/
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <set>
+#include <muda/logger/logger_binary.h>
+
+using namespace muda;
+
+namespace
+{
+class Options
+{
+  public:
+    std::string           input;
+    std::string           output;
+    bool                  json        = false;
+    bool                  tables      = false;
+    uint32_t              id_begin    = 0;
+    uint32_t              id_end      = ~0u;  // exclusive
+    std::set<std::string> types;
+};
+
+void print_usage(std::ostream& os)
+{
+    os << "usage: muda_log_decode <log.bin> [options]\n"
+          "  --json                   output a JSON array instead of text\n"
+          "  --id <id>                only entries of this log id\n"
+          "  --id-range <begin> <end> only entries with begin <= id < end\n"
+          "  --type <T1,T2,...>       only entries of these types (Int32, Float, String ...)\n"
+          "  --tables                 also print the kernel/viewer name tables\n"
+          "  -o <file>                write to file instead of stdout\n";
+}
+
+bool parse(int argc, char** argv, Options& opt)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        auto             next = [&]() -> const char*
+        { return i + 1 < argc ? argv[++i] : nullptr; };
+
+        if(arg == "--json")
+            opt.json = true;
+        else if(arg == "--tables")
+            opt.tables = true;
+        else if(arg == "--id")
+        {
+            auto v = next();
+            if(!v)
+                return false;
+            opt.id_begin = std::stoul(v);
+            opt.id_end   = opt.id_begin + 1;
+        }
+        else if(arg == "--id-range")
+        {
+            auto b = next();
+            auto e = next();
+            if(!b || !e)
+                return false;
+            opt.id_begin = std::stoul(b);
+            opt.id_end   = std::stoul(e);
+        }
+        else if(arg == "--type")
+        {
+            auto v = next();
+            if(!v)
+                return false;
+            std::stringstream ss{v};
+            std::string       t;
+            while(std::getline(ss, t, ','))
+                opt.types.insert(t);
+        }
+        else if(arg == "-o")
+        {
+            auto v = next();
+            if(!v)
+                return false;
+            opt.output = v;
+        }
+        else if(arg == "-h" || arg == "--help")
+            return false;
+        else if(opt.input.empty())
+            opt.input = arg;
+        else
+            return false;
+    }
+    return !opt.input.empty();
+}
+
+bool accept(const Options& opt, const LoggerBinaryEntry& e)
+{
+    if(e.id < opt.id_begin || e.id >= opt.id_end)
+        return false;
+    if(!opt.types.empty() && !opt.types.count(std::string{enum_name(e.basic_type())}))
+        return false;
+    return true;
+}
+
+void put_text(std::ostream& os, const Options& opt, const LoggerBinaryData& data)
+{
+    for(auto& e : data.entries)
+    {
+        if(!accept(opt, e))
+            continue;
+        if(!put_log_value(os, data, e))
+            os << "[log_id " << e.id << ": can't decode " << enum_name(e.basic_type()) << "]";
+    }
+    if(data.exceed_meta_data)
+        os << "\n[muda_log_decode: meta data was exceeded, some entries are missing]\n";
+    if(data.exceed_buffer)
+        os << "\n[muda_log_decode: buffer was exceeded, some entries are missing]\n";
+
+    if(opt.tables)
+    {
+        for(auto& t : data.string_tables)
+        {
+            os << "\n[" << t.name << "]\n";
+            for(size_t i = 0; i < t.strings.size(); ++i)
+                os << i << ": " << t.strings[i] << "\n";
+        }
+    }
+}
+
+void put_json(std::ostream& os, const Options& opt, const LoggerBinaryData& data)
+{
+    os << "{\n  \"entries\": [";
+    bool first = true;
+    for(auto& e : data.entries)
+    {
+        if(!accept(opt, e))
+            continue;
+        os << (first ? "\n" : ",\n") << "    {\"id\": " << e.id << ", \"type\": ";
+        put_json_string(os, enum_name(e.basic_type()));
+        if(e.exceeded)
+            os << ", \"exceeded\": true";
+        else
+        {
+            std::stringstream value;
+            if(put_log_value(value, data, e))
+            {
+                os << ", \"value\": ";
+                if(e.basic_type() == LoggerBasicType::String)
+                    put_json_string(os, value.str());
+                else
+                    os << value.str();
+            }
+        }
+        os << "}";
+        first = false;
+    }
+    os << "\n  ],\n  \"exceed_meta_data\": " << (data.exceed_meta_data ? "true" : "false")
+       << ",\n  \"exceed_buffer\": " << (data.exceed_buffer ? "true" : "false");
+
+    if(opt.tables)
+    {
+        for(auto& t : data.string_tables)
+        {
+            os << ",\n  ";
+            put_json_string(os, t.name);
+            os << ": [";
+            for(size_t i = 0; i < t.strings.size(); ++i)
+            {
+                os << (i ? ", " : "");
+                put_json_string(os, t.strings[i]);
+            }
+            os << "]";
+        }
+    }
+    os << "\n}\n";
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if(!parse(argc, argv, opt))
+    {
+        print_usage(std::cerr);
+        return 1;
+    }
+
+    std::ifstream in{opt.input, std::ios::binary};
+    if(!in)
+    {
+        std::cerr << "muda_log_decode: can't open " << opt.input << "\n";
+        return 1;
+    }
+
+    LoggerBinaryData data;
+    if(auto err = read_logger_binary(in, data); !err.empty())
+    {
+        std::cerr << "muda_log_decode: " << opt.input << ": " << err << "\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if(!opt.output.empty())
+    {
+        file.open(opt.output);
+        if(!file)
+        {
+            std::cerr << "muda_log_decode: can't open " << opt.output << "\n";
+            return 1;
+        }
+    }
+    std::ostream& os = opt.output.empty() ? std::cout : file;
+
+    if(opt.json)
+        put_json(os, opt, data);
+    else
+        put_text(os, opt, data);
+    return 0;
+}
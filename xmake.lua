@@ -17,11 +17,19 @@ target("muda")
     set_kind("headeronly")
     add_headerfiles("src/(muda/**.h)","src/(muda/**.inl)", {public = true})
     add_includedirs("src/", {public = true})
-    if(has_config("with_check")) then
+    if(get_config("check_level") and get_config("check_level") ~= "") then
+        add_defines("MUDA_CHECK_LEVEL=" .. get_config("check_level"), {public = true})
+    elseif(has_config("with_check")) then
         add_defines("MUDA_CHECK_ON=1", {public = true})
     else
         add_defines("MUDA_CHECK_ON=0", {public = true})
     end
+    if(has_config("with_non_finite_check")) then
+        add_defines("MUDA_NON_FINITE_CHECK=1", {public = true})
+    end
+    if(has_config("with_access_profile")) then
+        add_defines("MUDA_ACCESS_PROFILE=1", {public = true})
+    end
     if(has_config("with_compute_graph")) then
         add_defines("MUDA_COMPUTE_GRAPH_ON=1", {public = true})
     else
@@ -59,3 +67,11 @@ if has_config("example") then
     target_end()
 end
 
+if has_config("tools") then
+    -- offline tools, pure host C++
+    target("muda_log_decode")
+        set_kind("binary")
+        add_includedirs("src/")
+        add_files("tools/muda_log_decode/muda_log_decode.cpp")
+    target_end()
+end
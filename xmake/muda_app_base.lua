@@ -15,5 +15,5 @@ function muda_app_base(kind)
     add_headerfiles("src/muda/**.h","src/muda/**.inl")
     
     add_cugencodes("compute_75")
-    add_links("cublas","cusparse")
+    add_links("cublas","cusparse","cusolver")
 end
\ No newline at end of file
@@ -35,6 +35,14 @@ option("test")
     option_dev_related()
 option_end()
 
+option("tools")
+    set_default(false)
+    set_showmenu(true)
+    set_description("build muda offline tools (e.g. muda_log_decode).")
+    set_category("root menu/dev")
+    option_dev_related()
+option_end()
+
 option("playground")
     set_default(false)
     set_showmenu(true)
@@ -55,6 +63,27 @@ option("with_check")
     set_category("root menu/config")
 option_end()
 
+option("check_level")
+    set_default("")
+    set_showmenu(true)
+    set_description("muda runtime check level: 0 off, 1 bounds, 2 full (with names), 3 full + sync all. overrides with_check.")
+    set_category("root menu/config")
+option_end()
+
+option("with_non_finite_check")
+    set_default(false)
+    set_showmenu(true)
+    set_description("turn on the NaN/Inf sentinel of viewers (all modes).")
+    set_category("root menu/config")
+option_end()
+
+option("with_access_profile")
+    set_default(false)
+    set_showmenu(true)
+    set_description("turn on the warp access tracing of viewers (all modes).")
+    set_category("root menu/config")
+option_end()
+
 option("with_compute_graph")
     set_default(false)
     set_showmenu(true)